@@ -926,6 +926,8 @@ static void createLookupTable() {
 //
 ////////////////////////////////////////
 
+// The OPL chip is programmed from the OPL timer callback, so events are
+// played at timer resolution; sendDelayed() falls back to send().
 class MidiDriver_ADLIB : public MidiDriver {
 	friend class AdLibPart;
 	friend class AdLibPercussionChannel;
@@ -0,0 +1,266 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/decoded_sound_cache.h"
+#include "audio/audiostream.h"
+
+#include "common/debug.h"
+
+namespace Common {
+DECLARE_SINGLETON(Audio::DecodedSoundCache);
+}
+
+namespace Audio {
+
+enum {
+	kDefaultMaxSoundSize = 512 * 1024,
+	kDefaultMemoryBudget = 8 * 1024 * 1024
+};
+
+/**
+ * Decoded PCM data of one sound, shared by the cache and all streams
+ * playing it. Streams are usually destroyed by the mixer thread, and may
+ * outlive the cache itself, so the reference count is guarded by a mutex
+ * which belongs to the sound and lives exactly as long as its data.
+ */
+struct DecodedSound {
+	Common::String key;
+	int16 *samples;
+	uint32 numSamples;
+	int rate;
+	bool stereo;
+
+	Common::Mutex refLock;
+	uint refCount;
+
+	DecodedSound() : samples(0), numSamples(0), rate(0), stereo(false), refCount(1) {}
+	~DecodedSound() { free(samples); }
+
+	uint32 size() const { return numSamples * sizeof(int16); }
+
+	void incRef() {
+		Common::StackLock lock(refLock);
+		refCount++;
+	}
+
+	void decRef() {
+		bool last;
+		{
+			Common::StackLock lock(refLock);
+			last = (--refCount == 0);
+		}
+
+		if (last)
+			delete this;
+	}
+};
+
+/**
+ * A stream playing a sound from the decoded sound cache.
+ */
+class DecodedSoundStream : public SeekableAudioStream {
+public:
+	DecodedSoundStream(DecodedSound *sound) : _sound(sound), _pos(0) {
+		_sound->incRef();
+	}
+
+	~DecodedSoundStream() {
+		_sound->decRef();
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const uint32 len = MIN<uint32>(numSamples, _sound->numSamples - _pos);
+		memcpy(buffer, _sound->samples + _pos, len * sizeof(int16));
+		_pos += len;
+		return len;
+	}
+
+	bool isStereo() const  { return _sound->stereo; }
+	bool endOfData() const { return _pos >= _sound->numSamples; }
+
+	int getRate() const         { return _sound->rate; }
+	Timestamp getLength() const { return Timestamp(0, _sound->numSamples / (_sound->stereo ? 2 : 1), _sound->rate); }
+
+	bool seek(const Timestamp &where) {
+		const uint32 seekSample = convertTimeToStreamPos(where, getRate(), isStereo()).totalNumberOfFrames();
+		if (seekSample > _sound->numSamples) {
+			_pos = _sound->numSamples;
+			return false;
+		}
+
+		_pos = seekSample;
+		return true;
+	}
+
+private:
+	DecodedSound *_sound;
+	uint32 _pos;
+};
+
+DecodedSoundCache::DecodedSoundCache()
+	: _maxSoundSize(kDefaultMaxSoundSize), _memoryBudget(kDefaultMemoryBudget), _usedBytes(0),
+	  _hits(0), _misses(0), _rejected(0), _evictions(0) {
+}
+
+DecodedSoundCache::~DecodedSoundCache() {
+	clear();
+}
+
+Common::String DecodedSoundCache::makeKey(const Common::String &member, uint32 offset) {
+	return Common::String::format("%s@%u", member.c_str(), offset);
+}
+
+SeekableAudioStream *DecodedSoundCache::getStream(const Common::String &member, uint32 offset) {
+	Common::StackLock lock(_mutex);
+
+	SoundMap::iterator entry = _sounds.find(makeKey(member, offset));
+	if (entry == _sounds.end()) {
+		_misses++;
+		return 0;
+	}
+
+	_hits++;
+
+	// Move the sound to the back of the LRU list
+	DecodedSound *sound = *entry->_value;
+	_lru.erase(entry->_value);
+	_lru.push_back(sound);
+	entry->_value = _lru.reverse_begin();
+
+	return new DecodedSoundStream(sound);
+}
+
+SeekableAudioStream *DecodedSoundCache::cacheStream(const Common::String &member, uint32 offset, SeekableAudioStream *stream) {
+	if (!stream)
+		return 0;
+
+	const bool stereo = stream->isStereo();
+	const int rate = stream->getRate();
+	const uint32 numSamples = convertTimeToStreamPos(stream->getLength(), rate, stereo).totalNumberOfFrames();
+	const uint32 size = numSamples * sizeof(int16);
+
+	if (!numSamples || size > _maxSoundSize || size > _memoryBudget) {
+		Common::StackLock lock(_mutex);
+		_rejected++;
+		return stream;
+	}
+
+	int16 *samples = (int16 *)malloc(size);
+	if (!samples) {
+		warning("DecodedSoundCache::cacheStream: Could not allocate %u bytes", size);
+		return stream;
+	}
+
+	// Decode the whole sound. Decoders do not always know their exact
+	// length up front, so trust the amount of samples actually read.
+	uint32 decoded = 0;
+	while (decoded < numSamples && !stream->endOfData()) {
+		const int len = stream->readBuffer(samples + decoded, numSamples - decoded);
+		if (len <= 0)
+			break;
+		decoded += len;
+	}
+	delete stream;
+
+	DecodedSound *sound = new DecodedSound();
+	sound->key = makeKey(member, offset);
+	sound->samples = samples;
+	sound->numSamples = decoded;
+	sound->rate = rate;
+	sound->stereo = stereo;
+
+	// The stream takes its own reference before the cache lock is taken
+	SeekableAudioStream *result = new DecodedSoundStream(sound);
+
+	Common::StackLock lock(_mutex);
+
+	SoundMap::iterator old = _sounds.find(sound->key);
+	if (old != _sounds.end())
+		remove(old);
+
+	evict(sound->size());
+
+	_lru.push_back(sound);
+	_sounds[sound->key] = _lru.reverse_begin();
+	_usedBytes += sound->size();
+
+	debug(5, "DecodedSoundCache: Cached '%s' (%u bytes, %u bytes in use)", sound->key.c_str(), sound->size(), _usedBytes);
+
+	return result;
+}
+
+void DecodedSoundCache::evict(uint32 neededBytes) {
+	while (!_lru.empty() && _usedBytes + neededBytes > _memoryBudget) {
+		remove(_sounds.find(_lru.front()->key));
+		_evictions++;
+	}
+}
+
+void DecodedSoundCache::remove(SoundMap::iterator entry) {
+	assert(entry != _sounds.end());
+
+	DecodedSound *sound = *entry->_value;
+	_lru.erase(entry->_value);
+	_sounds.erase(entry);
+	_usedBytes -= sound->size();
+
+	sound->decRef();
+}
+
+void DecodedSoundCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	while (!_sounds.empty())
+		remove(_sounds.begin());
+}
+
+void DecodedSoundCache::setMaxSoundSize(uint32 bytes) {
+	_maxSoundSize = bytes;
+}
+
+void DecodedSoundCache::setMemoryBudget(uint32 bytes) {
+	Common::StackLock lock(_mutex);
+
+	_memoryBudget = bytes;
+	evict(0);
+}
+
+DecodedSoundCache::Stats DecodedSoundCache::getStats() {
+	Common::StackLock lock(_mutex);
+
+	Stats stats;
+	stats.hits = _hits;
+	stats.misses = _misses;
+	stats.rejected = _rejected;
+	stats.evictions = _evictions;
+	stats.entries = _sounds.size();
+	stats.usedBytes = _usedBytes;
+	return stats;
+}
+
+void DecodedSoundCache::resetStats() {
+	Common::StackLock lock(_mutex);
+
+	_hits = _misses = _rejected = _evictions = 0;
+}
+
+} // End of namespace Audio
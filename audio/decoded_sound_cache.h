@@ -0,0 +1,145 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_DECODED_SOUND_CACHE_H
+#define AUDIO_DECODED_SOUND_CACHE_H
+
+#include "common/scummsys.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Audio {
+
+class SeekableAudioStream;
+struct DecodedSound;
+
+/**
+ * Cache of fully decoded PCM data for short sounds.
+ *
+ * Engines which play the same short sound effects over and over (clicks,
+ * footsteps, ...) would otherwise create a new decoder for the compressed
+ * data every time the sound is played. The cache decodes such a sound once
+ * and afterwards hands out SeekableAudioStreams which play straight from
+ * the decoded buffer.
+ *
+ * Sounds are identified by the name of the archive member they are stored
+ * in and their offset inside of that member. Usage looks like this:
+ *
+ * @code
+ * Audio::SeekableAudioStream *stream = DecodedSounds.getStream(name, offset);
+ * if (!stream)
+ *     stream = DecodedSounds.cacheStream(name, offset, Audio::makeVOCStream(...));
+ * @endcode
+ *
+ * The cache is cleared whenever an engine quits, since member names are
+ * only unique within a single game.
+ */
+class DecodedSoundCache : public Common::Singleton<DecodedSoundCache> {
+public:
+	/** Statistics, as reported by the "soundcache" debugger command. */
+	struct Stats {
+		uint32 hits;       ///< Number of getStream calls which found the sound
+		uint32 misses;     ///< Number of getStream calls which did not find the sound
+		uint32 rejected;   ///< Number of sounds too large (or unsuitable) to cache
+		uint32 evictions;  ///< Number of sounds dropped to stay in the memory budget
+		uint32 entries;    ///< Number of sounds currently cached
+		uint32 usedBytes;  ///< Memory currently used by cached PCM data
+	};
+
+	/**
+	 * Look up a previously cached sound.
+	 *
+	 * @param member the name of the archive member containing the sound
+	 * @param offset the offset of the sound inside of the member
+	 * @return a new stream playing the cached sound, or 0 if it is not cached
+	 */
+	SeekableAudioStream *getStream(const Common::String &member, uint32 offset);
+
+	/**
+	 * Decode a sound and add it to the cache.
+	 *
+	 * If the decoded sound is small enough it is read completely from
+	 * the given stream, which is deleted afterwards, and a stream playing
+	 * from the cached data is returned. Otherwise the given stream is
+	 * returned untouched, so the caller can always use the result in place
+	 * of the stream it passed in.
+	 *
+	 * @param member the name of the archive member containing the sound
+	 * @param offset the offset of the sound inside of the member
+	 * @param stream the decoder for the sound (ownership is transferred)
+	 * @return a stream to play the sound, or 0 if stream was 0
+	 */
+	SeekableAudioStream *cacheStream(const Common::String &member, uint32 offset, SeekableAudioStream *stream);
+
+	/** Drop all cached sounds. Streams still playing are not affected. */
+	void clear();
+
+	/** Set the largest decoded size (in bytes) of a sound which is cached. */
+	void setMaxSoundSize(uint32 bytes);
+	uint32 getMaxSoundSize() const { return _maxSoundSize; }
+
+	/** Set the total amount of memory (in bytes) cached sounds may use. */
+	void setMemoryBudget(uint32 bytes);
+	uint32 getMemoryBudget() const { return _memoryBudget; }
+
+	Stats getStats();
+	void resetStats();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DecodedSoundCache();
+	~DecodedSoundCache();
+
+	typedef Common::List<DecodedSound *> SoundList;
+	typedef Common::HashMap<Common::String, SoundList::iterator, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SoundMap;
+
+	static Common::String makeKey(const Common::String &member, uint32 offset);
+
+	void evict(uint32 neededBytes);
+	void remove(SoundMap::iterator entry);
+
+	Common::Mutex _mutex;
+
+	/** Cached sounds, least recently used first. */
+	SoundList _lru;
+	SoundMap _sounds;
+
+	uint32 _maxSoundSize;
+	uint32 _memoryBudget;
+	uint32 _usedBytes;
+
+	uint32 _hits;
+	uint32 _misses;
+	uint32 _rejected;
+	uint32 _evictions;
+};
+
+} // End of namespace Audio
+
+/** Shortcut for accessing the decoded sound cache. */
+#define DecodedSounds Audio::DecodedSoundCache::instance()
+
+#endif
@@ -107,6 +107,17 @@ public:
 		send(status | ((uint32)firstOp << 8) | ((uint32)secondOp << 16));
 	}
 
+	/**
+	 * Output a packed midi command to the midi stream, to be played the
+	 * given amount of microseconds after the current timer callback.
+	 * This is used by MidiParser to let drivers which render their output
+	 * themselves play events at their exact time, instead of at timer
+	 * resolution. Drivers which can not schedule events play them at once.
+	 */
+	virtual void sendDelayed(uint32 b, uint32 delay) {
+		send(b);
+	}
+
 	/**
 	 * Transmit a sysEx to the midi device.
 	 *
@@ -119,10 +130,42 @@ public:
 	 */
 	virtual void sysEx(const byte *msg, uint16 length) { }
 
+	/**
+	 * Transmit a sysEx to the midi device, to be played the given amount
+	 * of microseconds after the current timer callback.
+	 * @see sendDelayed
+	 */
+	virtual void sysExDelayed(const byte *msg, uint16 length, uint32 delay) {
+		sysEx(msg, length);
+	}
+
 	// TODO: Document this.
 	virtual void metaEvent(byte type, byte *data, uint16 length) { }
 };
 
+/**
+ * Base class for MIDI outputs which filter messages in send() before passing
+ * them on to a driver or channel. sendDelayed() keeps the delay in _sendDelay
+ * while send() runs, so it can be handed on along with the message.
+ */
+class MidiDriver_Filter : public MidiDriver_BASE {
+public:
+	MidiDriver_Filter() : _sendDelay(0) { }
+
+	virtual void sendDelayed(uint32 b, uint32 delay) {
+		_sendDelay = delay;
+		send(b);
+		_sendDelay = 0;
+	}
+
+protected:
+	/**
+	 * The delay of the message sendDelayed() is passing through send().
+	 * 0 for messages which are due right away.
+	 */
+	uint32 _sendDelay;
+};
+
 /**
  * Abstract MIDI Driver Class
  *
@@ -262,6 +305,12 @@ public:
 
 	virtual void send(uint32 b) = 0; // 4-bit channel portion is ignored
 
+	/**
+	 * Send a message to be played the given amount of microseconds after
+	 * the current timer callback. @see MidiDriver_BASE::sendDelayed
+	 */
+	virtual void sendDelayed(uint32 b, uint32 delay) { send(b); }
+
 	// Regular messages
 	virtual void noteOff(byte note) = 0;
 	virtual void noteOn(byte note, byte velocity) = 0;
@@ -35,6 +35,8 @@ MidiParser::MidiParser() :
 _hangingNotesCount(0),
 _driver(0),
 _timerRate(0x4A0000),
+_eventDelay(0),
+_timedEvents(false),
 _ppqn(96),
 _tempo(500000),
 _psecPerTick(5208), // 500000 / 96
@@ -72,7 +74,20 @@ void MidiParser::property(int prop, int value) {
 }
 
 void MidiParser::sendToDriver(uint32 b) {
-	_driver->send(b);
+	// Events sent by onTimer() go through sendDelayed(), even those due
+	// right away, so drivers can keep them in order with the events they
+	// have queued. Anything sent at other times goes after those.
+	if (_timedEvents)
+		_driver->sendDelayed(b, _eventDelay);
+	else
+		_driver->send(b);
+}
+
+void MidiParser::sendSysExToDriver(const byte *msg, uint16 length) {
+	if (_timedEvents)
+		_driver->sysExDelayed(msg, length, _eventDelay);
+	else
+		_driver->sysEx(msg, length);
 }
 
 void MidiParser::setTempo(uint32 tempo) {
@@ -171,6 +186,7 @@ void MidiParser::onTimer() {
 
 	_abortParse = false;
 	endTime = _position._playTime + _timerRate;
+	_timedEvents = true;
 
 	// Scan our hanging notes for any
 	// that should be turned off.
@@ -180,6 +196,7 @@ void MidiParser::onTimer() {
 		for (i = ARRAYSIZE(_hangingNotes); i; --i, ++ptr) {
 			if (ptr->timeLeft) {
 				if (ptr->timeLeft <= _timerRate) {
+					_eventDelay = ptr->timeLeft;
 					sendToDriver(0x80 | ptr->channel, ptr->note, 0);
 					ptr->timeLeft = 0;
 					--_hangingNotesCount;
@@ -197,11 +214,17 @@ void MidiParser::onTimer() {
 		if (eventTime > endTime)
 			break;
 
+		// Let drivers which support it play the event at its exact time
+		// inside the upcoming timer period.
+		_eventDelay = (eventTime > _position._playTime) ? eventTime - _position._playTime : 0;
+
 		// Process the next info.
 		_position._lastEventTick += info.delta;
 		if (info.event < 0x80) {
 			warning("Bad command or running status %02X", info.event);
 			_position._playPos = 0;
+			_eventDelay = 0;
+			_timedEvents = false;
 			return;
 		}
 
@@ -226,6 +249,9 @@ void MidiParser::onTimer() {
 		}
 	}
 
+	_eventDelay = 0;
+	_timedEvents = false;
+
 	if (!_abortParse) {
 		_position._playTime = endTime;
 		_position._playTick = (_position._playTime - _position._lastEventTime) / _psecPerTick + _position._lastEventTick;
@@ -238,20 +264,28 @@ bool MidiParser::processEvent(const EventInfo &info, bool fireEvents) {
 		// Check for trailing 0xF7 -- if present, remove it.
 		if (fireEvents) {
 			if (info.ext.data[info.length-1] == 0xF7)
-				_driver->sysEx(info.ext.data, (uint16)info.length-1);
+				sendSysExToDriver(info.ext.data, (uint16)info.length-1);
 			else
-				_driver->sysEx(info.ext.data, (uint16)info.length);
+				sendSysExToDriver(info.ext.data, (uint16)info.length);
 		}
 	} else if (info.event == 0xFF) {
 		// META event
 		if (info.ext.type == 0x2F) {
 			// End of Track must be processed by us,
 			// as well as sending it to the output device.
+			// The notes it stops are due at its own time, after the events
+			// before it. onTimer() returns right after this, as the parser
+			// may be deleted by the driver, so the delay has to be reset
+			// here.
 			if (_autoLoop) {
 				jumpToTick(0);
 				parseNextEvent(_nextEvent);
+				_eventDelay = 0;
+				_timedEvents = false;
 			} else {
 				stopPlaying();
+				_eventDelay = 0;
+				_timedEvents = false;
 				if (fireEvents)
 					_driver->metaEvent(info.ext.type, info.ext.data, (uint16)info.length);
 			}
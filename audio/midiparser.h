@@ -271,6 +271,8 @@ protected:
 
 	MidiDriver_BASE *_driver;    ///< The device to which all events will be transmitted.
 	uint32 _timerRate;     ///< The time in microseconds between onTimer() calls. Obtained from the MidiDriver.
+	uint32 _eventDelay;    ///< The time in microseconds after the current onTimer() call at which the current event is due.
+	bool _timedEvents;     ///< Whether onTimer() is sending events, which are then sent with _eventDelay.
 	uint32 _ppqn;           ///< Pulses Per Quarter Note. (We refer to "pulses" as "ticks".)
 	uint32 _tempo;          ///< Microseconds per quarter note.
 	uint32 _psecPerTick;  ///< Microseconds per tick (_tempo / _ppqn).
@@ -304,6 +306,7 @@ protected:
 	void sendToDriver(byte status, byte firstOp, byte secondOp) {
 		sendToDriver(status | ((uint32)firstOp << 8) | ((uint32)secondOp << 16));
 	}
+	void sendSysExToDriver(const byte *msg, uint16 length);
 
 	/**
 	 * Platform independent BE uint32 read-and-advance.
@@ -119,7 +119,7 @@ void MidiPlayer::sendToChannel(byte ch, uint32 b) {
 		// Does this make sense, and should we maybe do it in general?
 	}
 	if (_channelsTable[ch]) {
-		_channelsTable[ch]->send(b);
+		_channelsTable[ch]->sendDelayed(b, _sendDelay);
 	}
 }
 
@@ -53,7 +53,7 @@ namespace Audio {
  * several engines (e.g. DRACI says it copied it from MADE, which took
  * it from SAGE).
  */
-class MidiPlayer : public MidiDriver_BASE {
+class MidiPlayer : public MidiDriver_Filter {
 public:
 	MidiPlayer();
 	~MidiPlayer();
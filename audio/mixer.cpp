@@ -175,12 +175,16 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _streamStart(0), _samplesMixed(0), _statsGeneration(0), _statsResetPending(0) {
 
 	assert(sampleRate > 0);
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = 0;
+
+	clearCallbackStats();
+	memset(_publishedStats, 0, sizeof(_publishedStats));
 }
 
 MixerImpl::~MixerImpl() {
@@ -196,6 +200,137 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
+// Access to the callback statistics shared with other threads. Without
+// atomics, _statsMutex is held around them instead.
+#ifdef SCUMMVM_ATOMICS
+static inline uint32 loadStatsValue(const volatile uint32 *ptr) {
+	return Common::atomicLoad(ptr);
+}
+
+static inline void storeStatsValue(volatile uint32 *ptr, uint32 value) {
+	Common::atomicStore(ptr, value);
+}
+
+static inline void statsFence() {
+	Common::atomicFence();
+}
+#else
+static inline uint32 loadStatsValue(const volatile uint32 *ptr) {
+	return *ptr;
+}
+
+static inline void storeStatsValue(volatile uint32 *ptr, uint32 value) {
+	*ptr = value;
+}
+
+static inline void statsFence() {
+}
+#endif
+
+void MixerImpl::recordCallback(uint64 start, uint32 duration, uint len) {
+#ifndef SCUMMVM_ATOMICS
+	Common::StackLock lock(_statsMutex);
+#endif
+
+	if (loadStatsValue(&_statsResetPending))
+		clearCallbackStats();
+
+	const uint32 samples = len / 4;
+	_bufferLength = (uint32)((uint64)samples * 1000000 / _sampleRate);
+	_durationHistogram[MIN<uint32>(duration / kBucketLength, kDurationBuckets - 1)]++;
+
+	// The device starts playing the next buffer while this one is being
+	// mixed, so mixing must not take longer than one buffer, and the next
+	// callback should not come in much later than one buffer either.
+	if (duration > _bufferLength || (_callbacks && start - _lastCallbackStart > 2 * (uint64)_bufferLength))
+		_missedDeadlines++;
+
+	// Everything mixed before, which the device could not have played since
+	// the first callback, is still queued ahead of this buffer. When the
+	// device ran dry, it played silence, so start counting from here.
+	if (!_samplesMixed)
+		_streamStart = start;
+	const uint64 mixed = _samplesMixed * 1000000 / _sampleRate;
+	const uint64 played = start - _streamStart;
+	if (played > mixed)
+		_streamStart = start - mixed;
+	const uint32 latency = (uint32)(mixed - (start - _streamStart)) + _bufferLength;
+
+	_latencySum += latency;
+	_maxLatency = MAX(_maxLatency, latency);
+	_samplesMixed += samples;
+	_lastCallbackStart = start;
+	_callbacks++;
+
+	// Readers of the published snapshot must see the new generation before
+	// the other one is overwritten
+	const uint32 generation = _statsGeneration + 1;
+	statsFence();
+
+	CallbackStats &stats = _publishedStats[generation & 1];
+	stats.callbacks = _callbacks;
+	stats.missedDeadlines = _missedDeadlines;
+	stats.durationP50 = getDurationPercentile(50);
+	stats.durationP95 = getDurationPercentile(95);
+	stats.durationP99 = getDurationPercentile(99);
+	stats.bufferLength = _bufferLength;
+	stats.latency = (uint32)(_latencySum / _callbacks);
+	stats.maxLatency = _maxLatency;
+
+	storeStatsValue(&_statsGeneration, generation);
+}
+
+uint32 MixerImpl::getDurationPercentile(uint percent) const {
+	const uint32 wanted = (uint32)((uint64)_callbacks * percent / 100);
+	uint32 seen = 0;
+
+	for (uint i = 0; i < kDurationBuckets; ++i) {
+		seen += _durationHistogram[i];
+		if (seen > wanted)
+			return (i + 1) * kBucketLength;
+	}
+
+	return kDurationBuckets * kBucketLength;
+}
+
+bool MixerImpl::getCallbackStats(CallbackStats &stats) const {
+#ifndef SCUMMVM_ATOMICS
+	Common::StackLock lock(_statsMutex);
+#endif
+
+	if (loadStatsValue(&_statsResetPending))
+		return false;
+
+	uint32 generation;
+	do {
+		generation = loadStatsValue(&_statsGeneration);
+		stats = _publishedStats[generation & 1];
+		statsFence();
+	} while (loadStatsValue(&_statsGeneration) != generation);
+
+	return stats.callbacks != 0;
+}
+
+void MixerImpl::resetCallbackStats() {
+#ifndef SCUMMVM_ATOMICS
+	Common::StackLock lock(_statsMutex);
+#endif
+
+	// The audio callback may be running, so leave the clearing to it
+	storeStatsValue(&_statsResetPending, 1);
+}
+
+void MixerImpl::clearCallbackStats() {
+	memset(_durationHistogram, 0, sizeof(_durationHistogram));
+	_callbacks = 0;
+	_missedDeadlines = 0;
+	_bufferLength = 0;
+	_lastCallbackStart = 0;
+	_latencySum = 0;
+	_maxLatency = 0;
+	storeStatsValue(&_statsResetPending, 0);
+}
+
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
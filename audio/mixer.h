@@ -277,6 +277,34 @@ public:
 	 * @return the output sample rate in Hz
 	 */
 	virtual uint getOutputRate() const = 0;
+
+	/**
+	 * Timing statistics of the audio callback of the backend, to judge
+	 * whether the output latency it uses is sustainable.
+	 */
+	struct CallbackStats {
+		uint32 callbacks;        ///< Number of callbacks measured
+		uint32 missedDeadlines;  ///< Callbacks which took longer than, or started more than, one buffer late
+		uint32 durationP50;      ///< Median callback duration in microseconds
+		uint32 durationP95;      ///< 95th percentile of the callback duration in microseconds
+		uint32 durationP99;      ///< 99th percentile of the callback duration in microseconds
+		uint32 bufferLength;     ///< Length of the last audio buffer in microseconds
+		uint32 latency;          ///< Average time from the start of a callback until the end of its buffer is played, in microseconds
+		uint32 maxLatency;       ///< Largest latency measured, in microseconds
+	};
+
+	/**
+	 * Query the timing statistics of the audio callback.
+	 *
+	 * @param stats receives the statistics collected so far
+	 * @return false if the backend does not measure its audio callback
+	 */
+	virtual bool getCallbackStats(CallbackStats &stats) const { return false; }
+
+	/**
+	 * Reset the timing statistics of the audio callback.
+	 */
+	virtual void resetCallbackStats() {}
 };
 
 
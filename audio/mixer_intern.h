@@ -24,6 +24,7 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
 
@@ -70,6 +71,44 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	enum {
+		kDurationBuckets = 500,	///< Buckets of the callback duration histogram
+		kBucketLength = 100		///< Microseconds per histogram bucket
+	};
+
+	// The callback statistics below are only touched by recordCallback(),
+	// so the audio callback never waits for another thread.
+	/** Histogram of the callback durations */
+	uint32 _durationHistogram[kDurationBuckets];
+	uint32 _callbacks;
+	uint32 _missedDeadlines;
+	uint32 _bufferLength;
+	uint64 _lastCallbackStart;
+	/** Time the device would have started playing at, if it never ran dry */
+	uint64 _streamStart;
+	/** Sample pairs mixed since _streamStart */
+	uint64 _samplesMixed;
+	uint64 _latencySum;
+	uint32 _maxLatency;
+
+	/**
+	 * Snapshots of the statistics for getCallbackStats(). recordCallback()
+	 * fills the one which is not published, then publishes it by bumping
+	 * _statsGeneration. Readers retry when the generation changed while
+	 * they were copying.
+	 */
+	CallbackStats _publishedStats[2];
+	volatile uint32 _statsGeneration;
+	/** Set by resetCallbackStats(), cleared by the next recordCallback() */
+	volatile uint32 _statsResetPending;
+#ifndef SCUMMVM_ATOMICS
+	/** Guards the callback statistics where atomics are not available */
+	mutable Common::Mutex _statsMutex;
+#endif
+
+	void clearCallbackStats();
+	uint32 getDurationPercentile(uint percent) const;
+
 
 public:
 
@@ -118,6 +157,9 @@ public:
 
 	virtual uint getOutputRate() const;
 
+	virtual bool getCallbackStats(CallbackStats &stats) const;
+	virtual void resetCallbackStats();
+
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
@@ -133,6 +175,22 @@ public:
 	 */
 	int mixCallback(byte *samples, uint len);
 
+	/**
+	 * Record the timing of one call of mixCallback(), for getCallbackStats().
+	 * Backends which can measure their audio callback call this after each
+	 * mixCallback().
+	 *
+	 * The latency is measured by comparing the amount of audio mixed with
+	 * the time passed since the first callback: whatever has been mixed but
+	 * could not have been played yet is still buffered on the way to the
+	 * device.
+	 *
+	 * @param start Start of the callback in microseconds, on any steady clock.
+	 * @param duration Duration of the callback in microseconds.
+	 * @param len Length of the buffer mixed, in bytes, as passed to mixCallback().
+	 */
+	void recordCallback(uint64 start, uint32 duration, uint len);
+
 	/**
 	 * Set the internal 'is ready' flag of the mixer.
 	 * Backends should invoke Mixer::setReady(true) once initialisation of
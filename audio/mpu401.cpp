@@ -48,6 +48,10 @@ void MidiChannel_MPU401::send(uint32 b) {
 	_owner->send((b & 0xFFFFFFF0) | (_channel & 0xF));
 }
 
+void MidiChannel_MPU401::sendDelayed(uint32 b, uint32 delay) {
+	_owner->sendDelayed((b & 0xFFFFFFF0) | (_channel & 0xF), delay);
+}
+
 void MidiChannel_MPU401::noteOff(byte note) {
 	_owner->send(note << 8 | 0x80 | _channel);
 }
@@ -44,6 +44,7 @@ public:
 	virtual void release() { _allocated = false; }
 
 	virtual void send(uint32 b);
+	virtual void sendDelayed(uint32 b, uint32 delay);
 
 	// Regular messages
 	virtual void noteOff(byte note);
@@ -27,6 +27,8 @@
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
 
+#include "common/mutex.h"
+
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
 	bool _isOpen;
@@ -44,12 +46,128 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	/**
+	 * Events sent during the timer callback, sorted by the sample (relative
+	 * to the start of the current tick) they are due at. SysEx data is kept
+	 * in _sysExBuffer.
+	 */
+	struct QueuedEvent {
+		uint32 msg;
+		int sample;
+		uint16 sysExOffset;
+		uint16 sysExLength;	///< 0 for short messages
+	};
+
+	enum {
+		kMaxQueuedEvents = 64,
+		kSysExBufferSize = 4 * 264
+	};
+
+	QueuedEvent _queuedEvents[kMaxQueuedEvents];
+	int _numQueuedEvents;
+	byte _sysExBuffer[kSysExBufferSize];
+	int _sysExUsed;
+	int _tickSamples;	///< Samples generated since the last timer callback
+	bool _inTimerProc;
+
+	/**
+	 * Guards the event queue. The mixer thread plays queued events while
+	 * other threads may send events, which first play everything queued
+	 * so that events are never reordered.
+	 */
+	Common::Mutex _queueMutex;
+
+	void sendQueuedEvents(int upToSample) {
+		int i = 0;
+		for (; i < _numQueuedEvents && _queuedEvents[i].sample <= upToSample; ++i) {
+			const QueuedEvent &event = _queuedEvents[i];
+			if (event.sysExLength)
+				playSysEx(_sysExBuffer + event.sysExOffset, event.sysExLength);
+			else
+				playEvent(event.msg);
+		}
+
+		if (i) {
+			_numQueuedEvents -= i;
+			memmove(_queuedEvents, _queuedEvents + i, _numQueuedEvents * sizeof(QueuedEvent));
+			if (!_numQueuedEvents)
+				_sysExUsed = 0;
+		}
+	}
+
+	void flushQueuedEvents() {
+		if (_numQueuedEvents)
+			sendQueuedEvents(_queuedEvents[_numQueuedEvents - 1].sample);
+	}
+
+	/**
+	 * The sample an event sent with the given delay is due at. Events
+	 * without a delay go after everything queued before them, so they are
+	 * played in the order they were sent.
+	 */
+	int queuedSample(uint32 delay, bool delayed) const {
+		if (!delayed)
+			return _numQueuedEvents ? _queuedEvents[_numQueuedEvents - 1].sample : 0;
+		return (int)((uint64)delay * getRate() / 1000000);
+	}
+
+	/**
+	 * Queue an event at the given sample, keeping the queue sorted but
+	 * events due at the same sample in the order they were sent.
+	 */
+	void queueEvent(uint32 msg, int sample, uint16 sysExOffset, uint16 sysExLength) {
+		int i = _numQueuedEvents;
+		while (i > 0 && _queuedEvents[i - 1].sample > sample) {
+			_queuedEvents[i] = _queuedEvents[i - 1];
+			--i;
+		}
+		_queuedEvents[i].msg = msg;
+		_queuedEvents[i].sample = sample;
+		_queuedEvents[i].sysExOffset = sysExOffset;
+		_queuedEvents[i].sysExLength = sysExLength;
+		_numQueuedEvents++;
+	}
+
+	void queueOrPlayEvent(uint32 b, uint32 delay, bool delayed) {
+		Common::StackLock lock(_queueMutex);
+
+		if (!_inTimerProc || _numQueuedEvents == kMaxQueuedEvents) {
+			flushQueuedEvents();
+			playEvent(b);
+			return;
+		}
+
+		queueEvent(b, queuedSample(delay, delayed), 0, 0);
+	}
+
+	void queueOrPlaySysEx(const byte *msg, uint16 length, uint32 delay, bool delayed) {
+		Common::StackLock lock(_queueMutex);
+
+		if (!_inTimerProc || _numQueuedEvents == kMaxQueuedEvents || !length ||
+		    _sysExUsed + length > kSysExBufferSize) {
+			flushQueuedEvents();
+			playSysEx(msg, length);
+			return;
+		}
+
+		memcpy(_sysExBuffer + _sysExUsed, msg, length);
+		queueEvent(0, queuedSample(delay, delayed), _sysExUsed, length);
+		_sysExUsed += length;
+	}
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Play a MIDI event or SysEx message on the synth right away. send()
+	 * and sysEx() call these, after all events queued before.
+	 */
+	virtual void playEvent(uint32 b) = 0;
+	virtual void playSysEx(const byte *msg, uint16 length) {}
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -58,6 +176,10 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_numQueuedEvents(0),
+		_sysExUsed(0),
+		_tickSamples(0),
+		_inTimerProc(false),
 		_baseFreq(250) {
 	}
 
@@ -87,6 +209,29 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
+	// Events sent from our timer callback are played at the exact sample
+	// they are due at, by splitting sample generation around them. Events
+	// sent with no delay are queued at the start of the tick, ahead of the
+	// later ones, while plain send() and sysEx() calls go after everything
+	// queued before them. Events which can not be queued are played at
+	// once, but only after all queued events, so a note off never overtakes
+	// its note on.
+	virtual void send(uint32 b) {
+		queueOrPlayEvent(b, 0, false);
+	}
+
+	virtual void sysEx(const byte *msg, uint16 length) {
+		queueOrPlaySysEx(msg, length, 0, false);
+	}
+
+	virtual void sendDelayed(uint32 b, uint32 delay) {
+		queueOrPlayEvent(b, delay, true);
+	}
+
+	virtual void sysExDelayed(const byte *msg, uint16 length, uint32 delay) {
+		queueOrPlaySysEx(msg, length, delay, true);
+	}
+
 	// AudioStream API
 	virtual int readBuffer(int16 *data, const int numSamples) {
 		const int stereoFactor = isStereo() ? 2 : 1;
@@ -98,13 +243,40 @@ public:
 			if (step > (_nextTick >> FIXP_SHIFT))
 				step = (_nextTick >> FIXP_SHIFT);
 
+			{
+				Common::StackLock lock(_queueMutex);
+				if (_numQueuedEvents) {
+					sendQueuedEvents(_tickSamples);
+					if (_numQueuedEvents && step > _queuedEvents[0].sample - _tickSamples)
+						step = _queuedEvents[0].sample - _tickSamples;
+				}
+			}
+
 			generateSamples(data, step);
+			_tickSamples += step;
 
 			_nextTick -= step << FIXP_SHIFT;
 			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
+				// Anything left over was due at the very end of this tick
+				_queueMutex.lock();
+				flushQueuedEvents();
+				_queueMutex.unlock();
+				_tickSamples = 0;
+
+				if (_timerProc) {
+					// The queue is not locked during the callback, so it
+					// may lock mutexes of its own before sending events.
+					_queueMutex.lock();
+					_inTimerProc = true;
+					_queueMutex.unlock();
+
 					(*_timerProc)(_timerParam);
 
+					_queueMutex.lock();
+					_inTimerProc = false;
+					_queueMutex.unlock();
+				}
+
 				onTimer();
 
 				_nextTick += _samplesPerTick;
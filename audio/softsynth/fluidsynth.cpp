@@ -58,7 +58,7 @@ public:
 
 	int open();
 	void close();
-	void send(uint32 b);
+	void playEvent(uint32 b);
 
 	MidiChannel *allocateChannel();
 	MidiChannel *getPercussionChannel();
@@ -217,7 +217,7 @@ void MidiDriver_FluidSynth::close() {
 	delete_fluid_settings(_settings);
 }
 
-void MidiDriver_FluidSynth::send(uint32 b) {
+void MidiDriver_FluidSynth::playEvent(uint32 b) {
 	//byte param3 = (byte) ((b >> 24) & 0xFF);
 	uint param2 = (byte) ((b >> 16) & 0xFF);
 	uint param1 = (byte) ((b >>  8) & 0xFF);
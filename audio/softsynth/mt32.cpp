@@ -37,6 +37,7 @@
 #include "common/system.h"
 #include "common/util.h"
 #include "common/archive.h"
+#include "common/atomic.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #include "common/osd_message_queue.h"
@@ -106,14 +107,15 @@ class MidiDriver_MT32 : public MidiDriver_Emulated {
 private:
 	MidiChannel_MT32 _midiChannels[16];
 	uint16 _channelMask;
-	MT32Emu::Service _service;
 	MT32Emu::ScummVMReportHandler _reportHandler;
 	byte *_controlData, *_pcmData;
-	Common::Mutex _mutex;
 
 	int _outputRate;
 
 protected:
+	MT32Emu::Service _service;
+	Common::Mutex _mutex;
+
 	void generateSamples(int16 *buf, int len);
 
 public:
@@ -122,9 +124,9 @@ public:
 
 	int open();
 	void close();
-	void send(uint32 b);
+	void playEvent(uint32 b);
 	void setPitchBendRange(byte channel, uint range);
-	void sysEx(const byte *msg, uint16 length);
+	void playSysEx(const byte *msg, uint16 length);
 
 	uint32 property(int prop, uint32 param);
 	MidiChannel *allocateChannel();
@@ -226,7 +228,7 @@ int MidiDriver_MT32::open() {
 	return 0;
 }
 
-void MidiDriver_MT32::send(uint32 b) {
+void MidiDriver_MT32::playEvent(uint32 b) {
 	Common::StackLock lock(_mutex);
 	_service.playMsg(b);
 }
@@ -242,7 +244,7 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 	_service.writeSysex(channel, benderRangeSysex, 4);
 }
 
-void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
+void MidiDriver_MT32::playSysEx(const byte *msg, uint16 length) {
 	if (msg[0] == 0xf0) {
 		Common::StackLock lock(_mutex);
 		_service.playSysex(msg, length);
@@ -314,119 +316,301 @@ MidiChannel *MidiDriver_MT32::getPercussionChannel() {
 	return &_midiChannels[9];
 }
 
-// This code should be used when calling the timer callback from the mixer thread is undesirable.
-// Note that it results in less accurate timing.
-#if 0
-class MidiEvent_MT32 {
-public:
-	MidiEvent_MT32 *_next;
-	uint32 _msg; // 0xFFFFFFFF indicates a sysex message
-	byte *_data;
-	uint32 _len;
-
-	MidiEvent_MT32(uint32 msg, byte *data, uint32 len) {
-		_msg = msg;
-		if (len > 0) {
-			_data = new byte[len];
-			memcpy(_data, data, len);
-		}
-		_len = len;
-		_next = NULL;
-	}
+////////////////////////////////////////
+//
+// MidiDriver_ThreadedMT32
+//
+////////////////////////////////////////
 
-	MidiEvent_MT32() {
-		if (_len > 0)
-			delete _data;
-	}
-};
+// OSystem has no thread API, so the driver needs thread local storage to
+// tell whether it is called from the thread which is rendering, and atomics
+// to share the ring with the mixer without locking. Without them,
+// render-ahead is not available.
+#if defined(SCUMMVM_THREAD_LOCAL) && defined(SCUMMVM_ATOMICS)
+#define MT32_RENDER_AHEAD
+#endif
 
-class MidiDriver_ThreadedMT32 : public MidiDriver_MT32 {
-private:
-	OSystem::Mutex _eventMutex;
-	MidiEvent_MT32 *_events;
-	TimerManager::TimerProc _timer_proc;
+#ifdef MT32_RENDER_AHEAD
 
-	void pushMidiEvent(MidiEvent_MT32 *event);
-	MidiEvent_MT32 *popMidiEvent();
+class MidiDriver_ThreadedMT32;
 
-protected:
-	void send(uint32 b);
-	void sysEx(const byte *msg, uint16 length);
+/** The driver rendering on the calling thread, if any. */
+static SCUMMVM_THREAD_LOCAL MidiDriver_ThreadedMT32 *g_renderingDriver = 0;
 
+// Renders the emulator output ahead of time from a timer callback, so that
+// the expensive emulation does not run inside the mixer callback. The mixer
+// only copies finished blocks out of a single producer, single consumer ring
+// buffer. The timer callback is the only writer of _writePos and the mixer
+// the only writer of _readPos, so both are accessed atomically instead of
+// with a lock. The mixer never waits for the renderer: when the ring runs
+// dry, it plays silence for the missing frames.
+//
+// MIDI events generated while rendering (i.e. by the music player driven from
+// our timer callback) are applied at their exact position in the rendered
+// output. Events sent from other threads are timestamped at the write
+// position, i.e. applied right at the start of the next block rendered, in
+// the order they were sent. Writes to the emulator memory which would take
+// effect immediately are sent as complete SysEx messages then, so they stay
+// in order with the events queued before them.
+class MidiDriver_ThreadedMT32 : public MidiDriver_MT32 {
 public:
 	MidiDriver_ThreadedMT32(Audio::Mixer *mixer);
+	virtual ~MidiDriver_ThreadedMT32();
 
-	void onTimer();
+	int open();
 	void close();
-	void setTimerCallback(void *timer_param, TimerManager::TimerProc timer_proc);
-};
+	void playEvent(uint32 b);
+	void setPitchBendRange(byte channel, uint range);
+	void playSysEx(const byte *msg, uint16 length);
 
+	// AudioStream API
+	int readBuffer(int16 *data, const int numSamples);
+
+private:
+	enum {
+		kBlockFrames = 256,
+		kNumBlocks = 8,
+		kRingFrames = kBlockFrames * kNumBlocks,
+		kRenderInterval = 5000,	// in microseconds
+		kStatsInterval = 10000	// in milliseconds
+	};
+
+	int16 *_ring;
+	volatile uint32 _readPos;	///< frames played so far, written by the mixer only
+	volatile uint32 _writePos;	///< frames rendered so far, written by the renderer only
+
+	// Statistics. The mixer is the only writer of the underrun count and the
+	// lowest fill, and resets the latter when the renderer asks for it.
+	volatile uint32 _underruns;
+	volatile uint32 _minFill;
+	volatile uint32 _resetMinFill;
+	uint32 _renderMillis;
+	uint32 _renderedFrames;
+	uint32 _lastStatsTime;
+
+	static void renderTimerProc(void *refCon);
+	void renderAhead();
+	void render(int16 *data, uint32 frames);
+	void queueSysEx(const byte *msg, uint16 length);
+	void queueRolandSysEx(byte device, const byte *data, uint16 length);
+	void printStats(int level, uint32 now);
+};
 
 MidiDriver_ThreadedMT32::MidiDriver_ThreadedMT32(Audio::Mixer *mixer) : MidiDriver_MT32(mixer) {
-	_events = NULL;
-	_timer_proc = NULL;
+	_ring = new int16[kRingFrames * 2];
+	_readPos = _writePos = 0;
+	_underruns = 0;
+	_minFill = kRingFrames;
+	_resetMinFill = 0;
+	_renderMillis = 0;
+	_renderedFrames = 0;
+	_lastStatsTime = 0;
+}
+
+MidiDriver_ThreadedMT32::~MidiDriver_ThreadedMT32() {
+	close();
+	delete[] _ring;
+}
+
+int MidiDriver_ThreadedMT32::open() {
+	if (_isOpen)
+		return MERR_ALREADY_OPEN;
+
+	_readPos = _writePos = 0;
+	_underruns = 0;
+	_minFill = kRingFrames;
+	_resetMinFill = 0;
+	_renderMillis = 0;
+	_renderedFrames = 0;
+	_lastStatsTime = g_system->getMillis();
+
+	int ret = MidiDriver_MT32::open();
+	if (ret)
+		return ret;
+
+	renderAhead();
+	g_system->getTimerManager()->installTimerProc(renderTimerProc, kRenderInterval, this, "MT32renderAhead");
+
+	return 0;
 }
 
 void MidiDriver_ThreadedMT32::close() {
+	if (!_isOpen)
+		return;
+
+	g_system->getTimerManager()->removeTimerProc(renderTimerProc);
+	printStats(1, g_system->getMillis());
+
 	MidiDriver_MT32::close();
-	while ((popMidiEvent() != NULL)) {
-		// Just eat any leftover events
+}
+
+void MidiDriver_ThreadedMT32::playEvent(uint32 b) {
+	if (g_renderingDriver == this) {
+		MidiDriver_MT32::playEvent(b);
+		return;
 	}
+
+	Common::StackLock lock(_mutex);
+	_service.playMsgAt(b, Common::atomicLoad(&_writePos));
 }
 
-void MidiDriver_ThreadedMT32::setTimerCallback(void *timer_param, TimerManager::TimerProc timer_proc) {
-	if (!_timer_proc || !timer_proc) {
-		if (_timer_proc)
-			_vm->_timer->removeTimerProc(_timer_proc);
-		_timer_proc = timer_proc;
-		if (timer_proc)
-			_vm->_timer->installTimerProc(timer_proc, getBaseTempo(), timer_param, "MT32tempo");
+void MidiDriver_ThreadedMT32::setPitchBendRange(byte channel, uint range) {
+	if (g_renderingDriver == this) {
+		MidiDriver_MT32::setPitchBendRange(channel, range);
+		return;
+	}
+
+	if (range > 24) {
+		warning("setPitchBendRange() called with range > 24: %d", range);
 	}
+	const byte benderRange[4] = { 0, 0, 4, (uint8)range };
+	queueRolandSysEx(channel, benderRange, 4);
 }
 
-void MidiDriver_ThreadedMT32::pushMidiEvent(MidiEvent_MT32 *event) {
-	Common::StackLock lock(_eventMutex);
-	if (_events == NULL) {
-		_events = event;
-	} else {
-		MidiEvent_MT32 *last = _events;
-		while (last->_next != NULL)
-			last = last->_next;
-		last->_next = event;
+void MidiDriver_ThreadedMT32::playSysEx(const byte *msg, uint16 length) {
+	if (g_renderingDriver == this) {
+		MidiDriver_MT32::playSysEx(msg, length);
+		return;
 	}
+
+	enum {
+		SYSEX_CMD_DT1 = 0x12,
+		SYSEX_CMD_DAT = 0x42
+	};
+
+	if (msg[0] == 0xf0)
+		queueSysEx(msg, length);
+	else if (length >= 5 && (msg[3] == SYSEX_CMD_DT1 || msg[3] == SYSEX_CMD_DAT))
+		queueRolandSysEx(msg[1], msg + 4, length - 5);
+	else
+		MidiDriver_MT32::playSysEx(msg, length);
 }
 
-MidiEvent_MT32 *MidiDriver_ThreadedMT32::popMidiEvent() {
-	Common::StackLock lock(_eventMutex);
-	MidiEvent_MT32 *event;
-	event = _events;
-	if (event != NULL)
-		_events = event->_next;
-	return event;
+void MidiDriver_ThreadedMT32::queueSysEx(const byte *msg, uint16 length) {
+	Common::StackLock lock(_mutex);
+	_service.playSysexAt(msg, length, Common::atomicLoad(&_writePos));
 }
 
-void MidiDriver_ThreadedMT32::send(uint32 b) {
-	MidiEvent_MT32 *event = new MidiEvent_MT32(b, NULL, 0);
-	pushMidiEvent(event);
+// Frame an address and data the way Service::writeSysex() takes them as a
+// Roland DT1 message, which the emulator applies just like writeSysex().
+void MidiDriver_ThreadedMT32::queueRolandSysEx(byte device, const byte *data, uint16 length) {
+	byte msg[288];
+	if (length + 7 > (int)sizeof(msg)) {
+		warning("MT-32 SysEx of %d bytes is too long to queue", length);
+		return;
+	}
+
+	msg[0] = 0xf0;
+	msg[1] = 0x41;
+	msg[2] = device;
+	msg[3] = 0x16;
+	msg[4] = 0x12;
+	memcpy(msg + 5, data, length);
+
+	byte checksum = 0;
+	for (int i = 0; i < length; ++i)
+		checksum += data[i];
+	msg[5 + length] = (128 - (checksum & 0x7f)) & 0x7f;
+	msg[6 + length] = 0xf7;
+
+	queueSysEx(msg, length + 7);
 }
 
-void MidiDriver_ThreadedMT32::sysEx(const byte *msg, uint16 length) {
-	MidiEvent_MT32 *event = new MidiEvent_MT32(0xFFFFFFFF, msg, length);
-	pushMidiEvent(event);
+void MidiDriver_ThreadedMT32::renderTimerProc(void *refCon) {
+	((MidiDriver_ThreadedMT32 *)refCon)->renderAhead();
 }
 
-void MidiDriver_ThreadedMT32::onTimer() {
-	MidiEvent_MT32 *event;
-	while ((event = popMidiEvent()) != NULL) {
-		if (event->_msg == 0xFFFFFFFF) {
-			MidiDriver_MT32::sysEx(event->_data, event->_len);
-		} else {
-			MidiDriver_MT32::send(event->_msg);
-		}
-		delete event;
+void MidiDriver_ThreadedMT32::render(int16 *data, uint32 frames) {
+	MidiDriver_ThreadedMT32 *previous = g_renderingDriver;
+	g_renderingDriver = this;
+	MidiDriver_Emulated::readBuffer(data, frames * 2);
+	g_renderingDriver = previous;
+}
+
+void MidiDriver_ThreadedMT32::renderAhead() {
+	const uint32 start = g_system->getMillis();
+	uint32 writePos = _writePos;
+	uint32 rendered = 0;
+
+	for (;;) {
+		const uint32 space = kRingFrames - (writePos - Common::atomicLoad(&_readPos));
+		if (space < kBlockFrames)
+			break;
+
+		const uint32 offset = writePos % kRingFrames;
+		const uint32 frames = MIN<uint32>(kBlockFrames, kRingFrames - offset);
+		render(_ring + offset * 2, frames);
+
+		// Publishes the rendered frames to the mixer
+		writePos += frames;
+		Common::atomicStore(&_writePos, writePos);
+		rendered += frames;
+	}
+
+	if (rendered) {
+		const uint32 now = g_system->getMillis();
+		_renderMillis += now - start;
+		_renderedFrames += rendered;
+
+		if (now - _lastStatsTime >= kStatsInterval)
+			printStats(2, now);
 	}
 }
-#endif
+
+int MidiDriver_ThreadedMT32::readBuffer(int16 *data, const int numSamples) {
+	uint32 readPos = _readPos;
+	const uint32 fill = Common::atomicLoad(&_writePos) - readPos;
+
+	if (Common::atomicLoad(&_resetMinFill)) {
+		Common::atomicStore(&_resetMinFill, 0);
+		Common::atomicStore(&_minFill, fill);
+	} else if (fill < _minFill) {
+		Common::atomicStore(&_minFill, fill);
+	}
+
+	const uint32 frames = numSamples / 2;
+	const uint32 done = MIN(frames, fill);
+
+	uint32 left = done;
+	int16 *dst = data;
+	while (left) {
+		const uint32 offset = readPos % kRingFrames;
+		const uint32 len = MIN<uint32>(left, kRingFrames - offset);
+
+		memcpy(dst, _ring + offset * 2, len * 2 * sizeof(int16));
+		dst += len * 2;
+		readPos += len;
+		left -= len;
+	}
+
+	// Only hand the space back to the renderer once it has been copied
+	Common::atomicStore(&_readPos, readPos);
+
+	if (done < frames) {
+		// The renderer fell behind. Rendering here would stall the mixer
+		// for as long as the emulation takes, so play silence instead.
+		memset(dst, 0, (frames - done) * 2 * sizeof(int16));
+		Common::atomicAdd(&_underruns, 1);
+	}
+
+	return numSamples;
+}
+
+void MidiDriver_ThreadedMT32::printStats(int level, uint32 now) {
+	// Headroom is the share of real time the renderer is idle.
+	const uint32 audioMillis = (uint32)((uint64)_renderedFrames * 1000 / getRate());
+	const int headroom = audioMillis ? 100 - (int)(_renderMillis * 100 / audioMillis) : 100;
+
+	debug(level, "MT-32 render-ahead: %d%% headroom, lowest fill %u of %u frames, %u underruns",
+	      headroom, Common::atomicLoad(&_minFill), (uint32)kRingFrames, Common::atomicLoad(&_underruns));
+
+	Common::atomicStore(&_resetMinFill, 1);
+	_renderMillis = 0;
+	_renderedFrames = 0;
+	_lastStatsTime = now;
+}
+
+#endif // MT32_RENDER_AHEAD
 
 
 // Plugin interface
@@ -463,7 +647,12 @@ bool MT32EmuMusicPlugin::checkDevice(MidiDriver::DeviceHandle) const {
 }
 
 Common::Error MT32EmuMusicPlugin::createInstance(MidiDriver **mididriver, MidiDriver::DeviceHandle) const {
-	*mididriver = new MidiDriver_MT32(g_system->getMixer());
+#ifdef MT32_RENDER_AHEAD
+	if (ConfMan.getBool("mt32_render_ahead"))
+		*mididriver = new MidiDriver_ThreadedMT32(g_system->getMixer());
+	else
+#endif
+		*mididriver = new MidiDriver_MT32(g_system->getMixer());
 
 	return Common::kNoError;
 }
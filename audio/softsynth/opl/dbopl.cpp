@@ -35,6 +35,7 @@
 // Last synch with DOSBox SVN trunk r3752
 
 #include "dbopl.h"
+#include "common/simd.h"
 
 #ifndef DISABLE_DOSBOX_OPL
 
@@ -90,6 +91,16 @@ namespace DBOPL {
 //Has to fit within 16bit lookuptable
 #define MUL_SH		16
 
+//Generate two operator channels side by side in vector registers, the
+//wave lookups stay scalar since SSE2 and NEON can't gather
+#if ( DBOPL_WAVE == WAVE_TABLEMUL ) && ( defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON) )
+#define DBOPL_LANES
+#endif
+//Amount of two operator channels that are generated side by side
+#define CHANNEL_LANES	4
+//Amount of samples their envelopes are forwarded at once
+#define LANE_BLOCK	64
+
 //Check some ranges
 #if ENV_EXTRA > 3
 #error Too many envelope bits
@@ -596,6 +607,64 @@ INLINE Bits Operator::GetSample( Bits modulation ) {
 	}
 }
 
+#ifdef DBOPL_LANES
+void Operator::ForwardMulBlock( Bit32u samples, Bit16u* mul, Bitu stride ) {
+	Bit32u i = 0;
+	while ( i < samples ) {
+		//Envelopes that can't change are simply filled in
+		if ( state == OFF || ( state == SUSTAIN && ( reg20 & MASK_SUSTAIN ) ) ) {
+			Bitu vol = currentLevel + ( state == OFF ? ENV_MAX : volume );
+			Bit16u level = ENV_SILENT( vol ) ? 0 : MulTable[ vol >> ENV_EXTRA ];
+			for ( ; i < samples; i++ )
+				mul[ i * stride ] = level;
+			return;
+		}
+		//Run TemplateVolume inline up to the sample where the state changes,
+		//that one goes through the handler. A silent sample multiplies the wave
+		//with 0, which GetWave returns as well.
+		Bit32s vol = volume;
+		Bit32u index = rateIndex;
+		if ( state == ATTACK ) {
+			for ( ; i < samples; i++ ) {
+				Bit32u next = index + attackAdd;
+				Bit32s change = next >> RATE_SH;
+				Bit32s nextVol = vol;
+				if ( change ) {
+					nextVol += ( (~vol) * change ) >> 3;
+					if ( nextVol < ENV_MIN )
+						break;
+				}
+				index = next & RATE_MASK;
+				vol = nextVol;
+				Bitu level = currentLevel + vol;
+				mul[ i * stride ] = ENV_SILENT( level ) ? 0 : MulTable[ level >> ENV_EXTRA ];
+			}
+		} else {
+			//Decay, release and sustain without holding it move linearly
+			Bit32u add = state == DECAY ? decayAdd : releaseAdd;
+			Bit32s limit = state == DECAY ? sustainLevel : ENV_MAX;
+			for ( ; i < samples; i++ ) {
+				Bit32u next = index + add;
+				Bit32s nextVol = vol + (Bit32s)( next >> RATE_SH );
+				if ( nextVol >= limit )
+					break;
+				index = next & RATE_MASK;
+				vol = nextVol;
+				Bitu level = currentLevel + vol;
+				mul[ i * stride ] = ENV_SILENT( level ) ? 0 : MulTable[ level >> ENV_EXTRA ];
+			}
+		}
+		volume = vol;
+		rateIndex = index;
+		if ( i < samples ) {
+			Bitu level = ForwardVolume();
+			mul[ i * stride ] = ENV_SILENT( level ) ? 0 : MulTable[ level >> ENV_EXTRA ];
+			i++;
+		}
+	}
+}
+#endif
+
 Operator::Operator() {
 	chanData = 0;
 	freqMul = 0;
@@ -1015,6 +1084,17 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 	return 0;
 }
 
+bool Channel::PrepareLane( const Chip* chip, bool am ) {
+	//Same early out as BlockTemplate
+	if ( am ? ( Op(0)->Silent() && Op(1)->Silent() ) : Op(1)->Silent() ) {
+		old[0] = old[1] = 0;
+		return false;
+	}
+	Op( 0 )->Prepare( chip );
+	Op( 1 )->Prepare( chip );
+	return true;
+}
+
 /*
 	Chip
 */
@@ -1025,6 +1105,7 @@ Chip::Chip() {
 	regBD = 0;
 	reg104 = 0;
 	opl3Active = 0;
+	channelLanes = true;
 }
 
 INLINE Bit32u Chip::ForwardNoise() {
@@ -1220,15 +1301,231 @@ Bit32u Chip::WriteAddr( Bit32u port, Bit8u val ) {
 	return 0;
 }
 
+#ifdef DBOPL_LANES
+
+//Look up the waves at the WaveTable indices in the 32 bit lanes and apply their volume
+#if defined(SCUMMVM_SSE2)
+static INLINE __m128i LaneWaves( __m128i index, const Bit16u* mul ) {
+	__m128i wave = _mm_setzero_si128();
+	wave = _mm_insert_epi16( wave, WaveTable[ _mm_extract_epi16( index, 0 ) ], 0 );
+	wave = _mm_insert_epi16( wave, WaveTable[ _mm_extract_epi16( index, 2 ) ], 1 );
+	wave = _mm_insert_epi16( wave, WaveTable[ _mm_extract_epi16( index, 4 ) ], 2 );
+	wave = _mm_insert_epi16( wave, WaveTable[ _mm_extract_epi16( index, 6 ) ], 3 );
+	__m128i m = _mm_loadl_epi64( (const __m128i*)mul );
+	//Signed multiply, adding the wave back in for multipliers from 0x8000 on makes it unsigned
+	__m128i high = _mm_mulhi_epi16( wave, m );
+	high = _mm_add_epi16( high, _mm_and_si128( wave, _mm_srai_epi16( m, 15 ) ) );
+	return _mm_srai_epi32( _mm_unpacklo_epi16( high, high ), 16 );
+}
+#elif defined(SCUMMVM_NEON)
+static INLINE int32x4_t LaneWaves( uint32x4_t index, const Bit16u* mul ) {
+	int16x4_t wave = vdup_n_s16( 0 );
+	wave = vset_lane_s16( WaveTable[ vgetq_lane_u32( index, 0 ) ], wave, 0 );
+	wave = vset_lane_s16( WaveTable[ vgetq_lane_u32( index, 1 ) ], wave, 1 );
+	wave = vset_lane_s16( WaveTable[ vgetq_lane_u32( index, 2 ) ], wave, 2 );
+	wave = vset_lane_s16( WaveTable[ vgetq_lane_u32( index, 3 ) ], wave, 3 );
+	int32x4_t m = vreinterpretq_s32_u32( vmovl_u16( vld1_u16( mul ) ) );
+	return vshrq_n_s32( vmulq_s32( vmovl_s16( wave ), m ), MUL_SH );
+}
+#endif
+
+template< bool opl3Mode >
+void Chip::GenerateLanes( Channel* const* lanes, const bool* am, Bitu count, Bit32u samples, Bit32s* output ) {
+	//Each channel's first operator feeds back into itself, so every sample
+	//waits for the previous one. Channels don't depend on each other, so the
+	//lanes of a vector can each run one of them. Unused lanes stay silent.
+	Bit32u index[ 2 ][ CHANNEL_LANES ], current[ 2 ][ CHANNEL_LANES ], base[ 2 ][ CHANNEL_LANES ], mask[ 2 ][ CHANNEL_LANES ];
+	Bit32s old[ 2 ][ CHANNEL_LANES ], fmMask[ CHANNEL_LANES ], amMask[ CHANNEL_LANES ], left[ CHANNEL_LANES ], right[ CHANNEL_LANES ];
+	Bit32s feedback[ CHANNEL_LANES ];
+	Bit16u mul[ 2 ][ LANE_BLOCK ][ CHANNEL_LANES ];
+	memset( mul, 0, sizeof( mul ) );
+	for ( Bitu l = 0; l < CHANNEL_LANES; l++ ) {
+		Channel* ch = l < count ? lanes[ l ] : 0;
+		for ( Bitu o = 0; o < 2; o++ ) {
+			Operator* op = ch ? ch->Op( o ) : 0;
+			index[ o ][ l ] = op ? op->waveIndex : 0;
+			current[ o ][ l ] = op ? op->waveCurrent : 0;
+			base[ o ][ l ] = op ? (Bit32u)( op->waveBase - WaveTable ) : 0;
+			mask[ o ][ l ] = op ? op->waveMask : 0;
+			old[ o ][ l ] = ch ? ch->old[ o ] : 0;
+		}
+		Bit32s shift = ch ? ch->feedback : 31;
+#if defined(SCUMMVM_SSE2)
+		//SSE2 can't shift each lane differently, take the high half of a multiplication
+		feedback[ l ] = (Bit32s)( 1U << ( 32 - shift ) );
+#else
+		feedback[ l ] = -shift;
+#endif
+		//FM modulates the second operator with the first, AM adds them
+		fmMask[ l ] = ( ch && !am[ l ] ) ? -1 : 0;
+		amMask[ l ] = ( ch && am[ l ] ) ? -1 : 0;
+		left[ l ] = ch ? ch->maskLeft : 0;
+		right[ l ] = ch ? ch->maskRight : 0;
+	}
+
+#if defined(SCUMMVM_SSE2)
+	__m128i index0 = _mm_loadu_si128( (const __m128i*)index[ 0 ] );
+	__m128i index1 = _mm_loadu_si128( (const __m128i*)index[ 1 ] );
+	__m128i old0 = _mm_loadu_si128( (const __m128i*)old[ 0 ] );
+	__m128i old1 = _mm_loadu_si128( (const __m128i*)old[ 1 ] );
+	const __m128i current0 = _mm_loadu_si128( (const __m128i*)current[ 0 ] );
+	const __m128i current1 = _mm_loadu_si128( (const __m128i*)current[ 1 ] );
+	const __m128i base0 = _mm_loadu_si128( (const __m128i*)base[ 0 ] );
+	const __m128i base1 = _mm_loadu_si128( (const __m128i*)base[ 1 ] );
+	const __m128i mask0 = _mm_loadu_si128( (const __m128i*)mask[ 0 ] );
+	const __m128i mask1 = _mm_loadu_si128( (const __m128i*)mask[ 1 ] );
+	const __m128i feedbackEven = _mm_loadu_si128( (const __m128i*)feedback );
+	const __m128i feedbackOdd = _mm_srli_epi64( feedbackEven, 32 );
+	const __m128i oddLanes = _mm_setr_epi32( 0, -1, 0, -1 );
+	const __m128i fm = _mm_loadu_si128( (const __m128i*)fmMask );
+	const __m128i amv = _mm_loadu_si128( (const __m128i*)amMask );
+	const __m128i maskLeft = _mm_loadu_si128( (const __m128i*)left );
+	const __m128i maskRight = _mm_loadu_si128( (const __m128i*)right );
+#elif defined(SCUMMVM_NEON)
+	uint32x4_t index0 = vld1q_u32( index[ 0 ] );
+	uint32x4_t index1 = vld1q_u32( index[ 1 ] );
+	int32x4_t old0 = vld1q_s32( old[ 0 ] );
+	int32x4_t old1 = vld1q_s32( old[ 1 ] );
+	const uint32x4_t current0 = vld1q_u32( current[ 0 ] );
+	const uint32x4_t current1 = vld1q_u32( current[ 1 ] );
+	const uint32x4_t base0 = vld1q_u32( base[ 0 ] );
+	const uint32x4_t base1 = vld1q_u32( base[ 1 ] );
+	const uint32x4_t mask0 = vld1q_u32( mask[ 0 ] );
+	const uint32x4_t mask1 = vld1q_u32( mask[ 1 ] );
+	const int32x4_t feedbackShift = vld1q_s32( feedback );
+	const int32x4_t fm = vld1q_s32( fmMask );
+	const int32x4_t amv = vld1q_s32( amMask );
+	const int32x4_t maskLeft = vld1q_s32( left );
+	const int32x4_t maskRight = vld1q_s32( right );
+#endif
+
+	for ( Bit32u done = 0; done < samples; done += LANE_BLOCK ) {
+		Bit32u todo = samples - done;
+		if ( todo > LANE_BLOCK )
+			todo = LANE_BLOCK;
+		for ( Bitu l = 0; l < count; l++ ) {
+			lanes[ l ]->Op( 0 )->ForwardMulBlock( todo, &mul[ 0 ][ 0 ][ l ], CHANNEL_LANES );
+			lanes[ l ]->Op( 1 )->ForwardMulBlock( todo, &mul[ 1 ][ 0 ][ l ], CHANNEL_LANES );
+		}
+		Bit32s* out = output + done * ( opl3Mode ? 2 : 1 );
+		//Same as BlockTemplate and Operator::GetSample
+		for ( Bit32u i = 0; i < todo; i++ ) {
+#if defined(SCUMMVM_SSE2)
+			__m128i sum = _mm_add_epi32( old0, old1 );
+			__m128i even = _mm_srli_epi64( _mm_mul_epu32( sum, feedbackEven ), 32 );
+			__m128i odd = _mm_and_si128( _mm_mul_epu32( _mm_srli_epi64( sum, 32 ), feedbackOdd ), oddLanes );
+			__m128i mod = _mm_or_si128( even, odd );
+			old0 = old1;
+			index0 = _mm_add_epi32( index0, current0 );
+			__m128i wave = _mm_add_epi32( _mm_srli_epi32( index0, WAVE_SH ), mod );
+			old1 = LaneWaves( _mm_add_epi32( _mm_and_si128( wave, mask0 ), base0 ), mul[ 0 ][ i ] );
+
+			index1 = _mm_add_epi32( index1, current1 );
+			wave = _mm_add_epi32( _mm_srli_epi32( index1, WAVE_SH ), _mm_and_si128( old0, fm ) );
+			wave = LaneWaves( _mm_add_epi32( _mm_and_si128( wave, mask1 ), base1 ), mul[ 1 ][ i ] );
+			__m128i sample = _mm_add_epi32( wave, _mm_and_si128( old0, amv ) );
+
+			if ( opl3Mode ) {
+				__m128i sampleLeft = _mm_and_si128( sample, maskLeft );
+				__m128i sampleRight = _mm_and_si128( sample, maskRight );
+				__m128i both = _mm_add_epi32( _mm_unpacklo_epi32( sampleLeft, sampleRight ), _mm_unpackhi_epi32( sampleLeft, sampleRight ) );
+				both = _mm_add_epi32( both, _mm_shuffle_epi32( both, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				__m128i mixed = _mm_loadl_epi64( (const __m128i*)( out + i * 2 ) );
+				_mm_storel_epi64( (__m128i*)( out + i * 2 ), _mm_add_epi32( mixed, both ) );
+			} else {
+				sample = _mm_add_epi32( sample, _mm_shuffle_epi32( sample, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				sample = _mm_add_epi32( sample, _mm_shuffle_epi32( sample, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+				out[ i ] += _mm_cvtsi128_si32( sample );
+			}
+#elif defined(SCUMMVM_NEON)
+			uint32x4_t mod = vshlq_u32( vreinterpretq_u32_s32( vaddq_s32( old0, old1 ) ), feedbackShift );
+			old0 = old1;
+			index0 = vaddq_u32( index0, current0 );
+			uint32x4_t wave = vaddq_u32( vshrq_n_u32( index0, WAVE_SH ), mod );
+			old1 = LaneWaves( vaddq_u32( vandq_u32( wave, mask0 ), base0 ), mul[ 0 ][ i ] );
+
+			index1 = vaddq_u32( index1, current1 );
+			wave = vaddq_u32( vshrq_n_u32( index1, WAVE_SH ), vreinterpretq_u32_s32( vandq_s32( old0, fm ) ) );
+			int32x4_t sample = vaddq_s32( LaneWaves( vaddq_u32( vandq_u32( wave, mask1 ), base1 ), mul[ 1 ][ i ] ), vandq_s32( old0, amv ) );
+
+			if ( opl3Mode ) {
+				int32x4_t sampleLeft = vandq_s32( sample, maskLeft );
+				int32x4_t sampleRight = vandq_s32( sample, maskRight );
+				int32x2_t both = vpadd_s32( vadd_s32( vget_low_s32( sampleLeft ), vget_high_s32( sampleLeft ) ),
+				                            vadd_s32( vget_low_s32( sampleRight ), vget_high_s32( sampleRight ) ) );
+				vst1_s32( out + i * 2, vadd_s32( vld1_s32( out + i * 2 ), both ) );
+			} else {
+				int32x2_t half = vadd_s32( vget_low_s32( sample ), vget_high_s32( sample ) );
+				out[ i ] += vget_lane_s32( vpadd_s32( half, half ), 0 );
+			}
+#endif
+		}
+	}
+
+#if defined(SCUMMVM_SSE2)
+	_mm_storeu_si128( (__m128i*)index[ 0 ], index0 );
+	_mm_storeu_si128( (__m128i*)index[ 1 ], index1 );
+	_mm_storeu_si128( (__m128i*)old[ 0 ], old0 );
+	_mm_storeu_si128( (__m128i*)old[ 1 ], old1 );
+#elif defined(SCUMMVM_NEON)
+	vst1q_u32( index[ 0 ], index0 );
+	vst1q_u32( index[ 1 ], index1 );
+	vst1q_s32( old[ 0 ], old0 );
+	vst1q_s32( old[ 1 ], old1 );
+#endif
+	for ( Bitu l = 0; l < count; l++ ) {
+		lanes[ l ]->Op( 0 )->waveIndex = index[ 0 ][ l ];
+		lanes[ l ]->Op( 1 )->waveIndex = index[ 1 ][ l ];
+		lanes[ l ]->old[ 0 ] = old[ 0 ][ l ];
+		lanes[ l ]->old[ 1 ] = old[ 1 ][ l ];
+	}
+}
+
+#endif
+
+template< bool opl3Mode >
+void Chip::GenerateChannels( Bit32u samples, Bit32s* output ) {
+#ifdef DBOPL_LANES
+	Channel* lanes[ CHANNEL_LANES ];
+	bool am[ CHANNEL_LANES ];
+	Bitu count = 0;
+#endif
+	for( Channel* ch = chan; ch < chan + ( opl3Mode ? 18 : 9 ); ) {
+		SynthHandler handler = ch->synthHandler;
+#ifdef DBOPL_LANES
+		bool fm = handler == &Channel::BlockTemplate< sm2FM > || handler == &Channel::BlockTemplate< sm3FM >;
+		bool amMode = handler == &Channel::BlockTemplate< sm2AM > || handler == &Channel::BlockTemplate< sm3AM >;
+		if ( channelLanes && ( fm || amMode ) ) {
+			if ( ch->PrepareLane( this, amMode ) ) {
+				lanes[ count ] = ch;
+				am[ count ] = amMode;
+				if ( ++count == CHANNEL_LANES ) {
+					GenerateLanes< opl3Mode >( lanes, am, count, samples, output );
+					count = 0;
+				}
+			}
+			ch++;
+			continue;
+		}
+#endif
+		ch = (ch->*handler)( this, samples, output );
+	}
+#ifdef DBOPL_LANES
+	//Mostly empty lanes are slower than the channels on their own
+	if ( count > CHANNEL_LANES / 2 ) {
+		GenerateLanes< opl3Mode >( lanes, am, count, samples, output );
+	} else {
+		for ( Bitu l = 0; l < count; l++ )
+			(lanes[ l ]->*(lanes[ l ]->synthHandler))( this, samples, output );
+	}
+#endif
+}
+
 void Chip::GenerateBlock2( Bitu total, Bit32s* output ) {
 	while ( total > 0 ) {
 		Bit32u samples = ForwardLFO( total );
 		memset(output, 0, sizeof(Bit32s) * samples);
-		int count = 0;
-		for( Channel* ch = chan; ch < chan + 9; ) {
-			count++;
-			ch = (ch->*(ch->synthHandler))( this, samples, output );
-		}
+		GenerateChannels< false >( samples, output );
 		total -= samples;
 		output += samples;
 	}
@@ -1238,11 +1535,7 @@ void Chip::GenerateBlock3( Bitu total, Bit32s* output  ) {
 	while ( total > 0 ) {
 		Bit32u samples = ForwardLFO( total );
 		memset(output, 0, sizeof(Bit32s) * samples * 2);
-		int count = 0;
-		for( Channel* ch = chan; ch < chan + 18; ) {
-			count++;
-			ch = (ch->*(ch->synthHandler))( this, samples, output );
-		}
+		GenerateChannels< true >( samples, output );
 		total -= samples;
 		output += samples * 2;
 	}
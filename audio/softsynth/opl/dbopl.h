@@ -175,6 +175,8 @@ public:
 	Bit32s RateForward( Bit32u add );
 	Bitu ForwardWave();
 	Bitu ForwardVolume();
+	//Forward the volume of the next samples and fill in their MulTable entries, 0 when silent
+	void ForwardMulBlock( Bit32u samples, Bit16u* mul, Bitu stride );
 
 	Bits GetSample( Bits modulation );
 	Bits GetWave( Bitu index, Bitu vol );
@@ -215,6 +217,8 @@ struct Channel {
 	//Generate blocks of data in specific modes
 	template<SynthMode mode>
 	Channel* BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output );
+	//Init the operators of a two operator channel for Chip::GenerateLanes, false when it's silent
+	bool PrepareLane( const Chip* chip, bool am );
 	Channel();
 };
 
@@ -253,11 +257,21 @@ struct Chip {
 	Bit8u waveFormMask;
 	//0 or -1 when enabled
 	Bit8s opl3Active;
+	//Generate two operator channels side by side instead of one after the other.
+	//Both give identical output, this is only cleared to compare them.
+	bool channelLanes;
 
 	//Return the maximum amount of samples before and LFO change
 	Bit32u ForwardLFO( Bit32u samples );
 	Bit32u ForwardNoise();
 
+	//Generate all channels, handing two operator channels to GenerateLanes
+	template< bool opl3Mode >
+	void GenerateChannels( Bit32u samples, Bit32s* output );
+	//Generate a few two operator channels at once, one sample for each in turn
+	template< bool opl3Mode >
+	void GenerateLanes( Channel* const* lanes, const bool* am, Bitu count, Bit32u samples, Bit32s* output );
+
 	void WriteBD( Bit8u val );
 	void WriteReg(Bit32u reg, Bit8u val );
 
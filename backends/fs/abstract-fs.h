@@ -183,6 +183,15 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Like createReadStream(), but the file may be mapped into memory
+	 * instead of being read through a buffer. Backends which can not map
+	 * files simply return createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream() { return createReadStream(); }
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -192,6 +201,15 @@ public:
 	 */
 	virtual Common::WriteStream *createWriteStream() = 0;
 
+	/**
+	 * Like createWriteStream(), but the file is only replaced once the
+	 * stream is finalized, so an interrupted write keeps the old file.
+	 * Backends which can not do that simply return createWriteStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::WriteStream *createAtomicWriteStream() { return createWriteStream(); }
+
 	/**
 	* Creates a file referred by this node.
 	*
@@ -32,6 +32,9 @@
 
 #include "backends/fs/posix/posix-fs.h"
 #include "backends/fs/stdiostream.h"
+#ifdef POSIX
+#include "backends/fs/posix/posix-mmapstream.h"
+#endif
 #include "common/algorithm.h"
 
 #include <sys/param.h>
@@ -254,10 +257,25 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createMappedReadStream() {
+#ifdef POSIX
+	// Small files are not worth the cost of setting up a mapping
+	Common::SeekableReadStream *stream = POSIXMmapStream::makeFromPath(getPath(), 256 * 1024);
+	if (stream)
+		return stream;
+#endif
+
+	return createReadStream();
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
 	return StdioStream::makeFromPath(getPath(), true);
 }
 
+Common::WriteStream *POSIXFilesystemNode::createAtomicWriteStream() {
+	return StdioStream::makeAtomicWriteStream(getPath());
+}
+
 bool POSIXFilesystemNode::create(bool isDirectoryFlag) {
 	bool success;
 
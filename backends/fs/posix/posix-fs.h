@@ -72,7 +72,9 @@ public:
 	virtual AbstractFSNode *getParent() const;
 
 	virtual Common::SeekableReadStream *createReadStream();
+	virtual Common::SeekableReadStream *createMappedReadStream();
 	virtual Common::WriteStream *createWriteStream();
+	virtual Common::WriteStream *createAtomicWriteStream();
 	virtual bool create(bool isDirectoryFlag);
 
 private:
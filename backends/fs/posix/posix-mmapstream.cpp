@@ -0,0 +1,117 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX)
+
+// Re-enable some forbidden symbols to avoid clashes with stat.h and unistd.h.
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
+
+#include "backends/fs/posix/posix-mmapstream.h"
+#include "common/util.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+POSIXMmapStream *POSIXMmapStream::makeFromPath(const Common::String &path, uint32 minSize) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || st.st_size < (off_t)minSize || st.st_size > 0x7FFFFFFF) {
+		close(fd);
+		return 0;
+	}
+
+	void *data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps the file referenced, so the descriptor is not needed anymore
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return 0;
+
+	return new POSIXMmapStream((const byte *)data, st.st_size);
+}
+
+POSIXMmapStream::POSIXMmapStream(const byte *data, uint32 size)
+	: _data(data), _size(size), _pos(0), _eos(false) {
+}
+
+POSIXMmapStream::~POSIXMmapStream() {
+	munmap(const_cast<byte *>(_data), _size);
+}
+
+bool POSIXMmapStream::seek(int32 offs, int whence) {
+	int32 newPos = offs;
+	if (whence == SEEK_CUR)
+		newPos += _pos;
+	else if (whence == SEEK_END)
+		newPos += _size;
+
+	// Like fseek(), allow seeking past the end, but not before the start
+	if (newPos < 0)
+		return false;
+
+	_pos = newPos;
+	_eos = false;
+	return true;
+}
+
+uint32 POSIXMmapStream::read(void *dataPtr, uint32 dataSize) {
+	const byte *data = borrow(dataSize);
+	memcpy(dataPtr, data, dataSize);
+	return dataSize;
+}
+
+const byte *POSIXMmapStream::borrow(uint32 &dataSize) {
+	const uint32 available = _pos < _size ? _size - _pos : 0;
+	if (dataSize > available) {
+		dataSize = available;
+		_eos = true;
+	}
+
+	const byte *data = _data + MIN(_pos, _size);
+	_pos += dataSize;
+	return data;
+}
+
+void POSIXMmapStream::setAccessPattern(AccessPattern pattern) {
+	int advice = MADV_NORMAL;
+	if (pattern == kAccessSequential)
+		advice = MADV_SEQUENTIAL;
+	else if (pattern == kAccessRandom)
+		advice = MADV_RANDOM;
+
+	// madvise() wants a page aligned address
+	const uint32 pageSize = sysconf(_SC_PAGESIZE);
+	uint32 start = MIN(_pos, _size);
+	start -= start % pageSize;
+	madvise(const_cast<byte *>(_data) + start, _size - start, advice);
+}
+
+#endif
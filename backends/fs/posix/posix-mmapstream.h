@@ -0,0 +1,73 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+/**
+ * Read-only stream on a file which is mapped into memory with mmap().
+ * Pages are read in on demand by the kernel, so there is no copy of the
+ * data in a stdio buffer, and data which is never read is never loaded.
+ * Reading from a file which was truncated while it is mapped raises
+ * SIGBUS, so these are only created for FSNode::createMappedReadStream().
+ */
+class POSIXMmapStream : public Common::SeekableReadStream, public Common::DirectReadAccess, public Common::NonCopyable {
+public:
+	/**
+	 * Given a path, map the file into memory and wrap it in a POSIXMmapStream
+	 * instance. Returns 0 if the file cannot be mapped, for example because
+	 * it is not a regular file, or if it is smaller than minSize bytes.
+	 */
+	static POSIXMmapStream *makeFromPath(const Common::String &path, uint32 minSize = 1);
+
+	virtual ~POSIXMmapStream();
+
+	virtual bool err() const { return false; }
+	virtual void clearErr() { _eos = false; }
+	virtual bool eos() const { return _eos; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offs, int whence = SEEK_SET);
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual Common::DirectReadAccess *getDirectAccess() { return this; }
+
+	// DirectReadAccess API. The access pattern is passed on to madvise().
+	virtual const byte *borrow(uint32 &dataSize);
+	virtual void setAccessPattern(AccessPattern pattern);
+
+private:
+	POSIXMmapStream(const byte *data, uint32 size);
+
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+};
+
+#endif
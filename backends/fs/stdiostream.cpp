@@ -27,20 +27,64 @@
 
 #include "backends/fs/stdiostream.h"
 
-StdioStream::StdioStream(void *handle) : _handle(handle) {
+#ifdef POSIX
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+StdioStream::StdioStream(void *handle) : _handle(handle), _commitFailed(false) {
 	assert(handle);
 }
 
 StdioStream::~StdioStream() {
-	fclose((FILE *)_handle);
+	if (!_replacePath.empty())
+		commit();
+	else if (_handle)
+		fclose((FILE *)_handle);
+}
+
+void StdioStream::commit() {
+	bool success = fflush((FILE *)_handle) == 0 && !ferror((FILE *)_handle);
+#ifdef POSIX
+	// Make sure the data is on disk before the rename makes it visible
+	success = success && fsync(fileno((FILE *)_handle)) == 0;
+#endif
+	success = (fclose((FILE *)_handle) == 0) && success;
+	_handle = 0;
+
+	if (success) {
+#ifdef WIN32
+		// rename() does not replace existing files on Windows
+		remove(_replacePath.c_str());
+#endif
+		success = rename(_tempPath.c_str(), _replacePath.c_str()) == 0;
+	}
+
+	if (!success)
+		remove(_tempPath.c_str());
+
+	_replacePath.clear();
+	_tempPath.clear();
+	_commitFailed = !success;
+}
+
+void StdioStream::finalize() {
+	if (!_replacePath.empty())
+		commit();
+	else
+		flush();
 }
 
 bool StdioStream::err() const {
+	if (!_handle)
+		return _commitFailed;
 	return ferror((FILE *)_handle) != 0;
 }
 
 void StdioStream::clearErr() {
-	clearerr((FILE *)_handle);
+	if (_handle)
+		clearerr((FILE *)_handle);
 }
 
 bool StdioStream::eos() const {
@@ -103,4 +147,67 @@ StdioStream *StdioStream::makeFromPath(const Common::String &path, bool writeMod
 	return 0;
 }
 
+StdioStream *StdioStream::makeAtomicWriteStream(const Common::String &path) {
+	Common::String target = path;
+#ifdef POSIX
+	// Replace the file a symbolic link points to, not the link itself
+	char *resolved = realpath(path.c_str(), NULL);
+	if (resolved) {
+		target = resolved;
+		free(resolved);
+	}
+#endif
+
+	StdioStream *stream = 0;
+	Common::String tempPath = target + ".tmp";
+#ifdef POSIX
+	// A unique name keeps other processes writing the same file from
+	// overwriting the temporary file
+	tempPath = target + ".XXXXXX";
+	char *tempName = (char *)malloc(tempPath.size() + 1);
+	strcpy(tempName, tempPath.c_str());
+	const int fd = mkstemp(tempName);
+	tempPath = tempName;
+	free(tempName);
+
+	if (fd >= 0) {
+		FILE *handle = fdopen(fd, "wb");
+		if (handle) {
+			stream = new StdioStream(handle);
+		} else {
+			close(fd);
+			remove(tempPath.c_str());
+		}
+	}
+
+	if (stream) {
+		// mkstemp() creates the file only accessible by its owner, so set
+		// the permissions of the file being replaced, or the usual ones
+		// for a new file
+		struct stat st;
+		mode_t mode;
+		if (stat(target.c_str(), &st) == 0) {
+			mode = st.st_mode & 07777;
+		} else {
+			const mode_t mask = umask(0);
+			umask(mask);
+			mode = 0666 & ~mask;
+		}
+		fchmod(fd, mode);
+	}
+#else
+	stream = makeFromPath(tempPath, true);
+#endif
+
+	if (!stream) {
+		// Writing the file directly is not safe against interruptions,
+		// but better than not writing it at all
+		return makeFromPath(target, true);
+	}
+
+	stream->_replacePath = target;
+	stream->_tempPath = tempPath;
+	return stream;
+}
+
 #endif
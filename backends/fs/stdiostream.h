@@ -33,6 +33,18 @@ protected:
 	/** File handle to the actual file. */
 	void *_handle;
 
+	/** Path of the file to replace on finalize() or destruction, if any. */
+	Common::String _replacePath;
+
+	/** Path of the temporary file written instead of _replacePath. */
+	Common::String _tempPath;
+
+	/** Whether replacing the file at _replacePath failed. */
+	bool _commitFailed;
+
+	/** Close the temporary file and move it over the file at _replacePath. */
+	void commit();
+
 public:
 	/**
 	 * Given a path, invokes fopen on that path and wrap the result in a
@@ -40,6 +52,24 @@ public:
 	 */
 	static StdioStream *makeFromPath(const Common::String &path, bool writeMode);
 
+	/**
+	 * Open a temporary file next to the given path for writing. On
+	 * finalize(), or when the stream is destroyed, the temporary file
+	 * replaces the file at the given path, unless writing failed, in which
+	 * case it is removed. Thus the file at the given path is never left
+	 * partially written. err() tells whether finalize() succeeded, nothing
+	 * may be written after it.
+	 *
+	 * Every stream gets a temporary file of its own, so streams for the
+	 * same path do not interfere, the last one finalized wins. If no
+	 * temporary file can be created, e.g. because only the file but not
+	 * its directory is writable, the file is written directly instead.
+	 *
+	 * Symbolic links are followed, so the file they point to is replaced,
+	 * and the permissions of the replaced file are kept.
+	 */
+	static StdioStream *makeAtomicWriteStream(const Common::String &path);
+
 	StdioStream(void *handle);
 	virtual ~StdioStream();
 
@@ -49,6 +79,7 @@ public:
 
 	virtual uint32 write(const void *dataPtr, uint32 dataSize);
 	virtual bool flush();
+	virtual void finalize();
 
 	virtual int32 pos() const;
 	virtual int32 size() const;
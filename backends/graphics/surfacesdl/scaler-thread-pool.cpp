@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/scaler-thread-pool.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+ScalerThreadPool::ScalerThreadPool(int numThreads)
+	: _numThreads(1), _workers(0), _done(0), _quit(false), _scaler(0),
+	  _srcPitch(0), _dstPitch(0), _width(0) {
+
+	if (numThreads > 1) {
+		_done = SDL_CreateSemaphore(0);
+		_workers = new Worker[numThreads - 1];
+	}
+
+	for (int i = 0; _done && i < numThreads - 1; ++i) {
+		Worker &worker = _workers[i];
+		worker.pool = this;
+		worker.index = i + 1;
+		worker.start = SDL_CreateSemaphore(0);
+		worker.thread = 0;
+		if (worker.start) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+			worker.thread = SDL_CreateThread(workerProc, "ScummVM scaler", &worker);
+#else
+			worker.thread = SDL_CreateThread(workerProc, &worker);
+#endif
+		}
+
+		if (!worker.thread) {
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			if (worker.start)
+				SDL_DestroySemaphore(worker.start);
+			break;
+		}
+
+		_numThreads++;
+	}
+
+	_bands = new Band[_numThreads];
+}
+
+ScalerThreadPool::~ScalerThreadPool() {
+	_quit = true;
+	for (int i = 0; i < _numThreads - 1; ++i) {
+		SDL_SemPost(_workers[i].start);
+		SDL_WaitThread(_workers[i].thread, 0);
+		SDL_DestroySemaphore(_workers[i].start);
+	}
+
+	if (_done)
+		SDL_DestroySemaphore(_done);
+	delete[] _workers;
+	delete[] _bands;
+}
+
+int SDLCALL ScalerThreadPool::workerProc(void *data) {
+	Worker *worker = (Worker *)data;
+	ScalerThreadPool *pool = worker->pool;
+
+	while (true) {
+		SDL_SemWait(worker->start);
+		if (pool->_quit)
+			break;
+
+		pool->scaleBand(worker->index);
+		SDL_SemPost(pool->_done);
+	}
+	return 0;
+}
+
+void ScalerThreadPool::scaleBand(int index) {
+	const Band &band = _bands[index];
+	if (band.height > 0)
+		_scaler(band.src, _srcPitch, band.dst, _dstPitch, _width, band.height);
+}
+
+void ScalerThreadPool::scale(ScalerProc *scaler, const uint8 *src, uint32 srcPitch,
+                             uint8 *dst, uint32 dstPitch, int width, int height, int scaleFactor) {
+	// Round the rows per band up to the band alignment
+	int bandHeight = (height + _numThreads - 1) / _numThreads;
+	bandHeight = (bandHeight + kBandAlignment - 1) & ~(kBandAlignment - 1);
+
+	if (_numThreads == 1 || bandHeight < kMinBandHeight || !isScalerThreadSafe(scaler)) {
+		scaler(src, srcPitch, dst, dstPitch, width, height);
+		return;
+	}
+
+	_scaler = scaler;
+	_srcPitch = srcPitch;
+	_dstPitch = dstPitch;
+	_width = width;
+
+	for (int i = 0; i < _numThreads; ++i) {
+		const int y = MIN(i * bandHeight, height);
+		_bands[i].src = src + y * srcPitch;
+		_bands[i].dst = dst + y * scaleFactor * dstPitch;
+		_bands[i].height = MIN(bandHeight, height - y);
+	}
+
+	// The semaphores make the job visible to the workers, and their
+	// results visible to us
+	for (int i = 0; i < _numThreads - 1; ++i)
+		SDL_SemPost(_workers[i].start);
+
+	scaleBand(0);
+
+	for (int i = 0; i < _numThreads - 1; ++i)
+		SDL_SemWait(_done);
+}
+
+#endif
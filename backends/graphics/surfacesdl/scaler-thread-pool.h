@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALER_THREAD_POOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALER_THREAD_POOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "graphics/scaler.h"
+
+/**
+ * Runs a scaler on several threads, each scaling a horizontal band of the
+ * area. Scalers only read the source pixels around each pixel they produce
+ * and write no pixels outside of their area, so bands can be scaled
+ * independently, with a result identical to scaling the area at once.
+ */
+class ScalerThreadPool {
+public:
+	/**
+	 * Create a pool.
+	 * @param numThreads	the number of threads to scale with, including
+	 *						the one calling scale()
+	 */
+	explicit ScalerThreadPool(int numThreads);
+	~ScalerThreadPool();
+
+	/** Return the number of threads used for scaling. */
+	int getNumThreads() const { return _numThreads; }
+
+	/**
+	 * Scale an area, with the same parameters as the scaler itself. Returns
+	 * once the whole area is scaled. Scalers which are not thread safe
+	 * scale the whole area on the calling thread.
+	 */
+	void scale(ScalerProc *scaler, const uint8 *src, uint32 srcPitch,
+	           uint8 *dst, uint32 dstPitch, int width, int height, int scaleFactor);
+
+private:
+	enum {
+		/**
+		 * Bands start at multiples of this many rows of the area. Some
+		 * scalers vary their output with the row, e.g. DotMatrix repeats
+		 * its pattern every two source rows.
+		 */
+		kBandAlignment = 4,
+		/** Areas with fewer rows per thread are scaled in one go. */
+		kMinBandHeight = 16
+	};
+
+	struct Band {
+		const uint8 *src;
+		uint8 *dst;
+		int height;
+	};
+
+	struct Worker {
+		ScalerThreadPool *pool;
+		int index;
+		SDL_Thread *thread;
+		SDL_sem *start;
+	};
+
+	static int SDLCALL workerProc(void *data);
+	void scaleBand(int index);
+
+	int _numThreads;
+	Worker *_workers;
+	SDL_sem *_done;
+	bool _quit;
+
+	// The current job
+	ScalerProc *_scaler;
+	uint32 _srcPitch;
+	uint32 _dstPitch;
+	int _width;
+	Band *_bands;
+};
+
+#endif
@@ -24,9 +24,11 @@
 
 #if defined(SDL_BACKEND)
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
+#include "backends/graphics/surfacesdl/scaler-thread-pool.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -150,6 +152,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_screenIsLocked(false),
 	_graphicsMutex(0),
 	_displayDisabled(false),
+	_dirtyRegion(16, 10),
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	_enableFocusRectDebugCode(false), _enableFocusRect(false), _focusRect(),
 #endif
@@ -204,6 +207,22 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	// consult the psp2sdl backend which inherits from this class
 	_currentShader = 0;
 	_numShaders = 1;
+
+	// By default, scale with one thread per CPU core, up to four
+	int scalerThreads = 0;
+	if (ConfMan.hasKey("scaler_threads"))
+		scalerThreads = ConfMan.getInt("scaler_threads");
+	if (scalerThreads <= 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		scalerThreads = MIN(SDL_GetCPUCount(), 4);
+#else
+		scalerThreads = 1;
+#endif
+	}
+	_scalerThreads = new ScalerThreadPool(scalerThreads);
+
+	_statsFrames = _scalerTime = _scalerTimeMax = _dirtyPercent = _dirtyRectCoalesces = 0;
+	_statsStart = SDL_GetTicks();
 }
 
 SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
@@ -221,6 +240,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	free(_currentPalette);
 	free(_cursorPalette);
 	delete[] _mouseData;
+	delete _scalerThreads;
 }
 
 void SurfaceSdlGraphicsManager::activateManager() {
@@ -1130,6 +1150,40 @@ void SurfaceSdlGraphicsManager::updateShader() {
 	// hardware-based up-scaling (sharp-bilinear-simple, etc.)
 }
 
+static uint64 getPerformanceCounter() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return SDL_GetPerformanceCounter();
+#else
+	return SDL_GetTicks();
+#endif
+}
+
+static uint32 getMicrosecondsSince(uint64 start) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return (uint32)((SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency());
+#else
+	return (uint32)(SDL_GetTicks() - start) * 1000;
+#endif
+}
+
+void SurfaceSdlGraphicsManager::updateFrameStats(uint32 scalerTime, uint32 dirtyArea, uint32 screenArea) {
+	_statsFrames++;
+	_scalerTime += scalerTime;
+	_scalerTimeMax = MAX(_scalerTimeMax, scalerTime);
+	_dirtyPercent += MIN<uint32>(dirtyArea * 100 / screenArea, 100);
+
+	// Report every five seconds
+	const uint32 now = SDL_GetTicks();
+	if (now - _statsStart >= 5000) {
+		debug(3, "%u frames drawn, %u%% of the screen dirty on average, dirty rects coalesced %u times",
+		      _statsFrames, _dirtyPercent / _statsFrames, _dirtyRectCoalesces);
+		debug(3, "Scaling took %u us per frame on average, %u us at most, using %d threads",
+		      _scalerTime / _statsFrames, _scalerTimeMax, _scalerThreads->getNumThreads());
+		_statsFrames = _scalerTime = _scalerTimeMax = _dirtyPercent = _dirtyRectCoalesces = 0;
+		_statsStart = now;
+	}
+}
+
 void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	SDL_Surface *srcSurf, *origSurf;
 	int height, width;
@@ -1222,7 +1276,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
+		const uint64 scaleStart = getPerformanceCounter();
+		uint32 dirtyArea = 0;
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
+			dirtyArea += r->w * r->h;
+
 			register int dst_y = r->y + _currentShakePos;
 			register int dst_h = 0;
 #ifdef USE_SCALERS
@@ -1244,8 +1303,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwScreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				_scalerThreads->scale(scalerProc, (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+					(byte *)_hwScreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h, scale1);
 			}
 
 			r->x = rx1;
@@ -1258,6 +1317,9 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 				r->h = stretch200To240((uint8 *) _hwScreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
 #endif
 		}
+
+		updateFrameStats(getMicrosecondsSince(scaleStart), dirtyArea, width * height);
+
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwScreen);
 
@@ -1545,11 +1607,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceRedraw)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceRedraw = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1600,6 +1657,9 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	}
 
 	if (w > 0 && h > 0) {
+		if (_numDirtyRects == NUM_DIRTY_RECT)
+			coalesceDirtyRects();
+
 		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
 
 		r->x = x;
@@ -1609,6 +1669,31 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	}
 }
 
+void SurfaceSdlGraphicsManager::coalesceDirtyRects() {
+	_dirtyRegion.clear();
+	for (int i = 0; i < _numDirtyRects; ++i) {
+		const SDL_Rect &r = _dirtyRectList[i];
+		_dirtyRegion.addRect(Common::Rect(r.x, r.y, r.x + r.w, r.y + r.h));
+	}
+
+	// Leave plenty of room for further rects, so that busy scenes do not
+	// have to coalesce the list again right away. The region uses tiles
+	// which are 10 lines high, which keeps the rects stretchable for the
+	// aspect ratio correction.
+	_dirtyRegion.getRects(_coalescedRects, NUM_DIRTY_RECT / 4);
+
+	_numDirtyRects = _coalescedRects.size();
+	for (int i = 0; i < _numDirtyRects; ++i) {
+		const Common::Rect &r = _coalescedRects[i];
+		_dirtyRectList[i].x = r.left;
+		_dirtyRectList[i].y = r.top;
+		_dirtyRectList[i].w = r.width();
+		_dirtyRectList[i].h = r.height();
+	}
+
+	_dirtyRectCoalesces++;
+}
+
 int16 SurfaceSdlGraphicsManager::getHeight() const {
 	return _videoMode.screenHeight;
 }
@@ -2693,6 +2778,9 @@ void SurfaceSdlGraphicsManager::recreateScreenTexture() {
 		SDL_DestroyTexture(oldTexture);
 	else
 		_screenTexture = oldTexture;
+
+	// The new texture has to be uploaded completely
+	_forceRedraw = true;
 }
 
 SDL_Surface *SurfaceSdlGraphicsManager::SDL_SetVideoMode(int width, int height, int bpp, Uint32 flags) {
@@ -2734,7 +2822,23 @@ SDL_Surface *SurfaceSdlGraphicsManager::SDL_SetVideoMode(int width, int height,
 }
 
 void SurfaceSdlGraphicsManager::SDL_UpdateRects(SDL_Surface *screen, int numrects, SDL_Rect *rects) {
-	SDL_UpdateTexture(_screenTexture, nullptr, screen->pixels, screen->pitch);
+	// Only upload the dirty parts of the screen, unless they cover most of it
+	uint32 area = 0;
+	for (int i = 0; i < numrects; ++i)
+		area += rects[i].w * rects[i].h;
+
+	if (area * 2 >= (uint32)(screen->w * screen->h)) {
+		SDL_UpdateTexture(_screenTexture, nullptr, screen->pixels, screen->pitch);
+	} else {
+		const SDL_Rect screenRect = { 0, 0, screen->w, screen->h };
+		for (int i = 0; i < numrects; ++i) {
+			SDL_Rect r;
+			if (SDL_IntersectRect(&rects[i], &screenRect, &r)) {
+				const byte *pixels = (const byte *)screen->pixels + r.y * screen->pitch + r.x * screen->format->BytesPerPixel;
+				SDL_UpdateTexture(_screenTexture, &r, pixels, screen->pitch);
+			}
+		}
+	}
 
 	SDL_Rect viewport;
 	viewport.x = _activeArea.drawRect.left;
@@ -25,6 +25,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/dirty_region.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -59,6 +60,8 @@ enum {
 };
 
 
+class ScalerThreadPool;
+
 class AspectRatio {
 	int _kw, _kh;
 public:
@@ -276,6 +279,20 @@ protected:
 	int _scalerType;
 	int _transactionMode;
 
+	/** Threads for scaling the dirty rects */
+	ScalerThreadPool *_scalerThreads;
+
+	// Frame statistics for the debug output: time spent scaling and
+	// correcting the aspect ratio, and the share of the screen redrawn
+	uint32 _statsFrames;
+	uint32 _statsStart;
+	uint32 _scalerTime;
+	uint32 _scalerTimeMax;
+	uint32 _dirtyPercent;
+	uint32 _dirtyRectCoalesces;
+
+	void updateFrameStats(uint32 scalerTime, uint32 dirtyArea, uint32 screenArea);
+
 	// Indicates whether it is needed to free _hwSurface in destructor
 	bool _displayDisabled;
 
@@ -296,6 +313,13 @@ protected:
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	// When the dirty rect list is full, its rects are merged into fewer,
+	// larger ones
+	Graphics::DirtyRegion _dirtyRegion;
+	Common::Array<Common::Rect> _coalescedRects;
+
+	void coalesceDirtyRects();
+
 	struct MousePos {
 		// The size and hotspot of the original cursor image.
 		int16 w, h;
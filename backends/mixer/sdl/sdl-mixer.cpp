@@ -38,6 +38,19 @@
 #define SAMPLES_PER_SEC 44100
 #endif
 
+// Microsecond timer for the callback statistics
+static uint64 getMicros() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// Scaling the whole counter would overflow with high resolution
+	// counters, so only scale what is left over after the full seconds
+	const Uint64 counter = SDL_GetPerformanceCounter();
+	const Uint64 frequency = SDL_GetPerformanceFrequency();
+	return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+#else
+	return (uint64)SDL_GetTicks() * 1000;
+#endif
+}
+
 SdlMixerManager::SdlMixerManager()
 	:
 	_mixer(0),
@@ -48,6 +61,13 @@ SdlMixerManager::SdlMixerManager()
 SdlMixerManager::~SdlMixerManager() {
 	_mixer->setReady(false);
 
+	Audio::Mixer::CallbackStats stats;
+	if (_mixer->getCallbackStats(stats)) {
+		debug(1, "Audio callback: %u calls, %u missed deadlines, duration p50/p95/p99 %u/%u/%u us, buffer %u us, latency %u us (max %u us)",
+		      stats.callbacks, stats.missedDeadlines, stats.durationP50, stats.durationP95, stats.durationP99,
+		      stats.bufferLength, stats.latency, stats.maxLatency);
+	}
+
 	SDL_CloseAudio();
 
 	delete _mixer;
@@ -107,7 +127,7 @@ void SdlMixerManager::init() {
 	if (_obtained.freq != desired.freq)
 		warning("SDL mixer output sample rate: %d differs from desired: %d", _obtained.freq, desired.freq);
 
-	debug(1, "Output buffer size: %d samples", _obtained.samples);
+	debug(1, "Output buffer size: %d samples (%d ms)", _obtained.samples, _obtained.samples * 1000 / _obtained.freq);
 	if (_obtained.samples != desired.samples)
 		warning("SDL mixer output buffer size: %d differs from desired: %d", _obtained.samples, desired.samples);
 
@@ -159,29 +179,56 @@ SDL_AudioSpec SdlMixerManager::getAudioSpec(uint32 outputRate) {
 
 	// One SDL "sample" is a complete audio frame (i.e. all channels = 1 sample)
 	uint32 samples = 0;
+	bool configured = true;
 
 	// Different games and host systems have different performance
 	// characteristics which are not easily measured, so allow advanced users to
 	// tweak their audio buffer size if they are experience excess latency or
-	// drop-outs by setting this value in their ScummVM config file directly
-	if (ConfMan.hasKey("audio_buffer_size", appDomain))
-		samples = ConfMan.getInt("audio_buffer_size", appDomain);
-
+	// drop-outs by setting this value in their ScummVM config file directly.
 	// 256 is an arbitrary minimum; 32768 is the largest power-of-two value
 	// representable with uint16
-	if (samples < 256 || samples > 32768)
+	if (ConfMan.hasKey("audio_buffer_size", appDomain)) {
+		const int bufferSize = ConfMan.getInt("audio_buffer_size", appDomain);
+		if (bufferSize >= 256 && bufferSize <= 32768)
+			samples = bufferSize;
+		else
+			warning("Ignoring invalid audio_buffer_size %d, it must be between 256 and 32768", bufferSize);
+	}
+
+	// Alternatively, users can ask for a latency in milliseconds, which is
+	// what matters for lip-sync and rhythm. Since SDL keeps one buffer
+	// playing while the next one is mixed, each buffer gets half of it.
+	// The mixer mixes each callback's buffer in one go, so this also sets
+	// the size of the blocks the audio streams are asked for.
+	if (samples == 0 && ConfMan.hasKey("audio_latency", appDomain)) {
+		const int latency = ConfMan.getInt("audio_latency", appDomain);
+		if (latency > 0)
+			samples = CLIP<uint32>(freq * latency / 2000, 128, 32768);
+		else
+			warning("Ignoring invalid audio_latency %d", latency);
+	}
+
+	if (samples == 0) {
+		configured = false;
+
 		// By default, hold no more than 45ms worth of samples to avoid
 		// perceptable audio lag (ATSC IS-191). For reference, DOSBox (as of Sep
 		// 2017) uses a buffer size of 1024 samples by default for a 16-bit
 		// stereo 44kHz mixer, which happens to be the next lowest power of two
 		// below 45ms.
-		samples = freq / (1000.0 / 45);
+		samples = MIN<uint32>(freq / (1000.0 / 45), 32768);
+	}
+
+	// SDL wants a power of two
+	const uint32 rounded = roundDownPowerOfTwo(samples);
+	if (rounded != samples && configured)
+		warning("Audio buffer size %u rounded down to %u samples (%u ms)", samples, rounded, rounded * 1000 / freq);
 
 	memset(&desired, 0, sizeof(desired));
 	desired.freq = freq;
 	desired.format = AUDIO_S16SYS;
 	desired.channels = 2;
-	desired.samples = roundDownPowerOfTwo(samples);
+	desired.samples = rounded;
 	desired.callback = sdlCallback;
 	desired.userdata = this;
 
@@ -202,7 +249,11 @@ void SdlMixerManager::sdlCallback(void *this_, byte *samples, int len) {
 	SdlMixerManager *manager = (SdlMixerManager *)this_;
 	assert(manager);
 
+	const uint64 start = getMicros();
+
 	manager->callbackHandler(samples, len);
+
+	manager->_mixer->recordCallback(start, (uint32)(getMicros() - start), len);
 }
 
 void SdlMixerManager::suspendAudio() {
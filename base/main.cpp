@@ -41,6 +41,7 @@
 #include "common/config-manager.h"
 #include "common/debug.h"
 #include "common/debug-channels.h" /* for debug manager */
+#include "common/memorypool.h"
 #include "common/events.h"
 #include "gui/EventRecorder.h"
 #include "common/fs.h"
@@ -56,11 +57,13 @@
 #include "gui/gui-manager.h"
 #include "gui/error.h"
 
+#include "audio/decoded_sound_cache.h"
 #include "audio/mididrv.h"
 #include "audio/musicplugin.h"  /* for music manager */
 
 #include "graphics/cursorman.h"
 #include "graphics/fontman.h"
+#include "graphics/transform_cache.h"
 #include "graphics/yuv_to_rgb.h"
 #ifdef USE_FREETYPE2
 #include "graphics/fonts/ttf.h"
@@ -277,6 +280,12 @@ static Common::Error runGame(const EnginePlugin *plugin, OSystem &system, const
 	// Reset the file/directory mappings
 	SearchMan.clear();
 
+	// Cached sounds are keyed by file name, which is only unique per game
+	DecodedSounds.clear();
+
+	// Transformed surfaces are keyed by the address of the game's pixels
+	TransformCacheMan.clear();
+
 	// Return result (== 0 means no error)
 	return result;
 }
@@ -435,6 +444,11 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	// the command line params) was read.
 	system.initBackend();
 
+	// Backends can only create mutexes once they are initialized. Nothing
+	// creates memory allocators before the launcher or an engine runs, so
+	// this is early enough to guard the list of allocators.
+	Common::SizeClassAllocator::initList();
+
 	// If we received an invalid graphics mode parameter via command line
 	// we check this here. We can't do it until after the backend is inited,
 	// or there won't be a graphics manager to ask for the supported modes.
@@ -627,6 +641,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	Common::TranslationManager::destroy();
 #endif
 	MusicManager::destroy();
+	Audio::DecodedSoundCache::destroy();
 	Graphics::CursorManager::destroy();
 	Graphics::FontManager::destroy();
 #ifdef USE_FREETYPE2
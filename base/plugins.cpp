@@ -444,6 +444,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 
 // Engine plugins
 
+#include "engines/advancedDetector.h"
 #include "engines/metaengine.h"
 
 namespace Common {
@@ -518,6 +519,10 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 	GameList candidates;
 	EnginePlugin::List plugins;
 	EnginePlugin::List::const_iterator iter;
+
+	// Let all engines share the MD5 sums of the files in this directory
+	AdvancedMetaEngine::beginDetectionScan();
+
 	PluginManager::instance().loadFirstPlugin();
 	do {
 		plugins = getPlugins();
@@ -527,6 +532,8 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 			candidates.push_back((**iter)->detectGames(fslist));
 		}
 	} while (PluginManager::instance().loadNextPlugin());
+
+	AdvancedMetaEngine::endDetectionScan();
 	return candidates;
 }
 
@@ -21,6 +21,7 @@
  */
 
 #include "common/archive.h"
+#include "common/atomic.h"
 #include "common/fs.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -62,6 +63,36 @@ int Archive::listMatchingMembers(ArchiveMemberList &list, const String &pattern)
 
 
 
+// Lookups may run on several threads at once, so the statistics are updated
+// atomically. Without atomics, some counts may get lost.
+static inline void countStat(uint32 &counter) {
+#ifdef SCUMMVM_ATOMICS
+	atomicAdd(&counter, 1);
+#else
+	counter++;
+#endif
+}
+
+static inline uint32 readStat(const uint32 &counter) {
+#ifdef SCUMMVM_ATOMICS
+	return atomicLoad(&counter);
+#else
+	return counter;
+#endif
+}
+
+static inline void resetStat(uint32 &counter) {
+#ifdef SCUMMVM_ATOMICS
+	atomicStore(&counter, 0);
+#else
+	counter = 0;
+#endif
+}
+
+SearchSet::SearchSet() : _nextOrder(0), _unindexedArchives(0) {
+	resetStats();
+}
+
 SearchSet::ArchiveNodeList::iterator SearchSet::find(const String &name) {
 	ArchiveNodeList::iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
@@ -83,9 +114,12 @@ SearchSet::ArchiveNodeList::const_iterator SearchSet::find(const String &name) c
 /*
     Keep the nodes sorted according to descending priorities.
     In case two or node nodes have the same priority, insertion
-    order prevails.
+    order prevails. The node gets the highest order so far, so the
+    index can sort archives by priority and order the same way.
 */
-void SearchSet::insert(const Node &node) {
+void SearchSet::insert(Node &node) {
+	node._order = _nextOrder++;
+
 	ArchiveNodeList::iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
 		if (it->_priority < node._priority)
@@ -94,10 +128,137 @@ void SearchSet::insert(const Node &node) {
 	_list.insert(it, node);
 }
 
+// Whether the archive of the first entry is searched before the second one
+static inline bool searchedBefore(int priority1, uint order1, int priority2, uint order2) {
+	return priority1 > priority2 || (priority1 == priority2 && order1 < order2);
+}
+
+/*
+    Add the members of an archive to the name index, by file name.
+    Called with _indexMutex held.
+*/
+void SearchSet::indexArchive(const Node &node) const {
+	ArchiveMemberList members;
+	node._unlisted = (node._arc->listMembers(members) == 0);
+	node._indexed = true;
+
+	IndexEntry added;
+	added._arc = node._arc;
+	added._priority = node._priority;
+	added._order = node._order;
+	added._listed = !node._unlisted;
+
+	if (node._unlisted) {
+		uint pos = 0;
+		while (pos < _unlistedArchives.size() && searchedBefore(_unlistedArchives[pos]._priority, _unlistedArchives[pos]._order, added._priority, added._order))
+			pos++;
+		_unlistedArchives.insert_at(pos, added);
+		return;
+	}
+
+	for (ArchiveMemberList::const_iterator i = members.begin(); i != members.end(); ++i) {
+		Array<IndexEntry> &entries = _index[lastPathComponent((*i)->getName(), '/')];
+
+		// Find the place in search order, archives may list a name twice
+		uint pos = 0;
+		while (pos < entries.size() && searchedBefore(entries[pos]._priority, entries[pos]._order, added._priority, added._order))
+			pos++;
+		if (pos < entries.size() && entries[pos]._arc == added._arc)
+			continue;
+		entries.insert_at(pos, added);
+	}
+}
+
+/*
+    Drop an archive from the index entries of the names it lists.
+    Called with _indexMutex held.
+*/
+void SearchSet::unindexArchive(const Node &node) {
+	if (!node._indexed)
+		return;
+
+	node._indexed = false;
+
+	if (node._unlisted) {
+		for (uint i = 0; i < _unlistedArchives.size(); ++i) {
+			if (_unlistedArchives[i]._arc == node._arc) {
+				_unlistedArchives.remove_at(i);
+				break;
+			}
+		}
+		return;
+	}
+
+	ArchiveMemberList members;
+	node._arc->listMembers(members);
+
+	for (ArchiveMemberList::const_iterator i = members.begin(); i != members.end(); ++i) {
+		const String fileName = lastPathComponent((*i)->getName(), '/');
+		NameIndex::iterator entry = _index.find(fileName);
+		if (entry == _index.end())
+			continue;
+
+		Array<IndexEntry> &entries = entry->_value;
+		for (uint j = 0; j < entries.size(); ++j) {
+			if (entries[j]._arc == node._arc) {
+				entries.remove_at(j);
+				break;
+			}
+		}
+		if (entries.empty())
+			_index.erase(entry);
+	}
+}
+
+/*
+    Called with _indexMutex held.
+*/
+void SearchSet::indexAddedArchives() const {
+	if (!_unindexedArchives)
+		return;
+
+	for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it) {
+		if (!it->_indexed)
+			indexArchive(*it);
+	}
+
+	_unindexedArchives = 0;
+}
+
+void SearchSet::findArchives(const String &name, Array<IndexEntry> &archives) const {
+	StackLock lock(_indexMutex);
+	indexAddedArchives();
+
+	// Archives which do not list their members can contain anything, so
+	// they are merged into the archives listing the name by search order.
+	// Look up the file name in place, without copying it into a String.
+	const char *fileName = strrchr(name.c_str(), '/');
+	NameIndex::const_iterator entry = _index.find(fileName ? fileName + 1 : name.c_str());
+
+	uint unlisted = 0;
+	if (entry != _index.end()) {
+		const Array<IndexEntry> &entries = entry->_value;
+		for (uint i = 0; i < entries.size(); ++i) {
+			while (unlisted < _unlistedArchives.size() && searchedBefore(_unlistedArchives[unlisted]._priority, _unlistedArchives[unlisted]._order, entries[i]._priority, entries[i]._order))
+				archives.push_back(_unlistedArchives[unlisted++]);
+			archives.push_back(entries[i]);
+		}
+	}
+
+	for (; unlisted < _unlistedArchives.size(); ++unlisted)
+		archives.push_back(_unlistedArchives[unlisted]);
+}
+
 void SearchSet::add(const String &name, Archive *archive, int priority, bool autoFree) {
+	StackLock lock(_indexMutex);
+
 	if (find(name) == _list.end()) {
 		Node node(priority, name, archive, autoFree);
 		insert(node);
+
+		// Listing the members may scan whole directory trees, so it is left
+		// to the first lookup
+		_unindexedArchives++;
 	} else {
 		if (autoFree)
 			delete archive;
@@ -168,12 +329,27 @@ void SearchSet::addSubDirectoriesMatching(const FSNode &directory, String origPa
 }
 
 void SearchSet::remove(const String &name) {
-	ArchiveNodeList::iterator it = find(name);
-	if (it != _list.end()) {
-		if (it->_autoFree)
-			delete it->_arc;
+	Archive *archive = 0;
+	bool autoFree = false;
+
+	{
+		StackLock lock(_indexMutex);
+
+		ArchiveNodeList::iterator it = find(name);
+		if (it == _list.end())
+			return;
+
+		archive = it->_arc;
+		autoFree = it->_autoFree;
+		if (it->_indexed)
+			unindexArchive(*it);
+		else
+			_unindexedArchives--;
 		_list.erase(it);
 	}
+
+	if (autoFree)
+		delete archive;
 }
 
 bool SearchSet::hasArchive(const String &name) const {
@@ -181,15 +357,22 @@ bool SearchSet::hasArchive(const String &name) const {
 }
 
 void SearchSet::clear() {
+	StackLock lock(_indexMutex);
+
 	for (ArchiveNodeList::iterator i = _list.begin(); i != _list.end(); ++i) {
 		if (i->_autoFree)
 			delete i->_arc;
 	}
 
 	_list.clear();
+	_index.clear();
+	_unindexedArchives = 0;
+	_unlistedArchives.clear();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
+	StackLock lock(_indexMutex);
+
 	ArchiveNodeList::iterator it = find(name);
 	if (it == _list.end()) {
 		warning("SearchSet::setPriority: archive '%s' is not present", name.c_str());
@@ -199,22 +382,36 @@ void SearchSet::setPriority(const String &name, int priority) {
 	if (priority == it->_priority)
 		return;
 
+	// Only the names the archive lists move to their new place
 	Node node(*it);
+	const bool indexed = node._indexed;
+	unindexArchive(node);
 	_list.erase(it);
 	node._priority = priority;
+
 	insert(node);
+	if (indexed)
+		indexArchive(*find(name));
 }
 
 bool SearchSet::hasFile(const String &name) const {
 	if (name.empty())
 		return false;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
+	Array<IndexEntry> archives;
+	findArchives(name, archives);
+
+	bool askedUnlisted = false;
+	for (uint i = 0; i < archives.size(); ++i) {
+		askedUnlisted |= !archives[i]._listed;
+		if (archives[i]._arc->hasFile(name)) {
+			countStat(askedUnlisted ? _stats.fallbacks : _stats.indexHits);
 			return true;
+		}
 	}
 
+	if (askedUnlisted)
+		countStat(_stats.fallbacks);
 	return false;
 }
 
@@ -242,12 +439,20 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return it->_arc->getMember(name);
+	Array<IndexEntry> archives;
+	findArchives(name, archives);
+
+	bool askedUnlisted = false;
+	for (uint i = 0; i < archives.size(); ++i) {
+		askedUnlisted |= !archives[i]._listed;
+		if (archives[i]._arc->hasFile(name)) {
+			countStat(askedUnlisted ? _stats.fallbacks : _stats.indexHits);
+			return archives[i]._arc->getMember(name);
+		}
 	}
 
+	if (askedUnlisted)
+		countStat(_stats.fallbacks);
 	return ArchiveMemberPtr();
 }
 
@@ -255,14 +460,43 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	if (name.empty())
 		return 0;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
-		if (stream)
-			return stream;
+	Array<IndexEntry> archives;
+	findArchives(name, archives);
+
+	SeekableReadStream *stream = 0;
+	bool askedUnlisted = false;
+	for (uint i = 0; i < archives.size() && !stream; ++i) {
+		askedUnlisted |= !archives[i]._listed;
+		stream = archives[i]._arc->createReadStreamForMember(name);
 	}
 
-	return 0;
+	if (askedUnlisted)
+		countStat(_stats.fallbacks);
+	else if (stream)
+		countStat(_stats.indexHits);
+	countStat(_stats.opens);
+
+	return stream;
+}
+
+uint SearchSet::getIndexSize() const {
+	StackLock lock(_indexMutex);
+	indexAddedArchives();
+	return _index.size();
+}
+
+SearchSet::Stats SearchSet::getStats() const {
+	Stats stats;
+	stats.opens = readStat(_stats.opens);
+	stats.indexHits = readStat(_stats.indexHits);
+	stats.fallbacks = readStat(_stats.fallbacks);
+	return stats;
+}
+
+void SearchSet::resetStats() {
+	resetStat(_stats.opens);
+	resetStat(_stats.indexHits);
+	resetStat(_stats.fallbacks);
 }
 
 
@@ -23,8 +23,12 @@
 #ifndef COMMON_ARCHIVE_H
 #define COMMON_ARCHIVE_H
 
+#include "common/array.h"
 #include "common/str.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/list.h"
+#include "common/mutex.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
 
@@ -132,27 +136,91 @@ public:
  * contained Archives, hence the simplistic policy of always looking for the first
  * match. SearchSet *DOES* guarantee that searches are performed in *DESCENDING*
  * priority order. In case of conflicting priorities, insertion order prevails.
+ *
+ * To avoid asking every archive in turn, the SearchSet keeps an index mapping
+ * the (case-insensitive) names of all members, as reported by listMembers(),
+ * to the archives listing them, in search order. An added archive is only
+ * listed by the first lookup after it was added, and removing an archive or
+ * changing its priority only updates the names it lists. A lookup only asks
+ * the archives listing the name, and the archives which cannot list their
+ * members, which may contain anything.
+ *
+ * Lookups may run on any thread, also while archives are added on another
+ * one. The index is guarded by a mutex, which is not held while archives
+ * are asked for the member.
  */
 class SearchSet : public Archive {
+public:
+	/**
+	 * Lookup statistics, as reported by the "searchman" debugger command.
+	 * Lookups may happen on any thread, so the counters are updated
+	 * atomically where SCUMMVM_ATOMICS is available.
+	 */
+	struct Stats {
+		uint32 opens;      ///< Number of createReadStreamForMember calls
+		uint32 indexHits;  ///< Number of lookups answered by an archive listing the member
+		uint32 fallbacks;  ///< Number of lookups which asked archives not listing their members
+	};
+
+private:
 	struct Node {
 		int		_priority;
+		uint	_order;		// Tells nodes of the same priority apart, see insert()
 		String	_name;
 		Archive	*_arc;
 		bool	_autoFree;
+		mutable bool _indexed;	// Its members are in the index
+		mutable bool _unlisted;	// listMembers() reported no members
 		Node(int priority, const String &name, Archive *arc, bool autoFree)
-			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree) {
+			: _priority(priority), _order(0), _name(name), _arc(arc), _autoFree(autoFree), _indexed(false), _unlisted(false) {
 		}
 	};
 	typedef List<Node> ArchiveNodeList;
 	ArchiveNodeList _list;
+	uint _nextOrder;
+
+	// An archive with its place in the search order
+	struct IndexEntry {
+		Archive *_arc;
+		int _priority;
+		uint _order;
+		bool _listed;	// It lists its members
+	};
+
+	// The archives listing a member, in search order, by the last component
+	// of its name. Archives may list members by a shorter name than the path
+	// hasFile() accepts, FSDirectory for example lists the bare file names of
+	// files in subdirectories, but the last component is always the same.
+	typedef HashMap<String, Array<IndexEntry>, IgnoreCase_Hash, IgnoreCase_EqualTo> NameIndex;
+
+	// Lookups add the archives added since the last lookup to the index.
+	// The index, the archives not indexed yet and those which do not list
+	// their members are guarded by _indexMutex, as is _list while it
+	// changes.
+	mutable NameIndex _index;
+	mutable uint _unindexedArchives;
+	// Indexed archives which do not list their members, in search order
+	mutable Array<IndexEntry> _unlistedArchives;
+	mutable Mutex _indexMutex;
+	mutable Stats _stats;
 
 	ArchiveNodeList::iterator find(const String &name);
 	ArchiveNodeList::const_iterator find(const String &name) const;
 
 	// Add an archive keeping the list sorted by descending priority.
-	void insert(const Node& node);
+	void insert(Node& node);
+
+	void indexArchive(const Node &node) const;
+	void unindexArchive(const Node &node);
+	void indexAddedArchives() const;
+
+	// Collect the archives which may contain the given member, in search
+	// order: those listing its file name, and those not listing their
+	// members.
+	void findArchives(const String &name, Array<IndexEntry> &archives) const;
 
 public:
+	SearchSet();
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -247,6 +315,12 @@ public:
 	 * opening the first file encountered that matches the name.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/** Return the number of member names in the index. */
+	uint getIndexSize() const;
+
+	Stats getStats() const;
+	void resetStats();
 };
 
 
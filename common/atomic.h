@@ -0,0 +1,113 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * Atomic access to 32 bit counters and positions, for data shared between
+ * threads without locking a mutex, e.g. with the audio callback. Loads
+ * have acquire and stores release semantics, so everything written before
+ * a store is visible to a thread which loads the stored value.
+ *
+ * Only available where SCUMMVM_ATOMICS is defined. Code using them must
+ * keep working without, e.g. by falling back to a mutex.
+ */
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+
+#define SCUMMVM_ATOMICS
+
+namespace Common {
+
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 value) {
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/** Add to the value and return the result. */
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 value) {
+	return __atomic_add_fetch(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * Replace the value with desired if it still is expected.
+ * @return whether the value was replaced
+ */
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/** Keep loads and stores from moving across this point in either direction. */
+inline void atomicFence() {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+} // End of namespace Common
+
+#elif defined(_MSC_VER)
+
+#define SCUMMVM_ATOMICS
+
+#include <intrin.h>
+
+namespace Common {
+
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	return (uint32)_InterlockedCompareExchange((volatile long *)ptr, 0, 0);
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 value) {
+	_InterlockedExchange((volatile long *)ptr, (long)value);
+}
+
+/** Add to the value and return the result. */
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 value) {
+	return (uint32)_InterlockedExchangeAdd((volatile long *)ptr, (long)value) + value;
+}
+
+/**
+ * Replace the value with desired if it still is expected.
+ * @return whether the value was replaced
+ */
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	return (uint32)_InterlockedCompareExchange((volatile long *)ptr, (long)desired, (long)expected) == expected;
+}
+
+/** Keep loads and stores from moving across this point in either direction. */
+inline void atomicFence() {
+	// Interlocked operations are full barriers
+	volatile long barrier = 0;
+	_InterlockedExchange(&barrier, 0);
+}
+
+} // End of namespace Common
+
+#endif
+
+#endif
@@ -23,6 +23,8 @@
 #ifndef COMMON_BUFFEREDSTREAM_H
 #define COMMON_BUFFEREDSTREAM_H
 
+#include "common/ptr.h"
+#include "common/span.h"
 #include "common/stream.h"
 #include "common/types.h"
 
@@ -50,6 +52,93 @@ ReadStream *wrapBufferedReadStream(ReadStream *parentStream, uint32 bufSize, Dis
  */
 SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
 
+/**
+ * A SeekableReadStream which keeps several blocks of its parent stream in
+ * memory. Unlike the stream returned by wrapBufferedSeekableReadStream(),
+ * which drops its buffer on any seek leaving it, this one serves backward
+ * and nearby seeks from the blocks it already holds, which suits parsers
+ * that read small headers and then jump around in a file.
+ *
+ * When reads proceed sequentially, several blocks are read ahead with a
+ * single read from the parent stream. peek() gives access to upcoming
+ * data without copying it.
+ */
+class CachedSeekableReadStream : public SeekableReadStream {
+public:
+	struct Stats {
+		uint32 hits;			///< Block lookups served from the cache
+		uint32 misses;			///< Block lookups which missed the cache
+		uint32 parentReads;		///< Reads from the parent stream
+		uint32 parentSeeks;		///< Seeks in the parent stream
+	};
+
+	/**
+	 * Constructor for a cached stream.
+	 * @param parentStream			the stream to cache
+	 * @param blockSize				the size of a cache block
+	 * @param numBlocks				the number of cache blocks
+	 * @param disposeParentStream	whether to delete the parent stream on destruction
+	 */
+	CachedSeekableReadStream(SeekableReadStream *parentStream, uint32 blockSize, uint numBlocks, DisposeAfterUse::Flag disposeParentStream);
+	virtual ~CachedSeekableReadStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _parentStream->err(); }
+	virtual void clearErr() { _eos = false; _parentStream->clearErr(); }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	/**
+	 * Return a span over the next bytes of the stream, without advancing
+	 * the stream position. The span is shorter than requested at the end
+	 * of the stream, and is only valid until the next call to any other
+	 * method of the stream.
+	 *
+	 * @param size	the number of bytes to look at, at most the block size
+	 */
+	Span<const byte> peek(uint32 size);
+
+	const Stats &getStats() const { return _stats; }
+
+private:
+	enum {
+		kEmptyBlock = -1
+	};
+
+	int findBlock(int32 offset) const;
+	int fetchBlocks(int32 offset);
+
+	DisposablePtr<SeekableReadStream> _parentStream;
+	const uint32 _blockSize;
+	const uint _numBlocks;
+	byte *_data;			///< Storage of all blocks, one after the other
+	int32 *_blockOffset;	///< Stream offset of each block, or kEmptyBlock
+	uint32 *_blockLength;	///< Number of valid bytes in each block
+	byte *_peekBuffer;		///< Used for peeks crossing block boundaries
+	uint _nextBlock;		///< Next block to replace
+	int32 _nextSequential;	///< Stream offset just past the last fetch
+
+	int32 _pos;
+	int32 _size;
+	int32 _parentPos;
+	bool _eos;
+
+	Stats _stats;
+};
+
+/**
+ * Take an arbitrary SeekableReadStream and wrap it in a
+ * CachedSeekableReadStream.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ */
+SeekableReadStream *wrapCachedSeekableReadStream(SeekableReadStream *parentStream, uint32 blockSize, uint numBlocks, DisposeAfterUse::Flag disposeParentStream);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which
  * transparently provides buffering.
@@ -21,9 +21,11 @@
  */
 
 #include "common/config-manager.h"
+#include "common/content-hash.h"
 #include "common/debug.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
@@ -52,7 +54,7 @@ char const *const ConfigManager::kCloudDomain = "cloud";
 #pragma mark -
 
 
-ConfigManager::ConfigManager() : _activeDomain(0) {
+ConfigManager::ConfigManager() : _activeDomain(0), _flushed(false), _flushedChangeCount(0), _flushedSize(0), _flushedHash(0) {
 }
 
 void ConfigManager::defragment() {
@@ -78,6 +80,12 @@ void ConfigManager::copyFrom(ConfigManager &source) {
 	_activeDomainName = source._activeDomainName;
 	_activeDomain = &_gameDomains[_activeDomainName];
 	_filename = source._filename;
+
+	// The contents are the same, so the file need not be written again
+	_flushed = source._flushed;
+	_flushedChangeCount = Domain::_changeCount;
+	_flushedSize = source._flushedSize;
+	_flushedHash = source._flushedHash;
 }
 
 
@@ -86,6 +94,7 @@ void ConfigManager::loadDefaultConfigFile() {
 	assert(g_system);
 	SeekableReadStream *stream = g_system->createConfigReadStream();
 	_filename.clear();  // clear the filename to indicate that we are using the default config file
+	forgetFlushedData();
 
 	// ... load it, if available ...
 	if (stream) {
@@ -104,6 +113,7 @@ void ConfigManager::loadDefaultConfigFile() {
 
 void ConfigManager::loadConfigFile(const String &filename) {
 	_filename = filename;
+	forgetFlushedData();
 
 	FSNode node(filename);
 	File cfg_file;
@@ -167,7 +177,6 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 	_miscDomains.clear();
 	_transientDomain.clear();
 	_domainSaveOrder.clear();
-
 #ifdef ENABLE_KEYMAPPER
 	_keymapperDomain.clear();
 #endif
@@ -258,6 +267,26 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 
 void ConfigManager::flushToDisk() {
 #ifndef __DC__
+	// Flushes happen often, e.g. whenever a dialog is closed, but mostly
+	// nothing changed in between. All changes made in between are written
+	// by the next flush at once.
+	const uint32 changeCount = Domain::_changeCount;
+	if (_flushed && _flushedChangeCount == changeCount)
+		return;
+
+	// Not every change changes the file, e.g. setting a value it already
+	// has, or changing the transient domain. Comparing against a hash of
+	// the last contents written avoids rewriting the file needlessly,
+	// which is slow on some storage devices.
+	MemoryWriteStreamDynamic buffer(DisposeAfterUse::YES);
+	writeConfig(buffer);
+
+	const uint64 hash = computeContentHash(buffer.getData(), buffer.size());
+	if (_flushed && _flushedSize == buffer.size() && _flushedHash == hash) {
+		_flushedChangeCount = changeCount;
+		return;
+	}
+
 	WriteStream *stream;
 
 	if (_filename.empty()) {
@@ -267,56 +296,79 @@ void ConfigManager::flushToDisk() {
 		if (!stream)    // If writing to the config file is not possible, do nothing
 			return;
 	} else {
-		DumpFile *dump = new DumpFile();
-		assert(dump);
-
-		if (!dump->open(_filename)) {
+		FSNode node(_filename);
+		stream = node.createAtomicWriteStream();
+		if (!stream) {
 			warning("Unable to write configuration file: %s", _filename.c_str());
-			delete dump;
 			return;
 		}
+	}
+
+	// Streams replacing the file atomically only do so in finalize(), so
+	// errors have to be checked after it, and before deleting the stream
+	stream->write(buffer.getData(), buffer.size());
+	stream->finalize();
+	const bool success = !stream->err();
+	delete stream;
 
-		stream = dump;
+	if (!success)
+		warning("Unable to write configuration file");
+
+	forgetFlushedData();
+	if (success) {
+		_flushed = true;
+		_flushedChangeCount = changeCount;
+		_flushedSize = buffer.size();
+		_flushedHash = hash;
 	}
+#endif // !__DC__
+}
 
+void ConfigManager::forgetFlushedData() {
+	_flushed = false;
+	_flushedChangeCount = 0;
+	_flushedSize = 0;
+	_flushedHash = 0;
+}
+
+void ConfigManager::writeConfig(WriteStream &stream) {
 	// Write the application domain
-	writeDomain(*stream, kApplicationDomain, _appDomain);
+	writeDomain(stream, kApplicationDomain, _appDomain);
 
 #ifdef ENABLE_KEYMAPPER
 	// Write the keymapper domain
-	writeDomain(*stream, kKeymapperDomain, _keymapperDomain);
+	writeDomain(stream, kKeymapperDomain, _keymapperDomain);
 #endif
 #ifdef USE_CLOUD
 	// Write the cloud domain
-	writeDomain(*stream, kCloudDomain, _cloudDomain);
+	writeDomain(stream, kCloudDomain, _cloudDomain);
 #endif
 
 	DomainMap::const_iterator d;
 
 	// Write the miscellaneous domains next
 	for (d = _miscDomains.begin(); d != _miscDomains.end(); ++d) {
-		writeDomain(*stream, d->_key, d->_value);
+		writeDomain(stream, d->_key, d->_value);
 	}
 
 	// First write the domains in _domainSaveOrder, in that order.
 	// Note: It's possible for _domainSaveOrder to list domains which
 	// are not present anymore, so we validate each name.
+	HashMap<String, bool> written;
 	Array<String>::const_iterator i;
 	for (i = _domainSaveOrder.begin(); i != _domainSaveOrder.end(); ++i) {
-		if (_gameDomains.contains(*i)) {
-			writeDomain(*stream, *i, _gameDomains[*i]);
-		}
+		written[*i] = true;
+
+		d = _gameDomains.find(*i);
+		if (d != _gameDomains.end())
+			writeDomain(stream, *i, d->_value);
 	}
 
 	// Now write the domains which haven't been written yet
 	for (d = _gameDomains.begin(); d != _gameDomains.end(); ++d) {
-		if (find(_domainSaveOrder.begin(), _domainSaveOrder.end(), d->_key) == _domainSaveOrder.end())
-			writeDomain(*stream, d->_key, d->_value);
+		if (!written.contains(d->_key))
+			writeDomain(stream, d->_key, d->_value);
 	}
-
-	delete stream;
-
-#endif // !__DC__
 }
 
 void ConfigManager::writeDomain(WriteStream &stream, const String &name, const Domain &domain) {
@@ -381,10 +433,12 @@ const ConfigManager::Domain *ConfigManager::getDomain(const String &domName) con
 	if (domName == kCloudDomain)
 		return &_cloudDomain;
 #endif
-	if (_gameDomains.contains(domName))
-		return &_gameDomains[domName];
-	if (_miscDomains.contains(domName))
-		return &_miscDomains[domName];
+	DomainMap::const_iterator domain = _gameDomains.find(domName);
+	if (domain != _gameDomains.end())
+		return &domain->_value;
+	domain = _miscDomains.find(domName);
+	if (domain != _miscDomains.end())
+		return &domain->_value;
 
 	return 0;
 }
@@ -405,10 +459,12 @@ ConfigManager::Domain *ConfigManager::getDomain(const String &domName) {
 	if (domName == kCloudDomain)
 		return &_cloudDomain;
 #endif
-	if (_gameDomains.contains(domName))
-		return &_gameDomains[domName];
-	if (_miscDomains.contains(domName))
-		return &_miscDomains[domName];
+	DomainMap::iterator domain = _gameDomains.find(domName);
+	if (domain != _gameDomains.end())
+		return &domain->_value;
+	domain = _miscDomains.find(domName);
+	if (domain != _miscDomains.end())
+		return &domain->_value;
 
 	return 0;
 }
@@ -494,8 +550,46 @@ const String &ConfigManager::get(const String &key, const String &domName) const
 	return _defaultsDomain.getVal(key);
 }
 
+const String &ConfigManager::get(const StringAtom &key) const {
+	// Same order as get(const String &), but ending with the defaults
+	const Domain *const domains[] = { &_transientDomain, _activeDomain, &_appDomain, &_defaultsDomain };
+
+	for (int i = 0; i < ARRAYSIZE(domains); ++i) {
+		if (!domains[i])
+			continue;
+
+		Domain::const_iterator entry = domains[i]->find(key);
+		if (entry != domains[i]->end())
+			return entry->_value;
+	}
+
+	return _defaultsDomain.getVal(key.toString());
+}
+
+bool ConfigManager::hasKey(const StringAtom &key) const {
+	// The defaults domain is not checked, like in hasKey(const String &)
+	if (_transientDomain.find(key) != _transientDomain.end())
+		return true;
+
+	if (_activeDomain && _activeDomain->find(key) != _activeDomain->end())
+		return true;
+
+	return _appDomain.find(key) != _appDomain.end();
+}
+
+int ConfigManager::getInt(const StringAtom &key) const {
+	return parseIntValue(get(key), key.c_str(), "");
+}
+
+bool ConfigManager::getBool(const StringAtom &key) const {
+	return parseBoolValue(get(key), key.c_str(), "");
+}
+
 int ConfigManager::getInt(const String &key, const String &domName) const {
-	String value(get(key, domName));
+	return parseIntValue(get(key, domName), key.c_str(), domName.c_str());
+}
+
+int ConfigManager::parseIntValue(const String &value, const char *key, const char *domName) {
 	char *errpos;
 
 	// For now, be tolerant against missing config keys. Strictly spoken, it is
@@ -510,19 +604,22 @@ int ConfigManager::getInt(const String &key, const String &domName) const {
 	int ivalue = (int)strtol(value.c_str(), &errpos, 0);
 	if (value.c_str() == errpos)
 		error("ConfigManager::getInt(%s,%s): '%s' is not a valid integer",
-		      key.c_str(), domName.c_str(), errpos);
+		      key, domName, errpos);
 
 	return ivalue;
 }
 
 bool ConfigManager::getBool(const String &key, const String &domName) const {
-	String value(get(key, domName));
+	return parseBoolValue(get(key, domName), key.c_str(), domName.c_str());
+}
+
+bool ConfigManager::parseBoolValue(const String &value, const char *key, const char *domName) {
 	bool val;
-	if (parseBool(value, val))
+	if (Common::parseBool(value, val))
 		return val;
 
 	error("ConfigManager::getBool(%s,%s): '%s' is not a valid bool",
-	      key.c_str(), domName.c_str(), value.c_str());
+	      key, domName, value.c_str());
 }
 
 
@@ -636,6 +733,7 @@ void ConfigManager::addGameDomain(const String &domName) {
 	// the given name already exists?
 
 	_gameDomains[domName];
+	Domain::_changeCount++;
 
 	// Add it to the _domainSaveOrder, if it's not already in there
 	if (find(_domainSaveOrder.begin(), _domainSaveOrder.end(), domName) == _domainSaveOrder.end())
@@ -647,6 +745,7 @@ void ConfigManager::addMiscDomain(const String &domName) {
 	assert(isValidDomainName(domName));
 
 	_miscDomains[domName];
+	Domain::_changeCount++;
 }
 
 void ConfigManager::removeGameDomain(const String &domName) {
@@ -657,12 +756,14 @@ void ConfigManager::removeGameDomain(const String &domName) {
 		_activeDomain = 0;
 	}
 	_gameDomains.erase(domName);
+	Domain::_changeCount++;
 }
 
 void ConfigManager::removeMiscDomain(const String &domName) {
 	assert(!domName.empty());
 	assert(isValidDomainName(domName));
 	_miscDomains.erase(domName);
+	Domain::_changeCount++;
 }
 
 
@@ -698,6 +799,7 @@ void ConfigManager::renameDomain(const String &oldName, const String &newName, D
 		newDom[iter->_key] = iter->_value;
 
 	map.erase(oldName);
+	Domain::_changeCount++;
 }
 
 bool ConfigManager::hasGameDomain(const String &domName) const {
@@ -712,7 +814,18 @@ bool ConfigManager::hasMiscDomain(const String &domName) const {
 
 #pragma mark -
 
+uint32 ConfigManager::Domain::_changeCount = 0;
+
+ConfigManager::Domain &ConfigManager::Domain::operator=(const Domain &other) {
+	_entries = other._entries;
+	_keyValueComments = other._keyValueComments;
+	_domainComment = other._domainComment;
+	_changeCount++;
+	return *this;
+}
+
 void ConfigManager::Domain::setDomainComment(const String &comment) {
+	_changeCount++;
 	_domainComment = comment;
 }
 const String &ConfigManager::Domain::getDomainComment() const {
@@ -720,6 +833,7 @@ const String &ConfigManager::Domain::getDomainComment() const {
 }
 
 void ConfigManager::Domain::setKVComment(const String &key, const String &comment) {
+	_changeCount++;
 	_keyValueComments[key] = comment;
 }
 const String &ConfigManager::Domain::getKVComment(const String &key) const {
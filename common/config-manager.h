@@ -47,12 +47,23 @@ class ConfigManager : public Singleton<ConfigManager> {
 public:
 
 	class Domain {
+		friend class ConfigManager;
+
 	private:
 		StringMap _entries;
 		StringMap _keyValueComments;
 		String _domainComment;
 
+		/**
+		 * Counts the changes of all domains, so flushToDisk() can tell
+		 * whether anything changed. Handing out a modifiable reference
+		 * counts as a change.
+		 */
+		static uint32 _changeCount;
+
 	public:
+		Domain &operator=(const Domain &other);
+
 		typedef StringMap::const_iterator const_iterator;
 		const_iterator begin() const { return _entries.begin(); }
 		const_iterator end()   const { return _entries.end(); }
@@ -61,17 +72,20 @@ public:
 
 		bool contains(const String &key) const { return _entries.contains(key); }
 
-		String &operator[](const String &key) { return _entries[key]; }
+		/** Look up a key by its atom, which is not hashed again. */
+		const_iterator find(const StringAtom &key) const { return _entries.find(key); }
+
+		String &operator[](const String &key) { _changeCount++; return _entries[key]; }
 		const String &operator[](const String &key) const { return _entries[key]; }
 
-		void setVal(const String &key, const String &value) { _entries.setVal(key, value); }
+		void setVal(const String &key, const String &value) { _changeCount++; _entries.setVal(key, value); }
 
-		String &getVal(const String &key) { return _entries.getVal(key); }
+		String &getVal(const String &key) { _changeCount++; return _entries.getVal(key); }
 		const String &getVal(const String &key) const { return _entries.getVal(key); }
 
-		void clear() { _entries.clear(); }
+		void clear() { _changeCount++; _entries.clear(); }
 
-		void erase(const String &key) { _entries.erase(key); }
+		void erase(const String &key) { _changeCount++; _entries.erase(key); }
 
 		void setDomainComment(const String &comment);
 		const String &getDomainComment() const;
@@ -120,6 +134,16 @@ public:
 	const String &		get(const String &key) const;
 	void				set(const String &key, const String &value);
 
+	/**
+	 * Variants of the generic access methods for keys which are looked up
+	 * often, like in a game loop. The hash of an atom is computed only once,
+	 * and each domain is searched only once.
+	 */
+	bool				hasKey(const StringAtom &key) const;
+	const String &		get(const StringAtom &key) const;
+	int					getInt(const StringAtom &key) const;
+	bool				getBool(const StringAtom &key) const;
+
 #if 1
 	//
 	// Domain specific access methods: Acces *one specific* domain and modify it.
@@ -149,6 +173,10 @@ public:
 	void				registerDefault(const String &key, int value);
 	void				registerDefault(const String &key, bool value);
 
+	/**
+	 * Write the configuration to disk. The file is only written if its
+	 * contents changed since the last flush, so calling this often is cheap.
+	 */
 	void				flushToDisk();
 
 	void				setActiveDomain(const String &domName);
@@ -180,9 +208,14 @@ private:
 
 	void			loadFromStream(SeekableReadStream &stream);
 	void			addDomain(const String &domainName, const Domain &domain);
+	void			writeConfig(WriteStream &stream);
+	void			forgetFlushedData();
 	void			writeDomain(WriteStream &stream, const String &name, const Domain &domain);
 	void			renameDomain(const String &oldName, const String &newName, DomainMap &map);
 
+	static int		parseIntValue(const String &value, const char *key, const char *domName);
+	static bool		parseBoolValue(const String &value, const char *key, const char *domName);
+
 	Domain			_transientDomain;
 	DomainMap		_gameDomains;
 	DomainMap		_miscDomains;		// Any other domains
@@ -203,6 +236,15 @@ private:
 	Domain *		_activeDomain;
 
 	String			_filename;
+
+	/**
+	 * Domain change count, size and content hash of what flushToDisk()
+	 * last wrote, if _flushed is set.
+	 */
+	bool			_flushed;
+	uint32			_flushedChangeCount;
+	uint32			_flushedSize;
+	uint64			_flushedHash;
 };
 
 } // End of namespace Common
@@ -0,0 +1,171 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/content-hash.h"
+#include "common/endian.h"
+#include "common/stream.h"
+#include "common/util.h"
+
+namespace Common {
+
+// The xxHash64 primes, built from two halves to avoid 64 bit literals
+#define MAKE_UINT64(hi, lo) (((uint64)(hi) << 32) | (uint64)(lo))
+
+static const uint64 kPrime1 = MAKE_UINT64(0x9E3779B1, 0x85EBCA87);
+static const uint64 kPrime2 = MAKE_UINT64(0xC2B2AE3D, 0x27D4EB4F);
+static const uint64 kPrime3 = MAKE_UINT64(0x165667B1, 0x9E3779F9);
+static const uint64 kPrime4 = MAKE_UINT64(0x85EBCA77, 0xC2B2AE63);
+static const uint64 kPrime5 = MAKE_UINT64(0x27D4EB2F, 0x165667C5);
+
+#undef MAKE_UINT64
+
+static inline uint64 rotl64(uint64 x, int n) {
+	return (x << n) | (x >> (64 - n));
+}
+
+static inline uint64 round64(uint64 acc, uint64 input) {
+	acc += input * kPrime2;
+	return rotl64(acc, 31) * kPrime1;
+}
+
+static inline uint64 mergeRound64(uint64 acc, uint64 val) {
+	acc ^= round64(0, val);
+	return acc * kPrime1 + kPrime4;
+}
+
+void ContentHash::reset(uint64 seed) {
+	_seed = seed;
+	_acc[0] = seed + kPrime1 + kPrime2;
+	_acc[1] = seed + kPrime2;
+	_acc[2] = seed;
+	_acc[3] = seed - kPrime1;
+	_totalSize = 0;
+	_bufferSize = 0;
+}
+
+void ContentHash::update(const void *data, uint32 size) {
+	const byte *input = (const byte *)data;
+	_totalSize += size;
+
+	// Complete a partially filled stripe first
+	if (_bufferSize) {
+		const uint32 fill = MIN<uint32>(size, kStripeSize - _bufferSize);
+		memcpy(_buffer + _bufferSize, input, fill);
+		_bufferSize += fill;
+		input += fill;
+		size -= fill;
+
+		if (_bufferSize < kStripeSize)
+			return;
+
+		for (int i = 0; i < 4; ++i)
+			_acc[i] = round64(_acc[i], READ_LE_UINT64(_buffer + i * 8));
+		_bufferSize = 0;
+	}
+
+	// Process whole stripes; the four lanes are independent of each other
+	uint64 acc0 = _acc[0], acc1 = _acc[1], acc2 = _acc[2], acc3 = _acc[3];
+	for (; size >= kStripeSize; size -= kStripeSize, input += kStripeSize) {
+		acc0 = round64(acc0, READ_LE_UINT64(input));
+		acc1 = round64(acc1, READ_LE_UINT64(input + 8));
+		acc2 = round64(acc2, READ_LE_UINT64(input + 16));
+		acc3 = round64(acc3, READ_LE_UINT64(input + 24));
+	}
+	_acc[0] = acc0;
+	_acc[1] = acc1;
+	_acc[2] = acc2;
+	_acc[3] = acc3;
+
+	if (size) {
+		memcpy(_buffer, input, size);
+		_bufferSize = size;
+	}
+}
+
+uint64 ContentHash::finish() const {
+	uint64 hash;
+
+	if (_totalSize >= kStripeSize) {
+		hash = rotl64(_acc[0], 1) + rotl64(_acc[1], 7) + rotl64(_acc[2], 12) + rotl64(_acc[3], 18);
+		for (int i = 0; i < 4; ++i)
+			hash = mergeRound64(hash, _acc[i]);
+	} else {
+		hash = _seed + kPrime5;
+	}
+
+	hash += _totalSize;
+
+	const byte *input = _buffer;
+	uint32 size = _bufferSize;
+
+	for (; size >= 8; size -= 8, input += 8) {
+		hash ^= round64(0, READ_LE_UINT64(input));
+		hash = rotl64(hash, 27) * kPrime1 + kPrime4;
+	}
+
+	if (size >= 4) {
+		hash ^= (uint64)READ_LE_UINT32(input) * kPrime1;
+		hash = rotl64(hash, 23) * kPrime2 + kPrime3;
+		size -= 4;
+		input += 4;
+	}
+
+	for (; size > 0; --size, ++input) {
+		hash ^= *input * kPrime5;
+		hash = rotl64(hash, 11) * kPrime1;
+	}
+
+	// Final avalanche
+	hash ^= hash >> 33;
+	hash *= kPrime2;
+	hash ^= hash >> 29;
+	hash *= kPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+uint64 computeContentHash(const void *data, uint32 size, uint64 seed) {
+	ContentHash hash(seed);
+	hash.update(data, size);
+	return hash.finish();
+}
+
+uint64 computeStreamContentHash(ReadStream &stream, uint32 length) {
+	ContentHash hash;
+	byte buf[4096];
+	const bool restricted = (length != 0);
+
+	while (!restricted || length > 0) {
+		const uint32 readlen = restricted ? MIN<uint32>(sizeof(buf), length) : sizeof(buf);
+		const uint32 n = stream.read(buf, readlen);
+		if (!n)
+			break;
+
+		hash.update(buf, n);
+		if (restricted)
+			length -= n;
+	}
+
+	return hash.finish();
+}
+
+} // End of namespace Common
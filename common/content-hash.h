@@ -0,0 +1,83 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_CONTENT_HASH_H
+#define COMMON_CONTENT_HASH_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+class ReadStream;
+
+/**
+ * Incremental computation of a 64 bit hash of arbitrary data, using the
+ * xxHash64 algorithm. Unlike MD5, it offers no protection against
+ * deliberately crafted collisions, but it is many times faster, which
+ * makes it the better choice for cache keys and for detecting accidental
+ * corruption.
+ */
+class ContentHash {
+public:
+	explicit ContentHash(uint64 seed = 0) { reset(seed); }
+
+	/** Start computing a new hash. */
+	void reset(uint64 seed = 0);
+
+	/** Add data to the hash. */
+	void update(const void *data, uint32 size);
+
+	/**
+	 * Return the hash of all data added so far. More data may still be
+	 * added afterwards.
+	 */
+	uint64 finish() const;
+
+private:
+	enum {
+		kStripeSize = 32
+	};
+
+	uint64 _acc[4];
+	uint64 _seed;
+	uint64 _totalSize;
+	byte _buffer[kStripeSize];
+	uint32 _bufferSize;
+};
+
+/**
+ * Compute the 64 bit content hash of a block of memory.
+ * @see ContentHash
+ */
+uint64 computeContentHash(const void *data, uint32 size, uint64 seed = 0);
+
+/**
+ * Compute the 64 bit content hash of the content of the given ReadStream.
+ * If length is set to a positive value, then only the first length
+ * bytes of the stream are used to compute the hash.
+ * @see ContentHash
+ */
+uint64 computeStreamContentHash(ReadStream &stream, uint32 length = 0);
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,505 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FLAT_HASHMAP_H
+#define COMMON_FLAT_HASHMAP_H
+
+#include "common/hashmap.h"
+
+namespace Common {
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for HashMap<Key,Val> which
+ * stores its entries directly in one flat array instead of allocating a node
+ * for each of them. Collisions are resolved by linear probing, guided by an
+ * array of control bytes: one per slot, marking it as empty, deleted, or in
+ * use together with 7 bits of the entry's hash. Most probes for absent keys
+ * thus never touch the entries themselves, and iterating only walks two
+ * contiguous arrays.
+ *
+ * It supports the same interface as HashMap, including iterators staying
+ * valid when other entries are erased. Unlike HashMap, inserting an entry
+ * may move all others in memory, so references to values (e.g. as returned
+ * by operator[]) are only valid until the next insertion.
+ *
+ * This pays off for maps with many small entries which are looked up or
+ * iterated over frequently. For large values, HashMap is often the better
+ * choice, since entries are moved when the map grows.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+private:
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> HM_t;
+
+	struct Node {
+		const Key _key;
+		Val _value;
+		explicit Node(const Key &key) : _key(key), _value() {}
+		Node(const Node &node) : _key(node._key), _value(node._value) {}
+
+	private:
+		Node &operator=(const Node &);
+	};
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The load factor, including deleted entries. Linear probing
+		// degrades quickly with fuller tables.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 3,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 4
+	};
+
+	enum {
+		kCtrlEmpty = 0,
+		kCtrlDeleted = 1,
+		kCtrlUsed = 0x80	///< Ored with the top 7 bits of the hash
+	};
+
+	byte *_ctrl;		///< Control byte for every slot
+	Node *_storage;		///< Entries, only constructed in used slots
+	size_type _mask;	///< Capacity of the map minus one; capacity is a power of two
+	size_type _size;
+	size_type _deleted;	///< Number of deleted slots
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+	// Spread the bits of hashes which are poorly distributed, such as the
+	// identity used for integers, so that both the slot index and the
+	// control byte depend on all of them.
+	static uint mixHash(uint hash) {
+		hash *= 0x9E3779B1;
+		return hash ^ (hash >> 16);
+	}
+
+	static byte ctrlForHash(uint hash) {
+		return kCtrlUsed | (hash >> 25);
+	}
+
+	void allocStorage(size_type capacity) {
+		_mask = capacity - 1;
+		_ctrl = (byte *)malloc(capacity);
+		_storage = (Node *)malloc(capacity * sizeof(Node));
+		assert(_ctrl && _storage);
+		memset(_ctrl, kCtrlEmpty, capacity);
+		_size = 0;
+		_deleted = 0;
+	}
+
+	void freeStorage() {
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_ctrl[ctr] & kCtrlUsed)
+				_storage[ctr].~Node();
+		}
+		free(_ctrl);
+		free(_storage);
+	}
+
+	void assign(const HM_t &map);
+	void expandStorage(size_type newCapacity);
+	template<class LookupKey>
+	size_type lookup(const LookupKey &key) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void eraseSlot(size_type ctr);
+
+	template<class T> friend class IteratorImpl;
+
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->_ctrl[_idx] & kCtrlUsed);
+			return &_hashmap->_storage[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			_idx = _hashmap->nextUsed(_idx + 1);
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+	/** Return the first used slot starting at ctr, or (size_type)-1 if there is none. */
+	size_type nextUsed(size_type ctr) const {
+		for (; ctr <= _mask; ++ctr) {
+			if (_ctrl[ctr] & kCtrlUsed)
+				return ctr;
+		}
+		return (size_type)-1;
+	}
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const HM_t &map);
+	~FlatHashMap();
+
+	HM_t &operator=(const HM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() { return iterator(nextUsed(0), this); }
+	iterator	end() { return iterator((size_type)-1, this); }
+
+	const_iterator	begin() const { return const_iterator(nextUsed(0), this); }
+	const_iterator	end() const { return const_iterator((size_type)-1, this); }
+
+	iterator	find(const Key &key) {
+		size_type ctr = lookup(key);
+		if (_ctrl[ctr] & kCtrlUsed)
+			return iterator(ctr, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		size_type ctr = lookup(key);
+		if (_ctrl[ctr] & kCtrlUsed)
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	// Heterogeneous lookups, see HashMap
+
+	template<class LookupKey>
+	typename HashMapLookupResult<HashFunc, EqualFunc, LookupKey, iterator>::type find(const LookupKey &key) {
+		size_type ctr = lookup(key);
+		if (_ctrl[ctr] & kCtrlUsed)
+			return iterator(ctr, this);
+		return end();
+	}
+
+	template<class LookupKey>
+	typename HashMapLookupResult<HashFunc, EqualFunc, LookupKey, const_iterator>::type find(const LookupKey &key) const {
+		size_type ctr = lookup(key);
+		if (_ctrl[ctr] & kCtrlUsed)
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	template<class LookupKey>
+	typename HashMapLookupResult<HashFunc, EqualFunc, LookupKey, bool>::type contains(const LookupKey &key) const {
+		return (_ctrl[lookup(key)] & kCtrlUsed) != 0;
+	}
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const HM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	freeStorage();
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const HM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// The slots of the other map can be copied one by one, since the
+	// positions of the entries only depend on the capacity.
+	memcpy(_ctrl, map._ctrl, _mask + 1);
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_ctrl[ctr] & kCtrlUsed)
+			new ((void *)&_storage[ctr]) Node(map._storage[ctr]);
+	}
+	_size = map._size;
+	_deleted = map._deleted;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_ctrl[ctr] & kCtrlUsed)
+			_storage[ctr].~Node();
+	}
+
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		free(_ctrl);
+		free(_storage);
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+	} else {
+		memset(_ctrl, kCtrlEmpty, _mask + 1);
+		_size = 0;
+		_deleted = 0;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
+	assert(newCapacity >= _mask + 1);
+
+#ifndef NDEBUG
+	const size_type old_size = _size;
+#endif
+	const size_type old_mask = _mask;
+	byte *old_ctrl = _ctrl;
+	Node *old_storage = _storage;
+
+	allocStorage(newCapacity);
+
+	// Move all entries to the new table. Since we know that no key exists
+	// twice in the old table, we don't have to call _equal().
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		if (!(old_ctrl[ctr] & kCtrlUsed))
+			continue;
+
+		const uint hash = mixHash(_hash(old_storage[ctr]._key));
+		size_type idx = hash & _mask;
+		while (_ctrl[idx] != kCtrlEmpty)
+			idx = (idx + 1) & _mask;
+
+		_ctrl[idx] = ctrlForHash(hash);
+		new ((void *)&_storage[idx]) Node(old_storage[ctr]);
+		old_storage[ctr].~Node();
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	assert(_size == old_size);
+
+	free(old_ctrl);
+	free(old_storage);
+}
+
+/**
+ * Return the slot containing the given key, or the empty slot ending its
+ * probe sequence if the key is not present.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+template<class LookupKey>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const LookupKey &key) const {
+	const uint hash = mixHash(_hash(key));
+	const byte ctrl = ctrlForHash(hash);
+	size_type ctr = hash & _mask;
+
+	// The load factor guarantees there is at least one empty slot
+	while (_ctrl[ctr] != kCtrlEmpty) {
+		if (_ctrl[ctr] == ctrl && _equal(_storage[ctr]._key, key))
+			break;
+		ctr = (ctr + 1) & _mask;
+	}
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	const uint hash = mixHash(_hash(key));
+	const byte ctrl = ctrlForHash(hash);
+	size_type ctr = hash & _mask;
+	const size_type NONE_FOUND = _mask + 1;
+	size_type first_free = NONE_FOUND;
+
+	while (_ctrl[ctr] != kCtrlEmpty) {
+		if (_ctrl[ctr] == ctrl && _equal(_storage[ctr]._key, key))
+			return ctr;
+		if (_ctrl[ctr] == kCtrlDeleted && first_free == NONE_FOUND)
+			first_free = ctr;
+		ctr = (ctr + 1) & _mask;
+	}
+
+	// Reuse the first deleted slot on the way, if any
+	if (first_free != NONE_FOUND) {
+		ctr = first_free;
+		_deleted--;
+	}
+
+	_ctrl[ctr] = ctrl;
+	new ((void *)&_storage[ctr]) Node(key);
+	_size++;
+
+	// Keep the load factor below a certain threshold.
+	// Deleted slots are also counted
+	size_type capacity = _mask + 1;
+	if ((_size + _deleted) * FLATHASHMAP_LOADFACTOR_DENOMINATOR >
+	        capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		// If the table is mostly full of deleted slots, dropping those
+		// is enough; otherwise grow.
+		if (_size * 2 * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+			capacity = capacity < 500 ? (capacity * 4) : (capacity * 2);
+		expandStorage(capacity);
+		ctr = lookup(key);
+		assert(_ctrl[ctr] & kCtrlUsed);
+	}
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return (_ctrl[lookup(key)] & kCtrlUsed) != 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	// The lookup may reallocate _storage, so it has to happen first
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	return _storage[ctr]._value;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key);
+	if (_ctrl[ctr] & kCtrlUsed)
+		return _storage[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	_storage[ctr]._value = val;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type ctr) {
+	_storage[ctr].~Node();
+	_size--;
+
+	// A slot followed by an empty one ends no other probe sequence, so it
+	// can become empty itself instead of leaving a deleted marker behind.
+	if (_ctrl[(ctr + 1) & _mask] == kCtrlEmpty) {
+		_ctrl[ctr] = kCtrlEmpty;
+	} else {
+		_ctrl[ctr] = kCtrlDeleted;
+		_deleted++;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	assert(entry._idx <= _mask);
+	assert(_ctrl[entry._idx] & kCtrlUsed);
+
+	eraseSlot(entry._idx);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key);
+	if (_ctrl[ctr] & kCtrlUsed)
+		eraseSlot(ctr);
+}
+
+} // End of namespace Common
+
+#endif
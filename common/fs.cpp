@@ -140,6 +140,21 @@ SeekableReadStream *FSNode::createReadStream() const {
 	return _realNode->createReadStream();
 }
 
+SeekableReadStream *FSNode::createMappedReadStream() const {
+	if (_realNode == 0)
+		return 0;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createMappedReadStream: '%s' does not exist", getName().c_str());
+		return 0;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createMappedReadStream: '%s' is a directory", getName().c_str());
+		return 0;
+	}
+
+	return _realNode->createMappedReadStream();
+}
+
 WriteStream *FSNode::createWriteStream() const {
 	if (_realNode == 0)
 		return 0;
@@ -152,22 +167,34 @@ WriteStream *FSNode::createWriteStream() const {
 	return _realNode->createWriteStream();
 }
 
+WriteStream *FSNode::createAtomicWriteStream() const {
+	if (_realNode == 0)
+		return 0;
+
+	if (_realNode->isDirectory()) {
+		warning("FSNode::createAtomicWriteStream: '%s' is a directory", getName().c_str());
+		return 0;
+	}
+
+	return _realNode->createAtomicWriteStream();
+}
+
 FSDirectory::FSDirectory(const FSNode &node, int depth, bool flat)
-  : _node(node), _cached(false), _depth(depth), _flat(flat) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _mapFiles(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const FSNode &node, int depth, bool flat)
-  : _node(node), _cached(false), _depth(depth), _flat(flat) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _mapFiles(false) {
 
 	setPrefix(prefix);
 }
 
 FSDirectory::FSDirectory(const String &name, int depth, bool flat)
-  : _node(name), _cached(false), _depth(depth), _flat(flat) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _mapFiles(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const String &name, int depth, bool flat)
-  : _node(name), _cached(false), _depth(depth), _flat(flat) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _mapFiles(false) {
 
 	setPrefix(prefix);
 }
@@ -230,7 +257,7 @@ SeekableReadStream *FSDirectory::createReadStreamForMember(const String &name) c
 	FSNode *node = lookupCache(_fileCache, name);
 	if (!node)
 		return 0;
-	SeekableReadStream *stream = node->createReadStream();
+	SeekableReadStream *stream = _mapFiles ? node->createMappedReadStream() : node->createReadStream();
 	if (!stream)
 		warning("FSDirectory::createReadStreamForMember: Can't create stream for file '%s'", name.c_str());
 
@@ -249,7 +276,9 @@ FSDirectory *FSDirectory::getSubDirectory(const String &prefix, const String &na
 	if (!node)
 		return 0;
 
-	return new FSDirectory(prefix, *node, depth, flat);
+	FSDirectory *dir = new FSDirectory(prefix, *node, depth, flat);
+	dir->setMapFiles(_mapFiles);
+	return dir;
 }
 
 void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const String& prefix) const {
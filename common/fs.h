@@ -222,6 +222,17 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Like createReadStream(), but the backend may map the file into memory
+	 * instead, so only the parts actually read are loaded. Reading from a
+	 * mapped file which was truncated, or is on removed media, crashes.
+	 * Only use this for read-only data files which are not expected to
+	 * change while they are open.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -230,6 +241,16 @@ public:
 	 * @return pointer to the stream object, 0 in case of a failure
 	 */
 	WriteStream *createWriteStream() const;
+
+	/**
+	 * Like createWriteStream(), but the backend may write to a temporary
+	 * file instead, which replaces the file in finalize() or when the
+	 * stream is deleted. If anything fails before, the old file is kept.
+	 * Check err() after finalize() to know whether the file was replaced.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	WriteStream *createAtomicWriteStream() const;
 };
 
 /**
@@ -279,6 +300,7 @@ class FSDirectory : public Archive {
 	mutable bool _cached;
 	mutable int	_depth;
 	mutable bool _flat;
+	bool _mapFiles;
 
 	// look for a match
 	FSNode *lookupCache(NodeCache &cache, const String &name) const;
@@ -314,6 +336,14 @@ public:
 	 */
 	FSNode getFSNode() const;
 
+	/**
+	 * Open members with FSNode::createMappedReadStream(), so they may be
+	 * mapped into memory. Only set this for directories of read-only data,
+	 * like the game data, which does not change while it is open.
+	 * Sub directories created afterwards inherit the setting.
+	 */
+	void setMapFiles(bool mapFiles) { _mapFiles = mapFiles; }
+
 	/**
 	 * Create a new FSDirectory pointing to a sub directory of the instance. See class comment
 	 * for an explanation of the prefix parameter.
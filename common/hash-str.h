@@ -25,6 +25,7 @@
 
 #include "common/hashmap.h"
 #include "common/str.h"
+#include "common/str-atom.h"
 
 namespace Common {
 
@@ -36,21 +37,38 @@ inline uint hashit_lower(const String &str) { return hashit_lower(str.c_str());
 
 // FIXME: The following functors obviously are not consistently named
 
+// These functors also accept C strings and StringAtoms. They are marked as
+// is_transparent, which lets HashMaps using them look up String keys by
+// either of these without creating a temporary String. StringAtoms are not
+// hashed again, they carry their hash with them.
+
 struct CaseSensitiveString_EqualTo {
+	typedef void is_transparent;
 	bool operator()(const String& x, const String& y) const { return x.equals(y); }
+	bool operator()(const String& x, const char *y) const { return x.equals(y); }
+	bool operator()(const String& x, const StringAtom &y) const { return x.equals(y.c_str()); }
 };
 
 struct CaseSensitiveString_Hash {
+	typedef void is_transparent;
 	uint operator()(const String& x) const { return hashit(x.c_str()); }
+	uint operator()(const char *x) const { return hashit(x); }
+	uint operator()(const StringAtom &x) const { return x.hash(); }
 };
 
 
 struct IgnoreCase_EqualTo {
+	typedef void is_transparent;
 	bool operator()(const String& x, const String& y) const { return x.equalsIgnoreCase(y); }
+	bool operator()(const String& x, const char *y) const { return x.equalsIgnoreCase(y); }
+	bool operator()(const String& x, const StringAtom &y) const { return x.equalsIgnoreCase(y.c_str()); }
 };
 
 struct IgnoreCase_Hash {
+	typedef void is_transparent;
 	uint operator()(const String& x) const { return hashit_lower(x.c_str()); }
+	uint operator()(const char *x) const { return hashit_lower(x); }
+	uint operator()(const StringAtom &x) const { return x.hashLowercase(); }
 };
 
 
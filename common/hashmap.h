@@ -64,6 +64,26 @@ namespace Common {
 template<class T> class IteratorImpl;
 #endif
 
+template<class T1, class T2>
+struct HashMapTransparentCheck {
+	typedef void type;
+};
+
+/**
+ * Helper for heterogeneous lookups in a HashMap: defines type as Result,
+ * but only if both HashFunc and EqualFunc declare the type is_transparent.
+ * Otherwise the lookup functions taking other key types are ignored.
+ */
+template<class HashFunc, class EqualFunc, class LookupKey, class Result, class Enable = void>
+struct HashMapLookupResult {
+};
+
+template<class HashFunc, class EqualFunc, class LookupKey, class Result>
+struct HashMapLookupResult<HashFunc, EqualFunc, LookupKey, Result,
+                           typename HashMapTransparentCheck<typename HashFunc::is_transparent, typename EqualFunc::is_transparent>::type> {
+	typedef Result type;
+};
+
 
 /**
  * HashMap<Key,Val> maps objects of type Key to objects of type Val.
@@ -77,6 +97,12 @@ template<class T> class IteratorImpl;
  * referenced, for a new key. If the object is const, then an assertion is
  * triggered instead. Hence if you are not sure whether a key is contained in
  * the map, use contains() first to check for its presence.
+ *
+ * If both HashFunc and EqualFunc declare the type is_transparent and accept
+ * other key types as well, find() and contains() can be used with these
+ * other key types directly. For example, the String functors
+ * in common/hash-str.h allow looking up String keys by a C string or a
+ * StringAtom without creating a temporary String.
  */
 template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
 class HashMap {
@@ -149,7 +175,8 @@ private:
 	}
 
 	void assign(const HM_t &map);
-	size_type lookup(const Key &key) const;
+	template<class LookupKey>
+	size_type lookup(const LookupKey &key) const;
 	size_type lookupAndCreateIfMissing(const Key &key);
 	void expandStorage(size_type newCapacity);
 
@@ -290,6 +317,29 @@ public:
 		return end();
 	}
 
+	// Heterogeneous lookups, see the class description
+
+	template<class LookupKey>
+	typename HashMapLookupResult<HashFunc, EqualFunc, LookupKey, iterator>::type find(const LookupKey &key) {
+		size_type ctr = lookup(key);
+		if (_storage[ctr])
+			return iterator(ctr, this);
+		return end();
+	}
+
+	template<class LookupKey>
+	typename HashMapLookupResult<HashFunc, EqualFunc, LookupKey, const_iterator>::type find(const LookupKey &key) const {
+		size_type ctr = lookup(key);
+		if (_storage[ctr])
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	template<class LookupKey>
+	typename HashMapLookupResult<HashFunc, EqualFunc, LookupKey, bool>::type contains(const LookupKey &key) const {
+		return _storage[lookup(key)] != NULL;
+	}
+
 	// TODO: insert() method?
 
 	bool empty() const {
@@ -463,7 +513,8 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity
 }
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
-typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+template<class LookupKey>
+typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, HashFunc, EqualFunc>::lookup(const LookupKey &key) const {
 	const size_type hash = _hash(key);
 	size_type ctr = hash & _mask;
 	for (size_type perturb = hash; ; perturb >>= HASHMAP_PERTURB_SHIFT) {
@@ -33,31 +33,20 @@
 
 namespace Common {
 
-struct md5_context {
-	uint32 total[2];
-	uint32 state[4];
-	uint8 buffer[64];
-};
-
-static void md5_starts(md5_context *ctx);
-static void md5_update(md5_context *ctx, const uint8 *input, uint32 length);
-static void md5_finish(md5_context *ctx, uint8 digest[16]);
-
-
 #define GET_UINT32(n, b, i)	(n) = READ_LE_UINT32(b + i)
 #define PUT_UINT32(n, b, i)	WRITE_LE_UINT32(b + i, n)
 
-void md5_starts(md5_context *ctx) {
-	ctx->total[0] = 0;
-	ctx->total[1] = 0;
+void MD5::reset() {
+	_total[0] = 0;
+	_total[1] = 0;
 
-	ctx->state[0] = 0x67452301;
-	ctx->state[1] = 0xEFCDAB89;
-	ctx->state[2] = 0x98BADCFE;
-	ctx->state[3] = 0x10325476;
+	_state[0] = 0x67452301;
+	_state[1] = 0xEFCDAB89;
+	_state[2] = 0x98BADCFE;
+	_state[3] = 0x10325476;
 }
 
-static void md5_process(md5_context *ctx, const uint8 data[64]) {
+void MD5::process(uint32 state[4], const uint8 *data) {
 	uint32 X[16], A, B, C, D;
 
 	GET_UINT32(X[0],  data,  0);
@@ -79,15 +68,17 @@ static void md5_process(md5_context *ctx, const uint8 data[64]) {
 
 #define S(x, n) ((x << n) | ((x & 0xFFFFFFFF) >> (32 - n)))
 
+// The message word and the constant do not depend on the previous step,
+// so adding them first shortens the dependency chain between steps.
 #define P(a, b, c, d, k, s, t)                    \
 {                                                 \
-	a += F(b,c,d) + X[k] + t; a = S(a,s) + b; \
+	a += X[k] + t; a += F(b,c,d); a = S(a,s) + b; \
 }
 
-	A = ctx->state[0];
-	B = ctx->state[1];
-	C = ctx->state[2];
-	D = ctx->state[3];
+	A = state[0];
+	B = state[1];
+	C = state[2];
+	D = state[3];
 
 #define F(x, y, z) (z ^ (x & (y ^ z)))
 
@@ -110,7 +101,13 @@ static void md5_process(md5_context *ctx, const uint8 data[64]) {
 
 #undef F
 
-#define F(x, y, z) (y ^ (z & (x ^ y)))
+// (x & z) and (y & ~z) have no bits in common, so they can be added
+// separately, and (y & ~z) does not depend on the previous step at all.
+#undef P
+#define P(a, b, c, d, k, s, t)                    \
+{                                                 \
+	a += X[k] + t; a += c & ~d; a += b & d; a = S(a,s) + b; \
+}
 
 	P(A, B, C, D,  1,  5, 0xF61E2562);
 	P(D, A, B, C,  6,  9, 0xC040B340);
@@ -129,7 +126,11 @@ static void md5_process(md5_context *ctx, const uint8 data[64]) {
 	P(C, D, A, B,  7, 14, 0x676F02D9);
 	P(B, C, D, A, 12, 20, 0x8D2A4C8A);
 
-#undef F
+#undef P
+#define P(a, b, c, d, k, s, t)                    \
+{                                                 \
+	a += X[k] + t; a += F(b,c,d); a = S(a,s) + b; \
+}
 
 #define F(x, y, z) (x ^ y ^ z)
 
@@ -173,43 +174,44 @@ static void md5_process(md5_context *ctx, const uint8 data[64]) {
 
 #undef F
 
-	ctx->state[0] += A;
-	ctx->state[1] += B;
-	ctx->state[2] += C;
-	ctx->state[3] += D;
+	state[0] += A;
+	state[1] += B;
+	state[2] += C;
+	state[3] += D;
 }
 
-void md5_update(md5_context *ctx, const uint8 *input, uint32 length) {
+void MD5::update(const void *data, uint32 length) {
+	const uint8 *input = (const uint8 *)data;
 	uint32 left, fill;
 
 	if (!length)
 		return;
 
-	left = ctx->total[0] & 0x3F;
+	left = _total[0] & 0x3F;
 	fill = 64 - left;
 
-	ctx->total[0] += length;
-	ctx->total[0] &= 0xFFFFFFFF;
+	_total[0] += length;
+	_total[0] &= 0xFFFFFFFF;
 
-	if (ctx->total[0] < length)
-		ctx->total[1]++;
+	if (_total[0] < length)
+		_total[1]++;
 
 	if (left && length >= fill) {
-		memcpy((void *)(ctx->buffer + left), (const void *)input, fill);
-		md5_process(ctx, ctx->buffer);
+		memcpy((void *)(_buffer + left), (const void *)input, fill);
+		process(_state, _buffer);
 		length -= fill;
 		input  += fill;
 		left = 0;
 	}
 
 	while (length >= 64) {
-		md5_process(ctx, input);
+		process(_state, input);
 		length -= 64;
 		input  += 64;
 	}
 
 	if (length) {
-		memcpy((void *)(ctx->buffer + left), (const void *)input, length);
+		memcpy((void *)(_buffer + left), (const void *)input, length);
 	}
 }
 
@@ -220,27 +222,27 @@ static const uint8 md5_padding[64] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 };
 
-void md5_finish(md5_context *ctx, uint8 digest[16]) {
+void MD5::finish(uint8 digest[16]) {
 	uint32 last, padn;
 	uint32 high, low;
 	uint8 msglen[8];
 
-	high = (ctx->total[0] >> 29) | (ctx->total[1] << 3);
-	low  = (ctx->total[0] <<  3);
+	high = (_total[0] >> 29) | (_total[1] << 3);
+	low  = (_total[0] <<  3);
 
 	PUT_UINT32(low,  msglen, 0);
 	PUT_UINT32(high, msglen, 4);
 
-	last = ctx->total[0] & 0x3F;
+	last = _total[0] & 0x3F;
 	padn = (last < 56) ? (56 - last) : (120 - last);
 
-	md5_update(ctx, md5_padding, padn);
-	md5_update(ctx, msglen, 8);
+	update(md5_padding, padn);
+	update(msglen, 8);
 
-	PUT_UINT32(ctx->state[0], digest,  0);
-	PUT_UINT32(ctx->state[1], digest,  4);
-	PUT_UINT32(ctx->state[2], digest,  8);
-	PUT_UINT32(ctx->state[3], digest, 12);
+	PUT_UINT32(_state[0], digest,  0);
+	PUT_UINT32(_state[1], digest,  4);
+	PUT_UINT32(_state[2], digest,  8);
+	PUT_UINT32(_state[3], digest, 12);
 }
 
 
@@ -249,9 +251,11 @@ bool computeStreamMD5(ReadStream &stream, uint8 digest[16], uint32 length) {
 #ifdef DISABLE_MD5
 	memset(digest, 0, 16);
 #else
-	md5_context ctx;
+	MD5 md5;
 	int i;
-	unsigned char buf[1000];
+	// A multiple of the MD5 block size, so the data never has to be
+	// copied into the internal buffer
+	unsigned char buf[4096];
 	bool restricted = (length != 0);
 	uint32 readlen;
 
@@ -260,10 +264,8 @@ bool computeStreamMD5(ReadStream &stream, uint8 digest[16], uint32 length) {
 	else
 		readlen = length;
 
-	md5_starts(&ctx);
-
 	while ((i = stream.read(buf, readlen)) > 0) {
-		md5_update(&ctx, buf, i);
+		md5.update(buf, i);
 
 		if (restricted) {
 			length -= i;
@@ -275,7 +277,7 @@ bool computeStreamMD5(ReadStream &stream, uint8 digest[16], uint32 length) {
 		}
 	}
 
-	md5_finish(&ctx, digest);
+	md5.finish(digest);
 #endif
 	return true;
 }
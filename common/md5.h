@@ -30,6 +30,34 @@ namespace Common {
 class ReadStream;
 class String;
 
+/**
+ * Incremental computation of an MD5 checksum, for data which arrives in
+ * pieces rather than as a single stream.
+ */
+class MD5 {
+public:
+	MD5() { reset(); }
+
+	/** Start computing a new checksum. */
+	void reset();
+
+	/** Add data to the checksum. */
+	void update(const void *data, uint32 size);
+
+	/**
+	 * Complete the checksum and return it in the array digest. Call reset()
+	 * before adding data for another checksum.
+	 */
+	void finish(uint8 digest[16]);
+
+private:
+	static void process(uint32 state[4], const uint8 *data);
+
+	uint32 _total[2];
+	uint32 _state[4];
+	uint8 _buffer[64];
+};
+
 /**
  * Compute the MD5 checksum of the content of the given ReadStream.
  * The 128 bit MD5 checksum is returned directly in the array digest.
@@ -21,12 +21,24 @@
  */
 
 #include "common/memorypool.h"
+#include "common/atomic.h"
+#include "common/system.h"
 #include "common/util.h"
 
+#if defined(SCUMMVM_THREAD_LOCAL) && defined(SCUMMVM_ATOMICS)
+#define SIZE_CLASS_THREAD_CACHES
+#endif
+
 namespace Common {
 
 enum {
-	INITIAL_CHUNKS_PER_PAGE = 8
+	INITIAL_CHUNKS_PER_PAGE = 8,
+	// allocPage() has always refused pages of 16 MB and more, but pages kept
+	// doubling, so a pool reaching about 16 MB of chunks hit that assert. The
+	// size class allocator keeps pools of 2048 byte chunks for as long as it
+	// exists, which makes this reachable. Pages now stop growing below the
+	// limit instead, the pool itself is not limited.
+	MAX_PAGE_SIZE = 16 * 1024 * 1024
 };
 
 static size_t adjustChunkSize(size_t chunkSize) {
@@ -64,15 +76,17 @@ void MemoryPool::allocPage() {
 
 	// Allocate a new page
 	page.numChunks = _chunksPerPage;
-	assert(page.numChunks * _chunkSize < 16*1024*1024);	// Refuse to allocate pages bigger than 16 MB
+	assert(page.numChunks * _chunkSize < MAX_PAGE_SIZE);	// Refuse to allocate pages bigger than 16 MB
 
 	page.start = ::malloc(page.numChunks * _chunkSize);
 	assert(page.start);
 	_pages.push_back(page);
 
 
-	// Next time, we'll allocate a page twice as big as this one.
-	_chunksPerPage *= 2;
+	// Next time, we'll allocate a page twice as big as this one,
+	// unless that would exceed the maximum page size.
+	if (_chunksPerPage * 2 * _chunkSize < MAX_PAGE_SIZE)
+		_chunksPerPage *= 2;
 
 	// Add the page to the pool of free chunk
 	addPageToPool(page);
@@ -179,4 +193,402 @@ void MemoryPool::freeUnusedPages() {
 	}
 }
 
+#pragma mark -
+
+SizeClassAllocator *SizeClassAllocator::_first = 0;
+OpaqueMutex *SizeClassAllocator::_listMutex = 0;
+
+/** Free chunks kept by one thread, linked through their first word. */
+struct SizeClassAllocator::ThreadCache {
+	void *chunks[kNumSizeClasses];
+	uint count[kNumSizeClasses];
+};
+
+#ifdef SIZE_CLASS_THREAD_CACHES
+// Threads are numbered from 1 on their first use of a thread safe
+// allocator. The number selects the cache in every allocator.
+static volatile uint32 s_numThreads = 0;
+static SCUMMVM_THREAD_LOCAL uint32 t_threadNumber = 0;
+#endif
+
+SizeClassAllocator::SizeClassAllocator(const char *name, bool threadSafe)
+	: _name(name), _mutex(0), _threadCaches(0) {
+	assert(sizeof(Header) == 8);
+
+	if (threadSafe) {
+		assert(g_system);
+		_mutex = g_system->createMutex();
+#ifdef SIZE_CLASS_THREAD_CACHES
+		_threadCaches = new ThreadCache[kThreadCaches];
+		memset(_threadCaches, 0, kThreadCaches * sizeof(ThreadCache));
+#endif
+	}
+
+	for (int i = 0; i < kNumSizeClasses; ++i)
+		_pools[i] = new MemoryPool(kMinChunkSize << i);
+
+	memset(_stats, 0, sizeof(_stats));
+	for (int i = 0; i < kMaxTags; ++i)
+		_tagNames[i] = 0;
+	_statsStart = g_system ? g_system->getMillis() : 0;
+
+	OpaqueMutex *listMutex = lockList();
+	_nextAllocator = _first;
+	_first = this;
+	unlockList(listMutex);
+}
+
+SizeClassAllocator::~SizeClassAllocator() {
+	OpaqueMutex *listMutex = lockList();
+	SizeClassAllocator **allocator = &_first;
+	while (*allocator != this)
+		allocator = &(*allocator)->_nextAllocator;
+	*allocator = _nextAllocator;
+	unlockList(listMutex);
+
+	// Chunks still in the caches belong to the pages of the pools
+	delete[] _threadCaches;
+	for (int i = 0; i < kNumSizeClasses; ++i)
+		delete _pools[i];
+
+	if (_mutex)
+		g_system->deleteMutex(_mutex);
+}
+
+void SizeClassAllocator::lock() const {
+	if (_mutex)
+		g_system->lockMutex(_mutex);
+}
+
+void SizeClassAllocator::unlock() const {
+	if (_mutex)
+		g_system->unlockMutex(_mutex);
+}
+
+void SizeClassAllocator::initList() {
+	assert(g_system && !_listMutex);
+	_listMutex = g_system->createMutex();
+}
+
+OpaqueMutex *SizeClassAllocator::lockList() {
+	// Before initList() there are no other threads, so the list needs no
+	// protection. The mutex is never destroyed, since allocators may be
+	// destroyed after the backend.
+	if (!_listMutex)
+		return 0;
+	g_system->lockMutex(_listMutex);
+	return _listMutex;
+}
+
+void SizeClassAllocator::unlockList(OpaqueMutex *mutex) {
+	if (mutex)
+		g_system->unlockMutex(mutex);
+}
+
+SizeClassAllocator::ThreadCache *SizeClassAllocator::getThreadCache() const {
+#ifdef SIZE_CLASS_THREAD_CACHES
+	if (_threadCaches) {
+		if (!t_threadNumber)
+			t_threadNumber = atomicAdd(&s_numThreads, 1);
+		if (t_threadNumber <= kThreadCaches)
+			return &_threadCaches[t_threadNumber - 1];
+	}
+#endif
+	return 0;
+}
+
+void *SizeClassAllocator::allocChunk(uint sizeClass) {
+	ThreadCache *cache = getThreadCache();
+	if (!cache) {
+		lock();
+		void *chunk = _pools[sizeClass]->allocChunk();
+		unlock();
+		return chunk;
+	}
+
+	void *&chunks = cache->chunks[sizeClass];
+	if (!cache->count[sizeClass]) {
+		lock();
+		for (int i = 0; i < kCacheBatch; ++i) {
+			void *chunk = _pools[sizeClass]->allocChunk();
+			*(void **)chunk = chunks;
+			chunks = chunk;
+		}
+		unlock();
+		cache->count[sizeClass] = kCacheBatch;
+	}
+
+	void *chunk = chunks;
+	chunks = *(void **)chunk;
+	cache->count[sizeClass]--;
+	return chunk;
+}
+
+void SizeClassAllocator::freeChunk(void *chunk, uint sizeClass) {
+	ThreadCache *cache = getThreadCache();
+	if (!cache) {
+		lock();
+		_pools[sizeClass]->freeChunk(chunk);
+		unlock();
+		return;
+	}
+
+	// The chunk may have been allocated by another thread, which does not
+	// matter as long as it goes back to a pool of the same size class.
+	void *&chunks = cache->chunks[sizeClass];
+	*(void **)chunk = chunks;
+	chunks = chunk;
+
+	if (++cache->count[sizeClass] > kCacheLimit) {
+		lock();
+		while (cache->count[sizeClass] > kCacheBatch) {
+			chunk = chunks;
+			chunks = *(void **)chunk;
+			_pools[sizeClass]->freeChunk(chunk);
+			cache->count[sizeClass]--;
+		}
+		unlock();
+	}
+}
+
+#ifdef SIZE_CLASS_THREAD_CACHES
+void SizeClassAllocator::addStats(uint tag, uint32 size) {
+	TagStats &stats = _stats[tag];
+	const uint32 liveBytes = atomicAdd(&stats.liveBytes, size);
+	uint32 peakBytes = atomicLoad(&stats.peakBytes);
+	while (liveBytes > peakBytes && !atomicCompareExchange(&stats.peakBytes, peakBytes, liveBytes))
+		peakBytes = atomicLoad(&stats.peakBytes);
+	atomicAdd(&stats.allocations, 1);
+}
+
+void SizeClassAllocator::removeStats(uint tag, uint32 size) {
+	TagStats &stats = _stats[tag];
+	atomicAdd(&stats.liveBytes, 0 - size);
+	atomicAdd(&stats.frees, 1);
+}
+#else
+void SizeClassAllocator::addStats(uint tag, uint32 size) {
+	TagStats &stats = _stats[tag];
+	stats.liveBytes += size;
+	stats.peakBytes = MAX(stats.peakBytes, stats.liveBytes);
+	stats.allocations++;
+}
+
+void SizeClassAllocator::removeStats(uint tag, uint32 size) {
+	TagStats &stats = _stats[tag];
+	stats.liveBytes -= size;
+	stats.frees++;
+}
+#endif
+
+void *SizeClassAllocator::allocate(size_t size, uint tag) {
+	assert(tag < kMaxTags);
+
+	const size_t blockSize = size + sizeof(Header);
+	uint sizeClass = 0;
+	while (sizeClass < kNumSizeClasses && blockSize > (size_t)(kMinChunkSize << sizeClass))
+		++sizeClass;
+
+	Header *header;
+	if (_threadCaches) {
+		// The statistics are updated atomically, only the pools need the
+		// mutex, and not even those if the thread has a cache.
+		if (sizeClass < kNumSizeClasses)
+			header = (Header *)allocChunk(sizeClass);
+		else
+			header = (Header *)::malloc(blockSize);
+		if (header)
+			addStats(tag, size);
+	} else {
+		lock();
+		if (sizeClass < kNumSizeClasses)
+			header = (Header *)_pools[sizeClass]->allocChunk();
+		else
+			header = (Header *)::malloc(blockSize);
+		if (header)
+			addStats(tag, size);
+		unlock();
+	}
+
+	if (!header)
+		return 0;
+
+	header->sizeClass = sizeClass;
+	header->tag = tag;
+	header->size = size;
+	return header + 1;
+}
+
+void SizeClassAllocator::free(void *ptr) {
+	if (!ptr)
+		return;
+
+	Header *header = (Header *)ptr - 1;
+	assert(header->tag < kMaxTags && header->sizeClass <= kNumSizeClasses);
+
+	if (_threadCaches) {
+		removeStats(header->tag, header->size);
+		if (header->sizeClass < kNumSizeClasses)
+			freeChunk(header, header->sizeClass);
+		else
+			::free(header);
+	} else {
+		lock();
+		removeStats(header->tag, header->size);
+		if (header->sizeClass < kNumSizeClasses)
+			_pools[header->sizeClass]->freeChunk(header);
+		else
+			::free(header);
+		unlock();
+	}
+}
+
+void SizeClassAllocator::freeUnusedPages() {
+	// Chunks in the caches of other threads keep their pages alive
+	ThreadCache *cache = getThreadCache();
+
+	lock();
+	for (int i = 0; i < kNumSizeClasses; ++i) {
+		if (cache) {
+			while (cache->chunks[i]) {
+				void *chunk = cache->chunks[i];
+				cache->chunks[i] = *(void **)chunk;
+				_pools[i]->freeChunk(chunk);
+			}
+			cache->count[i] = 0;
+		}
+		_pools[i]->freeUnusedPages();
+	}
+	unlock();
+}
+
+void SizeClassAllocator::setTagName(uint tag, const char *name) {
+	assert(tag < kMaxTags);
+	_tagNames[tag] = name;
+}
+
+SizeClassAllocator::TagStats SizeClassAllocator::getStats(uint tag) const {
+	assert(tag < kMaxTags);
+
+#ifdef SIZE_CLASS_THREAD_CACHES
+	if (_threadCaches) {
+		TagStats stats;
+		stats.liveBytes = atomicLoad(&_stats[tag].liveBytes);
+		stats.peakBytes = atomicLoad(&_stats[tag].peakBytes);
+		stats.allocations = atomicLoad(&_stats[tag].allocations);
+		stats.frees = atomicLoad(&_stats[tag].frees);
+		return stats;
+	}
+#endif
+
+	lock();
+	TagStats stats = _stats[tag];
+	unlock();
+	return stats;
+}
+
+void SizeClassAllocator::resetStats() {
+	lock();
+	for (int i = 0; i < kMaxTags; ++i) {
+#ifdef SIZE_CLASS_THREAD_CACHES
+		if (_threadCaches) {
+			atomicStore(&_stats[i].allocations, 0);
+			atomicStore(&_stats[i].frees, 0);
+			atomicStore(&_stats[i].peakBytes, atomicLoad(&_stats[i].liveBytes));
+			continue;
+		}
+#endif
+		_stats[i].allocations = 0;
+		_stats[i].frees = 0;
+		_stats[i].peakBytes = _stats[i].liveBytes;
+	}
+	_statsStart = g_system ? g_system->getMillis() : 0;
+	unlock();
+}
+
+uint32 SizeClassAllocator::getStatsDuration() const {
+	return g_system ? g_system->getMillis() - _statsStart : 0;
+}
+
+#pragma mark -
+
+MemoryArena::MemoryArena(size_t blockSize)
+	: _blockSize(blockSize), _blocks(0), _freeBlocks(0), _pos(0), _end(0),
+	  _usedBytes(0), _reservedBytes(0) {
+}
+
+MemoryArena::~MemoryArena() {
+	reset(true);
+}
+
+MemoryArena::Block *MemoryArena::allocBlock(size_t size) {
+	Block *block = (Block *)::malloc(kHeaderSize + size);
+	assert(block);
+	block->size = size;
+	_reservedBytes += size;
+	return block;
+}
+
+void *MemoryArena::allocate(size_t size) {
+	size = (size + kAlignment - 1) & ~(size_t)(kAlignment - 1);
+	_usedBytes += size;
+
+	// Oversized requests get a block of their own, so the rest of the
+	// current block remains available.
+	if (size > _blockSize) {
+		Block *block = allocBlock(size);
+		Block **insertPos = _blocks ? &_blocks->next : &_blocks;
+		block->next = *insertPos;
+		*insertPos = block;
+		return (byte *)block + kHeaderSize;
+	}
+
+	if ((size_t)(_end - _pos) < size) {
+		// Reuse a block kept by reset(), if there is one
+		Block *block = _freeBlocks;
+		if (block)
+			_freeBlocks = block->next;
+		else
+			block = allocBlock(_blockSize);
+
+		block->next = _blocks;
+		_blocks = block;
+		_pos = (byte *)block + kHeaderSize;
+		_end = _pos + _blockSize;
+	}
+
+	void *result = _pos;
+	_pos += size;
+	return result;
+}
+
+void MemoryArena::reset(bool releaseMemory) {
+	while (_blocks) {
+		Block *block = _blocks;
+		_blocks = block->next;
+
+		// Oversized blocks are always released, they are unlikely
+		// to be needed again.
+		if (releaseMemory || block->size != _blockSize) {
+			_reservedBytes -= block->size;
+			::free(block);
+		} else {
+			block->next = _freeBlocks;
+			_freeBlocks = block;
+		}
+	}
+
+	if (releaseMemory) {
+		while (_freeBlocks) {
+			Block *block = _freeBlocks;
+			_freeBlocks = block->next;
+			_reservedBytes -= block->size;
+			::free(block);
+		}
+	}
+
+	_pos = _end = 0;
+	_usedBytes = 0;
+}
+
 } // End of namespace Common
@@ -26,6 +26,7 @@
 #include "common/scummsys.h"
 #include "common/array.h"
 
+struct OpaqueMutex;
 
 namespace Common {
 
@@ -141,6 +142,216 @@ public:
 	}
 };
 
+/**
+ * A general purpose allocator, which serves small requests from a set of
+ * MemoryPools with increasing chunk sizes and passes larger ones on to
+ * malloc. Code which allocates and frees many small blocks of varying
+ * size, e.g. while loading and unloading scenes, can use it to keep those
+ * blocks out of the system heap and so avoid fragmenting it.
+ *
+ * Every allocation is charged to a tag, a small number chosen by the
+ * caller, and the allocator keeps statistics on the live bytes and the
+ * number of allocations per tag. All allocators register themselves in a
+ * global list, so the debugger console can show these statistics.
+ *
+ * Unless created otherwise, an allocator serializes access with a mutex,
+ * so it may be shared with the mixer and timer threads. Such allocators
+ * can only be created once the backend is initialized, allocators created
+ * before that, like static ones, have to be created with threadSafe set to
+ * false.
+ *
+ * Where the compiler supports thread local storage and atomics, thread safe
+ * allocators give each of the first kThreadCaches threads using them a
+ * cache of free chunks per size class. Chunks move between a cache and the
+ * pools in batches, so most allocations and frees take no lock, and the
+ * statistics are updated with atomics instead.
+ */
+class SizeClassAllocator {
+public:
+	enum {
+		kMinChunkSize = 16,
+		kNumSizeClasses = 8,	///< Size classes of 16, 32, ... 2048 bytes
+		kMaxTags = 16
+	};
+
+	struct TagStats {
+		uint32 liveBytes;
+		uint32 peakBytes;
+		uint32 allocations;	///< Number of allocations since the last resetStats()
+		uint32 frees;		///< Number of frees since the last resetStats()
+	};
+
+	/**
+	 * Constructor for an allocator.
+	 * @param name			the name shown in the statistics
+	 * @param threadSafe	whether to protect the allocator with a mutex,
+	 *						which requires the backend to be initialized
+	 */
+	explicit SizeClassAllocator(const char *name, bool threadSafe = true);
+	~SizeClassAllocator();
+
+	/**
+	 * Allocate a block of memory, charging it to the given tag.
+	 * The block is aligned suitably for any type up to 8 bytes.
+	 */
+	void	*allocate(size_t size, uint tag = 0);
+	/**
+	 * Return a block to the allocator. The given pointer must have been
+	 * obtained from the allocate() method of the very same allocator.
+	 * Passing 0 is allowed and has no effect.
+	 */
+	void	free(void *ptr);
+
+	/**
+	 * Release memory pages of the size class pools which are not in use.
+	 * @see MemoryPool::freeUnusedPages
+	 */
+	void	freeUnusedPages();
+
+	/** Set the name shown for a tag in the statistics. */
+	void	setTagName(uint tag, const char *name);
+	const char *getTagName(uint tag) const { assert(tag < kMaxTags); return _tagNames[tag]; }
+
+	const char *getName() const { return _name; }
+
+	/** Return a snapshot of the statistics for a tag. */
+	TagStats	getStats(uint tag) const;
+	/**
+	 * Reset the allocation and free counters of all tags. Live and peak
+	 * bytes are not affected, as they describe the memory in use.
+	 */
+	void	resetStats();
+	/** Return the time in milliseconds passed since the last resetStats(). */
+	uint32	getStatsDuration() const;
+
+	/**
+	 * Locks the global list of allocators for as long as it exists.
+	 * Allocators created or destroyed on other threads wait until it
+	 * goes out of scope, so hold one while walking the list.
+	 */
+	class ListLock {
+	public:
+		ListLock() : _mutex(lockList()) {}
+		~ListLock() { unlockList(_mutex); }
+	private:
+		OpaqueMutex *_mutex;
+	};
+
+	/**
+	 * Create the mutex guarding the global list of allocators. This is done
+	 * by scummvm_main() right after the backend is initialized. Until then,
+	 * the list is not locked, so allocators must only be created and
+	 * destroyed on the main thread.
+	 */
+	static void initList();
+
+	/** Return the first allocator of the global list. */
+	static SizeClassAllocator *getFirst() { return _first; }
+	/** Return the next allocator of the global list. */
+	SizeClassAllocator *getNext() const { return _nextAllocator; }
+
+private:
+	SizeClassAllocator(const SizeClassAllocator&);
+	SizeClassAllocator& operator=(const SizeClassAllocator&);
+
+	struct Header {
+		uint16 sizeClass;	///< kNumSizeClasses for blocks from malloc
+		uint16 tag;
+		uint32 size;
+	};
+
+	enum {
+		kThreadCaches = 8,	///< Further threads use the pools under the mutex
+		kCacheBatch = 16,	///< Chunks moved between a cache and a pool at once
+		kCacheLimit = 32	///< Chunks a cache holds per size class at most
+	};
+
+	struct ThreadCache;
+
+	void	lock() const;
+	void	unlock() const;
+
+	ThreadCache	*getThreadCache() const;
+	void	*allocChunk(uint sizeClass);
+	void	freeChunk(void *chunk, uint sizeClass);
+	void	addStats(uint tag, uint32 size);
+	void	removeStats(uint tag, uint32 size);
+
+	static OpaqueMutex	*lockList();
+	static void	unlockList(OpaqueMutex *mutex);
+
+	const char	*_name;
+	OpaqueMutex	*_mutex;
+	MemoryPool	*_pools[kNumSizeClasses];
+	ThreadCache	*_threadCaches;	///< kThreadCaches caches, if enabled
+	TagStats	_stats[kMaxTags];
+	const char	*_tagNames[kMaxTags];
+	uint32		_statsStart;
+
+	static SizeClassAllocator *_first;
+	static OpaqueMutex *_listMutex;
+	SizeClassAllocator *_nextAllocator;
+};
+
+/**
+ * A memory arena hands out memory from large blocks by advancing a
+ * pointer, and frees it all at once, either on reset() or when the arena
+ * is destroyed. This suits data sharing a life time, like the objects of
+ * a scene or the temporary buffers needed while drawing a single frame.
+ *
+ * Note that destructors of objects placed in an arena are never called.
+ */
+class MemoryArena {
+public:
+	/**
+	 * Constructor for a memory arena.
+	 * @param blockSize	the size of the blocks obtained from malloc
+	 */
+	explicit MemoryArena(size_t blockSize = 64 * 1024);
+	~MemoryArena();
+
+	/**
+	 * Allocate memory from the arena. The memory is aligned suitably for
+	 * any type up to 8 bytes.
+	 */
+	void	*allocate(size_t size);
+
+	/**
+	 * Free all memory allocated from the arena at once. The blocks are
+	 * kept for later allocations unless releaseMemory is set.
+	 */
+	void	reset(bool releaseMemory = false);
+
+	/** Return the number of bytes allocated since the last reset(). */
+	size_t	getUsedBytes() const { return _usedBytes; }
+	/** Return the number of bytes obtained from malloc. */
+	size_t	getReservedBytes() const { return _reservedBytes; }
+
+private:
+	MemoryArena(const MemoryArena&);
+	MemoryArena& operator=(const MemoryArena&);
+
+	struct Block {
+		Block *next;
+		size_t size;
+	};
+
+	enum {
+		kAlignment = 8,
+		kHeaderSize = (sizeof(Block) + kAlignment - 1) & ~(kAlignment - 1)
+	};
+
+	Block	*allocBlock(size_t size);
+
+	const size_t	_blockSize;
+	Block	*_blocks;		///< Blocks in use, the current one first
+	Block	*_freeBlocks;	///< Blocks kept by reset()
+	byte	*_pos;
+	byte	*_end;
+	size_t	_usedBytes;
+	size_t	_reservedBytes;
+};
+
 } // End of namespace Common
 
 /**
@@ -160,4 +371,14 @@ inline void operator delete(void *p, Common::MemoryPool &pool) {
 	pool.freeChunk(p);
 }
 
+/**
+ * A custom placement new operator, using a MemoryArena.
+ */
+inline void *operator new(size_t nbytes, Common::MemoryArena &arena) {
+	return arena.allocate(nbytes);
+}
+
+inline void operator delete(void *p, Common::MemoryArena &arena) {
+}
+
 #endif
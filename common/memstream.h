@@ -33,7 +33,7 @@ namespace Common {
  * Simple memory based 'stream', which implements the ReadStream interface for
  * a plain memory block.
  */
-class MemoryReadStream : public SeekableReadStream {
+class MemoryReadStream : public SeekableReadStream, public DirectReadAccess {
 private:
 	const byte * const _ptrOrig;
 	const byte *_ptr;
@@ -71,6 +71,9 @@ public:
 	int32 size() const { return _size; }
 
 	bool seek(int32 offs, int whence = SEEK_SET);
+
+	DirectReadAccess *getDirectAccess() { return this; }
+	const byte *borrow(uint32 &dataSize);
 };
 
 
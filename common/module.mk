@@ -3,6 +3,7 @@ MODULE := common
 MODULE_OBJS := \
 	archive.o \
 	config-manager.o \
+	content-hash.o \
 	coroutines.o \
 	dcl.o \
 	debug.o \
@@ -30,6 +31,7 @@ MODULE_OBJS := \
 	rational.o \
 	rendermode.o \
 	str.o \
+	str-atom.o \
 	stream.o \
 	system.o \
 	textconsole.o \
@@ -28,6 +28,7 @@
 // Seek function by Gael Chardon gael.dev@4now.net
 //
 
+#include "common/bufferedstream.h"
 #include "common/debug.h"
 #include "common/endian.h"
 #include "common/macresman.h"
@@ -84,7 +85,7 @@ bool QuickTimeParser::parseFile(const String &filename) {
 		delete _fd;
 	}
 
-	_fd = _resFork->getDataFork();
+	_fd = wrapFileHandle(_resFork->getDataFork());
 	atom.size = _fd->size();
 
 	if (readDefault(atom) < 0 || !_foundMOOV)
@@ -95,7 +96,9 @@ bool QuickTimeParser::parseFile(const String &filename) {
 }
 
 bool QuickTimeParser::parseStream(SeekableReadStream *stream, DisposeAfterUse::Flag disposeFileHandle) {
-	_fd = stream;
+	// A stream still used by the caller is left alone, the cache would not
+	// notice the caller moving its position.
+	_fd = (disposeFileHandle == DisposeAfterUse::YES) ? wrapFileHandle(stream) : stream;
 	_foundMOOV = false;
 	_disposeFileHandle = disposeFileHandle;
 
@@ -110,6 +113,14 @@ bool QuickTimeParser::parseStream(SeekableReadStream *stream, DisposeAfterUse::F
 	return true;
 }
 
+SeekableReadStream *QuickTimeParser::wrapFileHandle(SeekableReadStream *stream) {
+	// Atoms are parsed with many small reads and seeks, and the samples of
+	// the tracks are read alternately from different places in the file.
+	// Keep some blocks of the file around, so most of these reads are
+	// served from memory.
+	return wrapCachedSeekableReadStream(stream, 4096, 8, DisposeAfterUse::YES);
+}
+
 void QuickTimeParser::init() {
 	for (uint32 i = 0; i < _tracks.size(); i++) {
 		// Remove unknown/unhandled tracks
@@ -189,6 +189,7 @@ private:
 	bool _foundMOOV;
 
 	void initParseTable();
+	SeekableReadStream *wrapFileHandle(SeekableReadStream *stream);
 
 	int readDefault(Atom atom);
 	int readLeaf(Atom atom);
@@ -398,6 +398,19 @@
 	#endif
 #endif
 
+//
+// Thread local storage. OSystem has no thread API, so this is the only way
+// to keep data per thread. Left undefined where the compiler does not
+// support it, code using it must keep working without.
+//
+#ifndef SCUMMVM_THREAD_LOCAL
+	#if defined(_MSC_VER)
+		#define SCUMMVM_THREAD_LOCAL __declspec(thread)
+	#elif defined(__GNUC__)
+		#define SCUMMVM_THREAD_LOCAL __thread
+	#endif
+#endif
+
 #ifndef STRINGBUFLEN
 	#if defined(__N64__) || defined(__DS__) || defined(__3DS__)
 		#define STRINGBUFLEN 256
@@ -0,0 +1,52 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SIMD_H
+#define COMMON_SIMD_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * Detection of the SIMD instruction sets which every CPU of the target
+ * architecture supports, so they can be used without checking the CPU at
+ * runtime: SSE2 on x86-64, and NEON on AArch64. 32 bit targets get them
+ * when the compiler is told to use them (e.g. with -msse2 or -mfpu=neon).
+ *
+ * Code using them defines SCUMMVM_SSE2 resp. SCUMMVM_NEON, and has to keep
+ * a plain C version for all other targets, which the SIMD version must
+ * match bit for bit.
+ */
+
+#if !defined(DISABLE_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCUMMVM_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SCUMMVM_NEON
+#include <arm_neon.h>
+#endif
+
+#endif
+
+#endif
@@ -29,6 +29,10 @@
 #include "common/scummsys.h"
 #include "common/type-traits.h"
 
+#ifdef CXXTEST_RUNNING
+class SpanTestSuite;
+#endif
+
 namespace Common {
 
 #define COMMON_SPAN_TYPEDEFS \
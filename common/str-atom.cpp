@@ -0,0 +1,70 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/str-atom.h"
+#include "common/hash-str.h"
+
+namespace Common {
+
+namespace {
+
+struct AtomTable {
+	typedef HashMap<String, const void *, CaseSensitiveString_Hash, CaseSensitiveString_EqualTo> Map;
+	Map _atoms;
+};
+
+// The table is never destroyed, so atoms stay valid even in the
+// destructors of other static objects.
+AtomTable *g_atomTable = 0;
+
+} // End of anonymous namespace
+
+StringAtom::StringAtom() : _data(intern("")) {
+}
+
+StringAtom::StringAtom(const char *str) : _data(intern(str)) {
+}
+
+StringAtom::StringAtom(const String &str) : _data(intern(str.c_str())) {
+}
+
+const StringAtom::Data *StringAtom::intern(const char *str) {
+	if (!g_atomTable)
+		g_atomTable = new AtomTable();
+
+	AtomTable::Map::const_iterator entry = g_atomTable->_atoms.find(str);
+	if (entry != g_atomTable->_atoms.end())
+		return (const Data *)entry->_value;
+
+	Data *data = new Data();
+	data->_str = str;
+	data->_hash = hashit(str);
+	data->_hashLower = hashit_lower(str);
+	g_atomTable->_atoms[data->_str] = data;
+	return data;
+}
+
+uint StringAtom::getInternedCount() {
+	return g_atomTable ? g_atomTable->_atoms.size() : 0;
+}
+
+} // End of namespace Common
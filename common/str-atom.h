@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_STR_ATOM_H
+#define COMMON_STR_ATOM_H
+
+#include "common/scummsys.h"
+#include "common/func.h"
+#include "common/str.h"
+
+namespace Common {
+
+/**
+ * An interned, immutable string.
+ *
+ * All atoms created from equal strings share a single copy of the string,
+ * so comparing two atoms is a pointer comparison, and their hashes are
+ * computed only once, when the string is first interned. This makes atoms
+ * well suited as keys for HashMaps which are looked up frequently.
+ *
+ * Interned strings are never freed, so atoms should only be created from a
+ * limited set of strings, like configuration keys or resource names, and
+ * not from arbitrary user input. Interning is not thread safe.
+ */
+class StringAtom {
+public:
+	/** Create an atom for the empty string. */
+	StringAtom();
+	explicit StringAtom(const char *str);
+	explicit StringAtom(const String &str);
+
+	const String &toString() const { return _data->_str; }
+	const char *c_str() const { return _data->_str.c_str(); }
+	uint size() const { return _data->_str.size(); }
+	bool empty() const { return _data->_str.empty(); }
+
+	/** The hash of the string, as computed by hashit(). */
+	uint hash() const { return _data->_hash; }
+	/** The hash of the lowercase version of the string, as computed by hashit_lower(). */
+	uint hashLowercase() const { return _data->_hashLower; }
+
+	bool operator==(const StringAtom &x) const { return _data == x._data; }
+	bool operator!=(const StringAtom &x) const { return _data != x._data; }
+
+	/** Return the number of distinct strings interned so far. */
+	static uint getInternedCount();
+
+private:
+	struct Data {
+		String _str;
+		uint _hash;
+		uint _hashLower;
+	};
+
+	static const Data *intern(const char *str);
+
+	const Data *_data;
+};
+
+template<>
+struct Hash<StringAtom> {
+	uint operator()(const StringAtom &x) const { return x.hash(); }
+};
+
+} // End of namespace Common
+
+#endif
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/bufferedstream.h"
 #include "common/ptr.h"
 #include "common/stream.h"
 #include "common/memstream.h"
@@ -62,17 +63,23 @@ Common::String ReadStream::readPascalString(bool transformCR) {
 }
 
 uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
-	// Read at most as many bytes as are still available...
+	const byte *data = borrow(dataSize);
+	memcpy(dataPtr, data, dataSize);
+	return dataSize;
+}
+
+const byte *MemoryReadStream::borrow(uint32 &dataSize) {
+	// Borrow at most as many bytes as are still available...
 	if (dataSize > _size - _pos) {
 		dataSize = _size - _pos;
 		_eos = true;
 	}
-	memcpy(dataPtr, _ptr, dataSize);
+	const byte *data = _ptr;
 
 	_ptr += dataSize;
 	_pos += dataSize;
 
-	return dataSize;
+	return data;
 }
 
 bool MemoryReadStream::seek(int32 offs, int whence) {
@@ -464,6 +471,194 @@ SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStr
 
 #pragma mark -
 
+CachedSeekableReadStream::CachedSeekableReadStream(SeekableReadStream *parentStream, uint32 blockSize, uint numBlocks, DisposeAfterUse::Flag disposeParentStream)
+	: _parentStream(parentStream, disposeParentStream),
+	_blockSize(blockSize),
+	_numBlocks(numBlocks),
+	_peekBuffer(0),
+	_nextBlock(0),
+	_nextSequential(0),
+	_eos(false) {
+
+	assert(parentStream);
+	assert(blockSize > 0 && numBlocks > 0);
+
+	_data = new byte[blockSize * numBlocks];
+	_blockOffset = new int32[numBlocks];
+	_blockLength = new uint32[numBlocks];
+	for (uint i = 0; i < numBlocks; ++i) {
+		_blockOffset[i] = kEmptyBlock;
+		_blockLength[i] = 0;
+	}
+
+	_pos = _parentPos = parentStream->pos();
+	_size = parentStream->size();
+
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+CachedSeekableReadStream::~CachedSeekableReadStream() {
+	delete[] _data;
+	delete[] _blockOffset;
+	delete[] _blockLength;
+	delete[] _peekBuffer;
+}
+
+int CachedSeekableReadStream::findBlock(int32 offset) const {
+	for (uint i = 0; i < _numBlocks; ++i) {
+		if (_blockOffset[i] != kEmptyBlock && offset >= _blockOffset[i] && (uint32)(offset - _blockOffset[i]) < _blockLength[i])
+			return i;
+	}
+	return -1;
+}
+
+int CachedSeekableReadStream::fetchBlocks(int32 offset) {
+	const int32 start = offset - offset % _blockSize;
+
+	// Continuing where the last fetch ended means the data is read
+	// sequentially, so read ahead half the cache at once. Blocks are
+	// replaced in order, so the blocks of a fetch are contiguous and
+	// a single read from the parent stream fills them all.
+	uint count = (start == _nextSequential) ? MAX<uint>(1, _numBlocks / 2) : 1;
+	count = MIN<uint>(count, (_size - start + _blockSize - 1) / _blockSize);
+	if (_nextBlock + count > _numBlocks)
+		_nextBlock = 0;
+
+	if (_parentPos != start) {
+		_stats.parentSeeks++;
+		if (!_parentStream->seek(start))
+			return -1;
+	}
+
+	const uint32 length = _parentStream->read(_data + _nextBlock * _blockSize, count * _blockSize);
+	_stats.parentReads++;
+	_parentPos = start + length;
+	if (!length)
+		return -1;
+
+	for (uint i = 0; i < count; ++i) {
+		const uint block = _nextBlock + i;
+		if (i * _blockSize < length) {
+			_blockOffset[block] = start + i * _blockSize;
+			_blockLength[block] = MIN(_blockSize, length - i * _blockSize);
+		} else {
+			_blockOffset[block] = kEmptyBlock;
+		}
+	}
+
+	const int result = _nextBlock;
+	_nextBlock = (_nextBlock + count) % _numBlocks;
+	_nextSequential = start + count * _blockSize;
+	return result;
+}
+
+uint32 CachedSeekableReadStream::read(void *dataPtr, uint32 dataSize) {
+	byte *dst = (byte *)dataPtr;
+	uint32 alreadyRead = 0;
+
+	while (alreadyRead < dataSize && _pos < _size) {
+		int block = findBlock(_pos);
+		if (block < 0) {
+			_stats.misses++;
+
+			// Requests spanning several blocks are satisfied directly,
+			// there is little point in copying them through the cache.
+			if (dataSize - alreadyRead >= 2 * _blockSize) {
+				if (_parentPos != _pos) {
+					_stats.parentSeeks++;
+					_parentStream->seek(_pos);
+				}
+				const uint32 n = _parentStream->read(dst + alreadyRead, dataSize - alreadyRead);
+				_stats.parentReads++;
+				_pos += n;
+				_parentPos = _pos;
+				alreadyRead += n;
+				break;
+			}
+
+			block = fetchBlocks(_pos);
+			if (block < 0)
+				break;
+		} else {
+			_stats.hits++;
+		}
+
+		const uint32 offsetInBlock = _pos - _blockOffset[block];
+		const uint32 n = MIN(dataSize - alreadyRead, _blockLength[block] - offsetInBlock);
+		memcpy(dst + alreadyRead, _data + block * _blockSize + offsetInBlock, n);
+		_pos += n;
+		alreadyRead += n;
+	}
+
+	if (alreadyRead < dataSize)
+		_eos = true;
+	return alreadyRead;
+}
+
+bool CachedSeekableReadStream::seek(int32 offset, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offset += _size;
+		break;
+	case SEEK_CUR:
+		offset += _pos;
+		break;
+	default:
+		break;
+	}
+
+	// Like fseek(), seeking past the end is allowed, reads will then
+	// just hit the end of the stream.
+	if (offset < 0)
+		return false;
+
+	// Only the position changes here, the parent stream is sought
+	// once data which is not cached has to be read.
+	_pos = offset;
+	_eos = false;
+	return true;
+}
+
+Span<const byte> CachedSeekableReadStream::peek(uint32 size) {
+	assert(size <= _blockSize);
+	if (_pos >= _size)
+		return Span<const byte>();
+	size = MIN<uint32>(size, _size - _pos);
+
+	int block = findBlock(_pos);
+	if (block < 0) {
+		_stats.misses++;
+		block = fetchBlocks(_pos);
+		if (block < 0)
+			return Span<const byte>();
+	} else {
+		_stats.hits++;
+	}
+
+	const uint32 offsetInBlock = _pos - _blockOffset[block];
+	if (_blockLength[block] - offsetInBlock >= size)
+		return Span<const byte>(_data + block * _blockSize + offsetInBlock, size);
+
+	// The data crosses a block boundary, so it has to be copied
+	if (!_peekBuffer)
+		_peekBuffer = new byte[_blockSize];
+
+	const int32 oldPos = _pos;
+	const bool oldEos = _eos;
+	const uint32 n = read(_peekBuffer, size);
+	_pos = oldPos;
+	_eos = oldEos;
+	return Span<const byte>(_peekBuffer, n);
+}
+
+SeekableReadStream *wrapCachedSeekableReadStream(SeekableReadStream *parentStream, uint32 blockSize, uint numBlocks, DisposeAfterUse::Flag disposeParentStream) {
+	if (parentStream)
+		return new CachedSeekableReadStream(parentStream, blockSize, numBlocks, disposeParentStream);
+	return 0;
+}
+
+#pragma mark -
+
 namespace {
 
 /**
@@ -30,6 +30,7 @@
 namespace Common {
 
 class SeekableReadStream;
+class DirectReadAccess;
 
 /**
  * Virtual base class for both ReadStream and WriteStream.
@@ -557,6 +558,51 @@ public:
 	 * @param startOffset	shift the shown offsets by the starting offset (default: 0)
 	 */
 	void hexdump(int len, int bytesPerLine = 16, int startOffset = 0);
+
+	/**
+	 * Query whether the data of this stream can be accessed in place.
+	 * @return the DirectReadAccess interface of this stream, or 0 if it
+	 *         has none
+	 */
+	virtual DirectReadAccess *getDirectAccess() { return 0; }
+};
+
+/**
+ * Extension interface of a SeekableReadStream whose whole data lies in
+ * memory, for example a file mapped into memory. Readers which can work
+ * on the data in place get it with SeekableReadStream::getDirectAccess(),
+ * instead of copying it with read().
+ */
+class DirectReadAccess {
+public:
+	/** Hints on how the data is going to be accessed. */
+	enum AccessPattern {
+		kAccessNormal,
+		kAccessSequential,
+		kAccessRandom
+	};
+
+	virtual ~DirectReadAccess() {}
+
+	/**
+	 * Borrow up to dataSize bytes at the current position of the stream
+	 * without copying them, and advance the position past them. The
+	 * returned data stays valid as long as the stream exists. Like read(),
+	 * this sets the end-of-stream status when less than dataSize bytes are
+	 * left.
+	 *
+	 * @param dataSize	the number of bytes wanted, set to the number of
+	 *                  bytes borrowed
+	 * @return a pointer to the borrowed bytes
+	 */
+	virtual const byte *borrow(uint32 &dataSize) = 0;
+
+	/**
+	 * Tell how the rest of the data is going to be read, so the data can
+	 * be brought into memory accordingly. This does not change what is
+	 * read.
+	 */
+	virtual void setAccessPattern(AccessPattern pattern) {}
 };
 
 /**
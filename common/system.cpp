@@ -141,7 +141,7 @@ Common::WriteStream *OSystem::createConfigWriteStream() {
 	return 0;
 #else
 	Common::FSNode file(getDefaultConfigFileName());
-	return file.createWriteStream();
+	return file.createAtomicWriteStream();
 #endif
 }
 
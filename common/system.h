@@ -1261,6 +1261,9 @@ public:
 	 * WriteStream instance. It is the callers responsiblity to delete
 	 * the stream after use.
 	 *
+	 * The default implementation uses FSNode::createAtomicWriteStream(),
+	 * so the file may only be replaced in finalize().
+	 *
 	 * May return 0 to indicate that writing to config file is not possible.
 	 */
 	virtual Common::WriteStream *createConfigWriteStream();
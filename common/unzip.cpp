@@ -106,9 +106,14 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/zlib.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/textconsole.h"
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
 /* like the STRICT of WIN32, we define a pointer that cannot be converted
@@ -378,10 +383,24 @@ typedef struct {
 typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
 	Common::IgnoreCase_EqualTo> ZipHash;
 
+/* the io structure of the zipfile, shared with open member streams. These
+   may be read from other threads, e.g. the mixer, so every seek and read
+   has to hold the mutex
+*/
+struct ZipArchiveStream {
+	Common::SeekableReadStream *stream;
+	Common::Mutex mutex;
+
+	ZipArchiveStream(Common::SeekableReadStream *s) : stream(s) {}
+	~ZipArchiveStream() { delete stream; }
+};
+
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<ZipArchiveStream> _streamRef;	/* owns _stream, shared with
+													open member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -600,6 +619,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		return NULL;
 	}
 
+	us->_streamRef = Common::SharedPtr<ZipArchiveStream>(new ZipArchiveStream(stream));
 	us->byte_before_the_zipfile = central_pos -
 		                    (us->offset_central_dir+us->size_central_dir);
 	us->central_pos = central_pos;
@@ -644,7 +664,7 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
+	// The zipfile stream is deleted together with the last member stream
 	delete s;
 	return UNZ_OK;
 }
@@ -1453,6 +1473,95 @@ public:
 };
 */
 
+/**
+ * The compressed data of a single archive member. Keeps the archive's
+ * stream alive, so member streams may outlive their ZipArchive, and locks
+ * it for every access, so members may be read from several threads.
+ */
+class ZipMemberDataStream : public SafeSeekableSubReadStream {
+public:
+	ZipMemberDataStream(const SharedPtr<ZipArchiveStream> &archiveStream, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(archiveStream->stream, begin, end, DisposeAfterUse::NO), _archiveStream(archiveStream) {
+	}
+
+	virtual bool seek(int32 offset, int whence = SEEK_SET) {
+		StackLock lock(_archiveStream->mutex);
+		return SafeSeekableSubReadStream::seek(offset, whence);
+	}
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		StackLock lock(_archiveStream->mutex);
+		return SafeSeekableSubReadStream::read(dataPtr, dataSize);
+	}
+
+private:
+	SharedPtr<ZipArchiveStream> _archiveStream;
+};
+
+/**
+ * The compressed data of a single member of an archive whose data lies in
+ * memory, read in place. Keeps the archive's stream alive, like
+ * ZipMemberDataStream, but needs no locking, as it never touches that
+ * stream again.
+ */
+class ZipMemberMemoryStream : public MemoryReadStream {
+public:
+	ZipMemberMemoryStream(const SharedPtr<ZipArchiveStream> &archiveStream, const byte *data, uint32 size)
+		: MemoryReadStream(data, size), _archiveStream(archiveStream) {
+	}
+
+private:
+	SharedPtr<ZipArchiveStream> _archiveStream;
+};
+
+#ifdef USE_ZLIB
+/**
+ * Verifies the CRC of a member once all of its data has been read, like
+ * unzCloseCurrentFile() does. Reads after seeking elsewhere are not
+ * checked, until reading continues where the check left off.
+ */
+class ZipMemberCrcStream : public SeekableReadStream {
+public:
+	ZipMemberCrcStream(SeekableReadStream *stream, const String &name, uint32 crc)
+		: _stream(stream), _name(name), _expectedCrc(crc), _crc(0), _checked(0), _crcError(false) {
+	}
+
+	~ZipMemberCrcStream() {
+		delete _stream;
+	}
+
+	virtual bool err() const { return _crcError || _stream->err(); }
+	virtual void clearErr() { _stream->clearErr(); }
+	virtual bool eos() const { return _stream->eos(); }
+	virtual int32 pos() const { return _stream->pos(); }
+	virtual int32 size() const { return _stream->size(); }
+	virtual bool seek(int32 offset, int whence = SEEK_SET) { return _stream->seek(offset, whence); }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		const bool checked = (uint32)_stream->pos() == _checked;
+		const uint32 len = _stream->read(dataPtr, dataSize);
+		if (!checked || !len)
+			return len;
+
+		_crc = crc32(_crc, (const Bytef *)dataPtr, len);
+		_checked += len;
+		if (_checked == (uint32)_stream->size() && _crc != _expectedCrc) {
+			warning("ZipArchive: CRC mismatch in '%s'", _name.c_str());
+			_crcError = true;
+		}
+		return len;
+	}
+
+private:
+	SeekableReadStream *_stream;
+	String _name;
+	uLong _expectedCrc;
+	uLong _crc;
+	uint32 _checked;
+	bool _crcError;
+};
+#endif
+
 ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
 	assert(_zipFile);
 }
@@ -1462,6 +1571,7 @@ ZipArchive::~ZipArchive() {
 }
 
 bool ZipArchive::hasFile(const String &name) const {
+	StackLock lock(((unz_s *)_zipFile)->_streamRef->mutex);
 	return (unzLocateFile(_zipFile, name.c_str(), 2) == UNZ_OK);
 }
 
@@ -1486,35 +1596,60 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	StackLock lock(((unz_s *)_zipFile)->_streamRef->mutex);
+
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
-		return 0;
+	unz_s *const archive = (unz_s *)_zipFile;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
+	uInt sizeVar;
+	uLong offsetLocalExtrafield;
+	uInt sizeLocalExtrafield;
+	if (unzlocal_CheckCurrentFileCoherencyHeader(archive, &sizeVar, &offsetLocalExtrafield, &sizeLocalExtrafield) != UNZ_OK)
 		return 0;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
-
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return 0;
+	const unz_file_info &fileInfo = archive->cur_file_info;
+	const uint32 begin = archive->byte_before_the_zipfile +
+		archive->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + sizeVar;
+	const uint32 end = begin + fileInfo.compressed_size;
+
+	// Every member stream reads from its own window into the archive and
+	// keeps its own inflate state, so any number of members can be used
+	// independently at the same time. Nothing is decompressed up front.
+	// When the archive lies in memory, e.g. a file mapped into memory, the
+	// window is read in place.
+	SeekableReadStream *data = 0;
+	DirectReadAccess *direct = archive->_stream->getDirectAccess();
+	if (direct && archive->_stream->seek(begin)) {
+		uint32 size = end - begin;
+		const byte *compressed = direct->borrow(size);
+		if (size == end - begin)
+			data = new ZipMemberMemoryStream(archive->_streamRef, compressed, size);
+		archive->_stream->clearErr();
 	}
-
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
-		return 0;
+	if (!data)
+		data = new ZipMemberDataStream(archive->_streamRef, begin, end);
+
+	switch (fileInfo.compression_method) {
+	case 0:
+		break;
+	case Z_DEFLATED:
+		data = wrapDeflateReadStream(data, fileInfo.uncompressed_size);
+		break;
+	default:
+		delete data;
+		data = 0;
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
+#ifdef USE_ZLIB
+	// Only verify the CRC when zlib is linked in, because otherwise crc32()
+	// is not available
+	if (data)
+		data = new ZipMemberCrcStream(data, name, fileInfo.crc);
+#endif
 
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	return data;
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -1522,7 +1657,9 @@ Archive *makeZipArchive(const String &name) {
 }
 
 Archive *makeZipArchive(const FSNode &node) {
-	return makeZipArchive(node.createReadStream());
+	// Archives opened from a node are data files, like themes, which are
+	// read from all over the place and do not change while they are open
+	return makeZipArchive(node.createMappedReadStream());
 }
 
 Archive *makeZipArchive(SeekableReadStream *stream) {
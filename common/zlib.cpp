@@ -159,22 +159,38 @@ protected:
 	byte	_buf[BUFSIZE];
 
 	ScopedPtr<SeekableReadStream> _wrapped;
+	// Set if the wrapped data lies in memory, it is inflated in place then
+	DirectReadAccess *_direct;
 	z_stream _stream;
 	int _zlibErr;
 	uint32 _pos;
 	uint32 _origSize;
 	bool _eos;
+	bool _rawDeflate;
 
 public:
+	/** Format of the wrapped data */
+	enum Format {
+		kFormatZlib,		///< gzip or zlib data, told apart by their header
+		kFormatRawDeflate	///< Deflate data without any header, as stored in ZIP archives
+	};
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
+	/**
+	 * Create a decompressing stream. Raw deflate data carries no length,
+	 * so knownSize must be the size of the uncompressed data for it.
+	 */
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0, Format format = kFormatZlib) :
+			_wrapped(w), _direct(w ? w->getDirectAccess() : 0), _stream(), _rawDeflate(format == kFormatRawDeflate) {
 		assert(w != 0);
 
-		// Verify file header is correct
 		w->seek(0, SEEK_SET);
-		uint16 header = w->readUint16BE();
-		assert(header == 0x1F8B ||
-		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+		uint16 header = 0;
+		if (!_rawDeflate) {
+			// Verify file header is correct
+			header = w->readUint16BE();
+			assert(header == 0x1F8B ||
+			       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+		}
 
 		if (header == 0x1F8B) {
 			// Retrieve the original file size
@@ -189,12 +205,17 @@ public:
 		w->seek(0, SEEK_SET);
 		_eos = false;
 
-		// Adding 32 to windowBits indicates to zlib that it is supposed to
-		// automatically detect whether gzip or zlib headers are used for
-		// the compressed file. This feature was added in zlib 1.2.0.4,
-		// released 10 August 2003.
-		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		if (_rawDeflate) {
+			// Negative windowBits tell zlib there is no header at all
+			_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		} else {
+			// Adding 32 to windowBits indicates to zlib that it is supposed to
+			// automatically detect whether gzip or zlib headers are used for
+			// the compressed file. This feature was added in zlib 1.2.0.4,
+			// released 10 August 2003.
+			// Note: This is *crucial* for savegame compatibility, do *not* remove!
+			_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		}
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -214,6 +235,14 @@ public:
 	}
 
 	uint32 read(void *dataPtr, uint32 dataSize) {
+		// Raw deflate data has no trailer telling zlib where the data ends,
+		// so never ask for more than we know is there.
+		bool pastEnd = false;
+		if (_rawDeflate && dataSize > _origSize - _pos) {
+			dataSize = _origSize - _pos;
+			pastEnd = true;
+		}
+
 		_stream.next_out = (byte *)dataPtr;
 		_stream.avail_out = dataSize;
 
@@ -221,8 +250,14 @@ public:
 		while (_zlibErr == Z_OK && _stream.avail_out) {
 			if (_stream.avail_in == 0 && !_wrapped->eos()) {
 				// If we are out of input data: Read more data, if available.
-				_stream.next_in = _buf;
-				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
+				if (_direct) {
+					uint32 size = _wrapped->size() - _wrapped->pos();
+					_stream.next_in = const_cast<byte *>(_direct->borrow(size));
+					_stream.avail_in = size;
+				} else {
+					_stream.next_in = _buf;
+					_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
+				}
 			}
 			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
 		}
@@ -230,7 +265,7 @@ public:
 		// Update the position counter
 		_pos += dataSize - _stream.avail_out;
 
-		if (_zlibErr == Z_STREAM_END && _stream.avail_out > 0)
+		if ((_zlibErr == Z_STREAM_END && _stream.avail_out > 0) || pastEnd)
 			_eos = true;
 
 		return dataSize - _stream.avail_out;
@@ -292,7 +327,8 @@ public:
 		// huge amounts of data, but usually client code will only skip a few
 		// bytes, so this should be fine.
 		byte tmpBuf[1024];
-		while (!err() && offset > 0) {
+		_eos = false;
+		while (!err() && !_eos && offset > 0) {
 			offset -= read(tmpBuf, MIN((int32)sizeof(tmpBuf), offset));
 		}
 
@@ -432,6 +468,18 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize) {
+	if (!toBeWrapped)
+		return NULL;
+
+#if defined(USE_ZLIB)
+	return new GZipReadStream(toBeWrapped, uncompressedSize, GZipReadStream::kFormatRawDeflate);
+#else
+	delete toBeWrapped;
+	return NULL;
+#endif
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
@@ -121,6 +121,24 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
  */
 SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
 
+/**
+ * Take an arbitrary SeekableReadStream containing raw deflate data, i.e.
+ * compressed data without any zlib or gzip header as stored in ZIP archives,
+ * and wrap it in a custom stream which decompresses it on demand. Only a
+ * small input buffer and the inflate window are kept in memory, independent
+ * of the size of the data. Backward seeking restarts decompression from the
+ * beginning of the data, so it should be avoided where possible.
+ * The created stream also becomes responsible for freeing the passed stream.
+ * If there is no ZLIB support, NULL is returned and the stream is destroyed.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param toBeWrapped		the stream containing the compressed data
+ * @param uncompressedSize	the size of the uncompressed data
+ */
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
  * transparent on-the-fly compression. The compressed data is written in the
@@ -33,6 +33,15 @@
 #include "engines/advancedDetector.h"
 #include "engines/obsolete.h"
 
+/**
+ * File properties computed during the current detection scan, keyed by
+ * path and the number of bytes hashed.
+ */
+typedef Common::HashMap<Common::String, ADFileProperties> ADFilePropertiesCache;
+static ADFilePropertiesCache *s_filePropertiesCache = 0;
+static uint s_detectionScans = 0;
+static uint s_filePropertiesCacheHits = 0;
+
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
 	const char *title = 0;
 	const char *extra;
@@ -403,13 +412,21 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	// file and as one with resource fork.
 
 	if (game.flags & ADGF_MACRESFORK) {
-		Common::MacResManager macResMan;
+		// Mac resource forks are cached with size 0 if there is none
+		const Common::String key = Common::String::format("%s/%s:resfork:%u", parent.getPath().c_str(), fname.c_str(), _md5Bytes);
 
-		if (!macResMan.open(parent, fname))
-			return false;
+		if (!lookupFileProperties(key, fileProps)) {
+			Common::MacResManager macResMan;
+
+			if (macResMan.open(parent, fname)) {
+				fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
+				fileProps.size = macResMan.getResForkDataSize();
+			} else {
+				fileProps.size = 0;
+			}
 
-		fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
-		fileProps.size = macResMan.getResForkDataSize();
+			storeFileProperties(key, fileProps);
+		}
 
 		if (fileProps.size != 0)
 			return true;
@@ -418,16 +435,57 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode &node = allFiles[fname];
+	const Common::String key = Common::String::format("%s:%u", node.getPath().c_str(), _md5Bytes);
+	if (lookupFileProperties(key, fileProps))
+		return true;
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
 	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	storeFileProperties(key, fileProps);
+	return true;
+}
+
+bool AdvancedMetaEngine::lookupFileProperties(const Common::String &key, ADFileProperties &fileProps) {
+	if (!s_filePropertiesCache)
+		return false;
+
+	ADFilePropertiesCache::const_iterator entry = s_filePropertiesCache->find(key);
+	if (entry == s_filePropertiesCache->end())
+		return false;
+
+	fileProps = entry->_value;
+	s_filePropertiesCacheHits++;
 	return true;
 }
 
+void AdvancedMetaEngine::storeFileProperties(const Common::String &key, const ADFileProperties &fileProps) {
+	if (s_filePropertiesCache)
+		(*s_filePropertiesCache)[key] = fileProps;
+}
+
+void AdvancedMetaEngine::beginDetectionScan() {
+	if (s_detectionScans++ == 0) {
+		s_filePropertiesCache = new ADFilePropertiesCache();
+		s_filePropertiesCacheHits = 0;
+	}
+}
+
+void AdvancedMetaEngine::endDetectionScan() {
+	assert(s_detectionScans > 0);
+
+	if (--s_detectionScans == 0) {
+		debug(3, "Detection scan done: %u files hashed, %u cache hits", s_filePropertiesCache->size(), s_filePropertiesCacheHits);
+		delete s_filePropertiesCache;
+		s_filePropertiesCache = 0;
+	}
+}
+
 ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, const FileMap &allFiles, Common::Language language, Common::Platform platform, const Common::String &extra) const {
 	ADFilePropertiesMap filesProps;
 
@@ -284,6 +284,22 @@ public:
 
 	virtual const ExtraGuiOptions getExtraGuiOptions(const Common::String &target) const;
 
+	/**
+	 * Mark the start of a detection scan. Until the matching call to
+	 * endDetectionScan(), the sizes and MD5 sums of all files looked at by
+	 * any AdvancedMetaEngine are cached, so files which are checked by
+	 * several engines are only read once. Scans may be nested.
+	 */
+	static void beginDetectionScan();
+
+	/**
+	 * Mark the end of a detection scan. The file cache is dropped when the
+	 * outermost scan ends, so it only lasts for one call of
+	 * EngineManager::detectGames(). Files may change between scans, and
+	 * FSNode has no modification time to tell whether they did.
+	 */
+	static void endDetectionScan();
+
 protected:
 	// To be implemented by subclasses
 	virtual bool createInstance(OSystem *syst, Engine **engine, const ADGameDescription *desc) const = 0;
@@ -346,6 +362,10 @@ protected:
 
 	/** Get the properties (size and MD5) of this file. */
 	bool getFileProperties(const Common::FSNode &parent, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, ADFileProperties &fileProps) const;
+
+private:
+	static bool lookupFileProperties(const Common::String &key, ADFileProperties &fileProps);
+	static void storeFileProperties(const Common::String &key, const ADFileProperties &fileProps);
 };
 
 #endif
@@ -310,7 +310,7 @@ void MidiPlayer::send(uint32 b) {
 		}
 
 		// Send directly to Accolade/Miles/Simon1 Audio driver
-		_driver->send(b);
+		_driver->sendDelayed(b, _sendDelay);
 		return;
 	}
 
@@ -356,7 +356,7 @@ void MidiPlayer::send(uint32 b) {
 			else if (_current == &_music)
 				_current->channel[9]->volume(_current->volume[9] * _musicVolume / 255);
 		}
-		_current->channel[channel]->send(b);
+		_current->channel[channel]->sendDelayed(b, _sendDelay);
 		if ((b & 0xFFF0) == 0x79B0) {
 			// We have received a "Reset All Controllers" message
 			// and passed it on to the MIDI driver. This may or may
@@ -59,7 +59,7 @@ struct MusicInfo {
 	}
 };
 
-class MidiPlayer : public MidiDriver_BASE {
+class MidiPlayer : public MidiDriver_Filter {
 protected:
 	Common::Mutex _mutex;
 	MidiDriver *_driver;
@@ -288,7 +288,7 @@ void MusicPlayerMidi::send(uint32 b) {
 		return;
 	}
 	if (_driver)
-		_driver->send(b);
+		_driver->sendDelayed(b, _sendDelay);
 }
 
 void MusicPlayerMidi::metaEvent(byte type, byte *data, uint16 length) {
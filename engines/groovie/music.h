@@ -91,7 +91,7 @@ protected:
 	virtual void unload();
 };
 
-class MusicPlayerMidi : public MusicPlayer, public MidiDriver_BASE {
+class MusicPlayerMidi : public MusicPlayer, public MidiDriver_Filter {
 public:
 	MusicPlayerMidi(GroovieEngine *vm);
 	~MusicPlayerMidi();
@@ -247,13 +247,12 @@ public:
 	// MidiDriver interface
 	virtual void close() {}
 
-	virtual void send(uint32 data);
-
 	virtual MidiChannel *allocateChannel() { return 0; }
 	virtual MidiChannel *getPercussionChannel() { return 0; }
 
 	// MidiDriver_Emulated interface
 	void generateSamples(int16 *buffer, int numSamples);
+	void playEvent(uint32 data);
 
 	// AudioStream interface
 	bool isStereo() const { return false; }
@@ -51,7 +51,7 @@ MidiDriver_PCSpeaker::~MidiDriver_PCSpeaker() {
 	_speaker = 0;
 }
 
-void MidiDriver_PCSpeaker::send(uint32 data) {
+void MidiDriver_PCSpeaker::playEvent(uint32 data) {
 	Common::StackLock lock(_mutex);
 
 	uint8 channel = data & 0x0F;
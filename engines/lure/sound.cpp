@@ -703,7 +703,7 @@ void MidiMusic::send(uint32 b) {
 		// No implementation
 	}
 
-	_channels[channel].midiChannel->send(b);
+	_channels[channel].midiChannel->sendDelayed(b, _sendDelay);
 }
 
 void MidiMusic::metaEvent(byte type, byte *data, uint16 length) {
@@ -45,7 +45,7 @@ struct ChannelEntry {
 	uint8 volume;
 };
 
-class MidiMusic: public MidiDriver_BASE {
+class MidiMusic: public MidiDriver_Filter {
 private:
 	uint8 _soundNumber;
 	uint8 _channelNumber;
@@ -160,7 +160,7 @@ void MidiMusic::queueClear() {
 
 void MidiMusic::send(uint32 b) {
 	if (_adlib) {
-		_driver->send(b);
+		_driver->sendDelayed(b, _sendDelay);
 		return;
 	}
 
@@ -192,7 +192,7 @@ void MidiMusic::send(uint32 b) {
 		_channelsTable[channel] = (channel == 9) ? _driver->getPercussionChannel() : _driver->allocateChannel();
 
 	if (_channelsTable[channel])
-		_channelsTable[channel]->send(b);
+		_channelsTable[channel]->sendDelayed(b, _sendDelay);
 }
 
 void MidiMusic::metaEvent(byte type, byte *data, uint16 length) {
@@ -36,7 +36,7 @@ struct TuneData;
 
 class QueenEngine;
 
-class MidiMusic : public MidiDriver_BASE {
+class MidiMusic : public MidiDriver_Filter {
 public:
 	MidiMusic(QueenEngine *vm);
 	~MidiMusic();
@@ -22,6 +22,7 @@
 
 // Resource library
 
+#include "common/bufferedstream.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
@@ -1751,6 +1752,9 @@ int ResourceManager::readResourceMapSCI0(ResourceSource *map) {
 		fileStream = file;
 	}
 
+	// Map entries are read a few bytes at a time, keep the file in blocks
+	fileStream = Common::wrapCachedSeekableReadStream(fileStream, 4096, 8, DisposeAfterUse::YES);
+
 	fileStream->seek(0, SEEK_SET);
 
 	byte bMask = (_mapVersion >= kResVersionSci1Middle) ? 0xF0 : 0xFC;
@@ -1827,6 +1831,9 @@ int ResourceManager::readResourceMapSCI1(ResourceSource *map) {
 		fileStream = file;
 	}
 
+	// Map entries are read a few bytes at a time, keep the file in blocks
+	fileStream = Common::wrapCachedSeekableReadStream(fileStream, 4096, 8, DisposeAfterUse::YES);
+
 	resource_index_t resMap[32];
 	memset(resMap, 0, sizeof(resource_index_t) * 32);
 	byte type = 0, prevtype = 0;
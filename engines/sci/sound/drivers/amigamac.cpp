@@ -46,7 +46,7 @@ public:
 	// MidiDriver
 	int open();
 	void close();
-	void send(uint32 b);
+	void playEvent(uint32 b);
 	MidiChannel *allocateChannel() { return NULL; }
 	MidiChannel *getPercussionChannel() { return NULL; }
 
@@ -649,7 +649,7 @@ void MidiDriver_AmigaMac::setVolume(byte volume_) {
 	_masterVolume = volume_;
 }
 
-void MidiDriver_AmigaMac::send(uint32 b) {
+void MidiDriver_AmigaMac::playEvent(uint32 b) {
 	byte command = b & 0xf0;
 	byte channel = b & 0xf;
 	byte op1 = (b >> 8) & 0xff;
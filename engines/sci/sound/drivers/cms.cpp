@@ -45,7 +45,7 @@ public:
 	int open();
 	void close();
 
-	void send(uint32 b);
+	void playEvent(uint32 b);
 	uint32 property(int prop, uint32 param);
 
 	MidiChannel *allocateChannel() { return 0; }
@@ -223,7 +223,7 @@ void MidiDriver_CMS::close() {
 	_cms = nullptr;
 }
 
-void MidiDriver_CMS::send(uint32 b) {
+void MidiDriver_CMS::playEvent(uint32 b) {
 	const uint8 command = b & 0xf0;
 	const uint8 channel = b & 0xf;
 	const uint8 op1 = (b >> 8) & 0xff;
@@ -72,7 +72,7 @@ public:
 	// MidiDriver
 	int open() { return open(kMaxChannels); }
 	void close();
-	void send(uint32 b);
+	void playEvent(uint32 b);
 	MidiChannel *allocateChannel() { return NULL; }
 	MidiChannel *getPercussionChannel() { return NULL; }
 
@@ -95,7 +95,7 @@ private:
 	int _chan_nrs[kMaxChannels];
 };
 
-void MidiDriver_PCJr::send(uint32 b) {
+void MidiDriver_PCJr::playEvent(uint32 b) {
 	byte command = b & 0xff;
 	byte op1 = (b >> 8) & 0xff;
 	byte op2 = (b >> 16) & 0xff;
@@ -107,7 +107,7 @@ void MacM68kDriver::close() {
 	_mixBufferLength = 0;
 }
 
-void MacM68kDriver::send(uint32 d) {
+void MacM68kDriver::playEvent(uint32 d) {
 	assert(false);
 }
 
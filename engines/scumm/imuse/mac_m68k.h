@@ -42,7 +42,7 @@ public:
 	virtual int open();
 	virtual void close();
 
-	virtual void send(uint32 d);
+	virtual void playEvent(uint32 d);
 	virtual void sysEx_customInstrument(byte channel, uint32 type, const byte *instr);
 
 	virtual MidiChannel *allocateChannel();
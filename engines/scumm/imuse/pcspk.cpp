@@ -68,7 +68,7 @@ void PcSpkDriver::close() {
 	_mixer->stopHandle(_mixerSoundHandle);
 }
 
-void PcSpkDriver::send(uint32 d) {
+void PcSpkDriver::playEvent(uint32 d) {
 	assert((d & 0x0F) < 6);
 	_channels[(d & 0x0F)].send(d);
 }
@@ -552,11 +552,13 @@ int ScummEngine::readVar(uint var) {
 			}
 		}
 
+		// Scripts read these variables all the time, often every frame
+		static const Common::StringAtom subtitles("subtitles");
 		if (VAR_SUBTITLES != 0xFF && var == VAR_SUBTITLES) {
-			return ConfMan.getBool("subtitles");
+			return ConfMan.getBool(subtitles);
 		}
 		if (VAR_NOSUBTITLES != 0xFF && var == VAR_NOSUBTITLES) {
-			return !ConfMan.getBool("subtitles");
+			return !ConfMan.getBool(subtitles);
 		}
 
 		assertRange(0, var, _numVariables - 1, "variable (reading)");
@@ -30,6 +30,7 @@
 #include "audio/decoders/vorbis.h"
 #include "audio/decoders/raw.h"
 #include "audio/audiostream.h"
+#include "audio/decoded_sound_cache.h"
 
 #include "touche/midi.h"
 #include "touche/touche.h"
@@ -590,14 +591,20 @@ void ToucheEngine::res_loadSound(int priority, int num) {
 	if (priority >= 0) {
 		uint32 size;
 		const uint32 offs = res_getDataOffset(kResourceTypeSound, num, &size);
-		Common::SeekableReadStream *datastream = SearchMan.createReadStreamForMember("TOUCHE.DAT");
-		if (!datastream) {
-			warning("res_loadSound: Could not open TOUCHE.DAT");
-			return;
-		}
 
-		datastream->seek(offs);
-		Audio::AudioStream *stream = Audio::makeVOCStream(datastream, Audio::FLAG_UNSIGNED, DisposeAfterUse::YES);
+		// The same few sound effects are played over and over, so keep
+		// them decoded rather than reopening and decoding them every time
+		Audio::SeekableAudioStream *stream = DecodedSounds.getStream("TOUCHE.DAT", offs);
+		if (!stream) {
+			Common::SeekableReadStream *datastream = SearchMan.createReadStreamForMember("TOUCHE.DAT");
+			if (!datastream) {
+				warning("res_loadSound: Could not open TOUCHE.DAT");
+				return;
+			}
+
+			datastream->seek(offs);
+			stream = DecodedSounds.cacheStream("TOUCHE.DAT", offs, Audio::makeVOCStream(datastream, Audio::FLAG_UNSIGNED, DisposeAfterUse::YES));
+		}
 		if (stream) {
 			_mixer->playStream(Audio::Mixer::kSFXSoundType, &_sfxHandle, stream);
 		}
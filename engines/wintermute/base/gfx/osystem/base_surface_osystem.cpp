@@ -32,6 +32,7 @@
 #include "engines/wintermute/base/gfx/osystem/base_render_osystem.h"
 #include "engines/wintermute/base/gfx/base_image.h"
 #include "engines/wintermute/platform_osystem.h"
+#include "graphics/transform_cache.h"
 #include "graphics/transparent_surface.h"
 #include "graphics/transform_tools.h"
 #include "graphics/pixelformat.h"
@@ -50,11 +51,13 @@ BaseSurfaceOSystem::BaseSurfaceOSystem(BaseGame *inGame) : BaseSurface(inGame) {
 	_lockPitch = 0;
 	_loaded = false;
 	_rotation = 0;
+	_generation = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////
 BaseSurfaceOSystem::~BaseSurfaceOSystem() {
 	if (_surface) {
+		TransformCacheMan.invalidate(*_surface);
 		_surface->free();
 		delete _surface;
 		_surface = nullptr;
@@ -146,6 +149,7 @@ bool BaseSurfaceOSystem::finishLoad() {
 		// FIBITMAP *newImg = FreeImage_ConvertToGreyscale(img); TODO
 	}
 
+	TransformCacheMan.invalidate(*_surface);
 	_surface->free();
 	delete _surface;
 
@@ -317,6 +321,7 @@ bool BaseSurfaceOSystem::startPixelOp() {
 	// Any pixel-op makes the caching useless:
 	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
+	_generation++;
 	return STATUS_OK;
 }
 
@@ -447,7 +452,9 @@ bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAl
 		const byte *src = (const byte *)surface.getBasePtr(0, 0);
 		byte *dst = (byte *)_surface->getBasePtr(0, 0);
 		memcpy(dst, src, surface.pitch * surface.h);
+		_generation++;
 	} else {
+		TransformCacheMan.invalidate(*_surface);
 		_surface->free();
 		_surface->copyFrom(surface);
 	}
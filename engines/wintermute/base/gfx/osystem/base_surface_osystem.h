@@ -83,8 +83,11 @@ public:
 	}
 
 	Graphics::AlphaType getAlphaType() const { return _alphaType; }
+	/** Changes whenever the pixels are modified in place. */
+	uint32 getGeneration() const { return _generation; }
 private:
 	Graphics::Surface *_surface;
+	uint32 _generation;
 	bool _loaded;
 	bool finishLoad();
 	bool drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect, Graphics::TransformStruct transformStruct);
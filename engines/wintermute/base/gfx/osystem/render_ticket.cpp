@@ -30,11 +30,16 @@
 #include "engines/wintermute/base/base_game.h"
 #include "engines/wintermute/base/gfx/osystem/render_ticket.h"
 #include "engines/wintermute/base/gfx/osystem/base_surface_osystem.h"
+#include "graphics/transform_cache.h"
 #include "graphics/transform_tools.h"
 #include "common/textconsole.h"
 
 namespace Wintermute {
 
+static Graphics::TFilteringMode getFilteringMode(BaseSurfaceOSystem *owner) {
+	return owner->_gameRef->getBilinearFiltering() ? Graphics::FILTER_BILINEAR : Graphics::FILTER_NEAREST;
+}
+
 RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform) :
 	_owner(owner),
 	_srcRect(*srcRect),
@@ -43,14 +48,7 @@ RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *s
 	_wantsDraw(true),
 	_transform(transform) {
 	if (surf) {
-		_surface = new Graphics::Surface();
-		_surface->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
-		assert(_surface->format.bytesPerPixel == 4);
-		// Get a clipped copy of the surface
-		for (int i = 0; i < _surface->h; i++) {
-			memcpy(_surface->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * _surface->format.bytesPerPixel);
-		}
-		// Then scale it if necessary
+		// Scale it if necessary
 		//
 		// NB: The numTimesX/numTimesY properties don't yet mix well with
 		// scaling and rotation, but there is no need for that functionality at
@@ -58,30 +56,30 @@ RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *s
 		// NB: Mirroring and rotation are probably done in the wrong order.
 		// (Mirroring should most likely be done before rotation. See also
 		// TransformTools.)
+		//
+		// The same sprites get drawn with the same transformation over and
+		// over, so the transformed surfaces are cached. The owner bumps its
+		// generation whenever its pixels change, and drops the cached
+		// surfaces when it frees them.
+		const Graphics::TransparentSurface *transformed = nullptr;
 		if (_transform._angle != Graphics::kDefaultAngle) {
-			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp;
-			if (owner->_gameRef->getBilinearFiltering()) {
-				temp = src.rotoscaleT<Graphics::FILTER_BILINEAR>(transform);
-			} else {
-				temp = src.rotoscaleT<Graphics::FILTER_NEAREST>(transform);
-			}
-			_surface->free();
-			delete _surface;
-			_surface = temp;
+			transformed = TransformCacheMan.rotoscale(surf->getSubArea(*srcRect), owner->getGeneration(), transform, getFilteringMode(owner));
 		} else if ((dstRect->width() != srcRect->width() ||
 					dstRect->height() != srcRect->height()) &&
 					_transform._numTimesX * _transform._numTimesY == 1) {
-			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp;
-			if (owner->_gameRef->getBilinearFiltering()) {
-				temp = src.scaleT<Graphics::FILTER_BILINEAR>(dstRect->width(), dstRect->height());
-			} else {
-				temp = src.scaleT<Graphics::FILTER_NEAREST>(dstRect->width(), dstRect->height());
+			transformed = TransformCacheMan.scale(surf->getSubArea(*srcRect), owner->getGeneration(), dstRect->width(), dstRect->height(), getFilteringMode(owner));
+		}
+
+		_surface = new Graphics::Surface();
+		if (transformed) {
+			_surface->copyFrom(*transformed);
+		} else {
+			_surface->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
+			assert(_surface->format.bytesPerPixel == 4);
+			// Get a clipped copy of the surface
+			for (int i = 0; i < _surface->h; i++) {
+				memcpy(_surface->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * _surface->format.bytesPerPixel);
 			}
-			_surface->free();
-			delete _surface;
-			_surface = temp;
 		}
 	} else {
 		_surface = nullptr;
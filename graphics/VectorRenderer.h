@@ -279,6 +279,21 @@ public:
 	 */
 	virtual void setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) = 0;
 
+	/** The colors set by the methods above, which steps not setting their own inherit. */
+	enum StateColor {
+		kStateColorForeground,
+		kStateColorBackground,
+		kStateColorBevel,
+		kStateColorGradientStart,
+		kStateColorGradientEnd,
+		kStateColorCount
+	};
+
+	/**
+	 * Get one of the active colors, in the format of the surface.
+	 */
+	virtual uint32 getStateColor(StateColor color) const = 0;
+
 	/**
 	 * Sets the active drawing surface. All drawing from this
 	 * point on will be done on that surface.
@@ -289,6 +304,13 @@ public:
 		_activeSurface = surface;
 	}
 
+	/**
+	 * Returns the active drawing surface.
+	 */
+	TransparentSurface *getSurface() const {
+		return _activeSurface;
+	}
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -451,6 +473,12 @@ public:
 	virtual void drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra = 0);
 	virtual void drawStepClip(const Common::Rect &area, const Common::Rect &clip, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets the colors and options of a draw step, as drawing it would,
+	 * without drawing anything.
+	 */
+	void setStepState(const DrawStep &step, uint32 extra = 0);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -515,6 +543,7 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool areShadowsDisabled() const { return _disableShadows; }
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
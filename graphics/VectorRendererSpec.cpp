@@ -23,6 +23,7 @@
 #include "common/util.h"
 #include "common/system.h"
 #include "common/frac.h"
+#include "common/simd.h"
 
 #include "graphics/surface.h"
 #include "graphics/transparent_surface.h"
@@ -425,6 +426,291 @@ inline frac_t fp_sqroot(uint32 x) {
 
 namespace Graphics {
 
+/**
+ * Fills several pixels in a row with two alternating colors, as the dithering
+ * of gradients does.
+ *
+ * @param first Pointer to the first pixel to fill.
+ * @param last Pointer to the last pixel to fill.
+ * @param color1 Color of the first pixel, and every other one after it
+ * @param color2 Color of the second pixel, and every other one after it
+ */
+template<typename PixelType>
+void ditherFill(PixelType *first, PixelType *last, PixelType color1, PixelType color2) {
+	while (last - first >= 2) {
+		*first++ = color1;
+		*first++ = color2;
+	}
+
+	if (first < last)
+		*first = color1;
+}
+
+#if defined(SCUMMVM_SSE2)
+
+/**
+ * Fill 16 bytes at a time the way ditherFill() does, and leave the remaining
+ * pixels to it.
+ */
+template<typename PixelType>
+void ditherFill_SSE2(PixelType *first, PixelType *last, PixelType color1, PixelType color2) {
+	const int step = 16 / sizeof(PixelType);
+	__m128i colors;
+	if (sizeof(PixelType) == 2)
+		colors = _mm_set1_epi32(color1 | ((uint32)color2 << 16));
+	else
+		colors = _mm_set_epi32(color2, color1, color2, color1);
+
+	while (last - first >= step) {
+		_mm_storeu_si128((__m128i *)first, colors);
+		first += step;
+	}
+
+	ditherFill<PixelType>(first, last, color1, color2);
+}
+
+/**
+ * Blend 16 bytes at a time the way VectorRendererSpec::blendPixelPtr() does
+ * with alpha values below 255, and return the first pixel left to it.
+ *
+ * Each color channel is dst + (((src - dst) * alpha) >> 8), which is the
+ * same as (dst * (256 - alpha) + src * alpha) >> 8 without negative
+ * intermediates, and fits in 16 bits.
+ */
+template<typename PixelType>
+PixelType *blendFill_SSE2(PixelType *first, PixelType *last, PixelType color, uint8 alpha, const PixelFormat &format) {
+	const int step = 16 / sizeof(PixelType);
+	const __m128i inv = _mm_set1_epi16(256 - alpha);
+	const __m128i zero = _mm_setzero_si128();
+	const PixelType alphaMask = (0xFF >> format.aLoss) << format.aShift;
+
+	if (sizeof(PixelType) == 2) {
+		// Every channel on its own, which works for all formats
+		const int shifts[4] = { format.rShift, format.gShift, format.bShift, format.aShift };
+		const int losses[4] = { format.rLoss, format.gLoss, format.bLoss, format.aLoss };
+		__m128i shift[4], mask[4], src[4];
+		int channels = 0;
+		for (int i = 0; i < 4; ++i) {
+			if (losses[i] == 8)
+				continue;
+
+			const int channelMask = 0xFF >> losses[i];
+			// The alpha channel is blended towards opaque
+			const int value = (i == 3) ? channelMask : (color >> shifts[i]) & channelMask;
+			shift[channels] = _mm_cvtsi32_si128(shifts[i]);
+			mask[channels] = _mm_set1_epi16(channelMask);
+			src[channels] = _mm_set1_epi16(value * alpha);
+			channels++;
+		}
+
+		while (last - first >= step) {
+			const __m128i dst = _mm_loadu_si128((const __m128i *)first);
+			__m128i blended = zero;
+			for (int i = 0; i < channels; ++i) {
+				__m128i c = _mm_and_si128(_mm_srl_epi16(dst, shift[i]), mask[i]);
+				c = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(c, inv), src[i]), 8);
+				blended = _mm_or_si128(blended, _mm_sll_epi16(c, shift[i]));
+			}
+			_mm_storeu_si128((__m128i *)first, blended);
+			first += step;
+		}
+	} else {
+		// Byte sized channels are blended one byte at a time
+		if (format.rLoss || format.gLoss || format.bLoss || (format.aLoss && format.aLoss != 8) ||
+		    (format.rShift | format.gShift | format.bShift | (alphaMask ? format.aShift : 0)) & 7)
+			return first;
+
+		const __m128i mask = _mm_set1_epi32((0xFFU << format.rShift) | (0xFFU << format.gShift) | (0xFFU << format.bShift) | alphaMask);
+		const __m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32(color | alphaMask), zero), _mm_set1_epi16(alpha));
+
+		while (last - first >= step) {
+			const __m128i dst = _mm_loadu_si128((const __m128i *)first);
+			__m128i lo = _mm_unpacklo_epi8(dst, zero);
+			__m128i hi = _mm_unpackhi_epi8(dst, zero);
+			lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, inv), src), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, inv), src), 8);
+			_mm_storeu_si128((__m128i *)first, _mm_and_si128(_mm_packus_epi16(lo, hi), mask));
+			first += step;
+		}
+	}
+
+	return first;
+}
+
+/**
+ * Darken 16 bytes at a time the way VectorRendererSpec::darkenFill() does,
+ * and return the first pixel left to it. The alpha bits are either combined
+ * with the darkened colors, or added to them.
+ */
+template<typename PixelType>
+PixelType *darkenFill_SSE2(PixelType *first, PixelType *last, PixelType keep, PixelType alpha, bool addAlpha) {
+	const int step = 16 / sizeof(PixelType);
+
+	if (sizeof(PixelType) == 2) {
+		const __m128i keepMask = _mm_set1_epi16(keep);
+		const __m128i alphaBits = _mm_set1_epi16(alpha);
+		while (last - first >= step) {
+			__m128i c = _mm_srli_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i *)first), keepMask), 2);
+			c = addAlpha ? _mm_add_epi16(c, alphaBits) : _mm_or_si128(c, alphaBits);
+			_mm_storeu_si128((__m128i *)first, c);
+			first += step;
+		}
+	} else {
+		const __m128i keepMask = _mm_set1_epi32(keep);
+		const __m128i alphaBits = _mm_set1_epi32(alpha);
+		while (last - first >= step) {
+			__m128i c = _mm_srli_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i *)first), keepMask), 2);
+			c = addAlpha ? _mm_add_epi32(c, alphaBits) : _mm_or_si128(c, alphaBits);
+			_mm_storeu_si128((__m128i *)first, c);
+			first += step;
+		}
+	}
+
+	return first;
+}
+
+#define ditherFill_SIMD ditherFill_SSE2
+#define blendFill_SIMD blendFill_SSE2
+#define darkenFill_SIMD darkenFill_SSE2
+
+#elif defined(SCUMMVM_NEON)
+
+/**
+ * Fill 16 bytes at a time the way ditherFill() does, and leave the remaining
+ * pixels to it.
+ */
+template<typename PixelType>
+void ditherFill_NEON(PixelType *first, PixelType *last, PixelType color1, PixelType color2) {
+	const int step = 16 / sizeof(PixelType);
+	PixelType pattern[16 / sizeof(PixelType)];
+	ditherFill<PixelType>(pattern, pattern + step, color1, color2);
+	const uint8x16_t colors = vld1q_u8((const uint8 *)pattern);
+
+	while (last - first >= step) {
+		vst1q_u8((uint8 *)first, colors);
+		first += step;
+	}
+
+	ditherFill<PixelType>(first, last, color1, color2);
+}
+
+/**
+ * Blend 16 bytes at a time the way VectorRendererSpec::blendPixelPtr() does
+ * with alpha values below 255, and return the first pixel left to it.
+ *
+ * Each color channel is dst + (((src - dst) * alpha) >> 8), which is the
+ * same as (dst * (256 - alpha) + src * alpha) >> 8 without negative
+ * intermediates, and fits in 16 bits.
+ */
+template<typename PixelType>
+PixelType *blendFill_NEON(PixelType *first, PixelType *last, PixelType color, uint8 alpha, const PixelFormat &format) {
+	const int step = 16 / sizeof(PixelType);
+	const PixelType alphaMask = (0xFF >> format.aLoss) << format.aShift;
+
+	if (sizeof(PixelType) == 2) {
+		// Every channel on its own, which works for all formats
+		const int shifts[4] = { format.rShift, format.gShift, format.bShift, format.aShift };
+		const int losses[4] = { format.rLoss, format.gLoss, format.bLoss, format.aLoss };
+		const uint16x8_t inv = vdupq_n_u16(256 - alpha);
+		// Shifting by a negative count shifts to the right
+		int16x8_t shiftRight[4], shiftLeft[4];
+		uint16x8_t mask[4], src[4];
+		int channels = 0;
+		for (int i = 0; i < 4; ++i) {
+			if (losses[i] == 8)
+				continue;
+
+			const int channelMask = 0xFF >> losses[i];
+			// The alpha channel is blended towards opaque
+			const int value = (i == 3) ? channelMask : (color >> shifts[i]) & channelMask;
+			shiftRight[channels] = vdupq_n_s16(-shifts[i]);
+			shiftLeft[channels] = vdupq_n_s16(shifts[i]);
+			mask[channels] = vdupq_n_u16(channelMask);
+			src[channels] = vdupq_n_u16(value * alpha);
+			channels++;
+		}
+
+		while (last - first >= step) {
+			const uint16x8_t dst = vld1q_u16((const uint16 *)first);
+			uint16x8_t blended = vdupq_n_u16(0);
+			for (int i = 0; i < channels; ++i) {
+				uint16x8_t c = vandq_u16(vshlq_u16(dst, shiftRight[i]), mask[i]);
+				c = vshrq_n_u16(vmlaq_u16(src[i], c, inv), 8);
+				blended = vorrq_u16(blended, vshlq_u16(c, shiftLeft[i]));
+			}
+			vst1q_u16((uint16 *)first, blended);
+			first += step;
+		}
+	} else {
+		// Byte sized channels are blended one byte at a time
+		if (format.rLoss || format.gLoss || format.bLoss || (format.aLoss && format.aLoss != 8) ||
+		    (format.rShift | format.gShift | format.bShift | (alphaMask ? format.aShift : 0)) & 7)
+			return first;
+
+		const uint32 pixelMask = (0xFFU << format.rShift) | (0xFFU << format.gShift) | (0xFFU << format.bShift) | alphaMask;
+		const uint32 masks[4] = { pixelMask, pixelMask, pixelMask, pixelMask };
+		const uint32 colors[4] = { color | alphaMask, color | alphaMask, color | alphaMask, color | alphaMask };
+		const uint8x16_t mask = vld1q_u8((const uint8 *)masks);
+		const uint8x16_t src = vld1q_u8((const uint8 *)colors);
+		// 256 - alpha does not fit in 8 bits, so dst * (256 - alpha) is
+		// dst * (255 - alpha) + dst
+		const uint8x8_t inv = vdup_n_u8(255 - alpha);
+		const uint8x8_t a = vdup_n_u8(alpha);
+
+		while (last - first >= step) {
+			const uint8x16_t dst = vld1q_u8((const uint8 *)first);
+			uint16x8_t lo = vaddw_u8(vmlal_u8(vmull_u8(vget_low_u8(src), a), vget_low_u8(dst), inv), vget_low_u8(dst));
+			uint16x8_t hi = vaddw_u8(vmlal_u8(vmull_u8(vget_high_u8(src), a), vget_high_u8(dst), inv), vget_high_u8(dst));
+			vst1q_u8((uint8 *)first, vandq_u8(vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)), mask));
+			first += step;
+		}
+	}
+
+	return first;
+}
+
+/**
+ * Darken 16 bytes at a time the way VectorRendererSpec::darkenFill() does,
+ * and return the first pixel left to it. The alpha bits are either combined
+ * with the darkened colors, or added to them.
+ */
+template<typename PixelType>
+PixelType *darkenFill_NEON(PixelType *first, PixelType *last, PixelType keep, PixelType alpha, bool addAlpha) {
+	const int step = 16 / sizeof(PixelType);
+
+	if (sizeof(PixelType) == 2) {
+		const uint16x8_t keepMask = vdupq_n_u16(keep);
+		const uint16x8_t alphaBits = vdupq_n_u16(alpha);
+		while (last - first >= step) {
+			uint16x8_t c = vshrq_n_u16(vandq_u16(vld1q_u16((const uint16 *)first), keepMask), 2);
+			c = addAlpha ? vaddq_u16(c, alphaBits) : vorrq_u16(c, alphaBits);
+			vst1q_u16((uint16 *)first, c);
+			first += step;
+		}
+	} else {
+		const uint32x4_t keepMask = vdupq_n_u32(keep);
+		const uint32x4_t alphaBits = vdupq_n_u32(alpha);
+		while (last - first >= step) {
+			uint32x4_t c = vshrq_n_u32(vandq_u32(vld1q_u32((const uint32 *)first), keepMask), 2);
+			c = addAlpha ? vaddq_u32(c, alphaBits) : vorrq_u32(c, alphaBits);
+			vst1q_u32((uint32 *)first, c);
+			first += step;
+		}
+	}
+
+	return first;
+}
+
+#define ditherFill_SIMD ditherFill_NEON
+#define blendFill_SIMD blendFill_NEON
+#define darkenFill_SIMD darkenFill_NEON
+
+#else
+
+#define ditherFill_SIMD ditherFill
+
+#endif
+
 /**
  * Fills several pixels in a row with a given color.
  *
@@ -446,6 +732,14 @@ void colorFill(PixelType *first, PixelType *last, PixelType color) {
 	register int count = (last - first);
 	if (!count)
 		return;
+
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+	if (count >= 16 / (int)sizeof(PixelType)) {
+		ditherFill_SIMD<PixelType>(first, last, color, color);
+		return;
+	}
+#endif
+
 	register int n = (count + 7) >> 3;
 	switch (count % 8) {
 	case 0: do {
@@ -482,22 +776,7 @@ void colorFillClip(PixelType *first, PixelType *last, PixelType color, int realX
 		count -= diff;
 	}
 
-	if (!count)
-		return;
-
-	register int n = (count + 7) >> 3;
-	switch (count % 8) {
-	case 0: do {
-		*first++ = color;	// fall through
-	case 7:		*first++ = color;	// fall through
-	case 6:		*first++ = color;	// fall through
-	case 5:		*first++ = color;	// fall through
-	case 4:		*first++ = color;	// fall through
-	case 3:		*first++ = color;	// fall through
-	case 2:		*first++ = color;	// fall through
-	case 1:		*first++ = color;
-	} while (--n > 0);
-	}
+	colorFill<PixelType>(first, first + count, color);
 }
 
 
@@ -563,6 +842,25 @@ setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) {
 	}
 }
 
+template<typename PixelType>
+uint32 VectorRendererSpec<PixelType>::
+getStateColor(StateColor color) const {
+	switch (color) {
+	case kStateColorForeground:
+		return _fgColor;
+	case kStateColorBackground:
+		return _bgColor;
+	case kStateColorBevel:
+		return _bevelColor;
+	case kStateColorGradientStart:
+		return _gradientStart;
+	case kStateColorGradientEnd:
+		return _gradientEnd;
+	default:
+		return 0;
+	}
+}
+
 template<typename PixelType>
 inline PixelType VectorRendererSpec<PixelType>::
 calcGradient(uint32 pos, uint32 max) {
@@ -601,6 +899,19 @@ precalcGradient(int h) {
 	}
 }
 
+template<typename PixelType>
+inline void VectorRendererSpec<PixelType>::
+ditherColors(PixelType *colors, int curGrad, int grad, bool ox) {
+	for (int oy = 0; oy < 2; oy++) {
+		if ((ox && oy) ||
+			((grad == 2 || grad == 3) && ox && !oy) ||
+			(grad == 3 && oy))
+			colors[oy] = _gradCache[curGrad + 1];
+		else
+			colors[oy] = _gradCache[curGrad];
+	}
+}
+
 template<typename PixelType>
 void VectorRendererSpec<PixelType>::
 gradientFill(PixelType *ptr, int width, int x, int y) {
@@ -629,16 +940,9 @@ gradientFill(PixelType *ptr, int width, int x, int y) {
 	} else if (grad == 3 && ox) {
 		colorFill<PixelType>(ptr, ptr + width, _gradCache[curGrad + 1]);
 	} else {
-		for (int j = x; j < x + width; j++, ptr++) {
-			bool oy = ((j & 1) == 1);
-
-			if ((ox && oy) ||
-				((grad == 2 || grad == 3) && ox && !oy) ||
-				(grad == 3 && oy))
-				*ptr = _gradCache[curGrad + 1];
-			else
-				*ptr = _gradCache[curGrad];
-		}
+		PixelType colors[2];
+		ditherColors(colors, curGrad, grad, ox);
+		ditherFill_SIMD<PixelType>(ptr, ptr + width, colors[x & 1], colors[(x + 1) & 1]);
 	}
 }
 
@@ -671,17 +975,11 @@ gradientFillClip(PixelType *ptr, int width, int x, int y, int realX, int realY)
 	} else if (grad == 3 && ox) {
 		colorFill<PixelType>(ptr, ptr + width, _gradCache[curGrad + 1]);
 	} else {
-		for (int j = x; j < x + width; j++, ptr++) {
-			if (realX + j - x < _clippingArea.left || realX + j - x >= _clippingArea.right) continue;
-			bool oy = ((j & 1) == 1);
-
-			if ((ox && oy) ||
-				((grad == 2 || grad == 3) && ox && !oy) ||
-				(grad == 3 && oy))
-				*ptr = _gradCache[curGrad + 1];
-			else
-				*ptr = _gradCache[curGrad];
-		}
+		const int start = CLIP<int>(_clippingArea.left - realX, 0, MAX(width, 0));
+		const int end = CLIP<int>(_clippingArea.right - realX, start, MAX(width, 0));
+		PixelType colors[2];
+		ditherColors(colors, curGrad, grad, ox);
+		ditherFill_SIMD<PixelType>(ptr + start, ptr + end, colors[(x + start) & 1], colors[(x + start + 1) & 1]);
 	}
 }
 
@@ -1062,6 +1360,23 @@ blendPixelPtrClip(PixelType *ptr, PixelType color, uint8 alpha, int x, int y) {
 		blendPixelPtr(ptr, color, alpha);
 }
 
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha) {
+	if (alpha == 0xff) {
+		// fully opaque pixels, don't blend
+		colorFill<PixelType>(first, last, color | _alphaMask);
+		return;
+	}
+
+#ifdef blendFill_SIMD
+	first = blendFill_SIMD<PixelType>(first, last, color, alpha, _format);
+#endif
+
+	while (first != last)
+		blendPixelPtr(first++, color, alpha);
+}
+
 template<typename PixelType>
 inline void VectorRendererSpec<PixelType>::
 blendPixelDestAlphaPtr(PixelType *ptr, PixelType color, uint8 alpha) {
@@ -1087,6 +1402,10 @@ darkenFill(PixelType *ptr, PixelType *end) {
 	if (!g_system->hasFeature(OSystem::kFeatureOverlaySupportsAlpha)) {
 		// !kFeatureOverlaySupportsAlpha (but might have alpha bits)
 
+#ifdef darkenFill_SIMD
+		ptr = darkenFill_SIMD<PixelType>(ptr, end, ~mask, _alphaMask, false);
+#endif
+
 		while (ptr != end) {
 			*ptr = ((*ptr & ~mask) >> 2) | _alphaMask;
 			++ptr;
@@ -1098,6 +1417,10 @@ darkenFill(PixelType *ptr, PixelType *end) {
 		mask |= 3 << _format.aShift;
 		PixelType addA = (PixelType)(3 << (_format.aShift + 6 - _format.aLoss));
 
+#ifdef darkenFill_SIMD
+		ptr = darkenFill_SIMD<PixelType>(ptr, end, ~mask, addA, true);
+#endif
+
 		while (ptr != end) {
 			// Darken the color, and increase the alpha
 			// (0% -> 75%, 100% -> 100%)
@@ -1110,31 +1433,12 @@ darkenFill(PixelType *ptr, PixelType *end) {
 template<typename PixelType>
 inline void VectorRendererSpec<PixelType>::
 darkenFillClip(PixelType *ptr, PixelType *end, int x, int y) {
-	PixelType mask = (PixelType)((3 << _format.rShift) | (3 << _format.gShift) | (3 << _format.bShift));
-
-	if (!g_system->hasFeature(OSystem::kFeatureOverlaySupportsAlpha)) {
-		// !kFeatureOverlaySupportsAlpha (but might have alpha bits)
-
-		while (ptr != end) {
-			if (IS_IN_CLIP(x, y)) *ptr = ((*ptr & ~mask) >> 2) | _alphaMask;
-			++ptr;
-			++x;
-		}
-	} else {
-		// kFeatureOverlaySupportsAlpha
-		// assuming at least 3 alpha bits
-
-		mask |= 3 << _format.aShift;
-		PixelType addA = (PixelType)(3 << (_format.aShift + 6 - _format.aLoss));
+	if (y < _clippingArea.top || y >= _clippingArea.bottom)
+		return;
 
-		while (ptr != end) {
-			// Darken the color, and increase the alpha
-			// (0% -> 75%, 100% -> 100%)
-			if (IS_IN_CLIP(x, y)) *ptr = (PixelType)(((*ptr & ~mask) >> 2) + addA);
-			++ptr;
-			++x;
-		}
-	}
+	const int start = CLIP<int>(_clippingArea.left - x, 0, end - ptr);
+	const int stop = CLIP<int>(_clippingArea.right - x, start, end - ptr);
+	darkenFill(ptr + start, ptr + stop);
 }
 
 /********************************************************************
@@ -3512,9 +3816,7 @@ drawSquareShadow(int x, int y, int w, int h, int offset) {
 	ptr = (PixelType *)_activeSurface->getBasePtr(x + offset, y + h - 1);
 
 	while (i++ < offset) {
-		j = w - offset;
-		while (j--)
-			blendPixelPtr(ptr + j, 0, ((offset - i) << 8) / offset);
+		blendFill(ptr, ptr + w - offset, 0, ((offset - i) << 8) / offset);
 		ptr += pitch;
 	}
 
@@ -3556,9 +3858,7 @@ drawSquareShadowClip(int x, int y, int w, int h, int offset) {
 	ptr_y = y + h - 1;
 
 	while (i++ < offset) {
-		j = w - offset;
-		while (j--)
-			blendPixelPtrClip(ptr + j, 0, ((offset - i) << 8) / offset, ptr_x + j, ptr_y);
+		blendFillClip(ptr, ptr + w - offset, 0, ((offset - i) << 8) / offset, ptr_x, ptr_y);
 		ptr += pitch;
 		++ptr_y;
 	}
@@ -4199,4 +4499,8 @@ drawCircleAlg(int x1, int y1, int r, PixelType color, VectorRenderer::FillMode f
 
 #endif
 
+#undef ditherFill_SIMD
+#undef blendFill_SIMD
+#undef darkenFill_SIMD
+
 }
@@ -84,6 +84,7 @@ public:
 	void setBgColor(uint8 r, uint8 g, uint8 b) { _bgColor = _format.RGBToColor(r, g, b); }
 	void setBevelColor(uint8 r, uint8 g, uint8 b) { _bevelColor = _format.RGBToColor(r, g, b); }
 	void setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2);
+	uint32 getStateColor(StateColor color) const;
 
 	void copyFrame(OSystem *sys, const Common::Rect &r);
 	void copyWholeFrame(OSystem *sys) { copyFrame(sys, Common::Rect(0, 0, _activeSurface->w, _activeSurface->h)); }
@@ -275,6 +276,11 @@ protected:
 	inline PixelType calcGradient(uint32 pos, uint32 max);
 
 	void precalcGradient(int h);
+
+	/**
+	 * Picks the colors of the even and odd columns of a dithered gradient row.
+	 */
+	inline void ditherColors(PixelType *colors, int curGrad, int grad, bool ox);
 	void gradientFill(PixelType *first, int width, int x, int y);
 	void gradientFillClip(PixelType *first, int width, int x, int y, int realX, int realY);
 
@@ -288,19 +294,13 @@ protected:
 	 * @param color Color of the pixel
 	 * @param alpha Alpha intensity of the pixel (0-255)
 	 */
-	inline void blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha) {
-		while (first != last) blendPixelPtr(first++, color, alpha);
-	}
+	void blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha);
 
 	inline void blendFillClip(PixelType *first, PixelType *last, PixelType color, uint8 alpha, int realX, int realY) {
 		if (_clippingArea.top <= realY && realY < _clippingArea.bottom) {
-			while (first != last) {
-				if (_clippingArea.left <= realX && realX < _clippingArea.right)
-					blendPixelPtr(first++, color, alpha);
-				else
-					++first;
-				++realX;
-			}
+			const int start = CLIP<int>(_clippingArea.left - realX, 0, last - first);
+			const int end = CLIP<int>(_clippingArea.right - realX, start, last - first);
+			blendFill(first + start, first + end, color, alpha);
 		}
 	}
 
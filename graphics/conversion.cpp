@@ -22,6 +22,7 @@
 
 #include "graphics/conversion.h"
 #include "graphics/pixelformat.h"
+#include "graphics/simd_colors.h"
 
 #include "common/endian.h"
 
@@ -96,6 +97,173 @@ inline void crossBlitLogic3BppSource(byte *dst, const byte *src, const uint w, c
 	}
 }
 
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+
+/**
+ * The conversion of a color done by colorToARGB() and ARGBToColor(), as
+ * masks, multiplications and shifts which are the same for every color,
+ * so SIMD code can convert several pixels at once. ColorComponent::expand()
+ * is a multiplication followed by a shift for every component size.
+ */
+struct CrossBlitComponents {
+	// Red, green, blue and alpha
+	uint32 srcShift[4], srcMask[4], mul[4], shift[4], dstShift[4];
+	// The bits set in every destination color
+	uint32 constant;
+
+	CrossBlitComponents(const PixelFormat &srcFmt, const PixelFormat &dstFmt) {
+		const byte srcShifts[4] = { srcFmt.rShift, srcFmt.gShift, srcFmt.bShift, srcFmt.aShift };
+		const byte srcBits[4] = { srcFmt.rBits(), srcFmt.gBits(), srcFmt.bBits(), srcFmt.aBits() };
+		const byte dstShifts[4] = { dstFmt.rShift, dstFmt.gShift, dstFmt.bShift, dstFmt.aShift };
+		const byte dstLosses[4] = { dstFmt.rLoss, dstFmt.gLoss, dstFmt.bLoss, dstFmt.aLoss };
+
+		for (int i = 0; i < 4; ++i) {
+			srcShift[i] = srcShifts[i];
+			srcMask[i] = (1 << srcBits[i]) - 1;
+			mul[i] = expandMul[srcBits[i]];
+			shift[i] = expandShift[srcBits[i]] + dstLosses[i];
+			dstShift[i] = dstShifts[i];
+		}
+
+		// colorToARGB() returns opaque colors for formats without alpha
+		constant = 0;
+		if (srcFmt.aBits() == 0)
+			constant = (0xFF >> dstFmt.aLoss) << dstFmt.aShift;
+	}
+};
+
+#if defined(SCUMMVM_SSE2)
+
+struct CrossBlitComponents_SSE2 {
+	__m128i srcShift[4], srcMask[4], mul[4], shift[4], dstShift[4];
+	__m128i constant;
+
+	CrossBlitComponents_SSE2(const CrossBlitComponents &components) {
+		for (int i = 0; i < 4; ++i) {
+			srcShift[i] = _mm_cvtsi32_si128(components.srcShift[i]);
+			srcMask[i] = _mm_set1_epi32(components.srcMask[i]);
+			mul[i] = _mm_set1_epi32(components.mul[i]);
+			shift[i] = _mm_cvtsi32_si128(components.shift[i]);
+			dstShift[i] = _mm_cvtsi32_si128(components.dstShift[i]);
+		}
+		constant = _mm_set1_epi32(components.constant);
+	}
+};
+
+template<int srcBpp, int dstBpp>
+inline void convertColors_SSE2(byte *dst, const byte *src, const CrossBlitComponents_SSE2 &components) {
+	const __m128i colors = loadColors_SSE2<srcBpp>(src);
+
+	// The components are at most eight bits before the multiplication, and
+	// 16 bits after it, so the high halves of the lanes stay zero
+	__m128i result = components.constant;
+	for (int i = 0; i < 4; ++i) {
+		__m128i value = _mm_and_si128(_mm_srl_epi32(colors, components.srcShift[i]), components.srcMask[i]);
+		value = _mm_srl_epi32(_mm_mullo_epi16(value, components.mul[i]), components.shift[i]);
+		result = _mm_or_si128(result, _mm_sll_epi32(value, components.dstShift[i]));
+	}
+
+	storeColors_SSE2<dstBpp>(dst, result);
+}
+
+#define CrossBlitComponents_SIMD CrossBlitComponents_SSE2
+#define convertColors_SIMD convertColors_SSE2
+
+#elif defined(SCUMMVM_NEON)
+
+struct CrossBlitComponents_NEON {
+	// Shifting by a negative count shifts to the right
+	int32x4_t srcShift[4], shift[4], dstShift[4];
+	uint32x4_t srcMask[4], mul[4];
+	uint32x4_t constant;
+
+	CrossBlitComponents_NEON(const CrossBlitComponents &components) {
+		for (int i = 0; i < 4; ++i) {
+			srcShift[i] = vdupq_n_s32(-(int32)components.srcShift[i]);
+			srcMask[i] = vdupq_n_u32(components.srcMask[i]);
+			mul[i] = vdupq_n_u32(components.mul[i]);
+			shift[i] = vdupq_n_s32(-(int32)components.shift[i]);
+			dstShift[i] = vdupq_n_s32(components.dstShift[i]);
+		}
+		constant = vdupq_n_u32(components.constant);
+	}
+};
+
+template<int srcBpp, int dstBpp>
+inline void convertColors_NEON(byte *dst, const byte *src, const CrossBlitComponents_NEON &components) {
+	const uint32x4_t colors = loadColors_NEON<srcBpp>(src);
+
+	uint32x4_t result = components.constant;
+	for (int i = 0; i < 4; ++i) {
+		uint32x4_t value = vandq_u32(vshlq_u32(colors, components.srcShift[i]), components.srcMask[i]);
+		value = vshlq_u32(vmulq_u32(value, components.mul[i]), components.shift[i]);
+		result = vorrq_u32(result, vshlq_u32(value, components.dstShift[i]));
+	}
+
+	storeColors_NEON<dstBpp>(dst, result);
+}
+
+#define CrossBlitComponents_SIMD CrossBlitComponents_NEON
+#define convertColors_SIMD convertColors_NEON
+
+#endif
+
+template<int srcBpp, int dstBpp>
+inline void convertColor(byte *dst, const byte *src, const PixelFormat &srcFmt, const PixelFormat &dstFmt) {
+	uint32 color;
+	if (srcBpp == 2)
+		color = *(const uint16 *)src;
+	else if (srcBpp == 3)
+		color = READ_UINT24(src);
+	else
+		color = *(const uint32 *)src;
+
+	byte a, r, g, b;
+	srcFmt.colorToARGB(color, a, r, g, b);
+	if (dstBpp == 2)
+		*(uint16 *)dst = dstFmt.ARGBToColor(a, r, g, b);
+	else
+		*(uint32 *)dst = dstFmt.ARGBToColor(a, r, g, b);
+}
+
+/**
+ * Convert four pixels at a time, and the rest of the rows one by one.
+ * Like crossBlitLogic(), the pixels are converted from the bottom right
+ * to the top left when going backward, which keeps the conversion in
+ * place working.
+ */
+template<int srcBpp, int dstBpp, bool backward>
+void crossBlitLogicSIMD(byte *dst, const byte *src, const uint w, const uint h,
+                        const PixelFormat &srcFmt, const PixelFormat &dstFmt,
+                        const uint srcPitch, const uint dstPitch) {
+	const CrossBlitComponents_SIMD components(CrossBlitComponents(srcFmt, dstFmt));
+
+	for (uint i = 0; i < h; ++i) {
+		const uint y = backward ? h - 1 - i : i;
+		byte *dstRow = dst + y * dstPitch;
+		const byte *srcRow = src + y * srcPitch;
+
+		if (backward) {
+			uint x = w;
+			for (; x >= 4; x -= 4)
+				convertColors_SIMD<srcBpp, dstBpp>(dstRow + (x - 4) * dstBpp, srcRow + (x - 4) * srcBpp, components);
+			while (x-- > 0)
+				convertColor<srcBpp, dstBpp>(dstRow + x * dstBpp, srcRow + x * srcBpp, srcFmt, dstFmt);
+		} else {
+			uint x = 0;
+			for (; x + 4 <= w; x += 4)
+				convertColors_SIMD<srcBpp, dstBpp>(dstRow + x * dstBpp, srcRow + x * srcBpp, components);
+			for (; x < w; ++x)
+				convertColor<srcBpp, dstBpp>(dstRow + x * dstBpp, srcRow + x * srcBpp, srcFmt, dstFmt);
+		}
+	}
+}
+
+#undef CrossBlitComponents_SIMD
+#undef convertColors_SIMD
+
+#endif
+
 } // End of anonymous namespace
 
 // Function to blit a rect from one color format to another
@@ -126,6 +294,26 @@ bool crossBlit(byte *dst, const byte *src,
 		return true;
 	}
 
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+	// The same cases as below, which explains the directions
+	if (dstFmt.bytesPerPixel == 2) {
+		if (srcFmt.bytesPerPixel == 2)
+			crossBlitLogicSIMD<2, 2, false>(dst, src, w, h, srcFmt, dstFmt, srcPitch, dstPitch);
+		else if (srcFmt.bytesPerPixel == 3)
+			crossBlitLogicSIMD<3, 2, false>(dst, src, w, h, srcFmt, dstFmt, srcPitch, dstPitch);
+		else
+			crossBlitLogicSIMD<4, 2, false>(dst, src, w, h, srcFmt, dstFmt, srcPitch, dstPitch);
+	} else if (dstFmt.bytesPerPixel == 4) {
+		if (srcFmt.bytesPerPixel == 2)
+			crossBlitLogicSIMD<2, 4, true>(dst, src, w, h, srcFmt, dstFmt, srcPitch, dstPitch);
+		else if (srcFmt.bytesPerPixel == 3)
+			crossBlitLogicSIMD<3, 4, true>(dst, src, w, h, srcFmt, dstFmt, srcPitch, dstPitch);
+		else
+			crossBlitLogicSIMD<4, 4, false>(dst, src, w, h, srcFmt, dstFmt, srcPitch, dstPitch);
+	} else {
+		return false;
+	}
+#else
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
@@ -164,6 +352,7 @@ bool crossBlit(byte *dst, const byte *src,
 	} else {
 		return false;
 	}
+#endif
 	return true;
 }
 
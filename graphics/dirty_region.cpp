@@ -0,0 +1,127 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/dirty_region.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+DirtyRegion::DirtyRegion(int tileWidth, int tileHeight)
+	: _tileWidth(tileWidth), _tileHeight(tileHeight) {
+	assert(tileWidth > 0 && tileHeight > 0);
+}
+
+void DirtyRegion::addRect(const Common::Rect &r) {
+	if (r.isEmpty() || r.left < 0 || r.top < 0)
+		return;
+
+	if (_rects.empty())
+		_bounds = r;
+	else
+		_bounds.extend(r);
+	_rects.push_back(r);
+}
+
+uint32 DirtyRegion::getArea() const {
+	uint32 area = 0;
+	for (uint i = 0; i < _rects.size(); ++i)
+		area += _rects[i].width() * _rects[i].height();
+	return area;
+}
+
+void DirtyRegion::getRects(Common::Array<Common::Rect> &rects, uint maxRects) {
+	assert(maxRects > 0);
+
+	rects.clear();
+	if (_rects.empty())
+		return;
+
+	// Doubling the tile size ends with a single tile at the latest
+	int tileWidth = _tileWidth;
+	int tileHeight = _tileHeight;
+	while (true) {
+		coalesce(rects, tileWidth, tileHeight);
+		if (rects.size() <= maxRects)
+			break;
+
+		tileWidth *= 2;
+		tileHeight *= 2;
+	}
+}
+
+void DirtyRegion::coalesce(Common::Array<Common::Rect> &rects, int tileWidth, int tileHeight) {
+	const int columns = (_bounds.right + tileWidth - 1) / tileWidth;
+	const int rows = (_bounds.bottom + tileHeight - 1) / tileHeight;
+
+	_tiles.resize(columns * rows);
+	memset(_tiles.begin(), 0, _tiles.size());
+
+	for (uint i = 0; i < _rects.size(); ++i) {
+		const Common::Rect &r = _rects[i];
+		const int left = r.left / tileWidth;
+		const int right = (r.right - 1) / tileWidth;
+
+		for (int y = r.top / tileHeight; y <= (r.bottom - 1) / tileHeight; ++y)
+			memset(&_tiles[y * columns + left], 1, right - left + 1);
+	}
+
+	// Runs of tiles extend the rects ending at the tile row above them
+	// which have the same extent. Those rects are listed sorted by their
+	// left edge, alternating between two lists.
+	rects.clear();
+	_open[0].clear();
+
+	for (int y = 0; y < rows; ++y) {
+		const byte *tiles = &_tiles[y * columns];
+		const int16 top = y * tileHeight;
+		const int16 bottom = MIN<int>(top + tileHeight, _bounds.bottom);
+		const Common::Array<uint> &open = _open[y & 1];
+		Common::Array<uint> &stillOpen = _open[(y + 1) & 1];
+		uint o = 0;
+
+		stillOpen.clear();
+		for (int x = 0; x < columns;) {
+			if (!tiles[x]) {
+				++x;
+				continue;
+			}
+
+			const int16 left = x * tileWidth;
+			while (x < columns && tiles[x])
+				++x;
+			const int16 right = MIN<int>(x * tileWidth, _bounds.right);
+
+			while (o < open.size() && rects[open[o]].left < left)
+				++o;
+
+			if (o < open.size() && rects[open[o]].left == left && rects[open[o]].right == right) {
+				rects[open[o]].bottom = bottom;
+				stillOpen.push_back(open[o]);
+			} else {
+				stillOpen.push_back(rects.size());
+				rects.push_back(Common::Rect(left, top, right, bottom));
+			}
+		}
+	}
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_REGION_H
+#define GRAPHICS_DIRTY_REGION_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * Collects any number of dirty rects and coalesces them into a short list
+ * of rects covering all of them. The rects are marked in a bitmap of tiles,
+ * and runs of dirty tiles of the same extent in successive tile rows are
+ * merged. When that still gives too many rects, the tiles are made larger.
+ *
+ * The tiles are aligned to (0, 0), so their edges stay at multiples of the
+ * tile size, and the resulting rects never extend beyond the right or
+ * bottom edge of the rects added.
+ */
+class DirtyRegion {
+public:
+	/**
+	 * @param tileWidth		the initial width of the tiles
+	 * @param tileHeight	the initial height of the tiles
+	 */
+	DirtyRegion(int tileWidth, int tileHeight);
+
+	/** Remove all rects. */
+	void clear() { _rects.clear(); }
+
+	/** Return whether no rects were added since the last clear(). */
+	bool isEmpty() const { return _rects.empty(); }
+
+	/** Add a rect. Empty rects and rects with negative coordinates are ignored. */
+	void addRect(const Common::Rect &r);
+
+	/**
+	 * Compute rects covering all rects added.
+	 *
+	 * @param rects		receives the rects
+	 * @param maxRects	the maximal number of rects, at least one
+	 */
+	void getRects(Common::Array<Common::Rect> &rects, uint maxRects);
+
+	/** Return the sum of the areas of the rects added. Overlapping parts are counted repeatedly. */
+	uint32 getArea() const;
+
+private:
+	void coalesce(Common::Array<Common::Rect> &rects, int tileWidth, int tileHeight);
+
+	int _tileWidth;
+	int _tileHeight;
+
+	Common::Array<Common::Rect> _rects;
+	Common::Rect _bounds;
+
+	Common::Array<byte> _tiles;
+	Common::Array<uint> _open[2];
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/fonts/glyph_atlas.h"
+
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+GlyphAtlas::GlyphAtlas(int pageSize, uint32 budget)
+	: _pageSize(pageSize), _budget(budget), _memoryUsage(0), _useCounter(0) {
+	_stats.pages = 0;
+	_stats.evictions = 0;
+}
+
+GlyphAtlas::~GlyphAtlas() {
+	clear();
+}
+
+GlyphAtlas::Location GlyphAtlas::allocate(int w, int h) {
+	assert(w > 0 && h > 0);
+	Location loc;
+
+	if (w <= _pageSize && h <= _pageSize) {
+		for (uint i = 0; i < _pages.size(); ++i) {
+			Page &page = _pages[i];
+			if (page.pixels && page.w == _pageSize && page.h == _pageSize && allocateOnPage(i, w, h, loc))
+				return loc;
+		}
+	}
+
+	// Bitmaps larger than a page get a page of their own
+	const int pageW = MAX(w, _pageSize);
+	const int pageH = MAX(h, _pageSize);
+	const uint32 size = pageW * pageH;
+
+	// Empty the least recently used pages until the new one fits
+	while (_memoryUsage + size > _budget) {
+		int oldest = -1;
+		for (uint i = 0; i < _pages.size(); ++i) {
+			if (_pages[i].pixels && (oldest < 0 || _pages[i].lastUse < _pages[oldest].lastUse))
+				oldest = i;
+		}
+		if (oldest < 0)
+			break;
+
+		freePage(_pages[oldest]);
+		_stats.evictions++;
+	}
+
+	int index = -1;
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (!_pages[i].pixels) {
+			index = i;
+			break;
+		}
+	}
+	if (index < 0) {
+		Page page;
+		page.pixels = nullptr;
+		page.generation = 0;
+		_pages.push_back(page);
+		index = _pages.size() - 1;
+	}
+
+	Page &page = _pages[index];
+	page.pixels = new byte[size];
+	page.w = pageW;
+	page.h = pageH;
+	page.shelfEnd = 0;
+	page.shelves.clear();
+	_memoryUsage += size;
+	_stats.pages++;
+
+	if (!allocateOnPage(index, w, h, loc))
+		error("GlyphAtlas::allocate: Could not place a %dx%d bitmap on a %dx%d page", w, h, pageW, pageH);
+	return loc;
+}
+
+bool GlyphAtlas::allocateOnPage(int index, int w, int h, Location &loc) {
+	Page &page = _pages[index];
+
+	// The flattest shelf with room for the bitmap
+	int best = -1;
+	for (uint i = 0; i < page.shelves.size(); ++i) {
+		const Shelf &shelf = page.shelves[i];
+		if (shelf.h < h || shelf.used + w > page.w)
+			continue;
+		if (best < 0 || shelf.h < page.shelves[best].h)
+			best = i;
+	}
+
+	// Open a new shelf rather than wasting most of a tall one
+	if ((best < 0 || page.shelves[best].h > h * 2) && page.shelfEnd + h <= page.h) {
+		Shelf shelf;
+		shelf.y = page.shelfEnd;
+		shelf.h = MIN((h + 3) & ~3, page.h - page.shelfEnd);
+		shelf.used = 0;
+		page.shelves.push_back(shelf);
+		page.shelfEnd += shelf.h;
+		best = page.shelves.size() - 1;
+	}
+
+	if (best < 0)
+		return false;
+
+	Shelf &shelf = page.shelves[best];
+	loc.page = index;
+	loc.generation = page.generation;
+	loc.x = shelf.used;
+	loc.y = shelf.y;
+	loc.w = w;
+	loc.h = h;
+	shelf.used += w;
+
+	byte *pixels = page.pixels + loc.y * page.w + loc.x;
+	for (int y = 0; y < h; ++y) {
+		memset(pixels, 0, w);
+		pixels += page.w;
+	}
+
+	page.lastUse = ++_useCounter;
+	return true;
+}
+
+byte *GlyphAtlas::getPixels(const Location &loc) {
+	assert(isValid(loc));
+	Page &page = _pages[loc.page];
+	page.lastUse = ++_useCounter;
+	return page.pixels + loc.y * page.w + loc.x;
+}
+
+void GlyphAtlas::freePage(Page &page) {
+	_memoryUsage -= page.w * page.h;
+	delete[] page.pixels;
+	page.pixels = nullptr;
+	page.shelves.clear();
+	// Invalidates all locations on the page
+	page.generation++;
+}
+
+void GlyphAtlas::clear() {
+	// The pages are kept, so that locations on them can still be checked
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (_pages[i].pixels)
+			freePage(_pages[i]);
+	}
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_FONTS_GLYPH_ATLAS_H
+#define GRAPHICS_FONTS_GLYPH_ATLAS_H
+
+#include "common/array.h"
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Packs the 8 bit coverage bitmaps of glyphs into a few large pages, rather
+ * than allocating a surface for each of them. Bitmaps are placed on shelves,
+ * rows of bitmaps of about the same height; bitmaps larger than a page get a
+ * page of their own.
+ *
+ * When the pages exceed the memory budget, the page used the longest time
+ * ago is emptied and reused. The bitmaps it contained are lost: their
+ * locations are no longer valid, and the owner has to render and add them
+ * again when it needs them.
+ */
+class GlyphAtlas {
+public:
+	enum {
+		kDefaultPageSize = 256,
+		kDefaultBudget = 1024 * 1024
+	};
+
+	/** Where a bitmap is stored. */
+	struct Location {
+		int page;          ///< -1 if the bitmap was never added
+		uint32 generation; ///< Changes when the page is emptied
+		uint16 x, y;
+		uint16 w, h;
+
+		Location() : page(-1), generation(0), x(0), y(0), w(0), h(0) {}
+	};
+
+	struct Stats {
+		uint32 pages;      ///< Pages created
+		uint32 evictions;  ///< Pages emptied to make room
+	};
+
+	/**
+	 * @param pageSize the width and height of the pages
+	 * @param budget   the number of bytes the pages may take up; the atlas
+	 *                 always keeps at least one page, whatever its size
+	 */
+	GlyphAtlas(int pageSize = kDefaultPageSize, uint32 budget = kDefaultBudget);
+	~GlyphAtlas();
+
+	/**
+	 * Reserve room for a bitmap. This may empty the least recently used
+	 * page, invalidating the locations of the bitmaps on it.
+	 *
+	 * The reserved pixels are cleared.
+	 */
+	Location allocate(int w, int h);
+
+	/** Check whether a bitmap is still stored at a location. */
+	bool isValid(const Location &loc) const {
+		return loc.page >= 0 && _pages[loc.page].generation == loc.generation;
+	}
+
+	/**
+	 * Get the pixels of a valid location, and mark its page as used.
+	 */
+	byte *getPixels(const Location &loc);
+
+	/** Get the pitch of the pixels returned for a location. */
+	int getPitch(const Location &loc) const { return _pages[loc.page].w; }
+
+	/** Drop all bitmaps and free the pages. */
+	void clear();
+
+	/** Get the number of bytes the pages currently take up. */
+	uint32 getMemoryUsage() const { return _memoryUsage; }
+
+	const Stats &getStats() const { return _stats; }
+
+private:
+	struct Shelf {
+		int y, h;
+		int used; ///< Width taken up by bitmaps
+	};
+
+	struct Page {
+		byte *pixels;
+		int w, h;
+		int shelfEnd; ///< The bottom of the lowest shelf
+		Common::Array<Shelf> shelves;
+		uint32 generation;
+		uint32 lastUse;
+	};
+
+	bool allocateOnPage(int index, int w, int h, Location &loc);
+	void freePage(Page &page);
+
+	Common::Array<Page> _pages;
+	int _pageSize;
+	uint32 _budget;
+	uint32 _memoryUsage;
+	uint32 _useCounter;
+	Stats _stats;
+};
+
+} // End of namespace Graphics
+
+#endif
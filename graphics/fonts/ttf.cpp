@@ -28,9 +28,12 @@
 #ifdef USE_FREETYPE2
 
 #include "graphics/fonts/ttf.h"
+#include "graphics/fonts/glyph_atlas.h"
 #include "graphics/font.h"
+#include "graphics/simd_colors.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/singleton.h"
 #include "common/stream.h"
 #include "common/memstream.h"
@@ -133,17 +136,28 @@ private:
 	int _ascent, _descent;
 
 	struct Glyph {
-		Surface image;
+		GlyphAtlas::Location image;
+		int width, height;
 		int xOffset, yOffset;
 		int advance;
 		FT_UInt slot;
 	};
 
+	// Glyphs are rendered when first used. Their bitmaps may get dropped
+	// from the atlas later on, but their metrics stay.
 	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
+	bool rasterizeGlyph(Glyph &glyph) const;
 	typedef Common::HashMap<uint32, Glyph> GlyphCache;
 	mutable GlyphCache _glyphs;
-	bool _allowLateCaching;
-	void assureCached(uint32 chr) const;
+	mutable GlyphAtlas _atlas;
+	Glyph *getGlyph(uint32 chr) const;
+
+	// The fixed map of characters to unicode, if there is one
+	Common::Array<uint32> _mapping;
+
+	// Kerning offsets by the slots of both glyphs
+	typedef Common::HashMap<uint32, int> KerningCache;
+	mutable KerningCache _kerning;
 
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
@@ -159,7 +173,7 @@ private:
 TTFFont::TTFFont()
     : _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
       _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-      _hasKerning(false), _allowLateCaching(false) {
+      _hasKerning(false) {
 }
 
 TTFFont::~TTFFont() {
@@ -169,9 +183,6 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
 }
@@ -245,34 +256,25 @@ bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode siz
 	_width = ftCeil26_6(FT_MulFix(_face->max_advance_width, _face->size->metrics.x_scale));
 	_height = _ascent - _descent + 1;
 
-	if (!mapping) {
-		// Allow loading of all unicode characters.
-		_allowLateCaching = true;
-
-		// Load all ISO-8859-1 characters.
-		for (uint i = 0; i < 256; ++i) {
-			if (!cacheGlyph(_glyphs[i], i)) {
-				_glyphs.erase(i);
-			}
-		}
-	} else {
-		// We have a fixed map of characters do not load more later.
-		_allowLateCaching = false;
+	if (mapping) {
+		// We have a fixed map of characters, do not load any others.
+		_mapping.resize(256);
 
 		for (uint i = 0; i < 256; ++i) {
-			const uint32 unicode = mapping[i] & 0x7FFFFFFF;
+			_mapping[i] = mapping[i] & 0x7FFFFFFF;
 			const bool isRequired = (mapping[i] & 0x80000000) != 0;
-			// Check whether loading an important glyph fails and error out if
+			// Check whether an important glyph is missing and error out if
 			// that is the case.
-			if (!cacheGlyph(_glyphs[i], unicode)) {
-				_glyphs.erase(i);
-				if (isRequired)
-					return false;
-			}
+			if (isRequired && !FT_Get_Char_Index(_face, _mapping[i]))
+				return false;
 		}
 	}
 
-	_initialized = (_glyphs.size() != 0);
+	// Glyphs are only rendered once they are used, but at least one of the
+	// ISO-8859-1 characters (or mapped ones) has to be there.
+	for (uint i = 0; i < 256 && !_initialized; ++i)
+		_initialized = FT_Get_Char_Index(_face, _mapping.empty() ? i : _mapping[i]) != 0;
+
 	return _initialized;
 }
 
@@ -405,56 +407,50 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyph = getGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
-	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
-
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
-	} else {
+	const Glyph *leftGlyph = getGlyph(left);
+	if (!leftGlyph)
 		return 0;
-	}
 
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
-	} else {
+	const Glyph *rightGlyph = getGlyph(right);
+	if (!rightGlyph)
 		return 0;
-	}
 
-	if (!leftGlyph || !rightGlyph)
-		return 0;
+	// Strings are measured before they are drawn, and often drawn over and
+	// over again, so the same pairs come up a lot
+	const bool cacheable = leftGlyph->slot < 0x10000 && rightGlyph->slot < 0x10000;
+	const uint32 key = (leftGlyph->slot << 16) | rightGlyph->slot;
+	if (cacheable) {
+		KerningCache::const_iterator kerningEntry = _kerning.find(key);
+		if (kerningEntry != _kerning.end())
+			return kerningEntry->_value;
+	}
 
 	FT_Vector kerningVector;
-	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	FT_Get_Kerning(_face, leftGlyph->slot, rightGlyph->slot, FT_KERNING_DEFAULT, &kerningVector);
+	const int offset = kerningVector.x / 64;
+
+	if (cacheable)
+		_kerning[key] = offset;
+	return offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const Glyph *glyph = getGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
-		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
+		return Common::Rect(glyph->xOffset, glyph->yOffset, glyph->xOffset + glyph->width, glyph->yOffset + glyph->height);
 	}
 }
 
@@ -494,28 +490,182 @@ void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const i
 	}
 }
 
+#if defined(SCUMMVM_SSE2)
+
+/**
+ * Blend four pixels at a time the way renderGlyph() does, and leave the
+ * remaining columns to it.
+ */
+template<typename ColorType>
+void renderGlyph_SSE2(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const int srcPitch, const int w, const int h, ColorType color, const PixelFormat &dstFormat) {
+	uint8 sRGB[3];
+	dstFormat.colorToRGB(color, sRGB[0], sRGB[1], sRGB[2]);
+
+	const int shifts[3] = { dstFormat.rShift, dstFormat.gShift, dstFormat.bShift };
+	const int bits[3] = { dstFormat.rBits(), dstFormat.gBits(), dstFormat.bBits() };
+	const int losses[3] = { dstFormat.rLoss, dstFormat.gLoss, dstFormat.bLoss };
+
+	__m128i shift[3], mask[3], mul[3], mulShift[3], loss[3], srcColor[3];
+	for (int i = 0; i < 3; ++i) {
+		shift[i] = _mm_cvtsi32_si128(shifts[i]);
+		mask[i] = _mm_set1_epi32((1 << bits[i]) - 1);
+		mul[i] = _mm_set1_epi32(expandMul[bits[i]]);
+		mulShift[i] = _mm_cvtsi32_si128(expandShift[bits[i]]);
+		loss[i] = _mm_cvtsi32_si128(losses[i]);
+		srcColor[i] = _mm_set1_epi32(sRGB[i]);
+	}
+
+	// RGBToColor() sets the alpha bits
+	const __m128i alpha = _mm_set1_epi32((0xFF >> dstFormat.aLoss) << dstFormat.aShift);
+	const __m128i colors = _mm_set1_epi32(color);
+	const __m128i opaque = _mm_set1_epi32(255);
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i zero = _mm_setzero_si128();
+	const int simdWidth = w & ~3;
+
+	for (int y = 0; y < h; ++y) {
+		ColorType *rDst = (ColorType *)(dstPos + y * dstPitch);
+		const uint8 *src = srcPos + y * srcPitch;
+
+		for (int x = 0; x < simdWidth; x += 4) {
+			const uint32 coverage = READ_UINT32(src + x);
+			if (!coverage)
+				continue;
+
+			const __m128i a = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(coverage), zero), zero);
+			const __m128i inv = _mm_sub_epi32(opaque, a);
+			const __m128i dst = loadColors_SSE2<sizeof(ColorType)>((const byte *)(rDst + x));
+
+			// All products fit in 16 bits, so the 16 bit multiplication
+			// works on the 32 bit lanes
+			__m128i blended = alpha;
+			for (int i = 0; i < 3; ++i) {
+				__m128i c = _mm_and_si128(_mm_srl_epi32(dst, shift[i]), mask[i]);
+				c = _mm_srl_epi32(_mm_mullo_epi16(c, mul[i]), mulShift[i]);
+				const __m128i sum = _mm_add_epi32(_mm_mullo_epi16(inv, c), _mm_mullo_epi16(a, srcColor[i]));
+				// Exactly sum / 255 for sums up to 255 * 255
+				c = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(sum, one), _mm_srli_epi32(sum, 8)), 8);
+				blended = _mm_or_si128(blended, _mm_sll_epi32(_mm_srl_epi32(c, loss[i]), shift[i]));
+			}
+
+			// Fully covered pixels get the color itself, and uncovered ones
+			// are left alone
+			const __m128i full = _mm_cmpeq_epi32(a, opaque);
+			const __m128i none = _mm_cmpeq_epi32(a, zero);
+			blended = _mm_or_si128(_mm_and_si128(full, colors), _mm_andnot_si128(full, blended));
+			blended = _mm_or_si128(_mm_and_si128(none, dst), _mm_andnot_si128(none, blended));
+			storeColors_SSE2<sizeof(ColorType)>((byte *)(rDst + x), blended);
+		}
+	}
+
+	if (simdWidth < w)
+		renderGlyph<ColorType>(dstPos + simdWidth * sizeof(ColorType), dstPitch, srcPos + simdWidth, srcPitch, w - simdWidth, h, color, dstFormat);
+}
+
+#define renderGlyph_SIMD renderGlyph_SSE2
+
+#elif defined(SCUMMVM_NEON)
+
+/**
+ * Blend four pixels at a time the way renderGlyph() does, and leave the
+ * remaining columns to it.
+ */
+template<typename ColorType>
+void renderGlyph_NEON(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const int srcPitch, const int w, const int h, ColorType color, const PixelFormat &dstFormat) {
+	uint8 sRGB[3];
+	dstFormat.colorToRGB(color, sRGB[0], sRGB[1], sRGB[2]);
+
+	const int shifts[3] = { dstFormat.rShift, dstFormat.gShift, dstFormat.bShift };
+	const int bits[3] = { dstFormat.rBits(), dstFormat.gBits(), dstFormat.bBits() };
+	const int losses[3] = { dstFormat.rLoss, dstFormat.gLoss, dstFormat.bLoss };
+
+	// Shifting by a negative count shifts to the right
+	int32x4_t shiftRight[3], shiftLeft[3], mulShift[3], loss[3];
+	uint32x4_t mask[3], mul[3], srcColor[3];
+	for (int i = 0; i < 3; ++i) {
+		shiftRight[i] = vdupq_n_s32(-shifts[i]);
+		shiftLeft[i] = vdupq_n_s32(shifts[i]);
+		mask[i] = vdupq_n_u32((1 << bits[i]) - 1);
+		mul[i] = vdupq_n_u32(expandMul[bits[i]]);
+		mulShift[i] = vdupq_n_s32(-(int32)expandShift[bits[i]]);
+		loss[i] = vdupq_n_s32(-losses[i]);
+		srcColor[i] = vdupq_n_u32(sRGB[i]);
+	}
+
+	// RGBToColor() sets the alpha bits
+	const uint32x4_t alpha = vdupq_n_u32((0xFF >> dstFormat.aLoss) << dstFormat.aShift);
+	const uint32x4_t colors = vdupq_n_u32(color);
+	const uint32x4_t opaque = vdupq_n_u32(255);
+	const uint32x4_t zero = vdupq_n_u32(0);
+	const int simdWidth = w & ~3;
+
+	for (int y = 0; y < h; ++y) {
+		ColorType *rDst = (ColorType *)(dstPos + y * dstPitch);
+		const uint8 *src = srcPos + y * srcPitch;
+
+		for (int x = 0; x < simdWidth; x += 4) {
+			const uint32 coverage = READ_UINT32(src + x);
+			if (!coverage)
+				continue;
+
+			const uint32x4_t a = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(coverage)))));
+			const uint32x4_t inv = vsubq_u32(opaque, a);
+			const uint32x4_t dst = loadColors_NEON<sizeof(ColorType)>((const byte *)(rDst + x));
+
+			uint32x4_t blended = alpha;
+			for (int i = 0; i < 3; ++i) {
+				uint32x4_t c = vandq_u32(vshlq_u32(dst, shiftRight[i]), mask[i]);
+				c = vshlq_u32(vmulq_u32(c, mul[i]), mulShift[i]);
+				const uint32x4_t sum = vmlaq_u32(vmulq_u32(inv, c), a, srcColor[i]);
+				// Exactly sum / 255 for sums up to 255 * 255
+				c = vshrq_n_u32(vaddq_u32(vaddq_u32(sum, vdupq_n_u32(1)), vshrq_n_u32(sum, 8)), 8);
+				blended = vorrq_u32(blended, vshlq_u32(vshlq_u32(c, loss[i]), shiftLeft[i]));
+			}
+
+			// Fully covered pixels get the color itself, and uncovered ones
+			// are left alone
+			blended = vbslq_u32(vceqq_u32(a, opaque), colors, blended);
+			blended = vbslq_u32(vceqq_u32(a, zero), dst, blended);
+			storeColors_NEON<sizeof(ColorType)>((byte *)(rDst + x), blended);
+		}
+	}
+
+	if (simdWidth < w)
+		renderGlyph<ColorType>(dstPos + simdWidth * sizeof(ColorType), dstPitch, srcPos + simdWidth, srcPitch, w - simdWidth, h, color, dstFormat);
+}
+
+#define renderGlyph_SIMD renderGlyph_NEON
+
+#else
+
+#define renderGlyph_SIMD renderGlyph
+
+#endif
+
 } // End of anonymous namespace
 
 void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	Glyph *glyph = getGlyph(chr);
+	if (!glyph || !glyph->width)
 		return;
 
-	const Glyph &glyph = glyphEntry->_value;
+	// Render the glyph again if its bitmap got dropped from the atlas
+	if (!_atlas.isValid(glyph->image) && !rasterizeGlyph(*glyph))
+		return;
 
-	x += glyph.xOffset;
-	y += glyph.yOffset;
+	x += glyph->xOffset;
+	y += glyph->yOffset;
 
 	if (x > dst->w)
 		return;
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
+	int w = glyph->width;
+	int h = glyph->height;
 
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
+	const uint8 *srcPos = _atlas.getPixels(glyph->image);
+	const int srcPitch = _atlas.getPitch(glyph->image);
 
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
@@ -531,7 +681,7 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * srcPitch;
 		h += y;
 		y = 0;
 	}
@@ -560,21 +710,28 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += srcPitch;
 		}
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		renderGlyph_SIMD<uint16>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		renderGlyph_SIMD<uint32>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format);
 	}
 }
 
+#undef renderGlyph_SIMD
+
 bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	FT_UInt slot = FT_Get_Char_Index(_face, chr);
 	if (!slot)
 		return false;
 
 	glyph.slot = slot;
+	return rasterizeGlyph(glyph);
+}
+
+bool TTFFont::rasterizeGlyph(Glyph &glyph) const {
+	const FT_UInt slot = glyph.slot;
 
 	// We use the light target and render mode to improve the looks of the
 	// glyphs. It is most noticable in FreeSansBold.ttf, where otherwise the
@@ -594,7 +751,20 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	glyph.advance = ftCeil26_6(_face->glyph->advance.x);
 
 	const FT_Bitmap &bitmap = _face->glyph->bitmap;
-	glyph.image.create(bitmap.width, bitmap.rows, PixelFormat::createFormatCLUT8());
+	if (bitmap.pixel_mode != FT_PIXEL_MODE_MONO && bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::rasterizeGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
+		return false;
+	}
+
+	glyph.width = bitmap.width;
+	glyph.height = bitmap.rows;
+	if (!glyph.width || !glyph.height) {
+		glyph.width = glyph.height = 0;
+		glyph.image = GlyphAtlas::Location();
+		return true;
+	}
+
+	glyph.image = _atlas.allocate(glyph.width, glyph.height);
 
 	const uint8 *src = bitmap.buffer;
 	int srcPitch = bitmap.pitch;
@@ -603,11 +773,11 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		srcPitch = -srcPitch;
 	}
 
-	uint8 *dst = (uint8 *)glyph.image.getPixels();
-	memset(dst, 0, glyph.image.h * glyph.image.pitch);
+	// The atlas clears the pixels it hands out
+	uint8 *dst = _atlas.getPixels(glyph.image);
+	const int dstPitch = _atlas.getPitch(glyph.image);
 
-	switch (bitmap.pixel_mode) {
-	case FT_PIXEL_MODE_MONO:
+	if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
 		for (int y = 0; y < (int)bitmap.rows; ++y) {
 			const uint8 *curSrc = src;
 			uint8 mask = 0;
@@ -617,42 +787,44 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 					mask = *curSrc++;
 
 				if (mask & 0x80)
-					*dst = 255;
+					dst[x] = 255;
 
 				mask <<= 1;
-				++dst;
 			}
 
+			dst += dstPitch;
 			src += srcPitch;
 		}
-		break;
-
-	case FT_PIXEL_MODE_GRAY:
+	} else {
 		for (int y = 0; y < (int)bitmap.rows; ++y) {
 			memcpy(dst, src, bitmap.width);
-			dst += glyph.image.pitch;
+			dst += dstPitch;
 			src += srcPitch;
 		}
-		break;
-
-	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
-		glyph.image.free();
-		return false;
 	}
 
 	return true;
 }
 
-void TTFFont::assureCached(uint32 chr) const {
-	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
-		return;
+TTFFont::Glyph *TTFFont::getGlyph(uint32 chr) const {
+	GlyphCache::iterator glyphEntry = _glyphs.find(chr);
+	if (glyphEntry != _glyphs.end())
+		return &glyphEntry->_value;
+
+	uint32 unicode = chr;
+	if (!_mapping.empty()) {
+		if (chr >= _mapping.size())
+			return nullptr;
+		unicode = _mapping[chr];
 	}
 
 	Glyph newGlyph;
-	if (cacheGlyph(newGlyph, chr)) {
-		_glyphs[chr] = newGlyph;
-	}
+	if (!cacheGlyph(newGlyph, unicode))
+		return nullptr;
+
+	Glyph &glyph = _glyphs[chr];
+	glyph = newGlyph;
+	return &glyph;
 }
 
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping) {
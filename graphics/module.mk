@@ -3,10 +3,12 @@ MODULE := graphics
 MODULE_OBJS := \
 	conversion.o \
 	cursorman.o \
+	dirty_region.o \
 	font.o \
 	fontman.o \
 	fonts/bdf.o \
 	fonts/consolefont.o \
+	fonts/glyph_atlas.o \
 	fonts/macfont.o \
 	fonts/newfont_big.o \
 	fonts/newfont.o \
@@ -29,6 +31,7 @@ MODULE_OBJS := \
 	screen.o \
 	sjis.o \
 	surface.o \
+	transform_cache.o \
 	transform_struct.o \
 	transform_tools.o \
 	transparent_surface.o \
@@ -57,7 +60,8 @@ endif
 ifdef USE_HQ_SCALERS
 MODULE_OBJS += \
 	scaler/hq2x.o \
-	scaler/hq3x.o
+	scaler/hq3x.o \
+	scaler/hqpattern.o
 
 ifdef USE_NASM
 MODULE_OBJS += \
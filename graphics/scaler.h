@@ -62,6 +62,13 @@ DECLARE_SCALER(HQ3x);
 
 #endif // #ifdef USE_SCALERS
 
+/**
+ * Return whether a scaler may run on several threads at once, each one
+ * scaling a different area. The assembly versions of the HQ scalers keep
+ * their state in global variables, so they may not.
+ */
+extern bool isScalerThreadSafe(ScalerProc *scaler);
+
 // creates a 160x100 thumbnail for 320x200 games
 // and 160x120 thumbnail for 320x240 and 640x480 games
 // only 565 mode
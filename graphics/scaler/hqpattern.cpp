@@ -0,0 +1,183 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/simd.h"
+#include "graphics/scaler/intern.h"
+
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+
+extern "C" uint32 *RGBtoYUV;
+
+#if defined(SCUMMVM_SSE2)
+
+/**
+ * Compare the components of four YUV values at once, like diffYUV(). Lanes
+ * with a difference get all bits set, the others are cleared.
+ */
+static inline __m128i diffYUV_SSE2(__m128i yuv1, __m128i yuv2) {
+	const __m128i Ymask = _mm_set1_epi32(0x00FF0000);
+	const __m128i Umask = _mm_set1_epi32(0x0000FF00);
+	const __m128i Vmask = _mm_set1_epi32(0x000000FF);
+	const __m128i trY   = _mm_set1_epi32(0x00300000);
+	const __m128i trU   = _mm_set1_epi32(0x00000700);
+	const __m128i trV   = _mm_set1_epi32(0x00000006);
+
+	// The components never exceed 24 bits, so the differences cannot
+	// overflow, and comparing against both thresholds replaces ABS
+	const __m128i diffY = _mm_sub_epi32(_mm_and_si128(yuv1, Ymask), _mm_and_si128(yuv2, Ymask));
+	const __m128i diffU = _mm_sub_epi32(_mm_and_si128(yuv1, Umask), _mm_and_si128(yuv2, Umask));
+	const __m128i diffV = _mm_sub_epi32(_mm_and_si128(yuv1, Vmask), _mm_and_si128(yuv2, Vmask));
+
+	__m128i result = _mm_or_si128(_mm_cmpgt_epi32(diffY, trY), _mm_cmplt_epi32(diffY, _mm_sub_epi32(_mm_setzero_si128(), trY)));
+	result = _mm_or_si128(result, _mm_or_si128(_mm_cmpgt_epi32(diffU, trU), _mm_cmplt_epi32(diffU, _mm_sub_epi32(_mm_setzero_si128(), trU))));
+	result = _mm_or_si128(result, _mm_or_si128(_mm_cmpgt_epi32(diffV, trV), _mm_cmplt_epi32(diffV, _mm_sub_epi32(_mm_setzero_si128(), trV))));
+	return result;
+}
+
+static inline __m128i patternBit_SSE2(__m128i yuv5, const uint32 *yuv, int bit) {
+	return _mm_and_si128(diffYUV_SSE2(yuv5, _mm_loadu_si128((const __m128i *)yuv)), _mm_set1_epi32(bit));
+}
+
+static int computeHQPatterns_SSE2(const uint32 *above, const uint32 *row, const uint32 *below, uint8 *patterns, int width) {
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const __m128i yuv5 = _mm_loadu_si128((const __m128i *)(row + x + 1));
+
+		__m128i pattern = patternBit_SSE2(yuv5, above + x, 0x0001);
+		pattern = _mm_or_si128(pattern, patternBit_SSE2(yuv5, above + x + 1, 0x0002));
+		pattern = _mm_or_si128(pattern, patternBit_SSE2(yuv5, above + x + 2, 0x0004));
+		pattern = _mm_or_si128(pattern, patternBit_SSE2(yuv5, row + x, 0x0008));
+		pattern = _mm_or_si128(pattern, patternBit_SSE2(yuv5, row + x + 2, 0x0010));
+		pattern = _mm_or_si128(pattern, patternBit_SSE2(yuv5, below + x, 0x0020));
+		pattern = _mm_or_si128(pattern, patternBit_SSE2(yuv5, below + x + 1, 0x0040));
+		pattern = _mm_or_si128(pattern, patternBit_SSE2(yuv5, below + x + 2, 0x0080));
+
+		pattern = _mm_packs_epi32(pattern, pattern);
+		pattern = _mm_packus_epi16(pattern, pattern);
+		const uint32 packed = _mm_cvtsi128_si32(pattern);
+		memcpy(patterns + x, &packed, 4);
+	}
+	return x;
+}
+
+#elif defined(SCUMMVM_NEON)
+
+/**
+ * Compare the components of four YUV values at once, like diffYUV(). Lanes
+ * with a difference get all bits set, the others are cleared.
+ */
+static inline uint32x4_t diffYUV_NEON(int32x4_t yuv1, int32x4_t yuv2) {
+	const int32x4_t Ymask = vdupq_n_s32(0x00FF0000);
+	const int32x4_t Umask = vdupq_n_s32(0x0000FF00);
+	const int32x4_t Vmask = vdupq_n_s32(0x000000FF);
+
+	const int32x4_t diffY = vabdq_s32(vandq_s32(yuv1, Ymask), vandq_s32(yuv2, Ymask));
+	const int32x4_t diffU = vabdq_s32(vandq_s32(yuv1, Umask), vandq_s32(yuv2, Umask));
+	const int32x4_t diffV = vabdq_s32(vandq_s32(yuv1, Vmask), vandq_s32(yuv2, Vmask));
+
+	uint32x4_t result = vcgtq_s32(diffY, vdupq_n_s32(0x00300000));
+	result = vorrq_u32(result, vcgtq_s32(diffU, vdupq_n_s32(0x00000700)));
+	result = vorrq_u32(result, vcgtq_s32(diffV, vdupq_n_s32(0x00000006)));
+	return result;
+}
+
+static inline uint32x4_t patternBit_NEON(int32x4_t yuv5, const uint32 *yuv, uint32 bit) {
+	return vandq_u32(diffYUV_NEON(yuv5, vreinterpretq_s32_u32(vld1q_u32(yuv))), vdupq_n_u32(bit));
+}
+
+static int computeHQPatterns_NEON(const uint32 *above, const uint32 *row, const uint32 *below, uint8 *patterns, int width) {
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const int32x4_t yuv5 = vreinterpretq_s32_u32(vld1q_u32(row + x + 1));
+
+		uint32x4_t pattern = patternBit_NEON(yuv5, above + x, 0x0001);
+		pattern = vorrq_u32(pattern, patternBit_NEON(yuv5, above + x + 1, 0x0002));
+		pattern = vorrq_u32(pattern, patternBit_NEON(yuv5, above + x + 2, 0x0004));
+		pattern = vorrq_u32(pattern, patternBit_NEON(yuv5, row + x, 0x0008));
+		pattern = vorrq_u32(pattern, patternBit_NEON(yuv5, row + x + 2, 0x0010));
+		pattern = vorrq_u32(pattern, patternBit_NEON(yuv5, below + x, 0x0020));
+		pattern = vorrq_u32(pattern, patternBit_NEON(yuv5, below + x + 1, 0x0040));
+		pattern = vorrq_u32(pattern, patternBit_NEON(yuv5, below + x + 2, 0x0080));
+
+		const uint16x4_t narrow = vmovn_u32(pattern);
+		uint8 packed[8];
+		vst1_u8(packed, vmovn_u16(vcombine_u16(narrow, narrow)));
+		memcpy(patterns + x, packed, 4);
+	}
+	return x;
+}
+
+#endif
+
+HQPatterns::HQPatterns(const uint16 *src, uint32 nextlineSrc, int width)
+	: _src(src + nextlineSrc), _nextlineSrc(nextlineSrc), _width(width),
+	  _above(_yuv[0]), _row(_yuv[1]), _below(_yuv[2]) {
+	assert(width <= kMaxHQPatterns);
+
+	convertRow(_above, src - nextlineSrc);
+	convertRow(_row, src);
+}
+
+void HQPatterns::convertRow(uint32 *yuv, const uint16 *src) {
+	for (int x = -1; x <= _width; ++x)
+		*yuv++ = RGBtoYUV[src[x]];
+}
+
+const uint8 *HQPatterns::nextRow() {
+	convertRow(_below, _src);
+	_src += _nextlineSrc;
+
+	uint32 *above = _above;
+	uint32 *row = _row;
+	uint32 *below = _below;
+
+	int x = 0;
+#if defined(SCUMMVM_SSE2)
+	x = computeHQPatterns_SSE2(above, row, below, _patterns, _width);
+#elif defined(SCUMMVM_NEON)
+	x = computeHQPatterns_NEON(above, row, below, _patterns, _width);
+#endif
+
+	for (; x < _width; ++x) {
+		const uint32 yuv5 = row[x + 1];
+
+		int pattern = 0;
+		if (yuv5 != above[x]     && diffYUV(yuv5, above[x]))     pattern |= 0x0001;
+		if (yuv5 != above[x + 1] && diffYUV(yuv5, above[x + 1])) pattern |= 0x0002;
+		if (yuv5 != above[x + 2] && diffYUV(yuv5, above[x + 2])) pattern |= 0x0004;
+		if (yuv5 != row[x]       && diffYUV(yuv5, row[x]))       pattern |= 0x0008;
+		if (yuv5 != row[x + 2]   && diffYUV(yuv5, row[x + 2]))   pattern |= 0x0010;
+		if (yuv5 != below[x]     && diffYUV(yuv5, below[x]))     pattern |= 0x0020;
+		if (yuv5 != below[x + 1] && diffYUV(yuv5, below[x + 1])) pattern |= 0x0040;
+		if (yuv5 != below[x + 2] && diffYUV(yuv5, below[x + 2])) pattern |= 0x0080;
+		_patterns[x] = pattern;
+	}
+
+	// The rows move up by one
+	_above = row;
+	_row = below;
+	_below = above;
+
+	return _patterns;
+}
+
+#endif
@@ -218,4 +218,47 @@ static inline bool diffYUV(int yuv1, int yuv2) {
 */
 }
 
+enum {
+	/** The maximal width of the areas HQPatterns handles. */
+	kMaxHQPatterns = 256
+};
+
+/**
+ * Computes the patterns used by the hq scaler family, one row of an area of
+ * 16 bit pixels after the other. Bit n of each pattern is set if diffYUV()
+ * reports a difference between the pixel and its n-th neighbour, counting
+ * from the top left one to the bottom right one, row by row.
+ *
+ * Each row is converted to YUV only once, and the patterns are computed
+ * with SIMD instructions where available.
+ */
+class HQPatterns {
+public:
+	/**
+	 * @param src			the first pixel of the area
+	 * @param nextlineSrc	the pitch of the source, in pixels
+	 * @param width			the width of the area, at most kMaxHQPatterns
+	 */
+	HQPatterns(const uint16 *src, uint32 nextlineSrc, int width);
+
+	/** Compute the patterns of the next row of the area. */
+	const uint8 *nextRow();
+
+private:
+	void convertRow(uint32 *yuv, const uint16 *src);
+
+	const uint16 *_src;
+	uint32 _nextlineSrc;
+	int _width;
+
+	// The YUV values of the current row and the rows around it, including
+	// the pixels left and right of them
+	uint32 *_above;
+	uint32 *_row;
+	uint32 *_below;
+	uint32 _yuv[3][kMaxHQPatterns + 2];
+
+	uint8 _patterns[kMaxHQPatterns];
+};
+
 #endif
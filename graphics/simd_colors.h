@@ -0,0 +1,102 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_SIMD_COLORS_H
+#define GRAPHICS_SIMD_COLORS_H
+
+#include "common/endian.h"
+#include "common/simd.h"
+
+/**
+ * @file
+ * Helpers shared by the SIMD versions of pixel conversion and blending
+ * code: loading and storing four pixels of 2, 3 or 4 bytes in 32 bit lanes,
+ * and ColorComponent::expand() in a form which works on several lanes.
+ */
+
+namespace Graphics {
+
+/**
+ * ColorComponent::expand() as a multiplication followed by a shift, i.e.
+ * (value * expandMul[bits]) >> expandShift[bits], for every component size.
+ * Both the value and the product fit in 16 bits.
+ */
+static const uint32 expandMul[9] = { 0, 255, 85, 73, 17, 33, 65, 129, 257 };
+static const uint32 expandShift[9] = { 0, 0, 0, 1, 0, 2, 4, 6, 8 };
+
+#if defined(SCUMMVM_SSE2)
+
+// Load four colors into 32 bit lanes
+template<int bpp>
+inline __m128i loadColors_SSE2(const byte *src) {
+	if (bpp == 2)
+		return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+	if (bpp == 4)
+		return _mm_loadu_si128((const __m128i *)src);
+
+	// Put every three bytes into a lane of their own, like READ_UINT24()
+	const __m128i bytes = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)src), _mm_cvtsi32_si128(READ_UINT32(src + 8)));
+	const __m128i colors = _mm_unpacklo_epi64(_mm_unpacklo_epi32(bytes, _mm_srli_si128(bytes, 3)),
+	                                          _mm_unpacklo_epi32(_mm_srli_si128(bytes, 6), _mm_srli_si128(bytes, 9)));
+	return _mm_and_si128(colors, _mm_set1_epi32(0xFFFFFF));
+}
+
+// Store four colors from 32 bit lanes, for 2 or 4 bytes per pixel
+template<int bpp>
+inline void storeColors_SSE2(byte *dst, __m128i colors) {
+	if (bpp == 2) {
+		// Sign extend, so the signed saturation keeps the colors as they are
+		colors = _mm_srai_epi32(_mm_slli_epi32(colors, 16), 16);
+		_mm_storel_epi64((__m128i *)dst, _mm_packs_epi32(colors, colors));
+	} else {
+		_mm_storeu_si128((__m128i *)dst, colors);
+	}
+}
+
+#elif defined(SCUMMVM_NEON)
+
+// Load four colors into 32 bit lanes
+template<int bpp>
+inline uint32x4_t loadColors_NEON(const byte *src) {
+	if (bpp == 2)
+		return vmovl_u16(vld1_u16((const uint16 *)src));
+	if (bpp == 4)
+		return vld1q_u32((const uint32 *)src);
+
+	const uint32 colors[4] = { READ_UINT24(src), READ_UINT24(src + 3), READ_UINT24(src + 6), READ_UINT24(src + 9) };
+	return vld1q_u32(colors);
+}
+
+// Store four colors from 32 bit lanes, for 2 or 4 bytes per pixel
+template<int bpp>
+inline void storeColors_NEON(byte *dst, uint32x4_t colors) {
+	if (bpp == 2)
+		vst1_u16((uint16 *)dst, vmovn_u32(colors));
+	else
+		vst1q_u32((uint32 *)dst, colors);
+}
+
+#endif
+
+} // End of namespace Graphics
+
+#endif
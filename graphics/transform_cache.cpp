@@ -0,0 +1,165 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transform_cache.h"
+
+namespace Common {
+DECLARE_SINGLETON(Graphics::TransformCache);
+}
+
+namespace Graphics {
+
+TransformCache::Key::Key(const Surface &src, uint32 gen, TFilteringMode filter) :
+	pixels(src.getPixels()), w(src.w), h(src.h), pitch(src.pitch), generation(gen),
+	filteringMode(filter), angle(0) {
+}
+
+bool TransformCache::Key::operator==(const Key &key) const {
+	return pixels == key.pixels && w == key.w && h == key.h && pitch == key.pitch &&
+	       generation == key.generation && filteringMode == key.filteringMode &&
+	       angle == key.angle && size == key.size && zoom == key.zoom && hotspot == key.hotspot;
+}
+
+uint TransformCache::KeyHash::operator()(const Key &key) const {
+	uint hash = (uint)((uintptr)key.pixels >> 2);
+	hash = hash * 31 + ((key.w << 16) | key.h);
+	hash = hash * 31 + key.generation;
+	hash = hash * 31 + key.angle;
+	hash = hash * 31 + (((uint16)key.size.x << 16) | (uint16)key.size.y);
+	hash = hash * 31 + (((uint16)key.zoom.x << 16) | (uint16)key.zoom.y);
+	return hash;
+}
+
+TransformCache::TransformCache() : _budget(kDefaultBudget), _memoryUsage(0) {
+	resetStats();
+}
+
+TransformCache::~TransformCache() {
+	clear();
+}
+
+const TransparentSurface *TransformCache::scale(const Surface &src, uint32 generation, uint16 newWidth, uint16 newHeight, TFilteringMode filteringMode) {
+	Key key(src, generation, filteringMode);
+	key.size = Common::Point(newWidth, newHeight);
+	return lookup(key, src, nullptr);
+}
+
+const TransparentSurface *TransformCache::rotoscale(const Surface &src, uint32 generation, const TransformStruct &transform, TFilteringMode filteringMode) {
+	Key key(src, generation, filteringMode);
+	key.angle = transform._angle;
+	key.zoom = transform._zoom;
+	key.hotspot = transform._hotspot;
+	return lookup(key, src, &transform);
+}
+
+const TransparentSurface *TransformCache::lookup(const Key &key, const Surface &src, const TransformStruct *transform) {
+	EntryMap::iterator i = _entries.find(key);
+	if (i != _entries.end()) {
+		Entry *entry = i->_value;
+		_lru.erase(entry->lruPos);
+		_lru.push_front(entry);
+		entry->lruPos = _lru.begin();
+		_stats.hits++;
+		return entry->surface;
+	}
+
+	_stats.misses++;
+
+	// The transformations expect rows without any padding, which a
+	// part of a bigger surface does not have
+	const bool padded = src.pitch != src.w * src.format.bytesPerPixel;
+	TransparentSurface source(src, padded);
+
+	Entry *entry = new Entry(key);
+	if (transform) {
+		if (key.filteringMode == FILTER_BILINEAR)
+			entry->surface = source.rotoscaleT<FILTER_BILINEAR>(*transform);
+		else
+			entry->surface = source.rotoscaleT<FILTER_NEAREST>(*transform);
+	} else {
+		if (key.filteringMode == FILTER_BILINEAR)
+			entry->surface = source.scaleT<FILTER_BILINEAR>(key.size.x, key.size.y);
+		else
+			entry->surface = source.scaleT<FILTER_NEAREST>(key.size.x, key.size.y);
+	}
+	entry->size = entry->surface->pitch * entry->surface->h;
+
+	if (padded)
+		source.free();
+
+	// Make room first, so the new surface is kept even if it alone
+	// exceeds the budget
+	shrink(entry->size < _budget ? _budget - entry->size : 0);
+
+	_lru.push_front(entry);
+	entry->lruPos = _lru.begin();
+	_entries[key] = entry;
+	_memoryUsage += entry->size;
+	return entry->surface;
+}
+
+void TransformCache::invalidate(const Surface &src) {
+	const byte *start = (const byte *)src.getPixels();
+	const byte *end = start + src.pitch * src.h;
+
+	for (EntryList::iterator i = _lru.begin(); i != _lru.end();) {
+		Entry *entry = *i++;
+		const byte *pixels = (const byte *)entry->key.pixels;
+		if (pixels >= start && pixels < end)
+			remove(entry);
+	}
+}
+
+void TransformCache::clear() {
+	while (!_lru.empty())
+		remove(_lru.back());
+}
+
+void TransformCache::setBudget(uint32 budget) {
+	_budget = budget;
+	shrink(budget);
+}
+
+void TransformCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
+
+void TransformCache::remove(Entry *entry) {
+	_lru.erase(entry->lruPos);
+	_entries.erase(entry->key);
+	_memoryUsage -= entry->size;
+
+	entry->surface->free();
+	delete entry->surface;
+	delete entry;
+}
+
+void TransformCache::shrink(uint32 budget) {
+	while (_memoryUsage > budget && !_lru.empty()) {
+		remove(_lru.back());
+		_stats.evictions++;
+	}
+}
+
+} // End of namespace Graphics
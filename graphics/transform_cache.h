@@ -0,0 +1,166 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSFORM_CACHE_H
+#define GRAPHICS_TRANSFORM_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/singleton.h"
+#include "graphics/transparent_surface.h"
+
+namespace Graphics {
+
+/**
+ * A cache for the surfaces created by TransparentSurface::scaleT() and
+ * rotoscaleT(), for callers which draw the same scaled or rotated sprite
+ * over and over again.
+ *
+ * Sources are identified by their pixel data, so any Surface wrapping the
+ * same pixels, or the same part of them, finds the same entries. The owner
+ * of the pixels either calls invalidate() whenever they change or get freed,
+ * or passes a generation number which changes along with them.
+ *
+ * When the cached surfaces exceed the memory budget, the least recently used
+ * ones are dropped.
+ */
+class TransformCache : public Common::Singleton<TransformCache> {
+public:
+	enum {
+		kDefaultBudget = 16 * 1024 * 1024
+	};
+
+	struct Stats {
+		uint32 hits;
+		uint32 misses;
+		uint32 evictions;
+	};
+
+	/**
+	 * Get a scaled version of a 32bpp surface, as created by
+	 * TransparentSurface::scaleT().
+	 *
+	 * The returned surface belongs to the cache. It stays valid until the
+	 * next call to any method which is not const.
+	 *
+	 * @param src           the source surface
+	 * @param generation    changes whenever the pixels of the source change
+	 * @param newWidth      the resulting width
+	 * @param newHeight     the resulting height
+	 * @param filteringMode the filter used for scaling
+	 */
+	const TransparentSurface *scale(const Surface &src, uint32 generation, uint16 newWidth, uint16 newHeight, TFilteringMode filteringMode = FILTER_NEAREST);
+
+	/**
+	 * Get a rotated and scaled version of a 32bpp surface, as created by
+	 * TransparentSurface::rotoscaleT().
+	 *
+	 * The returned surface belongs to the cache. It stays valid until the
+	 * next call to any method which is not const.
+	 *
+	 * @param src           the source surface
+	 * @param generation    changes whenever the pixels of the source change
+	 * @param transform     the transformation; only the angle, zoom and
+	 *                      hotspot affect the result
+	 * @param filteringMode the filter used for the transformation
+	 */
+	const TransparentSurface *rotoscale(const Surface &src, uint32 generation, const TransformStruct &transform, TFilteringMode filteringMode = FILTER_BILINEAR);
+
+	/**
+	 * Drop all entries made from the pixels of a surface, or any part of
+	 * them.
+	 */
+	void invalidate(const Surface &src);
+
+	/** Drop all entries. */
+	void clear();
+
+	/**
+	 * Set the number of bytes the cached surfaces may take up. Entries are
+	 * dropped right away if they exceed the new budget.
+	 */
+	void setBudget(uint32 budget);
+	uint32 getBudget() const { return _budget; }
+
+	/** Get the number of bytes the cached surfaces currently take up. */
+	uint32 getMemoryUsage() const { return _memoryUsage; }
+
+	/** Get the number of cached surfaces. */
+	uint getSize() const { return _entries.size(); }
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	TransformCache();
+	~TransformCache();
+
+	struct Key {
+		const void *pixels;
+		uint16 w, h, pitch;
+		uint32 generation;
+		TFilteringMode filteringMode;
+		// What scaleT() resp. rotoscaleT() depend on. The angle is always
+		// 0 for scaled surfaces, as rotoscaleT() asserts it is not.
+		int32 angle;
+		Common::Point size;
+		Common::Point zoom;
+		Common::Point hotspot;
+
+		Key(const Surface &src, uint32 gen, TFilteringMode filter);
+		bool operator==(const Key &key) const;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	struct Entry;
+	typedef Common::List<Entry *> EntryList;
+	typedef Common::HashMap<Key, Entry *, KeyHash> EntryMap;
+
+	struct Entry {
+		Key key;
+		TransparentSurface *surface;
+		uint32 size;
+		EntryList::iterator lruPos;
+
+		Entry(const Key &k) : key(k), surface(nullptr), size(0) {}
+	};
+
+	const TransparentSurface *lookup(const Key &key, const Surface &src, const TransformStruct *transform);
+	void remove(Entry *entry);
+	void shrink(uint32 budget);
+
+	EntryMap _entries;
+	EntryList _lru; ///< Most recently used first
+	uint32 _budget;
+	uint32 _memoryUsage;
+	Stats _stats;
+};
+
+} // End of namespace Graphics
+
+#define TransformCacheMan (::Graphics::TransformCache::instance())
+
+#endif
@@ -32,6 +32,7 @@
 #include "common/util.h"
 #include "common/rect.h"
 #include "common/math.h"
+#include "common/simd.h"
 #include "common/textconsole.h"
 #include "graphics/primitives.h"
 #include "graphics/transparent_surface.h"
@@ -81,6 +82,218 @@ TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Sur
 	}
 }
 
+#if defined(SCUMMVM_SSE2)
+
+// Every pixel's alpha byte, as a mask over four pixels
+static inline __m128i alphaMask_SSE2() {
+	return _mm_set1_epi32((int)(0xFFU << (kAIndex * 8)));
+}
+
+// Spread the alpha of two pixels, unpacked to 16 bit, over all their lanes
+static inline __m128i spreadAlpha_SSE2(__m128i pixels) {
+	pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(kAIndex, kAIndex, kAIndex, kAIndex));
+	return _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(kAIndex, kAIndex, kAIndex, kAIndex));
+}
+
+// Load the source pixels j to j + 3, which go backwards in flipped rows
+static inline __m128i loadPixels_SSE2(const byte *in, uint32 j, bool flipped) {
+	if (flipped)
+		return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - (j + 3) * 4)), _MM_SHUFFLE(0, 1, 2, 3));
+	return _mm_loadu_si128((const __m128i *)(in + j * 4));
+}
+
+/**
+ * The SSE2 versions of the inner loops of doBlitOpaqueFast(),
+ * doBlitBinaryFast() and doBlitAlphaBlend(). They handle four pixels at a
+ * time and return the number of pixels done, leaving the rest to the
+ * plain loops.
+ */
+static uint32 blitRowOpaque_SSE2(const byte *in, byte *out, uint32 width) {
+	const __m128i alphaMask = alphaMask_SSE2();
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = _mm_loadu_si128((const __m128i *)(in + j * 4));
+		_mm_storeu_si128((__m128i *)(out + j * 4), _mm_or_si128(src, alphaMask));
+	}
+	return j;
+}
+
+static uint32 blitRowBinary_SSE2(const byte *in, byte *out, uint32 width, bool flipped) {
+	const __m128i alphaMask = alphaMask_SSE2();
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = loadPixels_SSE2(in, j, flipped);
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), _mm_setzero_si128());
+
+		const __m128i result = _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, _mm_or_si128(src, alphaMask)));
+		_mm_storeu_si128((__m128i *)(out + j * 4), result);
+	}
+	return j;
+}
+
+// (in * a + out * (255 - a)) >> 8 never exceeds 16 bits
+static inline __m128i blendHalf_SSE2(__m128i src, __m128i dst) {
+	const __m128i alpha = spreadAlpha_SSE2(src);
+	const __m128i invAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, invAlpha)), 8);
+}
+
+static uint32 blitRowAlphaBlend_SSE2(const byte *in, byte *out, uint32 width, bool flipped) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = alphaMask_SSE2();
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = loadPixels_SSE2(in, j, flipped);
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+
+		const __m128i lo = blendHalf_SSE2(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+		const __m128i hi = blendHalf_SSE2(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+		const __m128i blended = _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask);
+
+		// Fully transparent pixels leave the target untouched, alpha included
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), zero);
+		const __m128i result = _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, blended));
+		_mm_storeu_si128((__m128i *)(out + j * 4), result);
+	}
+	return j;
+}
+
+// in * ina * c >> 16 is the high half of the 16 bit product (in * ina) * c
+static inline __m128i blendHalfColor_SSE2(__m128i src, __m128i dst, __m128i ca, __m128i colorMod) {
+	const __m128i ina = _mm_srli_epi16(_mm_mullo_epi16(spreadAlpha_SSE2(src), ca), 8);
+	const __m128i kept = _mm_srli_epi16(_mm_mullo_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(255), ina)), 8);
+	return _mm_add_epi16(kept, _mm_mulhi_epu16(_mm_mullo_epi16(src, ina), colorMod));
+}
+
+static uint32 blitRowAlphaBlendColor_SSE2(const byte *in, byte *out, uint32 width, bool flipped, byte ca, byte cr, byte cg, byte cb) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = alphaMask_SSE2();
+
+	uint16 mod[8];
+	for (int i = 0; i < 8; i += 4) {
+		mod[i + kAIndex] = 0;
+		mod[i + kRIndex] = cr;
+		mod[i + kGIndex] = cg;
+		mod[i + kBIndex] = cb;
+	}
+	const __m128i colorMod = _mm_loadu_si128((const __m128i *)mod);
+	const __m128i alphaMod = _mm_set1_epi16(ca);
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = loadPixels_SSE2(in, j, flipped);
+		const __m128i dst = _mm_loadu_si128((const __m128i *)(out + j * 4));
+
+		const __m128i lo = blendHalfColor_SSE2(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), alphaMod, colorMod);
+		const __m128i hi = blendHalfColor_SSE2(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), alphaMod, colorMod);
+		_mm_storeu_si128((__m128i *)(out + j * 4), _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask));
+	}
+	return j;
+}
+
+#elif defined(SCUMMVM_NEON)
+
+// Load the source pixels j to j + 7 split into channels, in flipped rows
+// they go backwards
+static inline uint8x8x4_t loadPixels_NEON(const byte *in, uint32 j, bool flipped) {
+	if (!flipped)
+		return vld4_u8(in + j * 4);
+
+	uint8x8x4_t pixels = vld4_u8(in - (j + 7) * 4);
+	for (int c = 0; c < 4; ++c)
+		pixels.val[c] = vrev64_u8(pixels.val[c]);
+	return pixels;
+}
+
+/**
+ * The NEON versions of the inner loops of doBlitOpaqueFast(),
+ * doBlitBinaryFast() and doBlitAlphaBlend(). They handle eight pixels at a
+ * time, split into one vector per channel, and return the number of pixels
+ * done, leaving the rest to the plain loops.
+ */
+static uint32 blitRowOpaque_NEON(const byte *in, byte *out, uint32 width) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		uint8x8x4_t src = vld4_u8(in + j * 4);
+		src.val[kAIndex] = vdup_n_u8(0xFF);
+		vst4_u8(out + j * 4, src);
+	}
+	return j;
+}
+
+static uint32 blitRowBinary_NEON(const byte *in, byte *out, uint32 width, bool flipped) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		uint8x8x4_t src = loadPixels_NEON(in, j, flipped);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint8x8_t transparent = vceq_u8(src.val[kAIndex], vdup_n_u8(0));
+
+		src.val[kAIndex] = vdup_n_u8(0xFF);
+		for (int c = 0; c < 4; ++c)
+			dst.val[c] = vbsl_u8(transparent, dst.val[c], src.val[c]);
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+static uint32 blitRowAlphaBlend_NEON(const byte *in, byte *out, uint32 width, bool flipped) {
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = loadPixels_NEON(in, j, flipped);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint8x8_t alpha = src.val[kAIndex];
+		const uint8x8_t invAlpha = vsub_u8(vdup_n_u8(255), alpha);
+
+		// Fully transparent pixels leave the target untouched, alpha included
+		const uint8x8_t transparent = vceq_u8(alpha, vdup_n_u8(0));
+
+		dst.val[kAIndex] = vbsl_u8(transparent, dst.val[kAIndex], vdup_n_u8(255));
+		for (int c = 0; c < 4; ++c) {
+			if (c == kAIndex)
+				continue;
+			const uint16x8_t sum = vmlal_u8(vmull_u8(src.val[c], alpha), dst.val[c], invAlpha);
+			dst.val[c] = vbsl_u8(transparent, dst.val[c], vshrn_n_u16(sum, 8));
+		}
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+static uint32 blitRowAlphaBlendColor_NEON(const byte *in, byte *out, uint32 width, bool flipped, byte ca, byte cr, byte cg, byte cb) {
+	uint16 mod[4];
+	mod[kAIndex] = 0;
+	mod[kRIndex] = cr;
+	mod[kGIndex] = cg;
+	mod[kBIndex] = cb;
+
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const uint8x8x4_t src = loadPixels_NEON(in, j, flipped);
+		uint8x8x4_t dst = vld4_u8(out + j * 4);
+		const uint8x8_t ina = vshrn_n_u16(vmull_u8(src.val[kAIndex], vdup_n_u8(ca)), 8);
+		const uint8x8_t invIna = vsub_u8(vdup_n_u8(255), ina);
+
+		dst.val[kAIndex] = vdup_n_u8(255);
+		for (int c = 0; c < 4; ++c) {
+			if (c == kAIndex)
+				continue;
+			const uint8x8_t kept = vshrn_n_u16(vmull_u8(dst.val[c], invIna), 8);
+			const uint16x8_t srcIna = vmull_u8(src.val[c], ina);
+			const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(srcIna), vdup_n_u16(mod[c])), 16);
+			const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(srcIna), vdup_n_u16(mod[c])), 16);
+			dst.val[c] = vadd_u8(kept, vmovn_u16(vcombine_u16(lo, hi)));
+		}
+		vst4_u8(out + j * 4, dst);
+	}
+	return j;
+}
+
+#endif
+
 /**
  * Optimized version of doBlit to be used w/opaque blitting (no alpha).
  */
@@ -92,8 +305,18 @@ void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		memcpy(out, in, width * 4);
-		for (uint32 j = 0; j < width; j++) {
+
+		uint32 j = 0;
+#if defined(SCUMMVM_SSE2)
+		j = blitRowOpaque_SSE2(in, out, width);
+#elif defined(SCUMMVM_NEON)
+		j = blitRowOpaque_NEON(in, out, width);
+#endif
+		out += j * 4;
+		in += j * 4;
+
+		memcpy(out, in, (width - j) * 4);
+		for (; j < width; j++) {
 			out[kAIndex] = 0xFF;
 			out += 4;
 		}
@@ -113,7 +336,18 @@ void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		for (uint32 j = 0; j < width; j++) {
+
+		uint32 j = 0;
+		if (inStep == 4 || inStep == -4) {
+#if defined(SCUMMVM_SSE2)
+			j = blitRowBinary_SSE2(in, out, width, inStep < 0);
+#elif defined(SCUMMVM_NEON)
+			j = blitRowBinary_NEON(in, out, width, inStep < 0);
+#endif
+			out += j * 4;
+			in += (int32)j * inStep;
+		}
+		for (; j < width; j++) {
 			uint32 pix = *(uint32 *)in;
 			int a = in[kAIndex];
 
@@ -149,7 +383,18 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+
+			uint32 j = 0;
+			if (inStep == 4 || inStep == -4) {
+#if defined(SCUMMVM_SSE2)
+				j = blitRowAlphaBlend_SSE2(in, out, width, inStep < 0);
+#elif defined(SCUMMVM_NEON)
+				j = blitRowAlphaBlend_NEON(in, out, width, inStep < 0);
+#endif
+				out += j * 4;
+				in += (int32)j * inStep;
+			}
+			for (; j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kAIndex] = 255;
@@ -174,7 +419,18 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+
+			uint32 j = 0;
+			if (inStep == 4 || inStep == -4) {
+#if defined(SCUMMVM_SSE2)
+				j = blitRowAlphaBlendColor_SSE2(in, out, width, inStep < 0, ca, cr, cg, cb);
+#elif defined(SCUMMVM_NEON)
+				j = blitRowAlphaBlendColor_NEON(in, out, width, inStep < 0, ca, cr, cg, cb);
+#endif
+				out += j * 4;
+				in += (int32)j * inStep;
+			}
+			for (; j < width; j++) {
 
 				uint32 ina = in[kAIndex] * ca >> 8;
 				out[kAIndex] = 255;
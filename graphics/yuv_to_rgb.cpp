@@ -83,6 +83,8 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/simd.h"
+#include "common/util.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
@@ -192,6 +194,413 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+
+// The SIMD versions of the conversions compute the values of the lookup
+// tables instead of looking them up. The chroma entries of colorTab are
+// trunc(k * (c - 128)), which is floor(((c - 128) * K) >> (8 + S)), plus
+// one for negative values, with:
+//
+//   Cr_r_tab:  0.419 / 0.299  K = 717   S = 1
+//   Cr_g_tab:  0.299 / 0.419  K = 731   S = 2
+//   Cb_g_tab:  0.114 / 0.331  K = 2821  S = 5
+//   Cb_b_tab:  0.587 / 0.331  K = 454   S = 0
+//
+// Those give exactly the same values as the floating point math for every
+// chroma value. They are then added to the luma and clipped like the ends
+// of rgbToPix are. With kScaleITU, everything is doubled, so that the
+// scaling of the clipped luma from 16..235 to 0..255 becomes
+// (2 * (value - 16) * 38155) >> 16, which is exact too. The channels are
+// then put together like PixelFormat::RGBToColor() does.
+
+enum {
+	// The number of pixels of a YUV410 row interpolated at once
+	kYUV410Chunk = 256
+};
+
+#if defined(SCUMMVM_SSE2)
+
+struct YUVPacking_SSE2 {
+	__m128i rLoss, gLoss, bLoss;
+	__m128i rShift, gShift, bShift;
+	uint32 alpha;
+	bool itu;
+
+	YUVPacking_SSE2(const Graphics::PixelFormat &format, bool scaleITU) :
+		rLoss(_mm_cvtsi32_si128(format.rLoss)), gLoss(_mm_cvtsi32_si128(format.gLoss)), bLoss(_mm_cvtsi32_si128(format.bLoss)),
+		rShift(_mm_cvtsi32_si128(format.rShift)), gShift(_mm_cvtsi32_si128(format.gShift)), bShift(_mm_cvtsi32_si128(format.bShift)),
+		alpha(format.RGBToColor(0, 0, 0)), itu(scaleITU) {
+	}
+};
+
+// floor((c * k) >> (8 + s)) for chroma values c given as c << 8
+static inline __m128i chromaTerm_SSE2(__m128i c, int16 k, int s) {
+	return _mm_sra_epi16(_mm_mulhi_epi16(c, _mm_set1_epi16(k)), _mm_cvtsi32_si128(s));
+}
+
+// The offsets of the channels to the luma of eight pixels, from their u and
+// v in the upper bytes of 16 bit lanes
+static inline void chromaOffsets_SSE2(__m128i u, __m128i v, bool itu, __m128i &dr, __m128i &dg, __m128i &db) {
+	const __m128i cr = _mm_xor_si128(v, _mm_set1_epi16(-32768));
+	const __m128i cb = _mm_xor_si128(u, _mm_set1_epi16(-32768));
+	const __m128i crSign = _mm_srai_epi16(cr, 15);
+	const __m128i cbSign = _mm_srai_epi16(cb, 15);
+
+	dr = _mm_sub_epi16(chromaTerm_SSE2(cr, 717, 1), crSign);
+	dg = _mm_sub_epi16(_mm_add_epi16(crSign, cbSign), _mm_add_epi16(chromaTerm_SSE2(cr, 731, 2), chromaTerm_SSE2(cb, 2821, 5)));
+	db = _mm_sub_epi16(chromaTerm_SSE2(cb, 454, 0), cbSign);
+
+	if (itu) {
+		dr = _mm_add_epi16(dr, dr);
+		dg = _mm_add_epi16(dg, dg);
+		db = _mm_add_epi16(db, db);
+	}
+}
+
+static inline __m128i clipChannel_SSE2(__m128i value, bool itu) {
+	if (!itu)
+		return _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+
+	value = _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(2 * 219));
+	return _mm_mulhi_epu16(value, _mm_set1_epi16((int16)38155));
+}
+
+// Write eight pixels, from their luma in 16 bit lanes
+template<typename PixelInt>
+static inline void putPixels_SSE2(PixelInt *dst, __m128i y, __m128i dr, __m128i dg, __m128i db, const YUVPacking_SSE2 &packing) {
+	if (packing.itu)
+		y = _mm_slli_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), 1);
+
+	const __m128i r = _mm_srl_epi16(clipChannel_SSE2(_mm_add_epi16(y, dr), packing.itu), packing.rLoss);
+	const __m128i g = _mm_srl_epi16(clipChannel_SSE2(_mm_add_epi16(y, dg), packing.itu), packing.gLoss);
+	const __m128i b = _mm_srl_epi16(clipChannel_SSE2(_mm_add_epi16(y, db), packing.itu), packing.bLoss);
+
+	if (sizeof(PixelInt) == 2) {
+		__m128i pixels = _mm_or_si128(_mm_set1_epi16((int16)packing.alpha), _mm_sll_epi16(r, packing.rShift));
+		pixels = _mm_or_si128(pixels, _mm_or_si128(_mm_sll_epi16(g, packing.gShift), _mm_sll_epi16(b, packing.bShift)));
+		_mm_storeu_si128((__m128i *)dst, pixels);
+	} else {
+		const __m128i zero = _mm_setzero_si128();
+		__m128i lo = _mm_or_si128(_mm_set1_epi32(packing.alpha), _mm_sll_epi32(_mm_unpacklo_epi16(r, zero), packing.rShift));
+		lo = _mm_or_si128(lo, _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(g, zero), packing.gShift), _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), packing.bShift)));
+		__m128i hi = _mm_or_si128(_mm_set1_epi32(packing.alpha), _mm_sll_epi32(_mm_unpackhi_epi16(r, zero), packing.rShift));
+		hi = _mm_or_si128(hi, _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(g, zero), packing.gShift), _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), packing.bShift)));
+		_mm_storeu_si128((__m128i *)dst, lo);
+		_mm_storeu_si128((__m128i *)(dst + 4), hi);
+	}
+}
+
+// Convert a row with one chroma sample per pixel, returning the number of
+// pixels done
+template<typename PixelInt>
+static int convertRow444_SSE2(PixelInt *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVPacking_SSE2 &packing) {
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i dr, dg, db;
+		chromaOffsets_SSE2(_mm_unpacklo_epi8(zero, _mm_loadl_epi64((const __m128i *)(uSrc + x))),
+		                   _mm_unpacklo_epi8(zero, _mm_loadl_epi64((const __m128i *)(vSrc + x))), packing.itu, dr, dg, db);
+		putPixels_SSE2(dst + x, _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero), dr, dg, db, packing);
+	}
+	return x;
+}
+
+// Convert two rows sharing one chroma sample per two by two pixels,
+// returning the number of pixels done per row
+template<typename PixelInt>
+static int convertRows420_SSE2(PixelInt *dst1, PixelInt *dst2, const byte *ySrc1, const byte *ySrc2, const byte *uSrc, const byte *vSrc, int width, const YUVPacking_SSE2 &packing) {
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i dr, dg, db;
+		chromaOffsets_SSE2(_mm_unpacklo_epi8(zero, _mm_loadl_epi64((const __m128i *)(uSrc + x / 2))),
+		                   _mm_unpacklo_epi8(zero, _mm_loadl_epi64((const __m128i *)(vSrc + x / 2))), packing.itu, dr, dg, db);
+		const __m128i drLo = _mm_unpacklo_epi16(dr, dr), drHi = _mm_unpackhi_epi16(dr, dr);
+		const __m128i dgLo = _mm_unpacklo_epi16(dg, dg), dgHi = _mm_unpackhi_epi16(dg, dg);
+		const __m128i dbLo = _mm_unpacklo_epi16(db, db), dbHi = _mm_unpackhi_epi16(db, db);
+
+		const __m128i y1 = _mm_loadu_si128((const __m128i *)(ySrc1 + x));
+		putPixels_SSE2(dst1 + x, _mm_unpacklo_epi8(y1, zero), drLo, dgLo, dbLo, packing);
+		putPixels_SSE2(dst1 + x + 8, _mm_unpackhi_epi8(y1, zero), drHi, dgHi, dbHi, packing);
+		const __m128i y2 = _mm_loadu_si128((const __m128i *)(ySrc2 + x));
+		putPixels_SSE2(dst2 + x, _mm_unpacklo_epi8(y2, zero), drLo, dgLo, dbLo, packing);
+		putPixels_SSE2(dst2 + x + 8, _mm_unpackhi_epi8(y2, zero), drHi, dgHi, dbHi, packing);
+	}
+	return x;
+}
+
+// Interpolate the chroma of eight pixels horizontally, in the upper bytes
+// of 16 bit lanes
+static inline __m128i interpolateColumns_SSE2(const uint16 *columns) {
+	const __m128i pairs = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)columns), _mm_loadl_epi64((const __m128i *)columns));
+	const __m128i left = _mm_mullo_epi16(_mm_shuffle_epi32(pairs, _MM_SHUFFLE(1, 1, 0, 0)), _mm_set_epi16(1, 2, 3, 4, 1, 2, 3, 4));
+	const __m128i right = _mm_mullo_epi16(_mm_shuffle_epi32(pairs, _MM_SHUFFLE(2, 2, 1, 1)), _mm_set_epi16(3, 2, 1, 0, 3, 2, 1, 0));
+	return _mm_slli_epi16(_mm_srli_epi16(_mm_add_epi16(left, right), 4), 8);
+}
+
+// Convert a row with the chroma of every fourth pixel, interpolated
+// vertically already, returning the number of pixels done
+template<typename PixelInt>
+static int convertRow410_SSE2(PixelInt *dst, const byte *ySrc, const uint16 *uColumns, const uint16 *vColumns, int width, const YUVPacking_SSE2 &packing) {
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i dr, dg, db;
+		chromaOffsets_SSE2(interpolateColumns_SSE2(uColumns + x / 4), interpolateColumns_SSE2(vColumns + x / 4), packing.itu, dr, dg, db);
+		putPixels_SSE2(dst + x, _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero), dr, dg, db, packing);
+	}
+	return x;
+}
+
+#define YUVPacking YUVPacking_SSE2
+#define convertRow444_SIMD convertRow444_SSE2
+#define convertRows420_SIMD convertRows420_SSE2
+#define convertRow410_SIMD convertRow410_SSE2
+
+#elif defined(SCUMMVM_NEON)
+
+struct YUVPacking_NEON {
+	int16x8_t rLoss, gLoss, bLoss;
+	int16x8_t rShift, gShift, bShift;
+	int32x4_t rShift32, gShift32, bShift32;
+	uint32 alpha;
+	bool itu;
+
+	// Shifting by a negative count shifts to the right
+	YUVPacking_NEON(const Graphics::PixelFormat &format, bool scaleITU) :
+		rLoss(vdupq_n_s16(-format.rLoss)), gLoss(vdupq_n_s16(-format.gLoss)), bLoss(vdupq_n_s16(-format.bLoss)),
+		rShift(vdupq_n_s16(format.rShift)), gShift(vdupq_n_s16(format.gShift)), bShift(vdupq_n_s16(format.bShift)),
+		rShift32(vdupq_n_s32(format.rShift)), gShift32(vdupq_n_s32(format.gShift)), bShift32(vdupq_n_s32(format.bShift)),
+		alpha(format.RGBToColor(0, 0, 0)), itu(scaleITU) {
+	}
+};
+
+// floor((c * k) >> (8 + s)) for chroma values c given as c << 7, as the
+// doubling multiplication shifts by one less
+static inline int16x8_t chromaTerm_NEON(int16x8_t c, int16 k, int s) {
+	return vshlq_s16(vqdmulhq_n_s16(c, k), vdupq_n_s16(-s));
+}
+
+// The offsets of the channels to the luma of eight pixels, from their u and
+// v, minus 128 and shifted to the left by seven
+static inline void chromaOffsets_NEON(int16x8_t cb, int16x8_t cr, bool itu, int16x8_t &dr, int16x8_t &dg, int16x8_t &db) {
+	const int16x8_t crSign = vshrq_n_s16(cr, 15);
+	const int16x8_t cbSign = vshrq_n_s16(cb, 15);
+
+	dr = vsubq_s16(chromaTerm_NEON(cr, 717, 1), crSign);
+	dg = vsubq_s16(vaddq_s16(crSign, cbSign), vaddq_s16(chromaTerm_NEON(cr, 731, 2), chromaTerm_NEON(cb, 2821, 5)));
+	db = vsubq_s16(chromaTerm_NEON(cb, 454, 0), cbSign);
+
+	if (itu) {
+		dr = vaddq_s16(dr, dr);
+		dg = vaddq_s16(dg, dg);
+		db = vaddq_s16(db, db);
+	}
+}
+
+static inline int16x8_t chromaFromBytes_NEON(uint8x8_t c) {
+	return vshlq_n_s16(vreinterpretq_s16_u16(vsubl_u8(c, vdup_n_u8(128))), 7);
+}
+
+static inline uint16x8_t clipChannel_NEON(int16x8_t value, bool itu) {
+	if (!itu)
+		return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(0)), vdupq_n_s16(255)));
+
+	const uint16x8_t clipped = vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(0)), vdupq_n_s16(2 * 219)));
+	const uint16x4_t lo = vshrn_n_u32(vmull_n_u16(vget_low_u16(clipped), 38155), 16);
+	const uint16x4_t hi = vshrn_n_u32(vmull_n_u16(vget_high_u16(clipped), 38155), 16);
+	return vcombine_u16(lo, hi);
+}
+
+// Write eight pixels
+template<typename PixelInt>
+static inline void putPixels_NEON(PixelInt *dst, uint8x8_t y8, int16x8_t dr, int16x8_t dg, int16x8_t db, const YUVPacking_NEON &packing) {
+	int16x8_t y;
+	if (packing.itu)
+		y = vsubq_s16(vreinterpretq_s16_u16(vshll_n_u8(y8, 1)), vdupq_n_s16(32));
+	else
+		y = vreinterpretq_s16_u16(vmovl_u8(y8));
+
+	const uint16x8_t r = vshlq_u16(clipChannel_NEON(vaddq_s16(y, dr), packing.itu), packing.rLoss);
+	const uint16x8_t g = vshlq_u16(clipChannel_NEON(vaddq_s16(y, dg), packing.itu), packing.gLoss);
+	const uint16x8_t b = vshlq_u16(clipChannel_NEON(vaddq_s16(y, db), packing.itu), packing.bLoss);
+
+	if (sizeof(PixelInt) == 2) {
+		uint16x8_t pixels = vorrq_u16(vdupq_n_u16(packing.alpha), vshlq_u16(r, packing.rShift));
+		pixels = vorrq_u16(pixels, vorrq_u16(vshlq_u16(g, packing.gShift), vshlq_u16(b, packing.bShift)));
+		vst1q_u16((uint16 *)dst, pixels);
+	} else {
+		uint32x4_t lo = vorrq_u32(vdupq_n_u32(packing.alpha), vshlq_u32(vmovl_u16(vget_low_u16(r)), packing.rShift32));
+		lo = vorrq_u32(lo, vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(g)), packing.gShift32), vshlq_u32(vmovl_u16(vget_low_u16(b)), packing.bShift32)));
+		uint32x4_t hi = vorrq_u32(vdupq_n_u32(packing.alpha), vshlq_u32(vmovl_u16(vget_high_u16(r)), packing.rShift32));
+		hi = vorrq_u32(hi, vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(g)), packing.gShift32), vshlq_u32(vmovl_u16(vget_high_u16(b)), packing.bShift32)));
+		vst1q_u32((uint32 *)dst, lo);
+		vst1q_u32((uint32 *)(dst + 4), hi);
+	}
+}
+
+// Convert a row with one chroma sample per pixel, returning the number of
+// pixels done
+template<typename PixelInt>
+static int convertRow444_NEON(PixelInt *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVPacking_NEON &packing) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		int16x8_t dr, dg, db;
+		chromaOffsets_NEON(chromaFromBytes_NEON(vld1_u8(uSrc + x)), chromaFromBytes_NEON(vld1_u8(vSrc + x)), packing.itu, dr, dg, db);
+		putPixels_NEON(dst + x, vld1_u8(ySrc + x), dr, dg, db, packing);
+	}
+	return x;
+}
+
+// Convert two rows sharing one chroma sample per two by two pixels,
+// returning the number of pixels done per row
+template<typename PixelInt>
+static int convertRows420_NEON(PixelInt *dst1, PixelInt *dst2, const byte *ySrc1, const byte *ySrc2, const byte *uSrc, const byte *vSrc, int width, const YUVPacking_NEON &packing) {
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		int16x8_t dr, dg, db;
+		chromaOffsets_NEON(chromaFromBytes_NEON(vld1_u8(uSrc + x / 2)), chromaFromBytes_NEON(vld1_u8(vSrc + x / 2)), packing.itu, dr, dg, db);
+		const int16x8x2_t r = vzipq_s16(dr, dr);
+		const int16x8x2_t g = vzipq_s16(dg, dg);
+		const int16x8x2_t b = vzipq_s16(db, db);
+
+		const uint8x16_t y1 = vld1q_u8(ySrc1 + x);
+		putPixels_NEON(dst1 + x, vget_low_u8(y1), r.val[0], g.val[0], b.val[0], packing);
+		putPixels_NEON(dst1 + x + 8, vget_high_u8(y1), r.val[1], g.val[1], b.val[1], packing);
+		const uint8x16_t y2 = vld1q_u8(ySrc2 + x);
+		putPixels_NEON(dst2 + x, vget_low_u8(y2), r.val[0], g.val[0], b.val[0], packing);
+		putPixels_NEON(dst2 + x + 8, vget_high_u8(y2), r.val[1], g.val[1], b.val[1], packing);
+	}
+	return x;
+}
+
+// Interpolate the chroma of eight pixels horizontally, in the form
+// chromaOffsets_NEON() takes
+static inline int16x8_t interpolateColumns_NEON(const uint16 *columns) {
+	static const uint16 leftWeights[8] = { 4, 3, 2, 1, 4, 3, 2, 1 };
+	static const uint16 rightWeights[8] = { 0, 1, 2, 3, 0, 1, 2, 3 };
+
+	const uint16x4_t c = vld1_u16(columns);
+	const uint16x8_t left = vcombine_u16(vdup_lane_u16(c, 0), vdup_lane_u16(c, 1));
+	const uint16x8_t right = vcombine_u16(vdup_lane_u16(c, 1), vdup_lane_u16(c, 2));
+	const uint16x8_t value = vshrq_n_u16(vmlaq_u16(vmulq_u16(left, vld1q_u16(leftWeights)), right, vld1q_u16(rightWeights)), 4);
+	return vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(value), vdupq_n_s16(128)), 7);
+}
+
+// Convert a row with the chroma of every fourth pixel, interpolated
+// vertically already, returning the number of pixels done
+template<typename PixelInt>
+static int convertRow410_NEON(PixelInt *dst, const byte *ySrc, const uint16 *uColumns, const uint16 *vColumns, int width, const YUVPacking_NEON &packing) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		int16x8_t dr, dg, db;
+		chromaOffsets_NEON(interpolateColumns_NEON(uColumns + x / 4), interpolateColumns_NEON(vColumns + x / 4), packing.itu, dr, dg, db);
+		putPixels_NEON(dst + x, vld1_u8(ySrc + x), dr, dg, db, packing);
+	}
+	return x;
+}
+
+#define YUVPacking YUVPacking_NEON
+#define convertRow444_SIMD convertRow444_NEON
+#define convertRows420_SIMD convertRows420_NEON
+#define convertRow410_SIMD convertRow410_NEON
+
+#endif
+
+// A pixel from the lookup tables, for the ends of the rows
+template<typename PixelInt>
+static inline PixelInt lookupPixel(const uint32 *rgbToPix, const int16 *colorTab, byte y, byte u, byte v) {
+	const uint32 *L = &rgbToPix[y];
+	return L[colorTab[v]] | L[colorTab[256 + v] + colorTab[512 + u]] | L[colorTab[768 + u]];
+}
+
+template<typename PixelInt>
+void convertYUV444ToRGB_SIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const YUVPacking packing(lookup->getFormat(), lookup->getScale() == YUVToRGBManager::kScaleITU);
+	const uint32 *rgbToPix = lookup->getRGBToPix();
+
+	for (int h = 0; h < yHeight; h++) {
+		PixelInt *dst = (PixelInt *)dstPtr;
+		for (int x = convertRow444_SIMD(dst, ySrc, uSrc, vSrc, yWidth, packing); x < yWidth; x++)
+			dst[x] = lookupPixel<PixelInt>(rgbToPix, colorTab, ySrc[x], uSrc[x], vSrc[x]);
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+template<typename PixelInt>
+void convertYUV420ToRGB_SIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const YUVPacking packing(lookup->getFormat(), lookup->getScale() == YUVToRGBManager::kScaleITU);
+	const uint32 *rgbToPix = lookup->getRGBToPix();
+
+	for (int h = 0; h < yHeight; h += 2) {
+		PixelInt *dst1 = (PixelInt *)dstPtr;
+		PixelInt *dst2 = (PixelInt *)(dstPtr + dstPitch);
+		for (int x = convertRows420_SIMD(dst1, dst2, ySrc, ySrc + yPitch, uSrc, vSrc, yWidth, packing); x < yWidth; x++) {
+			dst1[x] = lookupPixel<PixelInt>(rgbToPix, colorTab, ySrc[x], uSrc[x >> 1], vSrc[x >> 1]);
+			dst2[x] = lookupPixel<PixelInt>(rgbToPix, colorTab, ySrc[yPitch + x], uSrc[x >> 1], vSrc[x >> 1]);
+		}
+
+		dstPtr += dstPitch * 2;
+		ySrc += yPitch * 2;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+// The bilinear interpolation of convertYUV410ToRGB() is done vertically
+// first here, once per chroma sample
+static void interpolateColumns410(uint16 *columns, const byte *src, int uvPitch, int yDiff, int width) {
+	for (int i = 0; i <= width / 4; i++)
+		columns[i] = src[i] * (4 - yDiff) + src[uvPitch + i] * yDiff;
+
+	// The SIMD code loads one more column than it uses
+	columns[width / 4 + 1] = 0;
+}
+
+static inline byte interpolate410(const uint16 *columns, int x) {
+	const int xDiff = x & 3;
+	return (columns[x >> 2] * (4 - xDiff) + columns[(x >> 2) + 1] * xDiff) >> 4;
+}
+
+template<typename PixelInt>
+void convertYUV410ToRGB_SIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const YUVPacking packing(lookup->getFormat(), lookup->getScale() == YUVToRGBManager::kScaleITU);
+	const uint32 *rgbToPix = lookup->getRGBToPix();
+	uint16 uColumns[kYUV410Chunk / 4 + 2], vColumns[kYUV410Chunk / 4 + 2];
+
+	// Like convertYUV410ToRGB(), only do whole groups of four pixels
+	yWidth &= ~3;
+
+	for (int y = 0; y < yHeight; y++) {
+		PixelInt *dst = (PixelInt *)dstPtr;
+		for (int x = 0; x < yWidth; x += kYUV410Chunk) {
+			const int width = MIN<int>(kYUV410Chunk, yWidth - x);
+			interpolateColumns410(uColumns, uSrc + (y >> 2) * uvPitch + x / 4, uvPitch, y & 3, width);
+			interpolateColumns410(vColumns, vSrc + (y >> 2) * uvPitch + x / 4, uvPitch, y & 3, width);
+
+			for (int i = convertRow410_SIMD(dst + x, ySrc + x, uColumns, vColumns, width, packing); i < width; i++)
+				dst[x + i] = lookupPixel<PixelInt>(rgbToPix, colorTab, ySrc[x + i], interpolate410(uColumns, i), interpolate410(vColumns, i));
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+	}
+}
+
+#undef YUVPacking
+#undef convertRow444_SIMD
+#undef convertRows420_SIMD
+#undef convertRow410_SIMD
+
+#endif
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -236,10 +645,17 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+	if (dst->format.bytesPerPixel == 2)
+		convertYUV444ToRGB_SIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else
+		convertYUV444ToRGB_SIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+#else
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
 		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+#endif
 }
 
 template<typename PixelInt>
@@ -274,7 +690,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
@@ -292,10 +708,17 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+	if (dst->format.bytesPerPixel == 2)
+		convertYUV420ToRGB_SIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else
+		convertYUV420ToRGB_SIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+#else
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
 		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+#endif
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -377,10 +800,17 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+	if (dst->format.bytesPerPixel == 2)
+		convertYUV410ToRGB_SIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else
+		convertYUV410ToRGB_SIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+#else
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
 		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+#endif
 }
 
 } // End of namespace Graphics
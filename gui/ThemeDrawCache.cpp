@@ -0,0 +1,271 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "gui/ThemeDrawCache.h"
+
+#include "common/content-hash.h"
+#include "graphics/surface.h"
+
+namespace GUI {
+
+namespace {
+
+void drawStepsUncached(Graphics::VectorRenderer *renderer, const Common::List<Graphics::DrawStep> &steps,
+                       const Common::Rect &area, const Common::Rect &clip, bool clipped, uint32 dynamic) {
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = steps.begin(); step != steps.end(); ++step) {
+		if (clipped)
+			renderer->drawStepClip(area, clip, *step, dynamic);
+		else
+			renderer->drawStep(area, *step, dynamic);
+	}
+}
+
+// Plain fills and lines are drawn about as fast as they are copied, unlike
+// gradients and shadows
+bool worthCaching(const Common::List<Graphics::DrawStep> &steps) {
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = steps.begin(); step != steps.end(); ++step) {
+		if (step->fillMode == Graphics::VectorRenderer::kFillGradient || step->shadow)
+			return true;
+	}
+	return false;
+}
+
+// The renderer colors which the steps draw with without setting them first.
+// Steps use the foreground and background colors for most shapes, but the
+// bevel and gradient colors only for bevels resp. gradient fills.
+uint inheritedColors(const Common::List<Graphics::DrawStep> &steps) {
+	uint set = 0, inherited = 0;
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = steps.begin(); step != steps.end(); ++step) {
+		if (step->fgColor.set)
+			set |= 1 << Graphics::VectorRenderer::kStateColorForeground;
+		if (step->bgColor.set)
+			set |= 1 << Graphics::VectorRenderer::kStateColorBackground;
+		if (step->bevelColor.set)
+			set |= 1 << Graphics::VectorRenderer::kStateColorBevel;
+		if (step->gradColor1.set && step->gradColor2.set)
+			set |= (1 << Graphics::VectorRenderer::kStateColorGradientStart) | (1 << Graphics::VectorRenderer::kStateColorGradientEnd);
+
+		uint used = (1 << Graphics::VectorRenderer::kStateColorForeground) | (1 << Graphics::VectorRenderer::kStateColorBackground);
+		if (step->bevel)
+			used |= 1 << Graphics::VectorRenderer::kStateColorBevel;
+		if (step->fillMode == Graphics::VectorRenderer::kFillGradient)
+			used |= (1 << Graphics::VectorRenderer::kStateColorGradientStart) | (1 << Graphics::VectorRenderer::kStateColorGradientEnd);
+		inherited |= used & ~set;
+	}
+	return inherited;
+}
+
+void saveColors(const Graphics::VectorRenderer *renderer, uint32 *colors) {
+	for (int i = 0; i < Graphics::VectorRenderer::kStateColorCount; ++i)
+		colors[i] = renderer->getStateColor((Graphics::VectorRenderer::StateColor)i);
+}
+
+void grabPixels(byte *dst, const Graphics::Surface *surface, const Common::Rect &r) {
+	const int rowSize = r.width() * surface->format.bytesPerPixel;
+	const byte *src = (const byte *)surface->getBasePtr(r.left, r.top);
+	for (int y = 0; y < r.height(); ++y) {
+		memcpy(dst, src, rowSize);
+		dst += rowSize;
+		src += surface->pitch;
+	}
+}
+
+void putPixels(Graphics::Surface *surface, const Common::Rect &r, const byte *src) {
+	const int rowSize = r.width() * surface->format.bytesPerPixel;
+	byte *dst = (byte *)surface->getBasePtr(r.left, r.top);
+	for (int y = 0; y < r.height(); ++y) {
+		memcpy(dst, src, rowSize);
+		dst += surface->pitch;
+		src += rowSize;
+	}
+}
+
+// Whether the pixels in a rectangle of a surface equal those grabbed earlier
+bool samePixels(const Graphics::Surface *surface, const Common::Rect &r, const byte *pixels) {
+	const int rowSize = r.width() * surface->format.bytesPerPixel;
+	const byte *src = (const byte *)surface->getBasePtr(r.left, r.top);
+	for (int y = 0; y < r.height(); ++y) {
+		if (memcmp(src, pixels, rowSize))
+			return false;
+		pixels += rowSize;
+		src += surface->pitch;
+	}
+	return true;
+}
+
+uint64 hashPixels(const Graphics::Surface *surface, const Common::Rect &r) {
+	const int rowSize = r.width() * surface->format.bytesPerPixel;
+	const byte *src = (const byte *)surface->getBasePtr(r.left, r.top);
+	Common::ContentHash hash;
+	for (int y = 0; y < r.height(); ++y) {
+		hash.update(src, rowSize);
+		src += surface->pitch;
+	}
+	return hash.finish();
+}
+
+} // End of anonymous namespace
+
+bool ThemeDrawCache::Key::operator==(const Key &key) const {
+	return id == key.id && dynamic == key.dynamic && w == key.w && h == key.h && rect == key.rect &&
+	       parity == key.parity && clipped == key.clipped && shadows == key.shadows &&
+	       bytesPerPixel == key.bytesPerPixel && background == key.background &&
+	       !memcmp(colors, key.colors, sizeof(colors));
+}
+
+uint ThemeDrawCache::KeyHash::operator()(const Key &key) const {
+	uint hash = key.id;
+	hash = hash * 31 + key.dynamic;
+	hash = hash * 31 + (((uint16)key.w << 16) | (uint16)key.h);
+	hash = hash * 31 + (((uint16)key.rect.left << 16) | (uint16)key.rect.top);
+	hash = hash * 31 + (((uint16)key.rect.right << 16) | (uint16)key.rect.bottom);
+	hash = hash * 31 + ((key.parity << 2) | (key.clipped << 1) | key.shadows);
+	hash = hash * 31 + (uint)(key.background ^ (key.background >> 32));
+	for (int i = 0; i < Graphics::VectorRenderer::kStateColorCount; ++i)
+		hash = hash * 31 + key.colors[i];
+	return hash;
+}
+
+ThemeDrawCache::ThemeDrawCache() : _budget(kDefaultBudget), _memoryUsage(0) {
+	resetStats();
+}
+
+ThemeDrawCache::~ThemeDrawCache() {
+	clear();
+}
+
+void ThemeDrawCache::drawSteps(Graphics::VectorRenderer *renderer, DrawData id, const Common::List<Graphics::DrawStep> &steps,
+                               const Common::Rect &area, const Common::Rect &dirty, const Common::Rect &clip, bool clipped, uint32 dynamic) {
+	Graphics::Surface *surface = renderer->getSurface();
+	const Graphics::PixelFormat &format = surface->format;
+
+	// The pixels the steps change
+	Common::Rect rect = dirty;
+	if (clipped)
+		rect.clip(clip);
+	rect.clip(surface->w, surface->h);
+
+	const uint32 size = rect.width() * rect.height() * format.bytesPerPixel;
+	if (rect.isEmpty() || size * 2 > _budget || !worthCaching(steps)) {
+		drawStepsUncached(renderer, steps, area, clip, clipped, dynamic);
+		return;
+	}
+
+	uint32 colors[Graphics::VectorRenderer::kStateColorCount];
+	saveColors(renderer, colors);
+
+	Key key;
+	key.id = id;
+	key.dynamic = dynamic;
+	key.w = area.width();
+	key.h = area.height();
+	key.rect = rect;
+	key.rect.translate(-area.left, -area.top);
+	key.parity = (area.left & 1) | ((area.top & 1) << 1);
+	key.clipped = clipped;
+	key.shadows = !renderer->areShadowsDisabled();
+	key.bytesPerPixel = format.bytesPerPixel;
+
+	const uint inherited = inheritedColors(steps);
+	for (int i = 0; i < Graphics::VectorRenderer::kStateColorCount; ++i)
+		key.colors[i] = (inherited & (1 << i)) ? colors[i] : 0;
+
+	key.background = hashPixels(surface, rect);
+
+	Entry *entry;
+	EntryMap::iterator i = _entries.find(key);
+	if (i != _entries.end()) {
+		entry = i->_value;
+
+		// Two different backgrounds may still have the same hash
+		if (!samePixels(surface, rect, entry->background)) {
+			drawStepsUncached(renderer, steps, area, clip, clipped, dynamic);
+			return;
+		}
+
+		putPixels(surface, rect, entry->pixels);
+
+		// Later items may depend on the colors the steps set
+		Common::List<Graphics::DrawStep>::const_iterator step;
+		for (step = steps.begin(); step != steps.end(); ++step)
+			renderer->setStepState(*step, dynamic);
+
+		_lru.erase(entry->lruPos);
+		_stats.hits++;
+	} else {
+		entry = new Entry;
+		entry->key = key;
+		entry->background = new byte[size];
+		entry->pixels = new byte[size];
+		entry->size = size * 2;
+
+		grabPixels(entry->background, surface, rect);
+		drawStepsUncached(renderer, steps, area, clip, clipped, dynamic);
+		grabPixels(entry->pixels, surface, rect);
+
+		_entries[key] = entry;
+		_memoryUsage += entry->size;
+		_stats.misses++;
+	}
+
+	_lru.push_front(entry);
+	entry->lruPos = _lru.begin();
+	shrink(_budget);
+}
+
+void ThemeDrawCache::clear() {
+	while (!_lru.empty())
+		remove(_lru.back());
+}
+
+void ThemeDrawCache::setBudget(uint32 budget) {
+	_budget = budget;
+	shrink(_budget);
+}
+
+void ThemeDrawCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
+
+void ThemeDrawCache::remove(Entry *entry) {
+	_lru.erase(entry->lruPos);
+	_entries.erase(entry->key);
+	_memoryUsage -= entry->size;
+
+	delete[] entry->background;
+	delete[] entry->pixels;
+	delete entry;
+}
+
+void ThemeDrawCache::shrink(uint32 budget) {
+	while (_memoryUsage > budget && !_lru.empty()) {
+		remove(_lru.back());
+		_stats.evictions++;
+	}
+}
+
+} // End of namespace GUI
@@ -0,0 +1,150 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GUI_THEMEDRAWCACHE_H
+#define GUI_THEMEDRAWCACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/rect.h"
+#include "graphics/VectorRenderer.h"
+#include "gui/ThemeEngine.h"
+
+namespace GUI {
+
+/**
+ * Remembers what drawing a DrawData item looks like, so that drawing the
+ * same item at the same size again turns into a copy. Dialogs draw all
+ * their backgrounds and buttons anew whenever they are redrawn, which
+ * otherwise means rasterizing the same gradients, rounded corners and
+ * shadows over and over again. Items without gradients or shadows are
+ * drawn as fast as they are copied, and are not cached.
+ *
+ * Items are identified by their DrawData id and size. The parity of their
+ * position, which gradients are dithered by, the renderer colors their
+ * steps do not set themselves and the background they are drawn on, which
+ * antialiased edges and shadows are blended with, are part of the key as
+ * well. An entry keeps the background next to the drawn pixels, and is
+ * only used if the background matches exactly, so that copying it gives
+ * the same result as drawing the item.
+ *
+ * The ids refer to the steps of the loaded theme, thus the cache has to be
+ * cleared when the theme changes. When the cached pixels exceed the memory
+ * budget, the least recently used ones are dropped.
+ */
+class ThemeDrawCache {
+public:
+	enum {
+		kDefaultBudget = 4 * 1024 * 1024
+	};
+
+	struct Stats {
+		uint32 hits;
+		uint32 misses;
+		uint32 evictions;
+	};
+
+	ThemeDrawCache();
+	~ThemeDrawCache();
+
+	/**
+	 * Draw the steps of an item on the active surface of a renderer, or
+	 * copy the result of drawing them earlier.
+	 *
+	 * @param renderer the renderer to draw with
+	 * @param id       the DrawData id of the item
+	 * @param steps    the steps of the item
+	 * @param area     the area of the item
+	 * @param dirty    the part of the surface the steps may change, which
+	 *                 contains @p area
+	 * @param clip     the clipping rectangle, if @p clipped is set
+	 * @param clipped  whether to draw with VectorRenderer::drawStepClip()
+	 * @param dynamic  the dynamic data of the item
+	 */
+	void drawSteps(Graphics::VectorRenderer *renderer, DrawData id, const Common::List<Graphics::DrawStep> &steps,
+	               const Common::Rect &area, const Common::Rect &dirty, const Common::Rect &clip, bool clipped, uint32 dynamic);
+
+	/** Drop all entries. */
+	void clear();
+
+	/**
+	 * Set the number of bytes the cached pixels may take up. Entries are
+	 * dropped right away if they exceed the new budget.
+	 */
+	void setBudget(uint32 budget);
+	uint32 getBudget() const { return _budget; }
+
+	/** Get the number of bytes the cached pixels currently take up. */
+	uint32 getMemoryUsage() const { return _memoryUsage; }
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	struct Key {
+		DrawData id;
+		uint32 dynamic;
+		int16 w, h;
+		// The part of the item which is drawn, relative to its area
+		Common::Rect rect;
+		// Bit 0 for an odd left edge, bit 1 for an odd top edge
+		byte parity;
+		bool clipped;
+		bool shadows;
+		byte bytesPerPixel;
+		// The content hash of the pixels the item is drawn on
+		uint64 background;
+		// The renderer colors the steps inherit, 0 for the others
+		uint32 colors[Graphics::VectorRenderer::kStateColorCount];
+
+		bool operator==(const Key &key) const;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	struct Entry;
+	typedef Common::List<Entry *> EntryList;
+	typedef Common::HashMap<Key, Entry *, KeyHash> EntryMap;
+
+	struct Entry {
+		Key key;
+		byte *background; ///< The pixels before drawing the item
+		byte *pixels;     ///< The pixels after drawing the item
+		uint32 size;
+		EntryList::iterator lruPos;
+	};
+
+	void remove(Entry *entry);
+	void shrink(uint32 budget);
+
+	EntryMap _entries;
+	EntryList _lru; ///< Most recently used first
+	uint32 _budget;
+	uint32 _memoryUsage;
+	Stats _stats;
+};
+
+} // End of namespace GUI
+
+#endif
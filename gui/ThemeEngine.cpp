@@ -40,6 +40,7 @@
 #include "image/png.h"
 
 #include "gui/widget.h"
+#include "gui/ThemeDrawCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -75,6 +76,8 @@ struct TextColorData {
 };
 
 struct WidgetDrawData {
+	DrawData _id;
+
 	/** List of all the steps needed to draw this widget */
 	Common::List<Graphics::DrawStep> _steps;
 
@@ -280,11 +283,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawCache()->drawSteps(_engine->renderer(), _data->_id, _data->_steps, _area, extendedRect, Common::Rect(), false, _dynamicData);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -301,12 +301,8 @@ void ThemeItemDrawDataClip::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step) {
-			_engine->renderer()->drawStepClip(_area, _clip, *step, _dynamicData);
-		}
-	}
+	if (draw)
+		_engine->drawCache()->drawSteps(_engine->renderer(), _data->_id, _data->_steps, _area, extendedRect, _clip, true, _dynamicData);
 
 	extendedRect.clip(_clip);
 
@@ -373,7 +369,7 @@ void ThemeItemBitmapClip::drawSelf(bool draw, bool restore) {
  * ThemeEngine class
  *********************************************************/
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
-	_system(0), _vectorRenderer(0),
+	_system(0), _vectorRenderer(0), _drawCache(0),
 	_buffering(false), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
 	_font(0), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
 	_cursor(0) {
@@ -381,6 +377,7 @@ ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system = g_system;
 	_parser = new ThemeParser(this);
 	_themeEval = new GUI::ThemeEval();
+	_drawCache = new ThemeDrawCache();
 
 	_useCursor = false;
 
@@ -427,6 +424,7 @@ ThemeEngine::~ThemeEngine() {
 	_backBuffer.free();
 
 	unloadTheme();
+	delete _drawCache;
 
 	// Release all graphics surfaces
 	for (ImagesMap::iterator i = _bitmaps.begin(); i != _bitmaps.end(); ++i) {
@@ -644,6 +642,9 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_screen.free();
 	_screen.create(width, height, _overlayFormat);
 
+	// The cached results were drawn on the old surfaces
+	_drawCache->clear();
+
 	delete _vectorRenderer;
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
@@ -675,6 +676,38 @@ void ThemeEngine::restoreBackground(Common::Rect r) {
 	_vectorRenderer->blitSurface(&_backBuffer, r);
 }
 
+bool ThemeEngine::moveScreenArea(const Common::Rect &r, int dy) {
+	Common::Rect dst = r;
+	dst.translate(0, dy);
+
+	const Common::Rect screen(_screen.w, _screen.h);
+	if (_buffering || !dy || r.isEmpty() || !screen.contains(r) || !screen.contains(dst))
+		return false;
+
+	// Copy the rows in the order which does not overwrite the ones still to copy
+	const int rowSize = r.width() * _screen.format.bytesPerPixel;
+	for (int i = 0; i < r.height(); ++i) {
+		const int y = dy > 0 ? r.bottom - 1 - i : r.top + i;
+		memcpy(_screen.getBasePtr(r.left, y + dy), _screen.getBasePtr(r.left, y), rowSize);
+	}
+
+	addDirtyRect(dst);
+	return true;
+}
+
+bool ThemeEngine::hasSameBackground(const Common::Rect &a, const Common::Rect &b) const {
+	const Common::Rect screen(_backBuffer.w, _backBuffer.h);
+	if (a.width() != b.width() || a.height() != b.height() || !screen.contains(a) || !screen.contains(b))
+		return false;
+
+	const int rowSize = a.width() * _backBuffer.format.bytesPerPixel;
+	for (int y = 0; y < a.height(); ++y) {
+		if (memcmp(_backBuffer.getBasePtr(a.left, a.top + y), _backBuffer.getBasePtr(b.left, b.top + y), rowSize))
+			return false;
+	}
+	return true;
+}
+
 
 
 /**********************************************************
@@ -871,6 +904,7 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 		delete _widgets[id];
 
 	_widgets[id] = new WidgetDrawData;
+	_widgets[id]->_id = id;
 	_widgets[id]->_buffer = kDrawDataDefaults[id].buffer;
 	_widgets[id]->_textDataId = kTextDataNone;
 
@@ -926,6 +960,9 @@ void ThemeEngine::unloadTheme() {
 		_textColors[i] = 0;
 	}
 
+	// The cached items were drawn with the steps of this theme
+	_drawCache->clear();
+
 	_themeEval->reset();
 	_themeOk = false;
 }
@@ -53,6 +53,7 @@ struct TextDrawData;
 struct TextColorData;
 class Dialog;
 class GuiObject;
+class ThemeDrawCache;
 class ThemeEval;
 class ThemeItem;
 class ThemeParser;
@@ -543,6 +544,7 @@ public:
 
 	inline ThemeEval *getEvaluator() { return _themeEval; }
 	inline Graphics::VectorRenderer *renderer() { return _vectorRenderer; }
+	inline ThemeDrawCache *drawCache() { return _drawCache; }
 
 	inline bool supportsImages() const { return true; }
 	inline bool ownCursor() const { return _useCursor; }
@@ -581,6 +583,25 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Moves a part of the screen vertically, as when the contents of a
+	 * widget scroll, and marks where it moved to as dirty. Only possible
+	 * while drawing straight on the screen, because queued items would be
+	 * drawn after the move.
+	 *
+	 * @param r  Area to move.
+	 * @param dy Distance to move it down by.
+	 * @return false if nothing was moved.
+	 */
+	bool moveScreenArea(const Common::Rect &r, int dy);
+
+	/**
+	 * Checks whether the Back Buffer holds the same pixels in two areas,
+	 * so that anything drawn on one of them looks the same moved to the
+	 * other one.
+	 */
+	bool hasSameBackground(const Common::Rect &a, const Common::Rect &b) const;
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -683,6 +704,9 @@ protected:
 	/** Vector Renderer object, does the actual drawing on screen */
 	Graphics::VectorRenderer *_vectorRenderer;
 
+	/** Results of drawing DrawData items, copied rather than drawn again */
+	GUI::ThemeDrawCache *_drawCache;
+
 	/** XML Parser, does the Theme parsing instead of the default parser */
 	GUI::ThemeParser *_parser;
 
@@ -23,19 +23,23 @@
 // NB: This is really only necessary if USE_READLINE is defined
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
+#include "common/archive.h"
 #include "common/debug.h"
 #include "common/debug-channels.h"
+#include "common/memorypool.h"
 #include "common/system.h"
 
 #ifndef DISABLE_MD5
 #include "common/md5.h"
-#include "common/archive.h"
 #include "common/macresman.h"
 #include "common/stream.h"
 #endif
 
 #include "engines/engine.h"
 
+#include "audio/decoded_sound_cache.h"
+#include "audio/mixer.h"
+
 #include "gui/debugger.h"
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 	#include "gui/console.h"
@@ -78,6 +82,11 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+
+	registerCmd("soundcache",		WRAP_METHOD(Debugger, cmdSoundCache));
+	registerCmd("audio",			WRAP_METHOD(Debugger, cmdAudio));
+	registerCmd("searchman",		WRAP_METHOD(Debugger, cmdSearchMan));
+	registerCmd("allocators",		WRAP_METHOD(Debugger, cmdAllocators));
 }
 
 Debugger::~Debugger() {
@@ -781,6 +790,101 @@ bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmdSoundCache(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "clear")) {
+		DecodedSounds.clear();
+	} else if (argc == 2 && !strcmp(argv[1], "reset")) {
+		DecodedSounds.resetStats();
+	} else if (argc != 1) {
+		debugPrintf("soundcache [clear | reset]\n");
+		return true;
+	}
+
+	const Audio::DecodedSoundCache::Stats stats = DecodedSounds.getStats();
+	const uint32 lookups = stats.hits + stats.misses;
+	debugPrintf("Decoded sound cache: %u sounds, %u of %u KB used\n", stats.entries,
+	            stats.usedBytes / 1024, DecodedSounds.getMemoryBudget() / 1024);
+	debugPrintf("  hits: %u, misses: %u, hit rate: %u%%\n", stats.hits, stats.misses,
+	            lookups ? stats.hits * 100 / lookups : 0);
+	debugPrintf("  rejected: %u, evicted: %u\n", stats.rejected, stats.evictions);
+	return true;
+}
+
+bool Debugger::cmdAudio(int argc, const char **argv) {
+	Audio::Mixer *mixer = g_system->getMixer();
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		mixer->resetCallbackStats();
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("audio [reset]\n");
+		return true;
+	}
+
+	Audio::Mixer::CallbackStats stats;
+	if (!mixer->getCallbackStats(stats)) {
+		debugPrintf("No audio callback statistics\n");
+		return true;
+	}
+
+	debugPrintf("Audio callback: %u calls at %u Hz, %u missed deadlines\n", stats.callbacks,
+	            mixer->getOutputRate(), stats.missedDeadlines);
+	debugPrintf("  duration p50/p95/p99: %u/%u/%u us\n", stats.durationP50, stats.durationP95, stats.durationP99);
+	debugPrintf("  buffer: %u us, latency: %u us, max latency: %u us\n", stats.bufferLength,
+	            stats.latency, stats.maxLatency);
+	return true;
+}
+
+bool Debugger::cmdSearchMan(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		SearchMan.resetStats();
+	} else if (argc != 1) {
+		debugPrintf("searchman [reset]\n");
+		return true;
+	}
+
+	const Common::SearchSet::Stats stats = SearchMan.getStats();
+	debugPrintf("Search manager: %u names indexed\n", SearchMan.getIndexSize());
+	debugPrintf("  opens: %u, index hits: %u, lookups asking unlisted archives: %u\n",
+	            stats.opens, stats.indexHits, stats.fallbacks);
+	return true;
+}
+
+bool Debugger::cmdAllocators(int argc, const char **argv) {
+	const bool reset = (argc == 2 && !strcmp(argv[1], "reset"));
+	if (argc != 1 && !reset) {
+		debugPrintf("allocators [reset]\n");
+		return true;
+	}
+
+	Common::SizeClassAllocator::ListLock listLock;
+	Common::SizeClassAllocator *allocator = Common::SizeClassAllocator::getFirst();
+	if (!allocator)
+		debugPrintf("No allocators\n");
+
+	for (; allocator; allocator = allocator->getNext()) {
+		if (reset) {
+			allocator->resetStats();
+			continue;
+		}
+
+		const uint32 duration = allocator->getStatsDuration();
+		debugPrintf("Allocator '%s', statistics of the last %u s:\n", allocator->getName(), duration / 1000);
+		debugPrintf("  %-16s %10s %10s %10s %10s\n", "tag", "live KB", "peak KB", "allocs", "allocs/s");
+
+		for (uint tag = 0; tag < Common::SizeClassAllocator::kMaxTags; ++tag) {
+			const Common::SizeClassAllocator::TagStats stats = allocator->getStats(tag);
+			if (!stats.allocations && !stats.liveBytes)
+				continue;
+
+			const char *name = allocator->getTagName(tag);
+			debugPrintf("  %-16s %10u %10u %10u %10u\n", name ? name : Common::String::format("%u", tag).c_str(),
+			            stats.liveBytes / 1024, stats.peakBytes / 1024, stats.allocations,
+			            duration ? (uint32)((uint64)stats.allocations * 1000 / duration) : 0);
+		}
+	}
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
@@ -232,6 +232,10 @@ protected:
 	bool cmdDebugFlagsList(int argc, const char **argv);
 	bool cmdDebugFlagEnable(int argc, const char **argv);
 	bool cmdDebugFlagDisable(int argc, const char **argv);
+	bool cmdSoundCache(int argc, const char **argv);
+	bool cmdAudio(int argc, const char **argv);
+	bool cmdSearchMan(int argc, const char **argv);
+	bool cmdAllocators(int argc, const char **argv);
 
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 private:
@@ -20,6 +20,7 @@ MODULE_OBJS := \
 	saveload.o \
 	saveload-dialog.o \
 	themebrowser.o \
+	ThemeDrawCache.o \
 	ThemeEngine.o \
 	ThemeEval.o \
 	ThemeLayout.o \
@@ -38,6 +38,7 @@ ListWidget::ListWidget(Dialog *boss, const String &name, const char *tooltip, ui
 
 	_scrollBar = NULL;
 	_textWidth = NULL;
+	_drawnPos = -1;
 
 	// This ensures that _entriesPerPage is properly initialized.
 	reflowLayout();
@@ -70,6 +71,7 @@ ListWidget::ListWidget(Dialog *boss, int x, int y, int w, int h, const char *too
 
 	_scrollBar = NULL;
 	_textWidth = NULL;
+	_drawnPos = -1;
 
 	// This ensures that _entriesPerPage is properly initialized.
 	reflowLayout();
@@ -182,6 +184,7 @@ void ListWidget::setList(const StringArray &list, const ColorList *colors) {
 		_currentPos = 0;
 	_selectedItem = -1;
 	_editMode = false;
+	_drawnPos = -1;
 	g_system->setFeatureState(OSystem::kFeatureVirtualKeyboard, false);
 	scrollBarRecalc();
 }
@@ -201,6 +204,7 @@ void ListWidget::append(const String &s, ThemeEngine::FontColor color) {
 
 	_dataList.push_back(s);
 	_list.push_back(s);
+	_drawnPos = -1;
 
 	setFilter(_filter, false);
 
@@ -251,7 +255,7 @@ void ListWidget::handleMouseDown(int x, int y, int button, int clickCount) {
 	// TODO: Determine where inside the string the user clicked and place the
 	// caret accordingly.
 	// See _editScrollOffset and EditTextWidget::handleMouseDown.
-	draw();
+	drawChangedRows();
 
 }
 
@@ -445,8 +449,10 @@ bool ListWidget::handleKeyDown(Common::KeyState state) {
 		scrollToCurrent();
 	}
 
-	if (dirty || _selectedItem != oldSelectedItem)
+	if (dirty)
 		draw();
+	else if (_selectedItem != oldSelectedItem)
+		drawChangedRows();
 
 	if (_selectedItem != oldSelectedItem) {
 		sendCommand(kListSelectionChangedCmd, _selectedItem);
@@ -486,7 +492,7 @@ void ListWidget::handleCommand(CommandSender *sender, uint32 cmd, uint32 data) {
 		if (_currentPos != (int)data) {
 			_currentPos = data;
 			checkBounds();
-			draw();
+			drawChangedRows();
 
 			// Scrollbar actions cause list focus (which triggers a redraw)
 			// NOTE: ListWidget's boss is always GUI::Dialog
@@ -498,60 +504,163 @@ void ListWidget::handleCommand(CommandSender *sender, uint32 cmd, uint32 data) {
 
 void ListWidget::drawWidget() {
 	int i, pos, len = _list.size();
-	Common::String buffer;
 
 	// Draw a thin frame around the list.
 	g_gui.theme()->drawWidgetBackgroundClip(Common::Rect(_x, _y, _x + _w, _y + _h), getBossClipRect(), 0, ThemeEngine::kWidgetBackgroundBorder);
-	const int scrollbarW = (_scrollBar && _scrollBar->isVisible()) ? _scrollBarWidth : 0;
 
 	// Draw the list items
-	for (i = 0, pos = _currentPos; i < _entriesPerPage && pos < len; i++, pos++) {
-		const int y = _y + _topPadding + kLineHeight * i;
-		const int fontHeight = kLineHeight;
-		ThemeEngine::TextInversionState inverted = ThemeEngine::kTextInversionNone;
-
-		// Draw the selected item inverted, on a highlighted background.
-		if (_selectedItem == pos)
-			inverted = _inversion;
-
-		Common::Rect r(getEditRect());
-		int pad = _leftPadding;
-
-		// If in numbering mode, we first print a number prefix
-		if (_numberingMode != kListNumberingOff) {
-			buffer = Common::String::format("%2d. ", (pos + _numberingMode));
-			g_gui.theme()->drawTextClip(Common::Rect(_x, y, _x + r.left + _leftPadding, y + fontHeight - 2), getBossClipRect(),
-									buffer, _state, Graphics::kTextAlignLeft, inverted, _leftPadding, true);
-			pad = 0;
-		}
+	for (i = 0, pos = _currentPos; i < _entriesPerPage && pos < len; i++, pos++)
+		drawRow(i);
 
-		int width;
+	// The caret and the edited text are not tracked
+	_drawnPos = _editMode ? -1 : _currentPos;
+	_drawnSelected = _selectedItem;
+	_drawnInversion = _inversion;
+	_drawnState = _state;
+	_rowBackgrounds.clear();
+}
 
-		ThemeEngine::FontColor color = ThemeEngine::kFontColorNormal;
+void ListWidget::drawChangedRows() {
+	if (!isVisible() || !_boss->isVisible())
+		return;
 
-		if (!_listColors.empty()) {
-			if (_filter.empty() || _selectedItem == -1)
-				color = _listColors[pos];
+	if (_drawnPos < 0 || _editMode || (getFlags() & WIDGET_BORDER) || _drawnInversion != _inversion || _drawnState != _state) {
+		draw();
+		return;
+	}
+
+	// Account for our relative position in the dialog, like draw() does
+	const int oldX = _x, oldY = _y;
+	_x = getAbsX();
+	_y = getAbsY();
+
+	// The back buffer is only up to date once the whole list was drawn
+	if (_rowBackgrounds.empty()) {
+		_rowBackgrounds.resize(_entriesPerPage);
+		for (int i = 0; i < _entriesPerPage; i++) {
+			if (i > 0 && g_gui.theme()->hasSameBackground(getRowRect(i - 1), getRowRect(i)))
+				_rowBackgrounds[i] = _rowBackgrounds[i - 1];
 			else
-				color = _listColors[_listIndex[pos]];
+				_rowBackgrounds[i] = i;
 		}
+	}
 
-		if (_selectedItem == pos && _editMode) {
-			buffer = _editString;
-			color = _editColor;
-			adjustOffset();
-			width = _w - r.left - _hlRightPadding - _leftPadding - scrollbarW;
-			g_gui.theme()->drawTextClip(Common::Rect(_x + r.left, y, _x + r.left + width, y + fontHeight - 2), getBossClipRect(), buffer, _state,
-									Graphics::kTextAlignLeft, inverted, pad, true, ThemeEngine::kFontStyleBold, color);
-		} else {
-			buffer = _list[pos];
-			width = _w - r.left - scrollbarW;
-			g_gui.theme()->drawTextClip(Common::Rect(_x + r.left, y, _x + r.left + width, y + fontHeight - 2), getBossClipRect(), buffer, _state,
-									Graphics::kTextAlignLeft, inverted, pad, true, ThemeEngine::kFontStyleBold, color);
+	// A row which shows the same item as before, in the same way, only
+	// moved. Its pixels can be moved along if it has the same background
+	// at both places.
+	const int len = _list.size();
+	const int delta = _currentPos - _drawnPos;
+	Common::Array<bool> moved;
+	moved.resize(_entriesPerPage);
+	for (int i = 0; i < _entriesPerPage; i++) {
+		const int pos = _currentPos + i;
+		moved[i] = delta && i + delta >= 0 && i + delta < _entriesPerPage &&
+		           _rowBackgrounds[i] == _rowBackgrounds[i + delta] &&
+		           (pos >= len || (pos == _selectedItem) == (pos == _drawnSelected));
+	}
+
+	// Move runs of such rows at once, in the order which does not
+	// overwrite rows still to be moved
+	for (int n = 0; n < _entriesPerPage; n++) {
+		const int first = delta > 0 ? n : _entriesPerPage - 1 - n;
+		if (!moved[first])
+			continue;
+
+		int last = first;
+		while (n + 1 < _entriesPerPage && moved[delta > 0 ? last + 1 : last - 1]) {
+			last = delta > 0 ? last + 1 : last - 1;
+			n++;
+		}
+
+		Common::Rect from = getRowRect(first + delta);
+		from.extend(getRowRect(last + delta));
+		Common::Rect to = getRowRect(first);
+		to.extend(getRowRect(last));
+
+		if (to.width() != from.width() || to.height() != from.height() || !g_gui.theme()->moveScreenArea(from, to.top - from.top)) {
+			for (int i = MIN(first, last); i <= MAX(first, last); i++)
+				moved[i] = false;
 		}
+	}
 
-		_textWidth[i] = width;
+	// Draw everything else which changed
+	for (int i = 0; i < _entriesPerPage; i++) {
+		const int pos = _currentPos + i;
+		if (moved[i] || (!delta && (pos >= len || (pos == _selectedItem) == (pos == _drawnSelected))))
+			continue;
+
+		const Common::Rect r = getRowRect(i);
+		g_gui.theme()->restoreBackground(r);
+		g_gui.theme()->addDirtyRect(r);
+		if (pos < len)
+			drawRow(i);
 	}
+
+	_x = oldX;
+	_y = oldY;
+
+	_drawnPos = _currentPos;
+	_drawnSelected = _selectedItem;
+}
+
+void ListWidget::drawRow(int row) {
+	const int pos = _currentPos + row;
+	const int y = _y + _topPadding + kLineHeight * row;
+	const int fontHeight = kLineHeight;
+	const int scrollbarW = (_scrollBar && _scrollBar->isVisible()) ? _scrollBarWidth : 0;
+	ThemeEngine::TextInversionState inverted = ThemeEngine::kTextInversionNone;
+	Common::String buffer;
+
+	// Draw the selected item inverted, on a highlighted background.
+	if (_selectedItem == pos)
+		inverted = _inversion;
+
+	Common::Rect r(getEditRect());
+	int pad = _leftPadding;
+
+	// If in numbering mode, we first print a number prefix
+	if (_numberingMode != kListNumberingOff) {
+		buffer = Common::String::format("%2d. ", (pos + _numberingMode));
+		g_gui.theme()->drawTextClip(Common::Rect(_x, y, _x + r.left + _leftPadding, y + fontHeight - 2), getBossClipRect(),
+								buffer, _state, Graphics::kTextAlignLeft, inverted, _leftPadding, true);
+		pad = 0;
+	}
+
+	int width;
+
+	ThemeEngine::FontColor color = ThemeEngine::kFontColorNormal;
+
+	if (!_listColors.empty()) {
+		if (_filter.empty() || _selectedItem == -1)
+			color = _listColors[pos];
+		else
+			color = _listColors[_listIndex[pos]];
+	}
+
+	if (_selectedItem == pos && _editMode) {
+		buffer = _editString;
+		color = _editColor;
+		adjustOffset();
+		width = _w - r.left - _hlRightPadding - _leftPadding - scrollbarW;
+		g_gui.theme()->drawTextClip(Common::Rect(_x + r.left, y, _x + r.left + width, y + fontHeight - 2), getBossClipRect(), buffer, _state,
+								Graphics::kTextAlignLeft, inverted, pad, true, ThemeEngine::kFontStyleBold, color);
+	} else {
+		buffer = _list[pos];
+		width = _w - r.left - scrollbarW;
+		g_gui.theme()->drawTextClip(Common::Rect(_x + r.left, y, _x + r.left + width, y + fontHeight - 2), getBossClipRect(), buffer, _state,
+								Graphics::kTextAlignLeft, inverted, pad, true, ThemeEngine::kFontStyleBold, color);
+	}
+
+	_textWidth[row] = width;
+}
+
+Common::Rect ListWidget::getRowRect(int row) const {
+	// The selection background reaches one pixel beyond the text
+	const int scrollbarW = (_scrollBar && _scrollBar->isVisible()) ? _scrollBarWidth : 0;
+	const int y = _y + _topPadding + kLineHeight * row;
+	Common::Rect r(_x - 1, y - 1, _x + _w - scrollbarW + 1, y + kLineHeight - 1);
+	r.clip(getBossClipRect());
+	return r;
 }
 
 Common::Rect ListWidget::getEditRect() const {
@@ -667,6 +776,7 @@ void ListWidget::reflowLayout() {
 
 	_entriesPerPage = fracToInt(entriesPerPage);
 	assert(_entriesPerPage > 0);
+	_drawnPos = -1;
 
 	delete[] _textWidth;
 	_textWidth = new int[_entriesPerPage];
@@ -730,6 +840,7 @@ void ListWidget::setFilter(const String &filter, bool redraw) {
 
 	_currentPos = 0;
 	_selectedItem = -1;
+	_drawnPos = -1;
 
 	if (redraw) {
 		scrollBarRecalc();
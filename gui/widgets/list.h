@@ -84,6 +84,18 @@ protected:
 
 	ThemeEngine::FontColor _editColor;
 
+	/// The scroll position, selection and look the rows were last drawn
+	/// with, so that only the rows which changed are drawn again. -1 when
+	/// the whole list has to be drawn.
+	int				_drawnPos;
+	int				_drawnSelected;
+	ThemeEngine::TextInversionState _drawnInversion;
+	ThemeEngine::WidgetStateInfo _drawnState;
+
+	/// Rows with the same number have the same background. Filled in when
+	/// first needed after drawing the whole list.
+	Common::Array<int>	_rowBackgrounds;
+
 public:
 	ListWidget(Dialog *boss, const String &name, const char *tooltip = 0, uint32 cmd = 0);
 	ListWidget(Dialog *boss, int x, int y, int w, int h, const char *tooltip = 0, uint32 cmd = 0);
@@ -103,7 +115,7 @@ public:
 	const String &getSelectedString() const		{ return _list[_selectedItem]; }
 	ThemeEngine::FontColor getSelectionColor() const;
 
-	void setNumberingMode(NumberingMode numberingMode)	{ _numberingMode = numberingMode; }
+	void setNumberingMode(NumberingMode numberingMode)	{ _numberingMode = numberingMode; _drawnPos = -1; }
 
 	void scrollTo(int item);
 	void scrollToEnd();
@@ -137,6 +149,13 @@ public:
 protected:
 	void drawWidget();
 
+	/// Draw the rows which changed since they were last drawn, moving the
+	/// ones which only scrolled rather than drawing them again.
+	void drawChangedRows();
+	void drawRow(int row);
+	/// The area of a row, including the space between rows.
+	Common::Rect getRowRect(int row) const;
+
 	/// Finds the item at position (x,y). Returns -1 if there is no item there.
 	int findItem(int x, int y) const;
 	void scrollBarRecalc();
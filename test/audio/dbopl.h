@@ -0,0 +1,91 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/dbopl.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+class DBOPLTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	void writeRandomRegister(OPL::DOSBox::DBOPL::Chip &a, OPL::DOSBox::DBOPL::Chip &b, bool opl3) {
+		static const uint32 bases[] = { 0x20, 0x40, 0x60, 0x80, 0xA0, 0xB0, 0xC0, 0xE0, 0xBD };
+		const uint32 base = bases[nextRandom() % ARRAYSIZE(bases)];
+
+		uint32 reg = base;
+		if (base != 0xBD)
+			reg += nextRandom() % (base >= 0xA0 && base <= 0xC0 ? 9 : 22);
+		if (opl3 && (nextRandom() & 1))
+			reg |= 0x100;
+
+		uint8 val = nextRandom() & 0xFF;
+		// Keep the attack rate up, so notes actually become audible
+		if (base == 0x60)
+			val |= 0x80;
+
+		a.WriteReg(reg, val);
+		b.WriteReg(reg, val);
+	}
+
+	void compareLanes(bool opl3, uint32 seconds) {
+		const uint32 rate = 49716;
+		const int channels = opl3 ? 2 : 1;
+
+		OPL::DOSBox::DBOPL::InitTables();
+		OPL::DOSBox::DBOPL::Chip lanes, serial;
+		lanes.Setup(rate);
+		serial.Setup(rate);
+		// Generates every channel on its own, like DOSBox does
+		serial.channelLanes = false;
+
+		if (opl3) {
+			lanes.WriteReg(0x105, 1);
+			serial.WriteReg(0x105, 1);
+			lanes.WriteReg(0x104, 0x3F);
+			serial.WriteReg(0x104, 0x3F);
+		}
+		lanes.WriteReg(0x01, 0x20);
+		serial.WriteReg(0x01, 0x20);
+
+		int32 bufferA[512 * 2], bufferB[512 * 2];
+		_seed = opl3 ? 3 : 2;
+
+		for (uint32 left = rate * seconds; left > 0;) {
+			for (int i = nextRandom() % 8; i >= 0; --i)
+				writeRandomRegister(lanes, serial, opl3);
+
+			const uint32 len = MIN<uint32>(left, 1 + nextRandom() % 512);
+			if (opl3) {
+				lanes.GenerateBlock3(len, bufferA);
+				serial.GenerateBlock3(len, bufferB);
+			} else {
+				lanes.GenerateBlock2(len, bufferA);
+				serial.GenerateBlock2(len, bufferB);
+			}
+
+			// Stop at the first difference, the chips went apart
+			if (memcmp(bufferA, bufferB, len * channels * sizeof(int32))) {
+				TS_FAIL("Output differs");
+				return;
+			}
+			left -= len;
+		}
+	}
+
+public:
+	void test_channel_lanes_opl2() {
+		compareLanes(false, 10);
+	}
+
+	void test_channel_lanes_opl3() {
+		compareLanes(true, 10);
+	}
+};
+
+#endif
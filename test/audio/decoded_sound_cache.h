@@ -0,0 +1,112 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decoded_sound_cache.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+
+#include "common/memstream.h"
+
+#include "test/stub_system.h"
+
+class DecodedSoundCacheTestSuite : public CxxTest::TestSuite {
+private:
+	StubSystem *_system;
+
+	// A mono 8 bit sound of the given length, decoding to 'value' << 8
+	static Audio::SeekableAudioStream *makeSound(uint32 numSamples, int8 value) {
+		byte *data = (byte *)malloc(numSamples);
+		memset(data, value ^ 0x80, numSamples);
+		return Audio::makeRawStream(new Common::MemoryReadStream(data, numSamples, DisposeAfterUse::YES), 11025, Audio::FLAG_UNSIGNED);
+	}
+
+	static bool isCached(const char *member) {
+		Audio::SeekableAudioStream *stream = DecodedSounds.getStream(member, 0);
+		delete stream;
+		return stream != 0;
+	}
+
+	// Add a sound to the cache and drop the stream returned for it
+	static void cache(const char *member, uint32 numSamples) {
+		delete DecodedSounds.cacheStream(member, 0, makeSound(numSamples, 1));
+	}
+
+public:
+	void setUp() {
+		_system = new StubSystem();
+		g_system = _system;
+		DecodedSounds.setMemoryBudget(3000);
+	}
+
+	void tearDown() {
+		Audio::DecodedSoundCache::destroy();
+		g_system = 0;
+		delete _system;
+	}
+
+	void test_lru_eviction() {
+		// Three sounds of 1000 bytes each fill the budget
+		cache("a", 500);
+		cache("b", 500);
+		cache("c", 500);
+		TS_ASSERT(isCached("a"));
+
+		// "b" is now the least recently used sound
+		cache("d", 500);
+		TS_ASSERT(isCached("a"));
+		TS_ASSERT(!isCached("b"));
+		TS_ASSERT(isCached("c"));
+		TS_ASSERT(isCached("d"));
+
+		const Audio::DecodedSoundCache::Stats stats = DecodedSounds.getStats();
+		TS_ASSERT_EQUALS(stats.entries, 3u);
+		TS_ASSERT_EQUALS(stats.evictions, 1u);
+		TS_ASSERT_EQUALS(stats.usedBytes, 3000u);
+	}
+
+	void test_budget() {
+		DecodedSounds.setMaxSoundSize(2000);
+
+		// Sounds too large are passed through untouched
+		Audio::SeekableAudioStream *large = makeSound(1001, 1);
+		TS_ASSERT_EQUALS(DecodedSounds.cacheStream("large", 0, large), large);
+		delete large;
+		TS_ASSERT(!isCached("large"));
+		TS_ASSERT_EQUALS(DecodedSounds.getStats().rejected, 1u);
+
+		cache("a", 1000);
+		cache("b", 400);
+		TS_ASSERT_EQUALS(DecodedSounds.getStats().usedBytes, 2800u);
+
+		// Lowering the budget evicts right away
+		DecodedSounds.setMemoryBudget(1000);
+		TS_ASSERT(!isCached("a"));
+		TS_ASSERT(isCached("b"));
+		TS_ASSERT_EQUALS(DecodedSounds.getStats().usedBytes, 800u);
+	}
+
+	void test_shared_sound() {
+		Audio::SeekableAudioStream *first = DecodedSounds.cacheStream("a", 0, makeSound(100, 2));
+		Audio::SeekableAudioStream *second = DecodedSounds.getStream("a", 0);
+		TS_ASSERT(first);
+		TS_ASSERT(second);
+		TS_ASSERT_DIFFERS(first, second);
+
+		// Streams keep playing the sound after the cache dropped it,
+		// and even after the cache itself is gone
+		DecodedSounds.clear();
+		TS_ASSERT(!isCached("a"));
+		Audio::DecodedSoundCache::destroy();
+
+		int16 buffer[120];
+		TS_ASSERT_EQUALS(first->readBuffer(buffer, 120), 100);
+		TS_ASSERT_EQUALS(buffer[0], 2 << 8);
+		TS_ASSERT_EQUALS(buffer[99], 2 << 8);
+		TS_ASSERT(first->endOfData());
+		delete first;
+
+		TS_ASSERT(second->rewind());
+		TS_ASSERT_EQUALS(second->readBuffer(buffer, 50), 50);
+		TS_ASSERT_EQUALS(buffer[49], 2 << 8);
+		delete second;
+	}
+};
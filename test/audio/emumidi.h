@@ -0,0 +1,174 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/midiparser.h"
+#include "audio/softsynth/emumidi.h"
+
+#include "test/stub_system.h"
+
+class EmulatedMidiTestSuite : public CxxTest::TestSuite
+{
+private:
+	class TestDriver : public MidiDriver_Emulated {
+	public:
+		TestDriver() : MidiDriver_Emulated(0), _generated(0), _numEvents(0), _ticks(0) {}
+
+		int _generated;
+		int _eventSamples[64];
+		uint32 _eventMsgs[64];
+		int _numEvents;
+		int _ticks;
+
+		bool isStereo() const { return false; }
+		int getRate() const { return 10000; }
+
+		void close() {}
+		MidiChannel *allocateChannel() { return 0; }
+		MidiChannel *getPercussionChannel() { return 0; }
+
+	protected:
+		void playEvent(uint32 b) {
+			if (_numEvents == ARRAYSIZE(_eventMsgs))
+				return;
+			_eventMsgs[_numEvents] = b;
+			_eventSamples[_numEvents++] = _generated;
+		}
+
+		// SysEx messages are recorded as 0xF0 followed by their first byte
+		void playSysEx(const byte *msg, uint16 length) {
+			playEvent(0xF0 | (msg[0] << 8));
+		}
+
+		void generateSamples(int16 *buf, int len) {
+			memset(buf, 0, len * sizeof(int16));
+			_generated += len;
+		}
+	};
+
+	static void timerProc(void *param) {
+		TestDriver *driver = (TestDriver *)param;
+		if (driver->_ticks++ == 1) {
+			driver->sendDelayed(0x80, 2500);
+			driver->sendDelayed(0x90, 1000);
+			driver->send(0xB0);
+		}
+	}
+
+	static void sysExTimerProc(void *param) {
+		TestDriver *driver = (TestDriver *)param;
+		if (driver->_ticks++ == 1) {
+			const byte data[] = { 0x41, 0x10, 0x16 };
+			driver->sendDelayed(0x90, 2000);
+			driver->sysExDelayed(data, sizeof(data), 1000);
+			// Not delayed, so it goes after everything sent before
+			driver->send(0xB0);
+			// Not delayed, so it is queued ahead of the delayed events
+			driver->sendDelayed(0x80, 0);
+		}
+	}
+
+	StubSystem *_system;
+
+public:
+	void setUp() {
+		_system = new StubSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = 0;
+		delete _system;
+	}
+
+	void test_delayed_events() {
+		TestDriver driver;
+		driver.open();
+		driver.setTimerCallback(&driver, timerProc);
+
+		// 10000 Hz at the default 250 Hz timer gives 40 samples per tick.
+		// The first tick happens right away, the second one after 40 samples.
+		int16 buffer[200];
+		TS_ASSERT_EQUALS(driver.readBuffer(buffer, 200), 200);
+		TS_ASSERT_EQUALS(driver._generated, 200);
+
+		// The plain send() is played right after the events sent before it
+		TS_ASSERT_EQUALS(driver._numEvents, 3);
+		TS_ASSERT_EQUALS(driver._eventMsgs[0], 0x90u);
+		TS_ASSERT_EQUALS(driver._eventSamples[0], 50);
+		TS_ASSERT_EQUALS(driver._eventMsgs[1], 0x80u);
+		TS_ASSERT_EQUALS(driver._eventSamples[1], 65);
+		TS_ASSERT_EQUALS(driver._eventMsgs[2], 0xB0u);
+		TS_ASSERT_EQUALS(driver._eventSamples[2], 65);
+	}
+
+	void test_delayed_events_outside_timer() {
+		TestDriver driver;
+		driver.open();
+
+		driver.sendDelayed(0x90, 1000);
+		TS_ASSERT_EQUALS(driver._numEvents, 1);
+		TS_ASSERT_EQUALS(driver._eventSamples[0], 0);
+	}
+
+	void test_delayed_sysex_and_undelayed() {
+		TestDriver driver;
+		driver.open();
+		driver.setTimerCallback(&driver, sysExTimerProc);
+
+		int16 buffer[200];
+		TS_ASSERT_EQUALS(driver.readBuffer(buffer, 200), 200);
+
+		// The plain send() is queued after the events sent before it,
+		// sendDelayed() with no delay at the start of the tick
+		TS_ASSERT_EQUALS(driver._numEvents, 4);
+		TS_ASSERT_EQUALS(driver._eventMsgs[0], 0x80u);
+		TS_ASSERT_EQUALS(driver._eventSamples[0], 40);
+		TS_ASSERT_EQUALS(driver._eventMsgs[1], 0x41F0u);
+		TS_ASSERT_EQUALS(driver._eventSamples[1], 50);
+		TS_ASSERT_EQUALS(driver._eventMsgs[2], 0x90u);
+		TS_ASSERT_EQUALS(driver._eventSamples[2], 60);
+		TS_ASSERT_EQUALS(driver._eventMsgs[3], 0xB0u);
+		TS_ASSERT_EQUALS(driver._eventSamples[3], 60);
+	}
+
+	void test_parser_loop_after_notes() {
+		// A track playing C at its start and D just before its end, with
+		// 96 ticks per quarter note at the default tempo of 500000
+		// microseconds per quarter note, so a tick takes 5208 microseconds.
+		static const byte smf[] = {
+			'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+			'M', 'T', 'r', 'k', 0, 0, 0, 12,
+			0, 0x90, 0x3C, 0x40,
+			11, 0x90, 0x3E, 0x40,
+			0, 0xFF, 0x2F, 0
+		};
+
+		TestDriver driver;
+		driver.open();
+
+		MidiParser *parser = MidiParser::createParser_SMF();
+		parser->setMidiDriver(&driver);
+		parser->setTimerRate(driver.getBaseTempo());
+		parser->property(MidiParser::mpAutoLoop, 1);
+		TS_ASSERT(parser->loadMusic(const_cast<byte *>(smf), sizeof(smf)));
+		driver.setTimerCallback(parser, MidiParser::timerCallback);
+
+		// D and the end of the track are due 57288 microseconds in, which
+		// is 12 samples into the tick starting at 56000 microseconds.
+		int16 buffer[1000];
+		TS_ASSERT_EQUALS(driver.readBuffer(buffer, 1000), 1000);
+		delete parser;
+
+		// Looping stops D at the end of the track, after it started
+		int noteOn = -1, noteOff = -1;
+		for (int i = 0; i < driver._numEvents; ++i) {
+			if (driver._eventMsgs[i] == 0x403E90u && noteOn < 0)
+				noteOn = i;
+			else if (driver._eventMsgs[i] == 0x3E80u && noteOff < 0)
+				noteOff = i;
+		}
+		TS_ASSERT_LESS_THAN_EQUALS(0, noteOn);
+		TS_ASSERT_LESS_THAN(noteOn, noteOff);
+		TS_ASSERT_EQUALS(driver._eventSamples[noteOn], 14 * 40 + 12);
+		TS_ASSERT_EQUALS(driver._eventSamples[noteOff], 14 * 40 + 12);
+	}
+};
@@ -0,0 +1,209 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/decoders/quicktime.h"
+
+#include "common/memstream.h"
+
+#include "test/stub_system.h"
+
+class QuickTimeTestSuite : public CxxTest::TestSuite {
+private:
+	StubSystem *_system;
+
+	/**
+	 * Counts the reads which reach the underlying stream, like the system
+	 * calls a file would make.
+	 */
+	class CountingStream : public Common::MemoryReadStream {
+	public:
+		CountingStream(const byte *data, uint32 size, uint &reads) : Common::MemoryReadStream(data, size), _reads(reads) {}
+
+		uint32 read(void *dataPtr, uint32 dataSize) { _reads++; return Common::MemoryReadStream::read(dataPtr, dataSize); }
+
+	private:
+		uint &_reads;
+	};
+
+	enum {
+		kRate = 11025,
+		kChunkSamples = 512,
+		kChunks = 40
+	};
+
+	static byte sample(uint i) { return (byte)(i * 7 + i / 300); }
+
+	static void beginAtom(Common::MemoryWriteStreamDynamic &out, uint32 type, Common::Array<uint32> &open) {
+		open.push_back(out.pos());
+		out.writeUint32BE(0);
+		out.writeUint32BE(type);
+	}
+
+	static void endAtom(Common::MemoryWriteStreamDynamic &out, Common::Array<uint32> &open) {
+		const uint32 start = open.back();
+		open.pop_back();
+		WRITE_BE_UINT32(out.getData() + start, out.pos() - start);
+	}
+
+	static void writeMatrix(Common::MemoryWriteStreamDynamic &out) {
+		static const uint32 matrix[] = { 0x10000, 0, 0, 0, 0x10000, 0, 0, 0, 0x40000000 };
+		for (uint i = 0; i < ARRAYSIZE(matrix); ++i)
+			out.writeUint32BE(matrix[i]);
+	}
+
+	/**
+	 * Build a movie with a single track of 8 bit mono raw samples, the
+	 * 'mdat' atom holding the samples first and the 'moov' atom last.
+	 */
+	static void buildMovie(Common::MemoryWriteStreamDynamic &out) {
+		Common::Array<uint32> open;
+		const uint32 numSamples = kChunks * kChunkSamples;
+
+		beginAtom(out, MKTAG('m', 'd', 'a', 't'), open);
+		const uint32 dataStart = out.pos();
+		for (uint32 i = 0; i < numSamples; ++i)
+			out.writeByte(sample(i));
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('m', 'o', 'o', 'v'), open);
+
+		beginAtom(out, MKTAG('m', 'v', 'h', 'd'), open);
+		out.writeUint32BE(0); // version and flags
+		out.writeUint32BE(0); out.writeUint32BE(0);
+		out.writeUint32BE(kRate);
+		out.writeUint32BE(numSamples);
+		out.writeUint32BE(0x10000);
+		out.writeUint16BE(0x100);
+		for (uint i = 0; i < 10; ++i)
+			out.writeByte(0);
+		writeMatrix(out);
+		for (uint i = 0; i < 7; ++i)
+			out.writeUint32BE(i == 6 ? 2 : 0);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('t', 'r', 'a', 'k'), open);
+
+		beginAtom(out, MKTAG('t', 'k', 'h', 'd'), open);
+		out.writeUint32BE(3); // version and flags
+		out.writeUint32BE(0); out.writeUint32BE(0);
+		out.writeUint32BE(1); // track id
+		out.writeUint32BE(0);
+		out.writeUint32BE(numSamples);
+		out.writeUint32BE(0); out.writeUint32BE(0);
+		out.writeUint16BE(0); out.writeUint16BE(0); out.writeUint16BE(0x100); out.writeUint16BE(0);
+		writeMatrix(out);
+		out.writeUint32BE(0); out.writeUint32BE(0);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('m', 'd', 'i', 'a'), open);
+
+		beginAtom(out, MKTAG('m', 'd', 'h', 'd'), open);
+		out.writeUint32BE(0);
+		out.writeUint32BE(0); out.writeUint32BE(0);
+		out.writeUint32BE(kRate);
+		out.writeUint32BE(numSamples);
+		out.writeUint16BE(0); out.writeUint16BE(0);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('h', 'd', 'l', 'r'), open);
+		out.writeUint32BE(0);
+		out.writeUint32BE(MKTAG('m', 'h', 'l', 'r'));
+		out.writeUint32BE(MKTAG('s', 'o', 'u', 'n'));
+		out.writeUint32BE(0); out.writeUint32BE(0); out.writeUint32BE(0);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('m', 'i', 'n', 'f'), open);
+
+		beginAtom(out, MKTAG('s', 'm', 'h', 'd'), open);
+		out.writeUint32BE(0); out.writeUint32BE(0);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('s', 't', 'b', 'l'), open);
+
+		beginAtom(out, MKTAG('s', 't', 's', 'd'), open);
+		out.writeUint32BE(0);
+		out.writeUint32BE(1);
+		out.writeUint32BE(36);
+		out.writeUint32BE(MKTAG('r', 'a', 'w', ' '));
+		out.writeUint32BE(0); out.writeUint16BE(0); out.writeUint16BE(1);
+		out.writeUint16BE(0); out.writeUint16BE(0); out.writeUint32BE(0);
+		out.writeUint16BE(1); // channels
+		out.writeUint16BE(8); // bits per sample
+		out.writeUint16BE(0); out.writeUint16BE(0);
+		out.writeUint32BE(kRate << 16);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('s', 't', 't', 's'), open);
+		out.writeUint32BE(0);
+		out.writeUint32BE(1);
+		out.writeUint32BE(numSamples); out.writeUint32BE(1);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('s', 't', 's', 'c'), open);
+		out.writeUint32BE(0);
+		out.writeUint32BE(1);
+		out.writeUint32BE(1); out.writeUint32BE(kChunkSamples); out.writeUint32BE(1);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('s', 't', 's', 'z'), open);
+		out.writeUint32BE(0);
+		out.writeUint32BE(1);
+		out.writeUint32BE(numSamples);
+		endAtom(out, open);
+
+		beginAtom(out, MKTAG('s', 't', 'c', 'o'), open);
+		out.writeUint32BE(0);
+		out.writeUint32BE(kChunks);
+		for (uint32 i = 0; i < kChunks; ++i)
+			out.writeUint32BE(dataStart + i * kChunkSamples);
+		endAtom(out, open);
+
+		endAtom(out, open); // stbl
+		endAtom(out, open); // minf
+		endAtom(out, open); // mdia
+		endAtom(out, open); // trak
+		endAtom(out, open); // moov
+	}
+
+public:
+	void setUp() {
+		_system = new StubSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = 0;
+		delete _system;
+	}
+
+	void test_decode() {
+		Common::MemoryWriteStreamDynamic movie(DisposeAfterUse::YES);
+		buildMovie(movie);
+
+		uint reads = 0;
+		Audio::SeekableAudioStream *stream = Audio::makeQuickTimeStream(new CountingStream(movie.getData(), movie.size(), reads), DisposeAfterUse::YES);
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		TS_ASSERT_EQUALS(stream->getRate(), kRate);
+		TS_ASSERT(!stream->isStereo());
+
+		const int numSamples = kChunks * kChunkSamples;
+		int16 *buffer = new int16[numSamples];
+		TS_ASSERT_EQUALS(stream->readBuffer(buffer, numSamples), numSamples);
+		for (int i = 0; i < numSamples; ++i) {
+			if (buffer[i] != (int16)((sample(i) - 128) << 8)) {
+				TS_FAIL("Sample decoded wrongly");
+				break;
+			}
+		}
+		delete[] buffer;
+		delete stream;
+
+		// The atoms are read with hundreds of small reads, but the parser
+		// owns the stream and so reads it through a cache, which only
+		// passes on a few large reads.
+		TS_ASSERT_LESS_THAN(reads, 20u);
+	}
+};
@@ -0,0 +1,118 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/fs/posix/posix-mmapstream.h"
+#include "backends/fs/stdiostream.h"
+
+class POSIXMmapStreamTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kFileSize = 10000
+	};
+
+	static const char *path() { return "mmapstream-test.dat"; }
+
+	static byte contents(uint32 i) { return (byte)(i * 7 + (i >> 8)); }
+
+public:
+	void setUp() {
+		StdioStream *file = StdioStream::makeFromPath(path(), true);
+		TS_ASSERT(file);
+		for (uint32 i = 0; i < kFileSize; ++i)
+			file->writeByte(contents(i));
+		delete file;
+	}
+
+	void tearDown() {
+		remove(path());
+	}
+
+	void test_read() {
+		POSIXMmapStream *stream = POSIXMmapStream::makeFromPath(path());
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), kFileSize);
+
+		byte data[100];
+		TS_ASSERT_EQUALS(stream->read(data, sizeof(data)), sizeof(data));
+		for (uint32 i = 0; i < sizeof(data); ++i)
+			TS_ASSERT_EQUALS(data[i], contents(i));
+		TS_ASSERT_EQUALS(stream->pos(), 100);
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+	}
+
+	void test_min_size() {
+		TS_ASSERT(!POSIXMmapStream::makeFromPath(path(), kFileSize + 1));
+		TS_ASSERT(!POSIXMmapStream::makeFromPath("mmapstream-missing.dat"));
+	}
+
+	void test_seek() {
+		POSIXMmapStream *stream = POSIXMmapStream::makeFromPath(path());
+		TS_ASSERT(stream);
+
+		TS_ASSERT(stream->seek(5000));
+		TS_ASSERT_EQUALS(stream->readByte(), contents(5000));
+		TS_ASSERT(stream->seek(-1, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->pos(), 5000);
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->readByte(), contents(kFileSize - 10));
+
+		// Seeking before the start fails and keeps the position
+		TS_ASSERT(!stream->seek(-1));
+		TS_ASSERT_EQUALS(stream->pos(), kFileSize - 9);
+
+		delete stream;
+	}
+
+	void test_eos() {
+		POSIXMmapStream *stream = POSIXMmapStream::makeFromPath(path());
+		TS_ASSERT(stream);
+
+		byte data[20];
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(data, sizeof(data)), 10u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT_EQUALS(data[9], contents(kFileSize - 1));
+
+		// Seeking clears the end of stream, reading past the end still fails
+		TS_ASSERT(stream->seek(kFileSize + 10));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS(stream->read(data, sizeof(data)), 0u);
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+	}
+
+	void test_borrow() {
+		POSIXMmapStream *stream = POSIXMmapStream::makeFromPath(path());
+		TS_ASSERT(stream);
+
+		// Borrowing is available through the stream interface
+		Common::SeekableReadStream *base = stream;
+		Common::DirectReadAccess *access = base->getDirectAccess();
+		TS_ASSERT(access);
+
+		TS_ASSERT(stream->seek(1000));
+		uint32 size = 500;
+		const byte *data = access->borrow(size);
+		TS_ASSERT_EQUALS(size, 500u);
+		TS_ASSERT_EQUALS(data[0], contents(1000));
+		TS_ASSERT_EQUALS(data[499], contents(1499));
+		TS_ASSERT_EQUALS(stream->pos(), 1500);
+
+		// The access pattern is only a hint, it does not change what is read
+		access->setAccessPattern(Common::DirectReadAccess::kAccessRandom);
+		TS_ASSERT_EQUALS(stream->readByte(), contents(1500));
+
+		// Borrowing at the end gives less data
+		TS_ASSERT(stream->seek(-4, SEEK_END));
+		size = 10;
+		data = access->borrow(size);
+		TS_ASSERT_EQUALS(size, 4u);
+		TS_ASSERT_EQUALS(data[3], contents(kFileSize - 1));
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+	}
+};
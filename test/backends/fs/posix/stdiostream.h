@@ -0,0 +1,70 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/fs/stdiostream.h"
+
+class StdioStreamTestSuite : public CxxTest::TestSuite {
+private:
+	static const char *path() { return "stdiostream-test.dat"; }
+
+	static void writeFile(const char *contents) {
+		StdioStream *file = StdioStream::makeFromPath(path(), true);
+		TS_ASSERT(file);
+		file->writeString(contents);
+		delete file;
+	}
+
+	static Common::String readFile() {
+		StdioStream *file = StdioStream::makeFromPath(path(), false);
+		if (!file)
+			return Common::String();
+		char buffer[64];
+		const uint32 n = file->read(buffer, sizeof(buffer) - 1);
+		buffer[n] = 0;
+		delete file;
+		return buffer;
+	}
+
+public:
+	void tearDown() {
+		remove(path());
+	}
+
+	void test_atomic_write() {
+		writeFile("old");
+
+		StdioStream *stream = StdioStream::makeAtomicWriteStream(path());
+		TS_ASSERT(stream);
+		stream->writeString("new");
+
+		// Nothing changes before the stream is finalized
+		TS_ASSERT_EQUALS(readFile(), "old");
+
+		stream->finalize();
+		TS_ASSERT(!stream->err());
+		delete stream;
+
+		TS_ASSERT_EQUALS(readFile(), "new");
+	}
+
+	void test_concurrent_writes() {
+		writeFile("old");
+
+		// Streams for the same file do not share their temporary file
+		StdioStream *first = StdioStream::makeAtomicWriteStream(path());
+		StdioStream *second = StdioStream::makeAtomicWriteStream(path());
+		TS_ASSERT(first && second);
+		first->writeString("first");
+		second->writeString("second");
+
+		second->finalize();
+		TS_ASSERT(!second->err());
+		TS_ASSERT_EQUALS(readFile(), "second");
+
+		first->finalize();
+		TS_ASSERT(!first->err());
+		TS_ASSERT_EQUALS(readFile(), "first");
+
+		delete first;
+		delete second;
+	}
+};
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of TransparentSurface::blit() in its different
+// modes. Use the 'blit-bench' target to build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "graphics/transparent_surface.h"
+#include "common/util.h"
+
+#include <time.h>
+
+static const struct {
+	const char *name;
+	Graphics::AlphaType alphaMode;
+	uint32 color;
+} modes[] = {
+	{ "Opaque", Graphics::ALPHA_OPAQUE, 0xFFFFFFFF },
+	{ "Binary", Graphics::ALPHA_BINARY, 0xFFFFFFFF },
+	{ "Alpha", Graphics::ALPHA_FULL, 0xFFFFFFFF },
+	{ "ColorMod", Graphics::ALPHA_FULL, 0xC0FF8040 }
+};
+
+static const struct {
+	int w, h;
+} sizes[] = {
+	{ 32, 32 },
+	{ 128, 128 },
+	{ 640, 480 }
+};
+
+// A sprite with a transparent border, a soft edge and an opaque center
+static void fillSprite(Graphics::TransparentSurface &sprite) {
+	uint32 seed = 1;
+	for (int y = 0; y < sprite.h; ++y) {
+		for (int x = 0; x < sprite.w; ++x) {
+			seed = seed * 1103515245 + 12345;
+			const int dx = ABS(2 * x - sprite.w + 1) * 256 / sprite.w;
+			const int dy = ABS(2 * y - sprite.h + 1) * 256 / sprite.h;
+			const int dist = MAX(dx, dy);
+			const uint32 alpha = dist < 160 ? 255 : (dist < 224 ? (224 - dist) * 4 : 0);
+			*(uint32 *)sprite.getBasePtr(x, y) = (seed & 0xFFFFFF00) | alpha;
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+	const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+	Graphics::Surface target;
+	target.create(640, 480, format);
+	memset(target.getPixels(), 0x80, target.pitch * target.h);
+
+	printf("%-10s %-8s %10s %10s\n", "Mode", "Size", "MPixel/s", "Flipped");
+	for (uint i = 0; i < ARRAYSIZE(modes); ++i) {
+		for (uint j = 0; j < ARRAYSIZE(sizes); ++j) {
+			Graphics::TransparentSurface sprite;
+			sprite.create(sizes[j].w, sizes[j].h, format);
+			sprite.setAlphaMode(modes[i].alphaMode);
+			fillSprite(sprite);
+
+			double mpixels[2];
+			for (int flipped = 0; flipped < 2; ++flipped) {
+				int blits = 0;
+				const clock_t start = clock();
+				clock_t elapsed;
+				do {
+					for (int k = 0; k < 10; ++k)
+						sprite.blit(target, 0, 0, flipped ? Graphics::FLIP_H : Graphics::FLIP_NONE, nullptr, modes[i].color);
+					blits += 10;
+					elapsed = clock() - start;
+				} while (elapsed < CLOCKS_PER_SEC / 4);
+
+				const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+				mpixels[flipped] = (double)blits * sprite.w * sprite.h / seconds / 1000000;
+			}
+
+			printf("%-10s %3dx%-4d %10.1f %10.1f\n", modes[i].name, sizes[j].w, sizes[j].h, mpixels[0], mpixels[1]);
+			sprite.free();
+		}
+	}
+
+	target.free();
+	return 0;
+}
@@ -0,0 +1,93 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of Graphics::crossBlit() for common pairs of
+// formats. Use the 'conversion-bench' target to build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "graphics/conversion.h"
+#include "graphics/pixelformat.h"
+#include "common/util.h"
+
+#include <time.h>
+
+static const struct {
+	const char *name;
+	Graphics::PixelFormat format;
+} formats[] = {
+	{ "RGB565", Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+	{ "RGB555", Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0) },
+	{ "RGB24", Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0) },
+	{ "ARGB8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24) },
+	{ "RGBA8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0) }
+};
+
+// Indices into formats
+static const struct {
+	int src, dst;
+} pairs[] = {
+	{ 0, 3 },
+	{ 3, 0 },
+	{ 4, 3 },
+	{ 3, 4 },
+	{ 1, 0 },
+	{ 2, 3 }
+};
+
+int main(int argc, char *argv[]) {
+	const int w = 640;
+	const int h = 480;
+
+	byte *src = new byte[w * h * 4];
+	byte *dst = new byte[w * h * 4];
+	uint32 seed = 1;
+	for (int i = 0; i < w * h * 4; ++i) {
+		seed = seed * 1103515245 + 12345;
+		src[i] = seed >> 16;
+	}
+
+	printf("%-10s %-10s %10s %10s\n", "Source", "Dest", "Frames/s", "MPixel/s");
+
+	for (uint i = 0; i < ARRAYSIZE(pairs); ++i) {
+		const Graphics::PixelFormat &srcFmt = formats[pairs[i].src].format;
+		const Graphics::PixelFormat &dstFmt = formats[pairs[i].dst].format;
+
+		int frames = 0;
+		const clock_t start = clock();
+		clock_t elapsed;
+		do {
+			Graphics::crossBlit(dst, src, w * dstFmt.bytesPerPixel, w * srcFmt.bytesPerPixel, w, h, dstFmt, srcFmt);
+			frames++;
+			elapsed = clock() - start;
+		} while (elapsed < CLOCKS_PER_SEC / 2);
+
+		const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+		printf("%-10s %-10s %10.1f %10.1f\n", formats[pairs[i].src].name, formats[pairs[i].dst].name,
+		       frames / seconds, (double)frames * w * h / seconds / 1000000);
+	}
+
+	delete[] src;
+	delete[] dst;
+	return 0;
+}
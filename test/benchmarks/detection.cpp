@@ -0,0 +1,214 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures how long the AdvancedDetector takes to scan a synthetic game
+// collection, as done when mass adding games, with and without sharing file
+// MD5 sums between engines. Use the 'detection-bench' target to build and
+// run it. The collection is created in the current directory and removed
+// afterwards.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+
+#include "common/scummsys.h"
+
+#ifdef POSIX
+
+#include "backends/fs/posix/posix-fs-factory.h"
+#include "backends/fs/stdiostream.h"
+#include "common/fs.h"
+#include "common/util.h"
+#include "engines/advancedDetector.h"
+#include "engines/engine.h"
+
+#include "test/stub_system.h"
+
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char *const root = "detection-bench.tmp";
+
+// The files of each game directory. Engines look for the same names, like
+// they do for common names such as "resource.map" or "data.001".
+static const struct {
+	const char *name;
+	uint32 size;
+} gameFiles[] = {
+	{ "resource.map", 16 * 1024 },
+	{ "resource.000", 2 * 1024 * 1024 },
+	{ "data.001", 512 * 1024 },
+	{ "game.exe", 256 * 1024 },
+	{ "sound.dat", 1024 * 1024 },
+	{ "intro.vid", 64 * 1024 }
+};
+
+enum {
+	kGames = 20,
+	kEngines = 8,
+	kDescriptionsPerEngine = 40
+};
+
+class DetectionSystem : public StubSystem {
+public:
+	DetectionSystem() { _fsFactory = new POSIXFilesystemFactory(); }
+};
+
+// An engine whose descriptions never match, so every engine hashes the files
+// it looks for, as most engines do for a directory holding another game.
+class SyntheticMetaEngine : public AdvancedMetaEngine {
+public:
+	SyntheticMetaEngine(const ADGameDescription *descs, const PlainGameDescriptor *gameIds) :
+		AdvancedMetaEngine(descs, sizeof(ADGameDescription), gameIds) {
+	}
+
+	const char *getName() const { return "Synthetic"; }
+	const char *getOriginalCopyright() const { return ""; }
+
+	bool createInstance(OSystem *syst, Engine **engine, const ADGameDescription *desc) const { return false; }
+};
+
+// Only needed to create engines, which the benchmark does not do. Linking
+// engine.cpp would pull in the launcher and the plugin manager.
+bool Engine::warnUserAboutUnsupportedGame() {
+	return false;
+}
+
+static void createFile(const Common::String &path, uint32 size) {
+	StdioStream *file = StdioStream::makeFromPath(path, true);
+	byte buffer[4096];
+	for (uint32 i = 0; i < sizeof(buffer); ++i)
+		buffer[i] = (byte)(i * 13 + size);
+	for (uint32 written = 0; written < size; written += sizeof(buffer))
+		file->write(buffer, MIN<uint32>(sizeof(buffer), size - written));
+	delete file;
+}
+
+static Common::String gamePath(int game) {
+	return Common::String::format("%s/game%02d", root, game);
+}
+
+static void createCollection() {
+	mkdir(root, 0755);
+	for (int game = 0; game < kGames; ++game) {
+		mkdir(gamePath(game).c_str(), 0755);
+		for (int i = 0; i < ARRAYSIZE(gameFiles); ++i)
+			createFile(gamePath(game) + "/" + gameFiles[i].name, gameFiles[i].size);
+	}
+}
+
+static void removeCollection() {
+	for (int game = 0; game < kGames; ++game) {
+		for (int i = 0; i < ARRAYSIZE(gameFiles); ++i)
+			remove((gamePath(game) + "/" + gameFiles[i].name).c_str());
+		rmdir(gamePath(game).c_str());
+	}
+	rmdir(root);
+}
+
+// Runs detection over every game directory and returns the time per directory
+static double measure(SyntheticMetaEngine *const *engines, bool shared) {
+	Common::FSList dirs;
+	Common::FSNode(root).getChildren(dirs, Common::FSNode::kListDirectoriesOnly);
+
+	int scans = 0;
+	const clock_t start = clock();
+	clock_t elapsed;
+	do {
+		for (Common::FSList::const_iterator dir = dirs.begin(); dir != dirs.end(); ++dir) {
+			Common::FSList files;
+			dir->getChildren(files, Common::FSNode::kListAll);
+
+			if (shared)
+				AdvancedMetaEngine::beginDetectionScan();
+			for (int i = 0; i < kEngines; ++i)
+				engines[i]->detectGames(files);
+			if (shared)
+				AdvancedMetaEngine::endDetectionScan();
+
+			scans++;
+		}
+		elapsed = clock() - start;
+	} while (elapsed < CLOCKS_PER_SEC);
+
+	return (double)elapsed / CLOCKS_PER_SEC * 1000 / scans;
+}
+
+int main(int argc, char *argv[]) {
+	DetectionSystem system;
+	g_system = &system;
+
+	createCollection();
+
+	static const PlainGameDescriptor gameIds[] = {
+		{ "synthetic", "Synthetic game" },
+		{ 0, 0 }
+	};
+
+	// Each description needs two of the files, with an MD5 sum which does
+	// not match, so detection goes through all of them
+	static ADGameDescription descs[kEngines][kDescriptionsPerEngine + 1];
+	SyntheticMetaEngine *engines[kEngines];
+	for (int e = 0; e < kEngines; ++e) {
+		for (int d = 0; d < kDescriptionsPerEngine; ++d) {
+			ADGameDescription &desc = descs[e][d];
+			memset(&desc, 0, sizeof(desc));
+			desc.gameId = "synthetic";
+			desc.extra = "";
+			desc.filesDescriptions[0].fileName = gameFiles[(e + d) % ARRAYSIZE(gameFiles)].name;
+			desc.filesDescriptions[0].md5 = "00000000000000000000000000000000";
+			desc.filesDescriptions[0].fileSize = -1;
+			desc.filesDescriptions[1].fileName = gameFiles[(e + d + 1) % ARRAYSIZE(gameFiles)].name;
+			desc.filesDescriptions[1].md5 = "00000000000000000000000000000000";
+			desc.filesDescriptions[1].fileSize = -1;
+			desc.language = Common::EN_ANY;
+			desc.platform = Common::kPlatformDOS;
+			desc.flags = ADGF_NO_FLAGS;
+			desc.guiOptions = "";
+		}
+		memset(&descs[e][kDescriptionsPerEngine], 0, sizeof(ADGameDescription));
+		engines[e] = new SyntheticMetaEngine(descs[e], gameIds);
+	}
+
+	printf("%d games, %d engines with %d descriptions each\n\n", kGames, kEngines, kDescriptionsPerEngine);
+	printf("%-30s %12s\n", "Scan", "ms/directory");
+	printf("%-30s %12.3f\n", "per engine", measure(engines, false));
+	printf("%-30s %12.3f\n", "shared", measure(engines, true));
+
+	for (int e = 0; e < kEngines; ++e)
+		delete engines[e];
+
+	removeCollection();
+	g_system = 0;
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+	printf("The detection benchmark needs a POSIX file system\n");
+	return 0;
+}
+
+#endif
@@ -0,0 +1,99 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Compares the throughput of Common::MD5 and Common::ContentHash, for
+// large buffers as well as for small blocks such as config files or
+// cache keys. Use the 'hash-bench' target to build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "common/content-hash.h"
+#include "common/md5.h"
+#include "common/util.h"
+
+#include <time.h>
+
+// Results of the hashes end up here, so they are not optimized away
+static volatile uint32 sink;
+
+struct MD5Hash {
+	static const char *name() { return "MD5"; }
+
+	static uint32 hash(const byte *data, uint32 size) {
+		Common::MD5 md5;
+		md5.update(data, size);
+		uint8 digest[16];
+		md5.finish(digest);
+		return digest[0];
+	}
+};
+
+struct XXHash {
+	static const char *name() { return "ContentHash"; }
+
+	static uint32 hash(const byte *data, uint32 size) {
+		return (uint32)Common::computeContentHash(data, size);
+	}
+};
+
+// Hashes the buffer in blocks of the given size for half a second and
+// prints the throughput
+template<class Hash>
+static void measure(const byte *data, uint32 dataSize, uint32 blockSize) {
+	uint64 bytes = 0;
+	uint32 result = 0;
+	const clock_t start = clock();
+	clock_t elapsed;
+	do {
+		for (uint32 offset = 0; offset + blockSize <= dataSize; offset += blockSize)
+			result += Hash::hash(data + offset, blockSize);
+		bytes += dataSize - dataSize % blockSize;
+		elapsed = clock() - start;
+	} while (elapsed < CLOCKS_PER_SEC / 2);
+
+	sink = result;
+
+	const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+	printf("  %-12s %10.1f MB/s\n", Hash::name(), bytes / seconds / (1024 * 1024));
+}
+
+int main(int argc, char *argv[]) {
+	static const uint32 blockSizes[] = { 64, 4096, 64 * 1024 * 1024 };
+	const uint32 dataSize = 64 * 1024 * 1024;
+
+	byte *data = new byte[dataSize];
+	uint32 seed = 1;
+	for (uint32 i = 0; i < dataSize; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 24;
+	}
+
+	for (uint i = 0; i < ARRAYSIZE(blockSizes); ++i) {
+		printf("%u byte blocks\n", blockSizes[i]);
+		measure<MD5Hash>(data, dataSize, blockSizes[i]);
+		measure<XXHash>(data, dataSize, blockSizes[i]);
+	}
+
+	delete[] data;
+	return 0;
+}
@@ -0,0 +1,142 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Compares Common::FlatHashMap against Common::HashMap for integer and
+// string keys. Use the 'hashmap-bench' target to build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "common/array.h"
+#include "common/flat-hashmap.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/util.h"
+
+#include <time.h>
+
+// Sets of keys: the ones stored in the map, and as many which are not
+template<class Key>
+struct KeySet {
+	Common::Array<Key> present;
+	Common::Array<Key> absent;
+};
+
+static void makeKeys(KeySet<uint> &keys, uint count) {
+	uint32 seed = 1;
+	for (uint i = 0; i < 2 * count; ++i) {
+		// xorshift, as the low bits of a linear congruential generator
+		// repeat far too often
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		// Keep the lowest bit free, so present and absent keys never clash
+		const uint key = (seed & ~1u) | (i & 1);
+		if (i & 1)
+			keys.absent.push_back(key);
+		else
+			keys.present.push_back(key);
+	}
+}
+
+static void makeKeys(KeySet<Common::String> &keys, uint count) {
+	for (uint i = 0; i < count; ++i) {
+		keys.present.push_back(Common::String::format("resource_%u.dat", i));
+		keys.absent.push_back(Common::String::format("missing_%u.dat", i));
+	}
+}
+
+// Results of the lookups end up here, so they are not optimized away
+static volatile uint sink;
+
+static double nsPerOp(clock_t elapsed, uint ops) {
+	return (double)elapsed / CLOCKS_PER_SEC * 1000000000 / ops;
+}
+
+template<class Map, class Key>
+static void measure(const char *name, const KeySet<Key> &keys) {
+	const uint count = keys.present.size();
+	uint rounds = 0;
+	uint found = 0;
+	clock_t insert = 0, hit = 0, miss = 0, iterate = 0, erase = 0;
+
+	while (insert + hit + miss + iterate + erase < CLOCKS_PER_SEC) {
+		Map map;
+		clock_t start = clock();
+		for (uint i = 0; i < count; ++i)
+			map[keys.present[i]] = i;
+		insert += clock() - start;
+
+		start = clock();
+		for (uint i = 0; i < count; ++i)
+			found += map.contains(keys.present[i]);
+		hit += clock() - start;
+
+		start = clock();
+		for (uint i = 0; i < count; ++i)
+			found += map.contains(keys.absent[i]);
+		miss += clock() - start;
+
+		start = clock();
+		for (typename Map::const_iterator i = map.begin(); i != map.end(); ++i)
+			found += i->_value & 1;
+		iterate += clock() - start;
+
+		start = clock();
+		for (uint i = 0; i < count; ++i)
+			map.erase(keys.present[i]);
+		erase += clock() - start;
+
+		rounds++;
+	}
+
+	sink = found;
+
+	const uint ops = rounds * count;
+	printf("%-26s %8.1f %8.1f %8.1f %8.1f %8.1f\n", name,
+	       nsPerOp(insert, ops), nsPerOp(hit, ops), nsPerOp(miss, ops),
+	       nsPerOp(iterate, ops), nsPerOp(erase, ops));
+}
+
+int main(int argc, char *argv[]) {
+	static const uint sizes[] = { 100, 10000, 1000000 };
+
+	printf("%-26s %8s %8s %8s %8s %8s  (ns per entry)\n", "Map", "Insert", "Hit", "Miss", "Iterate", "Erase");
+
+	for (uint i = 0; i < ARRAYSIZE(sizes); ++i) {
+		KeySet<uint> keys;
+		makeKeys(keys, sizes[i]);
+		printf("%u integer keys\n", sizes[i]);
+		measure<Common::HashMap<uint, uint> >("  HashMap", keys);
+		measure<Common::FlatHashMap<uint, uint> >("  FlatHashMap", keys);
+	}
+
+	for (uint i = 0; i < ARRAYSIZE(sizes) - 1; ++i) {
+		KeySet<Common::String> keys;
+		makeKeys(keys, sizes[i]);
+		printf("%u string keys\n", sizes[i]);
+		measure<Common::HashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("  HashMap", keys);
+		measure<Common::FlatHashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("  FlatHashMap", keys);
+	}
+
+	return 0;
+}
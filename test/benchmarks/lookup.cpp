@@ -0,0 +1,188 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures string keyed lookups as done by ConfigManager domains and
+// SearchMan, by String, C string and StringAtom keys. Use the 'lookup-bench'
+// target to build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "common/archive.h"
+#include "common/config-manager.h"
+#include "common/hash-str.h"
+#include "common/str-array.h"
+#include "common/str-atom.h"
+#include "common/util.h"
+
+#include "test/stub_system.h"
+
+#include <time.h>
+
+static const char *const configKeys[] = {
+	"music_volume", "sfx_volume", "speech_volume", "mute", "speech_mute",
+	"subtitles", "talkspeed", "music_driver", "multi_midi", "native_mt32",
+	"enable_gs", "midi_gain", "output_rate", "gfx_mode", "fullscreen",
+	"aspect_ratio", "filtering", "render_mode", "language", "platform",
+	"gameid", "description", "path", "extrapath", "savepath"
+};
+
+// Keeps its members in a HashMap, so the time spent in the archive itself
+// is small compared to the SearchSet overhead.
+class MemoryArchive : public Common::Archive {
+public:
+	void add(const Common::String &name) { _names[name] = true; }
+
+	bool hasFile(const Common::String &name) const { return _names.contains(name); }
+
+	int listMembers(Common::ArchiveMemberList &list) const {
+		for (NameMap::const_iterator i = _names.begin(); i != _names.end(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(i->_key, this)));
+		return _names.size();
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+	}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const { return 0; }
+
+private:
+	typedef Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> NameMap;
+	NameMap _names;
+};
+
+// Runs the lookup for half a second and prints the time per call
+template<class Lookup>
+static void measure(const char *name, Lookup lookup, uint count) {
+	uint calls = 0;
+	uint found = 0;
+	const clock_t start = clock();
+	clock_t elapsed;
+	do {
+		for (uint i = 0; i < count; ++i)
+			found += lookup(i);
+		calls += count;
+		elapsed = clock() - start;
+	} while (elapsed < CLOCKS_PER_SEC / 2);
+
+	const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+	printf("%-28s %10.1f ns %s\n", name, seconds * 1000000000 / calls, found == calls ? "" : "(misses)");
+}
+
+struct ConfigByString {
+	const Common::StringMap &_domain;
+	ConfigByString(const Common::StringMap &domain) : _domain(domain) {}
+	uint operator()(uint i) const { return _domain.contains(Common::String(configKeys[i])); }
+};
+
+struct ConfigByCString {
+	const Common::StringMap &_domain;
+	ConfigByCString(const Common::StringMap &domain) : _domain(domain) {}
+	uint operator()(uint i) const { return _domain.contains(configKeys[i]); }
+};
+
+struct ConfigByAtom {
+	const Common::StringMap &_domain;
+	const Common::StringAtom *_keys;
+	ConfigByAtom(const Common::StringMap &domain, const Common::StringAtom *keys) : _domain(domain), _keys(keys) {}
+	uint operator()(uint i) const { return _domain.contains(_keys[i]); }
+};
+
+// A map keyed by atoms compares pointers only
+typedef Common::HashMap<Common::StringAtom, Common::String> AtomMap;
+
+struct AtomMapByAtom {
+	const AtomMap &_map;
+	const Common::StringAtom *_keys;
+	AtomMapByAtom(const AtomMap &map, const Common::StringAtom *keys) : _map(map), _keys(keys) {}
+	uint operator()(uint i) const { return _map.contains(_keys[i]); }
+};
+
+struct ConfManByCString {
+	uint operator()(uint i) const { return !ConfMan.get(configKeys[i]).empty(); }
+};
+
+struct ConfManByAtom {
+	const Common::StringAtom *_keys;
+	ConfManByAtom(const Common::StringAtom *keys) : _keys(keys) {}
+	uint operator()(uint i) const { return !ConfMan.get(_keys[i]).empty(); }
+};
+
+struct ArchiveLookup {
+	const Common::SearchSet &_set;
+	const Common::StringArray &_names;
+	ArchiveLookup(const Common::SearchSet &set, const Common::StringArray &names) : _set(set), _names(names) {}
+	uint operator()(uint i) const { return _set.hasFile(_names[i]); }
+};
+
+int main(int argc, char *argv[]) {
+	StubSystem system;
+	g_system = &system;
+
+	// A domain with the usual keys and some engine specific ones
+	Common::StringMap domain;
+	for (uint i = 0; i < ARRAYSIZE(configKeys); ++i)
+		domain[configKeys[i]] = "1";
+	for (uint i = 0; i < 50; ++i)
+		domain[Common::String::format("engine_option_%d", i)] = "0";
+
+	measure("config by String", ConfigByString(domain), ARRAYSIZE(configKeys));
+	measure("config by const char *", ConfigByCString(domain), ARRAYSIZE(configKeys));
+
+	Common::StringAtom keys[ARRAYSIZE(configKeys)];
+	AtomMap atomDomain;
+	for (uint i = 0; i < ARRAYSIZE(configKeys); ++i) {
+		keys[i] = Common::StringAtom(configKeys[i]);
+		atomDomain[keys[i]] = "1";
+	}
+	for (uint i = 0; i < 50; ++i)
+		atomDomain[Common::StringAtom(Common::String::format("engine_option_%d", i))] = "0";
+
+	measure("config by StringAtom", ConfigByAtom(domain, keys), ARRAYSIZE(configKeys));
+	measure("atom keyed map by StringAtom", AtomMapByAtom(atomDomain, keys), ARRAYSIZE(configKeys));
+
+	// Through ConfigManager, which searches the transient, game, application
+	// and defaults domains in turn. Keys are found in the application domain.
+	for (uint i = 0; i < ARRAYSIZE(configKeys); ++i)
+		ConfMan.set(configKeys[i], "1");
+	measure("ConfMan by const char *", ConfManByCString(), ARRAYSIZE(configKeys));
+	measure("ConfMan by StringAtom", ConfManByAtom(keys), ARRAYSIZE(configKeys));
+
+	// Game data spread over a few archives, looked up by path
+	Common::SearchSet set;
+	Common::StringArray names;
+	for (int a = 0; a < 8; ++a) {
+		MemoryArchive *archive = new MemoryArchive();
+		for (int i = 0; i < 500; ++i) {
+			const Common::String name = Common::String::format("data%d/res%d_%03d.dat", a, a, i);
+			archive->add(name);
+			if (i % 25 == 0)
+				names.push_back(name);
+		}
+		set.add(Common::String::format("archive%d", a), archive, a);
+	}
+
+	measure("archive by path", ArchiveLookup(set, names), names.size());
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Replays a register capture through the DOSBox OPL emulator and measures
+// how fast it renders, with two operator channels generated side by side and
+// one after the other. The capture is a DOSBox raw OPL (.dro, version 2)
+// file, as written by DOSBox's "record OPL" command. The 'opl-bench' target
+// uses music.dro, the AdLib MIDI driver playing the testbed music.mid, or
+// pass another capture on the command line.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_fopen
+#define FORBIDDEN_SYMBOL_EXCEPTION_fread
+#define FORBIDDEN_SYMBOL_EXCEPTION_fclose
+#define FORBIDDEN_SYMBOL_EXCEPTION_fseek
+#define FORBIDDEN_SYMBOL_EXCEPTION_ftell
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "common/endian.h"
+#include "common/util.h"
+
+#include <time.h>
+
+#ifndef DISABLE_DOSBOX_OPL
+
+using OPL::DOSBox::DBOPL::Chip;
+
+static const uint32 kRate = 49716;
+// What a mixer callback asks for at a time
+static const uint32 kCallbackSamples = 512;
+
+struct Capture {
+	const byte *pairs;
+	uint32 numPairs;
+	uint32 lengthMs;
+	byte shortDelayCode;
+	byte longDelayCode;
+	byte codemapLength;
+	const byte *codemap;
+	bool opl3;
+};
+
+static bool parseCapture(const byte *data, long size, Capture &capture) {
+	if (size < 26 || memcmp(data, "DBRAWOPL", 8) || READ_LE_UINT16(data + 8) != 2)
+		return false;
+
+	capture.numPairs = READ_LE_UINT32(data + 12);
+	capture.lengthMs = READ_LE_UINT32(data + 16);
+	// 0 is OPL2, 1 dual OPL2 and 2 OPL3
+	capture.opl3 = data[20] != 0;
+	// Only interleaved, uncompressed captures exist
+	if (data[21] != 0 || data[22] != 0)
+		return false;
+	capture.shortDelayCode = data[23];
+	capture.longDelayCode = data[24];
+	capture.codemapLength = data[25];
+	capture.codemap = data + 26;
+	capture.pairs = capture.codemap + capture.codemapLength;
+	return capture.pairs + capture.numPairs * 2 <= data + size;
+}
+
+// Sums up all of the output, which has to be the same either way
+static void generate(Chip &chip, bool opl3, uint32 samples, uint32 &sum) {
+	static int32 buffer[kCallbackSamples * 2];
+	while (samples > 0) {
+		const uint32 len = MIN(samples, kCallbackSamples);
+		if (opl3)
+			chip.GenerateBlock3(len, buffer);
+		else
+			chip.GenerateBlock2(len, buffer);
+		for (uint32 i = 0; i < len * (opl3 ? 2 : 1); ++i)
+			sum = sum * 31 + buffer[i];
+		samples -= len;
+	}
+}
+
+static double render(const Capture &capture, bool opl3, bool lanes, uint32 &sum) {
+	Chip chip;
+	chip.Setup(kRate);
+	chip.channelLanes = lanes;
+	if (opl3) {
+		chip.WriteReg(0x105, 1);
+		chip.WriteReg(0x104, 0);
+	}
+
+	sum = 0;
+	uint64 ms = 0;
+	uint32 renderedSamples = 0;
+	const clock_t start = clock();
+
+	for (uint32 i = 0; i < capture.numPairs; ++i) {
+		const byte code = capture.pairs[i * 2];
+		const byte value = capture.pairs[i * 2 + 1];
+
+		if (code == capture.shortDelayCode || code == capture.longDelayCode) {
+			ms += (value + 1) << (code == capture.longDelayCode ? 8 : 0);
+			// Render up to the next write, without losing fractions of samples
+			const uint32 samples = (uint32)(ms * kRate / 1000);
+			generate(chip, opl3, samples - renderedSamples, sum);
+			renderedSamples = samples;
+		} else if ((code & 0x7F) < capture.codemapLength) {
+			// The high bit selects the second register bank
+			const uint32 reg = capture.codemap[code & 0x7F] | ((code & 0x80) ? 0x100 : 0);
+			// OPL2 music played on an OPL3 goes to both speakers, like the
+			// dual OPL2 mode of OPL::DOSBox::OPL enables it
+			if (opl3 && !capture.opl3 && reg >= 0xC0 && reg <= 0xC8)
+				chip.WriteReg(reg, value | 0x30);
+			else
+				chip.WriteReg(reg, value);
+		}
+	}
+
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+	const char *path = argc > 1 ? argv[1] : "test/benchmarks/music.dro";
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		printf("Could not open %s\n", path);
+		return 1;
+	}
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	byte *data = new byte[size];
+	const bool read = fread(data, size, 1, file) == 1;
+	fclose(file);
+
+	Capture capture;
+	if (!read || !parseCapture(data, size, capture)) {
+		printf("%s is not a DOSBox raw OPL version 2 capture\n", path);
+		delete[] data;
+		return 1;
+	}
+
+	OPL::DOSBox::DBOPL::InitTables();
+
+	const double length = capture.lengthMs / 1000.0;
+	printf("Rendering %.1f seconds of captured music at %u Hz\n", length, kRate);
+	printf("%-6s %-14s %10s %12s %10s\n", "Mode", "Channels", "Seconds", "x realtime", "Checksum");
+
+	// OPL2 captures also play on an OPL3 in its OPL2 compatible mode
+	for (int opl3 = capture.opl3; opl3 < 2; ++opl3) {
+		for (int lanes = 0; lanes < 2; ++lanes) {
+			uint32 sum;
+			const double seconds = render(capture, opl3, lanes, sum);
+			printf("%-6s %-14s %10.3f %12.1f   %08x\n", opl3 ? "OPL3" : "OPL2", lanes ? "side by side" : "one by one",
+			       seconds, seconds > 0 ? length / seconds : 0, sum);
+		}
+	}
+
+	delete[] data;
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+	printf("The DOSBox OPL emulator is disabled\n");
+	return 0;
+}
+
+#endif
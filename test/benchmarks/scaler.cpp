@@ -0,0 +1,114 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of the scalers. Use the 'scaler-bench' target to
+// build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "graphics/scaler.h"
+#include "common/util.h"
+
+#include <time.h>
+
+#define SCALER(name, factor) { #name, name, factor }
+
+static const struct {
+	const char *name;
+	ScalerProc *proc;
+	int factor;
+} scalers[] = {
+	SCALER(Normal1x, 1),
+#ifdef USE_SCALERS
+	SCALER(Normal2x, 2),
+	SCALER(Normal3x, 3),
+	SCALER(_2xSaI, 2),
+	SCALER(Super2xSaI, 2),
+	SCALER(SuperEagle, 2),
+	SCALER(AdvMame2x, 2),
+	SCALER(AdvMame3x, 3),
+	SCALER(TV2x, 2),
+	SCALER(DotMatrix, 2),
+#ifdef USE_HQ_SCALERS
+	SCALER(HQ2x, 2),
+	SCALER(HQ3x, 3),
+#endif
+#endif
+};
+
+enum {
+	kWidth = 320,
+	kHeight = 200,
+	kSrcPitch = (kWidth + 4) * 2,
+	kDstPitch = kWidth * 3 * 2
+};
+
+// Something resembling a game screen: flat areas, gradients and dithering
+static void fillScreen(uint16 *buffer) {
+	uint32 seed = 1;
+	for (int y = 0; y < kHeight + 4; ++y) {
+		for (int x = 0; x < kWidth + 4; ++x) {
+			seed = seed * 1103515245 + 12345;
+			uint16 color;
+			if (y < kHeight / 3)
+				color = (x / 40) * 0x1863;
+			else if (y < kHeight * 2 / 3)
+				color = ((x >> 3) << 11) | ((y >> 2) << 5) | ((x + y) & 31);
+			else
+				color = ((x ^ y) & 1) ? (seed >> 16) : 0x7BEF;
+			buffer[y * kSrcPitch / 2 + x] = color;
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+	InitScalers(565);
+
+	uint16 *src = new uint16[(kHeight + 4) * kSrcPitch / 2];
+	uint16 *dst = new uint16[kHeight * 3 * kDstPitch / 2];
+	fillScreen(src);
+
+	// The scalers read the pixels around the area
+	const uint8 *srcArea = (const uint8 *)src + 2 * kSrcPitch + 2 * 2;
+
+	printf("%-12s %10s\n", "Scaler", "MPixel/s");
+	for (uint i = 0; i < ARRAYSIZE(scalers); ++i) {
+		int frames = 0;
+		const clock_t start = clock();
+		clock_t elapsed;
+		do {
+			for (int j = 0; j < 10; ++j)
+				scalers[i].proc(srcArea, kSrcPitch, (uint8 *)dst, kDstPitch, kWidth, kHeight);
+			frames += 10;
+			elapsed = clock() - start;
+		} while (elapsed < CLOCKS_PER_SEC / 2);
+
+		const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+		printf("%-12s %10.1f\n", scalers[i].name, (double)frames * kWidth * kHeight / seconds / 1000000);
+	}
+
+	delete[] src;
+	delete[] dst;
+	DestroyScalers();
+	return 0;
+}
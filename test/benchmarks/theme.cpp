@@ -0,0 +1,196 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the frame time of the launcher's game list with the modern
+// theme: opening the launcher, with and without GUI::ThemeDrawCache, and
+// scrolling the list one row at a time, with the list drawn in full or
+// only its changed rows. Use the 'theme-bench' target to build and run it.
+// The themes are loaded from the directory given as argument.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "common/scummsys.h"
+
+#ifdef POSIX
+
+#include "backends/fs/posix/posix-fs-factory.h"
+#include "common/config-manager.h"
+#include "common/util.h"
+#include "gui/dialog.h"
+#include "gui/gui-manager.h"
+#include "gui/ThemeDrawCache.h"
+#include "gui/ThemeEngine.h"
+#include "gui/widget.h"
+#include "gui/widgets/edittext.h"
+#include "gui/widgets/list.h"
+
+#include "test/stub_system.h"
+
+#include <time.h>
+
+class ThemeSystem : public StubSystem {
+public:
+	ThemeSystem() { _fsFactory = new POSIXFilesystemFactory(); }
+
+	void logMessage(LogMessageType::Type type, const char *message) {
+		if (type != LogMessageType::kInfo)
+			printf("%s", message);
+	}
+};
+
+// The widgets of the launcher with the modern theme, except for the
+// pictures, which the launcher creates with the same layout
+class LauncherListDialog : public GUI::Dialog {
+public:
+	LauncherListDialog() : GUI::Dialog("Launcher") {
+		new GUI::StaticTextWidget(this, "Launcher.Version", "ScummVM");
+		new GUI::ButtonWidget(this, "Launcher.QuitButton", "Quit");
+		new GUI::ButtonWidget(this, "Launcher.AboutButton", "About...");
+		new GUI::ButtonWidget(this, "Launcher.OptionsButton", "Options...");
+		new GUI::ButtonWidget(this, "Launcher.StartButton", "Start");
+		new GUI::ButtonWidget(this, "Launcher.LoadGameButton", "Load...");
+		new GUI::ButtonWidget(this, "Launcher.AddGameButton", "Add Game...");
+		new GUI::ButtonWidget(this, "Launcher.EditGameButton", "Edit Game...");
+		new GUI::ButtonWidget(this, "Launcher.RemoveGameButton", "Remove Game");
+		new GUI::EditTextWidget(this, "Launcher.Search", "", 0, 0);
+
+		_list = new GUI::ListWidget(this, "Launcher.GameList");
+		_list->setEditable(false);
+		_list->setNumberingMode(GUI::kListNumberingOff);
+
+		GUI::ListWidget::StringArray games;
+		for (int i = 0; i < 300; ++i)
+			games.push_back(Common::String::format("Game number %d (CD/DOS/English)", i));
+		_list->setList(games);
+	}
+
+	using GUI::Dialog::open;
+	using GUI::Dialog::close;
+	using GUI::Dialog::drawDialog;
+
+	GUI::ListWidget *_list;
+};
+
+// Draws the whole dialog, like GuiManager::redraw() when it is opened
+static void drawDialog(LauncherListDialog *dialog) {
+	GUI::ThemeEngine *theme = g_gui.theme();
+	theme->clearAll();
+	theme->openDialog(true, GUI::ThemeEngine::kShadingNone);
+	dialog->drawDialog();
+	theme->finishBuffering();
+	theme->updateScreen();
+}
+
+// Scrolls down the list with the mouse wheel until the end, then up again
+static void scrollList(GUI::ListWidget *list, int &direction) {
+	const int pos = list->getCurrentScrollPos();
+	list->handleMouseWheel(0, 0, direction);
+	if (list->getCurrentScrollPos() == pos) {
+		direction = -direction;
+		list->handleMouseWheel(0, 0, direction);
+	}
+	g_gui.theme()->updateScreen();
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		printf("Usage: %s <themes directory>\n", argv[0]);
+		return 1;
+	}
+
+	const Graphics::PixelFormat formats[] = {
+		Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+		Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24)
+	};
+
+	ThemeSystem *system = new ThemeSystem();
+	g_system = system;
+	system->_overlayFormat = formats[0];
+
+	ConfMan.set("themepath", argv[1]);
+	ConfMan.set("gui_theme", "scummmodern");
+	ConfMan.set("gui_renderer", "antialias");
+	if (g_gui.theme()->getThemeId() != "scummmodern") {
+		printf("The modern theme was not found in %s\n", argv[1]);
+		return 1;
+	}
+
+	printf("%-8s %-16s %12s %12s\n", "Format", "Frame", "Frames/s", "ms/frame");
+
+	for (int i = 0; i < ARRAYSIZE(formats); ++i) {
+		system->_overlayFormat = formats[i];
+		g_gui.loadNewTheme("scummmodern", GUI::ThemeEngine::kGfxAntialias, true);
+
+		LauncherListDialog *dialog = new LauncherListDialog();
+		dialog->open();
+		dialog->_list->setSelected(0);
+		GUI::ThemeDrawCache *cache = g_gui.theme()->drawCache();
+
+		for (int test = 0; test < 4; ++test) {
+			static const char *const names[] = { "open, uncached", "open, cached", "scroll, all rows", "scroll, moved" };
+
+			// Without a budget nothing is cached
+			cache->setBudget(test == 0 ? 0 : (uint32)GUI::ThemeDrawCache::kDefaultBudget);
+			drawDialog(dialog);
+
+			int frames = 0;
+			int direction = 1;
+			const clock_t start = clock();
+			clock_t elapsed;
+			do {
+				if (test < 2) {
+					drawDialog(dialog);
+				} else {
+					// Changing the numbering mode makes the list draw all
+					// of its rows again, like it did for every scroll step
+					if (test == 2)
+						dialog->_list->setNumberingMode(GUI::kListNumberingOff);
+					scrollList(dialog->_list, direction);
+				}
+				frames++;
+				elapsed = clock() - start;
+			} while (elapsed < CLOCKS_PER_SEC / 2);
+
+			const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+			printf("%-8s %-16s %12.1f %12.3f\n", formats[i].bytesPerPixel == 2 ? "RGB565" : "ARGB8888",
+			       names[test], frames / seconds, seconds * 1000 / frames);
+		}
+
+		dialog->close();
+		delete dialog;
+	}
+
+	GUI::GuiManager::destroy();
+	g_system = 0;
+	delete system;
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+	printf("The theme benchmark needs a POSIX file system\n");
+	return 0;
+}
+
+#endif
@@ -0,0 +1,146 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures how long loading a TrueType font takes, and how fast strings are
+// drawn with it. Use the 'ttf-bench' target to build and run it, or pass the
+// font to use on the command line.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_fopen
+#define FORBIDDEN_SYMBOL_EXCEPTION_fread
+#define FORBIDDEN_SYMBOL_EXCEPTION_fclose
+#define FORBIDDEN_SYMBOL_EXCEPTION_fseek
+#define FORBIDDEN_SYMBOL_EXCEPTION_ftell
+
+#include "common/scummsys.h"
+
+#ifdef USE_FREETYPE2
+
+#include "graphics/font.h"
+#include "graphics/fonts/ttf.h"
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+#include "common/memstream.h"
+#include "common/util.h"
+
+#include <time.h>
+
+static const char *const text = "The quick brown fox jumps over the lazy dog. 0123456789";
+
+int main(int argc, char *argv[]) {
+	const char *path = argc > 1 ? argv[1] : "gui/themes/fonts/FreeSans.ttf";
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		printf("Could not open %s\n", path);
+		return 1;
+	}
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	byte *data = new byte[size];
+	const bool read = fread(data, size, 1, file) == 1;
+	fclose(file);
+	if (!read) {
+		printf("Could not read %s\n", path);
+		return 1;
+	}
+
+	Common::MemoryReadStream stream(data, size);
+
+	// Loading the font, and the time until the first string is drawn
+	static const int sizes[] = { 12, 16, 24 };
+	Graphics::Surface surface;
+	surface.create(640, 480, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+
+	printf("%-20s %10s %10s\n", "Load", "Loads/s", "ms");
+	for (int i = 0; i < ARRAYSIZE(sizes); ++i) {
+		for (int first = 0; first < 2; ++first) {
+			int loads = 0;
+			const clock_t start = clock();
+			clock_t elapsed;
+			do {
+				stream.seek(0);
+				Graphics::Font *font = Graphics::loadTTFFont(stream, sizes[i]);
+				if (first)
+					font->drawString(&surface, text, 0, 0, surface.w, 0xFFFFFFFF);
+				delete font;
+				loads++;
+				elapsed = clock() - start;
+			} while (elapsed < CLOCKS_PER_SEC / 2);
+
+			const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+			printf("%2dpt %-15s %10.1f %10.3f\n", sizes[i], first ? "+ first string" : "", loads / seconds, seconds * 1000 / loads);
+		}
+	}
+
+	// Drawing a string over and over again
+	static const struct {
+		const char *name;
+		Graphics::PixelFormat format;
+	} formats[] = {
+		{ "RGB565", Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+		{ "ARGB8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24) }
+	};
+
+	printf("\n%-20s %10s %10s\n", "Draw", "Strings/s", "MPixel/s");
+	for (int i = 0; i < ARRAYSIZE(sizes); ++i) {
+		stream.seek(0);
+		Graphics::Font *font = Graphics::loadTTFFont(stream, sizes[i]);
+		const int width = font->getStringWidth(text);
+
+		for (int j = 0; j < ARRAYSIZE(formats); ++j) {
+			surface.free();
+			surface.create(640, 480, formats[j].format);
+
+			int strings = 0;
+			const clock_t start = clock();
+			clock_t elapsed;
+			do {
+				font->drawString(&surface, text, 0, (strings * font->getFontHeight()) % (surface.h - font->getFontHeight()), surface.w, formats[j].format.RGBToColor(255, 255, 255));
+				strings++;
+				elapsed = clock() - start;
+			} while (elapsed < CLOCKS_PER_SEC / 2);
+
+			const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+			printf("%2dpt %-15s %10.1f %10.1f\n", sizes[i], formats[j].name, strings / seconds,
+			       (double)strings * width * font->getFontHeight() / seconds / 1000000);
+		}
+
+		delete font;
+	}
+
+	surface.free();
+	Graphics::shutdownTTF();
+	delete[] data;
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+	printf("FreeType2 support is disabled\n");
+	return 0;
+}
+
+#endif
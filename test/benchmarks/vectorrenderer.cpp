@@ -0,0 +1,158 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the time the antialiased vector renderer takes to draw each kind
+// of primitive the themes use, at the sizes the modern theme has at 2x. Use
+// the 'vectorrenderer-bench' target to build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "graphics/transparent_surface.h"
+#include "graphics/VectorRenderer.h"
+#include "gui/ThemeEngine.h"
+#include "common/util.h"
+
+#include "test/stub_system.h"
+
+#include <time.h>
+
+typedef Graphics::VectorRenderer Renderer;
+
+static void setState(Renderer *renderer, Renderer::FillMode fillMode, int stroke, int bevel, int shadow) {
+	renderer->setFgColor(120, 40, 16);
+	renderer->setBgColor(254, 250, 245);
+	renderer->setBevelColor(200, 124, 104);
+	renderer->setGradientColors(203, 126, 107, 169, 42, 12);
+	renderer->setGradientFactor(1);
+	renderer->setFillMode(fillMode);
+	renderer->setStrokeWidth(stroke);
+	renderer->setBevel(bevel);
+	renderer->setShadowOffset(shadow);
+}
+
+static void squareFill(Renderer *renderer) {
+	setState(renderer, Renderer::kFillForeground, 0, 0, 0);
+	renderer->drawSquare(40, 40, 1000, 600);
+}
+
+static void squareGradient(Renderer *renderer) {
+	setState(renderer, Renderer::kFillGradient, 0, 0, 0);
+	renderer->drawSquare(40, 40, 1000, 600);
+}
+
+static void squareShadow(Renderer *renderer) {
+	setState(renderer, Renderer::kFillForeground, 0, 0, 14);
+	renderer->drawSquare(40, 40, 1000, 600);
+}
+
+static void roundedFill(Renderer *renderer) {
+	setState(renderer, Renderer::kFillForeground, 1, 0, 0);
+	renderer->drawRoundedSquare(40, 40, 10, 1000, 600);
+}
+
+static void roundedGradient(Renderer *renderer) {
+	setState(renderer, Renderer::kFillGradient, 0, 0, 0);
+	renderer->drawRoundedSquare(40, 40, 12, 1000, 600);
+}
+
+static void roundedShadow(Renderer *renderer) {
+	setState(renderer, Renderer::kFillGradient, 0, 0, 14);
+	renderer->drawRoundedSquare(40, 40, 12, 1000, 600);
+}
+
+static void button(Renderer *renderer) {
+	setState(renderer, Renderer::kFillGradient, 1, 1, 0);
+	renderer->drawRoundedSquare(40, 40, 10, 220, 48);
+}
+
+static void beveledSquare(Renderer *renderer) {
+	setState(renderer, Renderer::kFillBackground, 0, 0, 0);
+	renderer->setBgColor(0, 0, 0);
+	renderer->drawBeveledSquare(40, 40, 1000, 600, 2);
+}
+
+static void tab(Renderer *renderer) {
+	setState(renderer, Renderer::kFillBackground, 1, 0, 0);
+	renderer->drawTab(40, 40, 8, 240, 40);
+}
+
+static const struct {
+	const char *name;
+	void (*draw)(Renderer *renderer);
+} primitives[] = {
+	{ "square", squareFill },
+	{ "square gradient", squareGradient },
+	{ "square shadow", squareShadow },
+	{ "rounded", roundedFill },
+	{ "rounded gradient", roundedGradient },
+	{ "rounded shadow", roundedShadow },
+	{ "button", button },
+	{ "beveled square", beveledSquare },
+	{ "tab", tab }
+};
+
+int main(int argc, char *argv[]) {
+	const Graphics::PixelFormat formats[] = {
+		Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+		Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24)
+	};
+
+	StubSystem *system = new StubSystem();
+	g_system = system;
+
+	printf("%-8s %-18s %12s %12s\n", "Format", "Primitive", "Draws/s", "us/draw");
+
+	for (int i = 0; i < ARRAYSIZE(formats); ++i) {
+		system->_overlayFormat = formats[i];
+		Renderer *renderer = Graphics::createRenderer(GUI::ThemeEngine::kGfxAntialias);
+
+		Graphics::TransparentSurface screen;
+		screen.create(1280, 800, formats[i]);
+		renderer->setSurface(&screen);
+		renderer->setGradientColors(120, 40, 16, 255, 180, 60);
+		renderer->setFillMode(Renderer::kFillGradient);
+		renderer->fillSurface();
+
+		for (int j = 0; j < ARRAYSIZE(primitives); ++j) {
+			int draws = 0;
+			const clock_t start = clock();
+			clock_t elapsed;
+			do {
+				primitives[j].draw(renderer);
+				draws++;
+				elapsed = clock() - start;
+			} while (elapsed < CLOCKS_PER_SEC / 2);
+
+			const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+			printf("%-8s %-18s %12.1f %12.1f\n", formats[i].bytesPerPixel == 2 ? "RGB565" : "ARGB8888",
+			       primitives[j].name, draws / seconds, seconds * 1000000 / draws);
+		}
+
+		screen.free();
+		delete renderer;
+	}
+
+	g_system = 0;
+	delete system;
+	return 0;
+}
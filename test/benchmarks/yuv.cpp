@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Measures the throughput of the YUV to RGB conversions. Use the
+// 'yuv-bench' target to build and run it.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "graphics/yuv_to_rgb.h"
+#include "common/util.h"
+
+#include <time.h>
+
+static const struct {
+	int w, h;
+} sizes[] = {
+	{ 640, 480 },
+	{ 1280, 720 }
+};
+
+static const struct {
+	const char *name;
+	Graphics::PixelFormat format;
+} formats[] = {
+	{ "RGB565", Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+	{ "RGBA8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0) }
+};
+
+// Log2 of the chroma subsampling
+static const struct {
+	const char *name;
+	int shift;
+} subsamplings[] = {
+	{ "444", 0 },
+	{ "420", 1 },
+	{ "410", 2 }
+};
+
+// Smooth gradients with a bit of noise, like a video frame
+static void fillPlane(byte *plane, int size, int w, uint32 seed) {
+	for (int i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		plane[i] = ((i % w) + (i / w) + ((seed >> 16) & 15)) & 0xFF;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	printf("%-5s %-9s %-10s %10s %10s\n", "YUV", "Size", "Format", "Frames/s", "MPixel/s");
+
+	for (uint i = 0; i < ARRAYSIZE(subsamplings); ++i) {
+		for (uint j = 0; j < ARRAYSIZE(sizes); ++j) {
+			const int w = sizes[j].w;
+			const int h = sizes[j].h;
+			const int shift = subsamplings[i].shift;
+			// 410 reads one more row and column of chroma
+			const int uvPitch = (w >> shift) + 1;
+			const int uvSize = uvPitch * ((h >> shift) + 1);
+
+			byte *ySrc = new byte[w * h];
+			byte *uSrc = new byte[uvSize];
+			byte *vSrc = new byte[uvSize];
+			fillPlane(ySrc, w * h, w, 1);
+			fillPlane(uSrc, uvSize, uvPitch, 2);
+			fillPlane(vSrc, uvSize, uvPitch, 3);
+
+			for (uint k = 0; k < ARRAYSIZE(formats); ++k) {
+				Graphics::Surface dst;
+				dst.create(w, h, formats[k].format);
+
+				int frames = 0;
+				const clock_t start = clock();
+				clock_t elapsed;
+				do {
+					if (shift == 0)
+						YUVToRGBMan.convert444(&dst, Graphics::YUVToRGBManager::kScaleITU, ySrc, uSrc, vSrc, w, h, w, uvPitch);
+					else if (shift == 1)
+						YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, ySrc, uSrc, vSrc, w, h, w, uvPitch);
+					else
+						YUVToRGBMan.convert410(&dst, Graphics::YUVToRGBManager::kScaleITU, ySrc, uSrc, vSrc, w, h, w, uvPitch);
+					frames++;
+					elapsed = clock() - start;
+				} while (elapsed < CLOCKS_PER_SEC / 2);
+
+				const double seconds = (double)elapsed / CLOCKS_PER_SEC;
+				printf("%-5s %4dx%-4d %-10s %10.1f %10.1f\n", subsamplings[i].name, w, h, formats[k].name,
+				       frames / seconds, (double)frames * w * h / seconds / 1000000);
+				dst.free();
+			}
+
+			delete[] ySrc;
+			delete[] uSrc;
+			delete[] vSrc;
+		}
+	}
+
+	Graphics::YUVToRGBManager::destroy();
+	return 0;
+}
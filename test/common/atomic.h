@@ -0,0 +1,20 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+
+class AtomicTestSuite : public CxxTest::TestSuite {
+public:
+	void test_load_store_add() {
+#ifdef SCUMMVM_ATOMICS
+		volatile uint32 value = 0;
+		Common::atomicStore(&value, 41);
+		TS_ASSERT_EQUALS(Common::atomicLoad(&value), 41u);
+		TS_ASSERT_EQUALS(Common::atomicAdd(&value, 1), 42u);
+		TS_ASSERT_EQUALS(Common::atomicLoad(&value), 42u);
+
+		// Positions wrap around like unsigned integers
+		Common::atomicStore(&value, 0xFFFFFFFF);
+		TS_ASSERT_EQUALS(Common::atomicAdd(&value, 2), 1u);
+#endif
+	}
+};
@@ -0,0 +1,169 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/bufferedstream.h"
+
+class CachedSeekableReadStreamTestSuite : public CxxTest::TestSuite {
+private:
+	/**
+	 * Counts the reads and seeks which reach the underlying stream, like
+	 * system calls would for a file.
+	 */
+	class CountingStream : public Common::MemoryReadStream {
+	public:
+		CountingStream(const byte *data, uint32 size) : Common::MemoryReadStream(data, size), _reads(0), _seeks(0) {}
+
+		uint32 read(void *dataPtr, uint32 dataSize) { _reads++; return Common::MemoryReadStream::read(dataPtr, dataSize); }
+		bool seek(int32 offs, int whence = SEEK_SET) { _seeks++; return Common::MemoryReadStream::seek(offs, whence); }
+
+		uint _reads;
+		uint _seeks;
+	};
+
+	enum {
+		kFileSize = 64 * 1024
+	};
+
+	static byte contents(uint32 pos) {
+		return (byte)(pos ^ (pos >> 8));
+	}
+
+	// Mimics a container parser: read a small header, look at the
+	// chunk it points to, and return to the header for the next one.
+	static bool parseChunks(Common::SeekableReadStream &stream) {
+		for (uint32 chunk = 0; chunk < 32; ++chunk) {
+			stream.seek(chunk * 8);
+			const uint32 pos = stream.pos();
+			byte header[8];
+			stream.read(header, sizeof(header));
+			if (header[0] != contents(pos))
+				return false;
+
+			const uint32 offset = 1024 + chunk * 1500;
+			stream.seek(offset);
+			byte data[16];
+			stream.read(data, sizeof(data));
+			if (data[15] != contents(offset + 15))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void test_traverse() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+		Common::CachedSeekableReadStream stream(&ms, 4, 2, DisposeAfterUse::NO);
+
+		byte i, b;
+		for (i = 0; i < 10; ++i) {
+			TS_ASSERT(!stream.eos());
+			TS_ASSERT_EQUALS(i, stream.pos());
+			stream.read(&b, 1);
+			TS_ASSERT_EQUALS(i, b);
+		}
+
+		TS_ASSERT(!stream.eos());
+		TS_ASSERT_EQUALS((uint)0, stream.read(&b, 1));
+		TS_ASSERT(stream.eos());
+
+		TS_ASSERT(stream.seek(-3, SEEK_END));
+		TS_ASSERT(!stream.eos());
+		byte buffer[5];
+		TS_ASSERT_EQUALS(stream.read(buffer, 5), 3u);
+		TS_ASSERT_EQUALS(buffer[0], 7);
+		TS_ASSERT_EQUALS(buffer[2], 9);
+		TS_ASSERT(stream.eos());
+
+		// Like fseek(), seeking past the end works, reading there does not
+		TS_ASSERT(stream.seek(11));
+		TS_ASSERT_EQUALS(stream.pos(), 11);
+		TS_ASSERT_EQUALS(stream.read(&b, 1), 0u);
+		TS_ASSERT(stream.eos());
+		TS_ASSERT_EQUALS(stream.peek(1).size(), 0u);
+		TS_ASSERT(!stream.seek(-1));
+	}
+
+	void test_random_access() {
+		byte *data = new byte[kFileSize];
+		for (uint32 i = 0; i < kFileSize; ++i)
+			data[i] = contents(i);
+		Common::MemoryReadStream ms(data, kFileSize);
+		Common::CachedSeekableReadStream stream(&ms, 1000, 5, DisposeAfterUse::NO);
+
+		uint32 seed = 1;
+		byte buffer[4000];
+		for (int i = 0; i < 1000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = (seed >> 8) % kFileSize;
+			const uint32 size = MIN<uint32>((seed >> 4) % 4000, kFileSize - pos);
+
+			TS_ASSERT(stream.seek(pos));
+			TS_ASSERT_EQUALS(stream.read(buffer, size), size);
+			for (uint32 j = 0; j < size; ++j) {
+				if (buffer[j] != contents(pos + j)) {
+					TS_FAIL("Wrong data");
+					break;
+				}
+			}
+			TS_ASSERT_EQUALS(stream.pos(), (int32)(pos + size));
+		}
+
+		delete[] data;
+	}
+
+	void test_peek() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+		Common::CachedSeekableReadStream stream(&ms, 4, 2, DisposeAfterUse::NO);
+
+		// Within a block the data is not copied
+		Common::Span<const byte> span = stream.peek(4);
+		TS_ASSERT_EQUALS(span.size(), 4u);
+		TS_ASSERT_EQUALS(span[3], 3);
+		TS_ASSERT_EQUALS(stream.pos(), 0);
+
+		stream.seek(3);
+		span = stream.peek(3);
+		TS_ASSERT_EQUALS(span.size(), 3u);
+		TS_ASSERT_EQUALS(span[0], 3);
+		TS_ASSERT_EQUALS(span[2], 5);
+		TS_ASSERT_EQUALS(stream.pos(), 3);
+
+		stream.seek(8);
+		span = stream.peek(4);
+		TS_ASSERT_EQUALS(span.size(), 2u);
+		TS_ASSERT_EQUALS(span[1], 9);
+		TS_ASSERT(!stream.eos());
+	}
+
+	void test_parent_access() {
+		byte *data = new byte[kFileSize];
+		for (uint32 i = 0; i < kFileSize; ++i)
+			data[i] = contents(i);
+
+		CountingStream buffered(data, kFileSize);
+		Common::SeekableReadStream *stream = Common::wrapBufferedSeekableReadStream(&buffered, 4096, DisposeAfterUse::NO);
+		TS_ASSERT(parseChunks(*stream));
+		delete stream;
+
+		CountingStream cached(data, kFileSize);
+		stream = Common::wrapCachedSeekableReadStream(&cached, 4096, 16, DisposeAfterUse::NO);
+		TS_ASSERT(parseChunks(*stream));
+
+		// The whole parse touches 12 blocks, which the cache fetches in
+		// two sequential runs, versus a refill for every seek.
+		TS_ASSERT_EQUALS(cached._reads, 2u);
+		TS_ASSERT_LESS_THAN(cached._reads * 10, buffered._reads);
+
+		// Reading it all again is served from the cache
+		stream->seek(0);
+		byte buffer[4096];
+		while (stream->read(buffer, 1000) == 1000)
+			;
+		TS_ASSERT_EQUALS(cached._reads, 2u);
+
+		delete stream;
+		delete[] data;
+	}
+};
@@ -0,0 +1,94 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/content-hash.h"
+#include "common/memstream.h"
+
+class ContentHashTestSuite : public CxxTest::TestSuite {
+private:
+	struct Vector {
+		uint32 size;
+		uint32 hashHigh;
+		uint32 hashLow;
+	};
+
+	static uint64 expected(const Vector &vector) {
+		return ((uint64)vector.hashHigh << 32) | vector.hashLow;
+	}
+
+	byte _data[1000];
+
+	void fillData() {
+		for (uint32 i = 0; i < sizeof(_data); ++i)
+			_data[i] = ((i * 7 + 3) ^ (i >> 5)) & 0xFF;
+	}
+
+	static const Vector *vectors(int &count) {
+		// Reference values of the xxHash64 algorithm
+		static const Vector v[] = {
+			{    0, 0xef46db37, 0x51d8e999 },
+			{    1, 0x1f25c8d0, 0xbc1f4bb6 },
+			{    3, 0x31d2363f, 0x52e564c9 },
+			{    4, 0x9bb64b7d, 0x66ee9fda },
+			{    7, 0x9a7b1499, 0x59ce60d8 },
+			{    8, 0xdab99d95, 0xc6f90092 },
+			{   31, 0xa2aa5f33, 0xcc4a6119 },
+			{   32, 0x23c3c17e, 0xf790fd97 },
+			{   33, 0xc2652c55, 0x30c8fe89 },
+			{   63, 0x0972686d, 0xc23a5bf3 },
+			{  100, 0xb1c6935a, 0xe914488c },
+			{ 1000, 0x32f4d180, 0xd88fc026 }
+		};
+		count = ARRAYSIZE(v);
+		return v;
+	}
+
+public:
+	void test_vectors() {
+		fillData();
+
+		int count;
+		const Vector *v = vectors(count);
+		for (int i = 0; i < count; ++i)
+			TS_ASSERT_EQUALS(Common::computeContentHash(_data, v[i].size), expected(v[i]));
+
+		const uint64 seed = ((uint64)0x1 << 32) | 0x23456789;
+		const uint64 seeded = ((uint64)0x38be491c << 32) | 0x26b4ba23;
+		TS_ASSERT_EQUALS(Common::computeContentHash(_data, 100, seed), seeded);
+	}
+
+	void test_incremental() {
+		fillData();
+
+		int count;
+		const Vector *v = vectors(count);
+		for (int i = 0; i < count; ++i) {
+			for (uint32 chunk = 1; chunk < 70; chunk += 5) {
+				Common::ContentHash hash;
+				for (uint32 pos = 0; pos < v[i].size; pos += chunk)
+					hash.update(_data + pos, MIN(chunk, v[i].size - pos));
+				TS_ASSERT_EQUALS(hash.finish(), expected(v[i]));
+			}
+		}
+
+		// Data may still be added after finish()
+		Common::ContentHash hash;
+		hash.update(_data, 31);
+		TS_ASSERT_EQUALS(hash.finish(), expected(v[6]));
+		hash.update(_data + 31, 2);
+		TS_ASSERT_EQUALS(hash.finish(), expected(v[8]));
+	}
+
+	void test_stream() {
+		fillData();
+
+		int count;
+		const Vector *v = vectors(count);
+
+		Common::MemoryReadStream stream(_data, sizeof(_data));
+		TS_ASSERT_EQUALS(Common::computeStreamContentHash(stream), expected(v[count - 1]));
+
+		stream.seek(0);
+		TS_ASSERT_EQUALS(Common::computeStreamContentHash(stream, 100), expected(v[10]));
+		TS_ASSERT_EQUALS(stream.pos(), 100);
+	}
+};
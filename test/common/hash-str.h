@@ -160,5 +160,25 @@ class HashStrTestSuite : public CxxTest::TestSuite {
 
 	}
 
-
+	void test_c_string_lookup() {
+		Common::StringMap map;
+		map["Music_Volume"] = "192";
+		map["subtitles"] = "true";
+
+		const Common::StringMap &constMap = map;
+		const char *key = "music_volume";
+		TS_ASSERT(constMap.contains(key));
+		TS_ASSERT(constMap.contains("SUBTITLES"));
+		TS_ASSERT(!constMap.contains("speech_mute"));
+		TS_ASSERT_EQUALS(constMap.find(key)->_value, "192");
+		TS_ASSERT(constMap.find("speech_mute") == constMap.end());
+
+		map.find("MUSIC_VOLUME")->_value = "255";
+		TS_ASSERT_EQUALS(map["music_volume"], "255");
+
+		Common::HashMap<Common::String, int, Common::CaseSensitiveString_Hash, Common::CaseSensitiveString_EqualTo> caseMap;
+		caseMap["Key"] = 1;
+		TS_ASSERT(caseMap.contains("Key"));
+		TS_ASSERT(!caseMap.contains("key"));
+	}
 };
@@ -2,6 +2,7 @@
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/flat-hashmap.h"
 
 class HashMapTestSuite : public CxxTest::TestSuite
 {
@@ -230,5 +231,112 @@ class HashMapTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(found == 16+8+4);
 }
 
+	void test_flat_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		for (int i = 0; i < 5; ++i)
+			container[i] = i * 10;
+		TS_ASSERT_EQUALS(container.size(), 5u);
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container.erase(container.find(2));
+		TS_ASSERT(!container.contains(2));
+		container[1] = 42;
+		TS_ASSERT_EQUALS(container[1], 42);
+		TS_ASSERT_EQUALS(container[4], 40);
+		TS_ASSERT_EQUALS(container.size(), 4u);
+
+		const Common::FlatHashMap<int, int> &containerRef = container;
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(container.size(), 4u);
+
+		container.clear();
+		TS_ASSERT(container.empty());
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+	}
+
+	void test_flat_collision() {
+		// Keys which share their low bits must still be told apart
+		Common::FlatHashMap<int, int> h;
+		for (int i = 0; i < 8; ++i)
+			h[(i << 16) + 5] = i;
+		h.erase((3 << 16) + 5);
+		for (int i = 0; i < 8; ++i)
+			TS_ASSERT_EQUALS(h.contains((i << 16) + 5), i != 3);
+		h[(3 << 16) + 5] = 3;
+		for (int i = 0; i < 8; ++i)
+			TS_ASSERT_EQUALS(h[(i << 16) + 5], i);
+	}
+
+	void test_flat_iterator_erase() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 100; ++i)
+			container[i] = i;
+
+		// Erasing entries must not invalidate other iterators
+		Common::FlatHashMap<int, int>::iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			if (i->_key & 1)
+				container.erase(i);
+		}
+		TS_ASSERT_EQUALS(container.size(), 50u);
+
+		int sum = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		for (j = container.begin(); j != container.end(); ++j) {
+			TS_ASSERT_EQUALS(j->_key & 1, 0);
+			sum += j->_value;
+		}
+		TS_ASSERT_EQUALS(sum, 2450);
+	}
+
+	void test_flat_against_hashmap() {
+		Common::HashMap<uint, uint> reference;
+		Common::FlatHashMap<uint, uint> flat;
+
+		uint32 seed = 1;
+		for (int i = 0; i < 20000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint key = (seed >> 16) % 3000;
+			if (seed & 0x100) {
+				reference.erase(key);
+				flat.erase(key);
+			} else {
+				reference[key] = i;
+				flat[key] = i;
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+		for (Common::HashMap<uint, uint>::const_iterator k = reference.begin(); k != reference.end(); ++k)
+			TS_ASSERT_EQUALS(flat.getVal(k->_key, ~0u), k->_value);
+
+		Common::FlatHashMap<uint, uint> copy;
+		copy = flat;
+		TS_ASSERT_EQUALS(copy.size(), flat.size());
+		for (Common::FlatHashMap<uint, uint>::const_iterator k = flat.begin(); k != flat.end(); ++k)
+			TS_ASSERT_EQUALS(copy[k->_key], k->_value);
+	}
+
+	void test_flat_string_keys() {
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container;
+		container["foo"] = "bar";
+		container["Quux"] = "blub";
+		TS_ASSERT(container.contains("FOO"));
+		TS_ASSERT(container.contains(Common::String("quux")));
+		TS_ASSERT(!container.contains("bar"));
+		TS_ASSERT_EQUALS(container["QUUX"], "blub");
+
+		// Grow the map while it holds non-POD entries
+		for (int i = 0; i < 1000; ++i)
+			container[Common::String::format("key%d", i)] = Common::String::format("value%d", i);
+		TS_ASSERT_EQUALS(container.size(), 1002u);
+		TS_ASSERT_EQUALS(container["KEY500"], "value500");
+		TS_ASSERT_EQUALS(container["foo"], "bar");
+	}
+
 	// TODO: Add test cases for iterators, find, ...
 };
@@ -47,4 +47,31 @@ class MD5TestSuite : public CxxTest::TestSuite {
 		}
 	}
 
+	void test_incremental() {
+		char output[33];
+		unsigned char md5sum[16];
+
+		Common::MD5 md5;
+		for (int i = 0; i < 7; i++) {
+			// Feed the data in pieces of varying size
+			const char *str = md5_test_string[i];
+			uint32 len = strlen(str);
+			for (uint32 chunk = 1; len > 0; chunk = chunk * 3 % 17 + 1) {
+				const uint32 n = MIN(chunk, len);
+				md5.update(str, n);
+				str += n;
+				len -= n;
+			}
+			md5.finish(md5sum);
+			md5.reset();
+
+			for (int j = 0; j < 16; j++) {
+				sprintf(output + j * 2, "%02x", md5sum[j]);
+			}
+
+			Common::String tmp(output);
+			TS_ASSERT_EQUALS(tmp, md5_test_digest[i]);
+		}
+	}
+
 };
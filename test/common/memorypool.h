@@ -0,0 +1,180 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memorypool.h"
+#include "common/atomic.h"
+
+#include "test/stub_system.h"
+
+#if defined(SCUMMVM_THREAD_LOCAL) && defined(SCUMMVM_ATOMICS)
+#define SIZE_CLASS_THREAD_CACHES
+#endif
+
+class MemoryPoolTestSuite : public CxxTest::TestSuite {
+private:
+	class MutexCountingSystem : public StubSystem {
+	public:
+		MutexCountingSystem() : _mutexes(0), _locks(0) {}
+
+		int _mutexes;
+		int _locks;
+
+		MutexRef createMutex() { _mutexes++; return (MutexRef)this; }
+		void lockMutex(MutexRef mutex) { _locks++; }
+		void deleteMutex(MutexRef mutex) { _mutexes--; }
+	};
+
+public:
+	void test_size_classes() {
+		Common::SizeClassAllocator allocator("test", false);
+		allocator.setTagName(1, "scene");
+
+		static const size_t sizes[] = { 0, 1, 8, 9, 100, 2040, 2041, 100000 };
+		const uint32 numSizes = ARRAYSIZE(sizes);
+		void *blocks[ARRAYSIZE(sizes)];
+		size_t total = 0;
+
+		for (uint i = 0; i < numSizes; ++i) {
+			blocks[i] = allocator.allocate(sizes[i], 1);
+			TS_ASSERT(blocks[i]);
+			TS_ASSERT_EQUALS((size_t)blocks[i] & 7, 0u);
+			memset(blocks[i], i, sizes[i]);
+			total += sizes[i];
+		}
+
+		for (uint i = 0; i < numSizes; ++i) {
+			for (size_t j = 0; j < sizes[i]; ++j) {
+				if (((byte *)blocks[i])[j] != (byte)i) {
+					TS_FAIL("Block overwritten");
+					break;
+				}
+			}
+		}
+
+		Common::SizeClassAllocator::TagStats stats = allocator.getStats(1);
+		TS_ASSERT_EQUALS(stats.liveBytes, total);
+		TS_ASSERT_EQUALS(stats.allocations, numSizes);
+		TS_ASSERT_EQUALS(allocator.getStats(0).allocations, 0u);
+		TS_ASSERT_EQUALS(allocator.getTagName(1), "scene");
+
+		for (uint i = 0; i < numSizes; ++i)
+			allocator.free(blocks[i]);
+		allocator.free(0);
+
+		stats = allocator.getStats(1);
+		TS_ASSERT_EQUALS(stats.liveBytes, 0u);
+		TS_ASSERT_EQUALS(stats.peakBytes, total);
+		TS_ASSERT_EQUALS(stats.frees, numSizes);
+
+		allocator.resetStats();
+		stats = allocator.getStats(1);
+		TS_ASSERT_EQUALS(stats.allocations, 0u);
+		TS_ASSERT_EQUALS(stats.peakBytes, 0u);
+
+		allocator.freeUnusedPages();
+	}
+
+	void test_thread_safe_allocator() {
+		MutexCountingSystem system;
+		g_system = &system;
+
+		{
+			Common::SizeClassAllocator allocator("test");
+			TS_ASSERT_EQUALS(system._mutexes, 1);
+
+			const int locks = system._locks;
+			allocator.free(allocator.allocate(100));
+#ifdef SIZE_CLASS_THREAD_CACHES
+			// Only filling the cache of the thread takes the lock
+			TS_ASSERT_EQUALS(system._locks, locks + 1);
+			allocator.free(allocator.allocate(100));
+			TS_ASSERT_EQUALS(system._locks, locks + 1);
+#else
+			TS_ASSERT_EQUALS(system._locks, locks + 2);
+#endif
+		}
+		TS_ASSERT_EQUALS(system._mutexes, 0);
+
+		g_system = 0;
+	}
+
+	void test_thread_cache() {
+		MutexCountingSystem system;
+		g_system = &system;
+
+		{
+			Common::SizeClassAllocator allocator("test");
+			void *blocks[100];
+
+			const int locks = system._locks;
+			for (int i = 0; i < 100; ++i)
+				blocks[i] = allocator.allocate(40, 2);
+			for (int i = 0; i < 100; ++i)
+				allocator.free(blocks[i]);
+#ifdef SIZE_CLASS_THREAD_CACHES
+			// Chunks move in batches of 16, the cache holds at most 32
+			TS_ASSERT_EQUALS(system._locks, locks + 7 + 5);
+#else
+			TS_ASSERT_EQUALS(system._locks, locks + 200);
+#endif
+
+			Common::SizeClassAllocator::TagStats stats = allocator.getStats(2);
+			TS_ASSERT_EQUALS(stats.liveBytes, 0u);
+			TS_ASSERT_EQUALS(stats.peakBytes, 4000u);
+			TS_ASSERT_EQUALS(stats.allocations, 100u);
+			TS_ASSERT_EQUALS(stats.frees, 100u);
+
+			allocator.freeUnusedPages();
+		}
+
+		g_system = 0;
+	}
+
+	void test_allocator_list() {
+		Common::SizeClassAllocator *first = Common::SizeClassAllocator::getFirst();
+		{
+			Common::SizeClassAllocator allocator("test", false);
+			TS_ASSERT_EQUALS(Common::SizeClassAllocator::getFirst(), &allocator);
+			TS_ASSERT_EQUALS(allocator.getNext(), first);
+		}
+		TS_ASSERT_EQUALS(Common::SizeClassAllocator::getFirst(), first);
+	}
+
+	void test_arena() {
+		Common::MemoryArena arena(1024);
+
+		byte *a = (byte *)arena.allocate(3);
+		byte *b = (byte *)arena.allocate(5);
+		TS_ASSERT_EQUALS(b - a, 8);
+		TS_ASSERT_EQUALS(arena.getUsedBytes(), 16u);
+		TS_ASSERT_EQUALS(arena.getReservedBytes(), 1024u);
+
+		// Too big for the current block, but still fits a regular one
+		arena.allocate(1010);
+		TS_ASSERT_EQUALS(arena.getReservedBytes(), 2048u);
+
+		// Oversized blocks get a block of their own
+		arena.allocate(5000);
+		TS_ASSERT_EQUALS(arena.getReservedBytes(), 2048u + 5000u);
+
+		int *value = new (arena) int(42);
+		TS_ASSERT_EQUALS(*value, 42);
+
+		// Regular blocks are kept for reuse
+		arena.reset();
+		TS_ASSERT_EQUALS(arena.getUsedBytes(), 0u);
+		TS_ASSERT_EQUALS(arena.getReservedBytes(), 2048u);
+		arena.allocate(1000);
+		arena.allocate(1000);
+		TS_ASSERT_EQUALS(arena.getReservedBytes(), 2048u);
+
+		arena.reset(true);
+		TS_ASSERT_EQUALS(arena.getReservedBytes(), 0u);
+	}
+
+	void test_pool_page_limit() {
+		// Pages stop growing before they exceed 16 MB
+		Common::MemoryPool pool(1024);
+		for (int i = 0; i < 40000; ++i)
+			pool.allocChunk();
+	}
+};
@@ -104,4 +104,24 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_borrow() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		Common::DirectReadAccess *access = ms.getDirectAccess();
+		TS_ASSERT(access);
+
+		ms.seek(2, SEEK_SET);
+		uint32 size = 3;
+		TS_ASSERT_EQUALS(access->borrow(size), contents + 2);
+		TS_ASSERT_EQUALS(size, 3u);
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+		TS_ASSERT(!ms.eos());
+
+		// Borrowing past the end gives what is left
+		size = 10;
+		TS_ASSERT_EQUALS(access->borrow(size), contents + 5);
+		TS_ASSERT_EQUALS(size, 2u);
+		TS_ASSERT(ms.eos());
+	}
 };
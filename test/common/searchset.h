@@ -0,0 +1,297 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/str-array.h"
+
+#include "test/stub_system.h"
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+private:
+	class TestArchive : public Common::Archive {
+	public:
+		TestArchive(byte id, bool listed = true, bool bareNames = false) : _unreadable(false), _listings(0), _lookups(0), _id(id), _listed(listed), _bareNames(bareNames) {}
+
+		Common::StringArray _names;
+		bool _unreadable;	// Has its members, but fails to open them
+		mutable int _listings;	// Number of listMembers() calls
+		mutable int _lookups;	// Number of hasFile() and createReadStreamForMember() calls
+
+		bool hasFile(const Common::String &name) const {
+			_lookups++;
+			for (uint i = 0; i < _names.size(); ++i) {
+				if (_names[i].equalsIgnoreCase(name))
+					return true;
+			}
+			return false;
+		}
+
+		int listMembers(Common::ArchiveMemberList &list) const {
+			_listings++;
+			if (!_listed)
+				return 0;
+
+			for (uint i = 0; i < _names.size(); ++i)
+				list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(_bareNames ? Common::lastPathComponent(_names[i], '/') : _names[i], this)));
+			return _names.size();
+		}
+
+		const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+			return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+		}
+
+		Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			if (!hasFile(name) || _unreadable)
+				return 0;
+			return new Common::MemoryReadStream(&_id, 1);
+		}
+
+	private:
+		byte _id;
+		bool _listed;
+		bool _bareNames;	// List members without their path, like FSDirectory
+	};
+
+	static int openArchive(const Common::SearchSet &set, const char *name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return -1;
+
+		int id = stream->readByte();
+		delete stream;
+		return id;
+	}
+
+	StubSystem *_system;
+
+public:
+	void setUp() {
+		_system = new StubSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = 0;
+		delete _system;
+	}
+
+	void test_priority() {
+		Common::SearchSet set;
+
+		TestArchive *low = new TestArchive(1);
+		low->_names.push_back("both.dat");
+		low->_names.push_back("low.dat");
+		set.add("low", low, 0);
+
+		TestArchive *high = new TestArchive(2);
+		high->_names.push_back("BOTH.DAT");
+		set.add("high", high, 10);
+
+		TS_ASSERT_EQUALS(set.getIndexSize(), 2u);
+		TS_ASSERT_EQUALS(openArchive(set, "both.dat"), 2);
+		TS_ASSERT_EQUALS(openArchive(set, "Low.Dat"), 1);
+		TS_ASSERT_EQUALS(openArchive(set, "missing.dat"), -1);
+		TS_ASSERT(set.hasFile("both.dat"));
+		TS_ASSERT(!set.hasFile("missing.dat"));
+
+		// Added after the index is built, but with equal priority to
+		// the existing archive, so insertion order prevails.
+		TestArchive *late = new TestArchive(3);
+		late->_names.push_back("low.dat");
+		late->_names.push_back("late.dat");
+		set.add("late", late, 0);
+
+		TS_ASSERT_EQUALS(openArchive(set, "low.dat"), 1);
+		TS_ASSERT_EQUALS(openArchive(set, "late.dat"), 3);
+
+		set.remove("high");
+		TS_ASSERT_EQUALS(openArchive(set, "both.dat"), 1);
+
+		set.remove("low");
+		TS_ASSERT_EQUALS(openArchive(set, "both.dat"), -1);
+		TS_ASSERT_EQUALS(openArchive(set, "low.dat"), 3);
+
+		set.setPriority("late", 5);
+		TS_ASSERT_EQUALS(openArchive(set, "late.dat"), 3);
+	}
+
+	void test_unlisted_archive() {
+		Common::SearchSet set;
+
+		TestArchive *listed = new TestArchive(1);
+		listed->_names.push_back("file.dat");
+		set.add("listed", listed, 0);
+
+		TestArchive *unlisted = new TestArchive(2, false);
+		unlisted->_names.push_back("file.dat");
+		unlisted->_names.push_back("hidden.dat");
+		set.add("unlisted", unlisted, 10);
+
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 2);
+		TS_ASSERT_EQUALS(openArchive(set, "hidden.dat"), 2);
+		TS_ASSERT(set.hasFile("hidden.dat"));
+
+		// Added after the index is built
+		TestArchive *late = new TestArchive(3, false);
+		late->_names.push_back("file.dat");
+		set.add("late", late, 20);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 3);
+	}
+
+	void test_sub_paths() {
+		Common::SearchSet set;
+
+		TestArchive *full = new TestArchive(1);
+		full->_names.push_back("sub/file.dat");
+		set.add("full", full, 0);
+
+		TestArchive *bare = new TestArchive(2, true, true);
+		bare->_names.push_back("sub/file.dat");
+		bare->_names.push_back("file.dat");
+		set.add("bare", bare, 10);
+
+		TS_ASSERT_EQUALS(openArchive(set, "sub/file.dat"), 2);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 2);
+
+		set.setPriority("bare", -10);
+		TS_ASSERT_EQUALS(openArchive(set, "sub/file.dat"), 1);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 2);
+	}
+
+	void test_stats() {
+		Common::SearchSet set;
+
+		TestArchive *archive = new TestArchive(1);
+		archive->_names.push_back("file.dat");
+		set.add("archive", archive);
+
+		openArchive(set, "file.dat");
+		openArchive(set, "missing.dat");
+
+		const Common::SearchSet::Stats &stats = set.getStats();
+		TS_ASSERT_EQUALS(stats.opens, 2u);
+		TS_ASSERT_EQUALS(stats.indexHits, 1u);
+		TS_ASSERT_EQUALS(stats.fallbacks, 0u);
+
+		set.resetStats();
+		TS_ASSERT_EQUALS(set.getStats().opens, 0u);
+
+		// The index finds the archive, but the archive fails to open the
+		// member, so the lookup is not answered
+		archive->_unreadable = true;
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), -1);
+		TS_ASSERT_EQUALS(set.getStats().indexHits, 0u);
+		TS_ASSERT_EQUALS(set.getStats().fallbacks, 0u);
+
+		// Archives not listing their members are asked for anything
+		TestArchive *unlisted = new TestArchive(2, false);
+		set.add("unlisted", unlisted, -10);
+		TS_ASSERT_EQUALS(openArchive(set, "missing.dat"), -1);
+		TS_ASSERT_EQUALS(set.getStats().fallbacks, 1u);
+	}
+
+	void test_misses_skip_listed_archives() {
+		Common::SearchSet set;
+
+		TestArchive *listed = new TestArchive(1);
+		listed->_names.push_back("file.dat");
+		set.add("listed", listed, 10);
+
+		TestArchive *other = new TestArchive(2);
+		other->_names.push_back("other.dat");
+		set.add("other", other, 0);
+
+		TestArchive *unlisted = new TestArchive(3, false);
+		unlisted->_names.push_back("hidden.dat");
+		set.add("unlisted", unlisted, 5);
+
+		// Only archives listing the name, or not listing anything, are
+		// asked for a member
+		TS_ASSERT_EQUALS(openArchive(set, "hidden.dat"), 3);
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT(!set.getMember("missing.dat"));
+		TS_ASSERT_EQUALS(listed->_lookups, 0);
+		TS_ASSERT_EQUALS(other->_lookups, 0);
+		TS_ASSERT_EQUALS(unlisted->_lookups, 3);
+
+		// The unlisted archive is searched before the listed one of lower
+		// priority, but after the one of higher priority
+		unlisted->_names.push_back("file.dat");
+		unlisted->_names.push_back("other.dat");
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 1);
+		TS_ASSERT_EQUALS(openArchive(set, "other.dat"), 3);
+	}
+
+	void test_removed_winner() {
+		Common::SearchSet set;
+
+		TestArchive *low = new TestArchive(1);
+		low->_names.push_back("file.dat");
+		set.add("low", low, 0);
+
+		TestArchive *high = new TestArchive(2);
+		high->_names.push_back("file.dat");
+		set.add("high", high, 10);
+
+		TS_ASSERT_EQUALS(set.getIndexSize(), 1u);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 2);
+
+		// The index has to name the remaining archive now, instead of
+		// falling back to searching all archives
+		set.remove("high");
+		set.resetStats();
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 1);
+		TS_ASSERT_EQUALS(set.getStats().indexHits, 1u);
+
+		set.setPriority("low", 20);
+		TestArchive *middle = new TestArchive(3);
+		middle->_names.push_back("file.dat");
+		set.add("middle", middle, 10);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 1);
+
+		set.setPriority("low", 0);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 3);
+		TS_ASSERT_EQUALS(set.getStats().fallbacks, 0u);
+	}
+
+	void test_incremental_index() {
+		Common::SearchSet set;
+
+		TestArchive *first = new TestArchive(1);
+		first->_names.push_back("file.dat");
+		set.add("first", first, 0);
+
+		// Archives are only listed by the first lookup after adding them
+		TS_ASSERT_EQUALS(first->_listings, 0);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 1);
+		TS_ASSERT_EQUALS(first->_listings, 1);
+
+		TestArchive *second = new TestArchive(2);
+		second->_names.push_back("file.dat");
+		second->_names.push_back("other.dat");
+		set.add("second", second, 10);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 2);
+		TS_ASSERT_EQUALS(set.getIndexSize(), 2u);
+		TS_ASSERT_EQUALS(first->_listings, 1);
+		TS_ASSERT_EQUALS(second->_listings, 1);
+
+		// Only the archive changing its priority is listed again
+		set.setPriority("second", -10);
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 1);
+		TS_ASSERT_EQUALS(first->_listings, 1);
+		TS_ASSERT_EQUALS(second->_listings, 3);
+
+		set.remove("first");
+		TS_ASSERT_EQUALS(openArchive(set, "file.dat"), 2);
+		TS_ASSERT_EQUALS(second->_listings, 3);
+
+		// An archive removed before any lookup is never listed
+		TestArchive *unused = new TestArchive(3);
+		set.add("unused", unused, 20, false);
+		set.remove("unused");
+		TS_ASSERT_EQUALS(unused->_listings, 0);
+		TS_ASSERT_EQUALS(set.getIndexSize(), 2u);
+		delete unused;
+		TS_ASSERT_EQUALS(set.getStats().fallbacks, 0u);
+	}
+};
@@ -0,0 +1,53 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/hash-str.h"
+#include "common/str-atom.h"
+
+class StringAtomTestSuite : public CxxTest::TestSuite {
+public:
+	void test_interning() {
+		Common::StringAtom a("music_volume");
+		Common::StringAtom b(Common::String("music_") + "volume");
+		Common::StringAtom c("sfx_volume");
+
+		TS_ASSERT(a == b);
+		TS_ASSERT(a != c);
+		TS_ASSERT_EQUALS(a.c_str(), b.c_str());
+		TS_ASSERT_EQUALS(a.toString(), "music_volume");
+		TS_ASSERT_EQUALS(a.size(), 12u);
+
+		TS_ASSERT_EQUALS(a.hash(), Common::hashit("music_volume"));
+		TS_ASSERT_EQUALS(Common::StringAtom("MUSIC_Volume").hashLowercase(), Common::hashit("music_volume"));
+		TS_ASSERT(Common::StringAtom("MUSIC_Volume") != a);
+
+		Common::StringAtom empty;
+		TS_ASSERT(empty.empty());
+		TS_ASSERT(empty == Common::StringAtom(""));
+	}
+
+	void test_atom_keys() {
+		Common::HashMap<Common::StringAtom, int> map;
+		map[Common::StringAtom("one")] = 1;
+		map[Common::StringAtom("two")] = 2;
+
+		TS_ASSERT_EQUALS(map[Common::StringAtom("one")], 1);
+		TS_ASSERT(map.contains(Common::StringAtom("two")));
+		TS_ASSERT(!map.contains(Common::StringAtom("three")));
+	}
+
+	void test_string_key_lookup() {
+		Common::StringMap map;
+		map["Music_Volume"] = "192";
+
+		Common::StringAtom atom("MUSIC_VOLUME");
+		TS_ASSERT(map.contains(atom));
+		TS_ASSERT(!map.contains(Common::StringAtom("speech_mute")));
+		map.find(atom)->_value = "255";
+		TS_ASSERT_EQUALS(map["music_volume"], "255");
+
+		Common::HashMap<Common::String, int, Common::CaseSensitiveString_Hash, Common::CaseSensitiveString_EqualTo> caseMap;
+		caseMap["Key"] = 1;
+		TS_ASSERT(caseMap.contains(Common::StringAtom("Key")));
+		TS_ASSERT(!caseMap.contains(Common::StringAtom("key")));
+	}
+};
@@ -0,0 +1,254 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/substream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+#include "test/stub_system.h"
+
+class ZipArchiveTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kFileSize = 100000
+	};
+
+	struct Member {
+		const char *name;
+		uint16 method;
+		uint32 offset;
+		uint32 compressedSize;
+		uint32 crc;
+	};
+
+	StubSystem *_system;
+
+	static byte contents(uint32 pos, byte seed) {
+		return (byte)(((pos * 7) ^ (pos >> 9)) + seed);
+	}
+
+	static uint32 crc32(const byte *data, uint32 size) {
+		uint32 crc = 0xFFFFFFFF;
+		for (uint32 i = 0; i < size; ++i) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+		return ~crc;
+	}
+
+	// Raw deflate data is what remains of gzip data without its
+	// 10 byte header and 8 byte trailer.
+	static byte *deflate(const byte *data, uint32 size, uint32 &compressedSize) {
+		Common::MemoryWriteStreamDynamic *out = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(out);
+		gzip->write(data, size);
+		gzip->finalize();
+
+		compressedSize = out->size() - 18;
+		byte *result = (byte *)malloc(compressedSize);
+		memcpy(result, out->getData() + 10, compressedSize);
+		free(out->getData());
+		delete gzip;
+		return result;
+	}
+
+	static void writeHeader(Common::WriteStream &out, const Member &member) {
+		out.writeUint16LE(0);	// flags
+		out.writeUint16LE(member.method);
+		out.writeUint32LE(0);	// time and date
+		out.writeUint32LE(member.crc);
+		out.writeUint32LE(member.compressedSize);
+		out.writeUint32LE(kFileSize);
+		out.writeUint16LE(strlen(member.name));
+		out.writeUint16LE(0);	// extra field
+	}
+
+	// Archives lying in memory have their members read in place, others
+	// are read through the archive's stream
+	static Common::Archive *makeArchive(Member *members, int count, bool inMemory = true) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+		byte *data = (byte *)malloc(kFileSize);
+
+		for (int i = 0; i < count; ++i) {
+			for (uint32 pos = 0; pos < kFileSize; ++pos)
+				data[pos] = contents(pos, i);
+
+			// Members asking for a CRC get a wrong one on purpose
+			members[i].crc = crc32(data, kFileSize) + members[i].crc;
+
+			byte *stored = data;
+			members[i].compressedSize = kFileSize;
+			if (members[i].method)
+				stored = deflate(data, kFileSize, members[i].compressedSize);
+
+			members[i].offset = out.pos();
+			out.writeUint32LE(0x04034b50);
+			out.writeUint16LE(20);
+			writeHeader(out, members[i]);
+			out.write(members[i].name, strlen(members[i].name));
+			out.write(stored, members[i].compressedSize);
+
+			if (stored != data)
+				free(stored);
+		}
+		free(data);
+
+		const uint32 centralDir = out.pos();
+		for (int i = 0; i < count; ++i) {
+			out.writeUint32LE(0x02014b50);
+			out.writeUint16LE(20);
+			out.writeUint16LE(20);
+			writeHeader(out, members[i]);
+			out.writeUint16LE(0);	// comment
+			out.writeUint16LE(0);	// disk
+			out.writeUint16LE(0);	// internal attributes
+			out.writeUint32LE(0);	// external attributes
+			out.writeUint32LE(members[i].offset);
+			out.write(members[i].name, strlen(members[i].name));
+		}
+
+		const uint32 centralDirSize = out.pos() - centralDir;
+		out.writeUint32LE(0x06054b50);
+		out.writeUint16LE(0);
+		out.writeUint16LE(0);
+		out.writeUint16LE(count);
+		out.writeUint16LE(count);
+		out.writeUint32LE(centralDirSize);
+		out.writeUint32LE(centralDir);
+		out.writeUint16LE(0);
+
+		Common::SeekableReadStream *stream = new Common::MemoryReadStream(out.getData(), out.size(), DisposeAfterUse::YES);
+		if (!inMemory)
+			stream = new Common::SeekableSubReadStream(stream, 0, stream->size(), DisposeAfterUse::YES);
+		return Common::makeZipArchive(stream);
+	}
+
+	static bool check(Common::SeekableReadStream *stream, uint32 pos, uint32 len, byte seed) {
+		byte buffer[4096];
+		assert(len <= sizeof(buffer));
+		if (stream->read(buffer, len) != len)
+			return false;
+		for (uint32 i = 0; i < len; ++i) {
+			if (buffer[i] != contents(pos + i, seed))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void setUp() {
+		_system = new StubSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = 0;
+		delete _system;
+	}
+
+	void checkConcurrentMembers(bool inMemory) {
+		Member members[] = {
+			{ "stored.dat", 0, 0, 0, 0 },
+#ifdef USE_ZLIB
+			{ "deflated.dat", 8, 0, 0, 0 },
+			{ "another.dat", 8, 0, 0, 0 }
+#endif
+		};
+		const int count = ARRAYSIZE(members);
+
+		Common::Archive *archive = makeArchive(members, count, inMemory);
+		TS_ASSERT(archive);
+
+		Common::SeekableReadStream *streams[count];
+		for (int i = 0; i < count; ++i) {
+			streams[i] = archive->createReadStreamForMember(members[i].name);
+			TS_ASSERT(streams[i]);
+			TS_ASSERT_EQUALS(streams[i]->size(), kFileSize);
+		}
+
+		// Interleave reads, so every stream has to keep its own state
+		for (uint32 pos = 0; pos < kFileSize; pos += 1000) {
+			for (int i = 0; i < count; ++i)
+				TS_ASSERT(check(streams[i], pos, 1000, i));
+		}
+
+		for (int i = 0; i < count; ++i) {
+			byte b;
+			TS_ASSERT(!streams[i]->eos());
+			TS_ASSERT_EQUALS(streams[i]->read(&b, 1), 0u);
+			TS_ASSERT(streams[i]->eos());
+			TS_ASSERT(!streams[i]->err());
+		}
+
+		// Member streams may outlive the archive
+		delete archive;
+
+		for (int i = 0; i < count; ++i) {
+			// Backward seek
+			TS_ASSERT(streams[i]->seek(1234));
+			TS_ASSERT_EQUALS(streams[i]->pos(), 1234);
+			TS_ASSERT(check(streams[i], 1234, 100, i));
+
+			// Forward seek
+			TS_ASSERT(streams[i]->seek(50000, SEEK_CUR));
+			TS_ASSERT_EQUALS(streams[i]->pos(), 51334);
+			TS_ASSERT(check(streams[i], 51334, 4000, i));
+
+			delete streams[i];
+		}
+	}
+
+	void test_concurrent_members() {
+		checkConcurrentMembers(false);
+	}
+
+	void test_concurrent_members_in_memory() {
+		checkConcurrentMembers(true);
+	}
+
+	void test_missing_member() {
+		Member members[] = {
+			{ "stored.dat", 0, 0, 0, 0 }
+		};
+
+		Common::Archive *archive = makeArchive(members, 1);
+		TS_ASSERT(archive);
+		TS_ASSERT(archive->hasFile("STORED.DAT"));
+		TS_ASSERT(!archive->createReadStreamForMember("missing.dat"));
+		delete archive;
+	}
+
+#ifdef USE_ZLIB
+	void test_crc_mismatch() {
+		Member members[] = {
+			{ "stored.dat", 0, 0, 0, 1 },
+			{ "deflated.dat", 8, 0, 0, 1 }
+		};
+
+		Common::Archive *archive = makeArchive(members, 2);
+		TS_ASSERT(archive);
+
+		for (int i = 0; i < 2; ++i) {
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(members[i].name);
+			TS_ASSERT(stream);
+
+			// Skipping ahead leaves the rest of the data unchecked
+			TS_ASSERT(check(stream, 0, 1000, i));
+			TS_ASSERT(stream->seek(kFileSize - 1000));
+			TS_ASSERT(check(stream, kFileSize - 1000, 1000, i));
+			TS_ASSERT(!stream->err());
+
+			TS_ASSERT(stream->seek(1000));
+			for (uint32 pos = 1000; pos < kFileSize; pos += 1000)
+				TS_ASSERT(check(stream, pos, 1000, i));
+			TS_ASSERT(stream->err());
+
+			delete stream;
+		}
+
+		delete archive;
+	}
+#endif
+};
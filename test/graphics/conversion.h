@@ -0,0 +1,134 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/endian.h"
+#include "graphics/conversion.h"
+#include "graphics/pixelformat.h"
+
+class ConversionTestSuite : public CxxTest::TestSuite {
+private:
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	static uint32 readColor(const byte *src, const Graphics::PixelFormat &format) {
+		if (format.bytesPerPixel == 2)
+			return READ_UINT16(src);
+		if (format.bytesPerPixel == 3)
+			return READ_UINT24(src);
+		return READ_UINT32(src);
+	}
+
+	// The conversion crossBlit() does, one pixel at a time
+	static uint32 expectedColor(const byte *src, const Graphics::PixelFormat &srcFmt, const Graphics::PixelFormat &dstFmt) {
+		byte a, r, g, b;
+		srcFmt.colorToARGB(readColor(src, srcFmt), a, r, g, b);
+		return dstFmt.ARGBToColor(a, r, g, b);
+	}
+
+	static Graphics::PixelFormat getFormat(int index) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12),
+			Graphics::PixelFormat(2, 3, 3, 2, 0, 5, 2, 0, 0),
+			Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(3, 8, 8, 8, 0, 0, 8, 16, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 7, 7, 7, 1, 17, 10, 3, 31)
+		};
+		return formats[index];
+	}
+
+	static const int kNumFormats = 11;
+
+public:
+	void test_format_pairs() {
+		static const int widths[] = { 1, 4, 7, 21 };
+		const int h = 3;
+		_seed = 1;
+
+		for (int i = 0; i < kNumFormats; ++i) {
+			const Graphics::PixelFormat srcFmt = getFormat(i);
+			for (int j = 0; j < kNumFormats; ++j) {
+				// Equal formats are copied as they are, unused bits included
+				const Graphics::PixelFormat dstFmt = getFormat(j);
+				if (i == j || dstFmt.bytesPerPixel == 3)
+					continue;
+
+				for (int k = 0; k < ARRAYSIZE(widths); ++k) {
+					const int w = widths[k];
+					const int srcPitch = w * srcFmt.bytesPerPixel + 3;
+					const int dstPitch = w * dstFmt.bytesPerPixel + 5;
+					byte *src = new byte[srcPitch * h];
+					byte *dst = new byte[dstPitch * h];
+					for (int n = 0; n < srcPitch * h; ++n)
+						src[n] = nextRandom();
+
+					TS_ASSERT(Graphics::crossBlit(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt));
+
+					for (int y = 0; y < h; ++y) {
+						for (int x = 0; x < w; ++x) {
+							const byte *srcPixel = src + y * srcPitch + x * srcFmt.bytesPerPixel;
+							const byte *dstPixel = dst + y * dstPitch + x * dstFmt.bytesPerPixel;
+							TS_ASSERT_EQUALS(readColor(dstPixel, dstFmt), expectedColor(srcPixel, srcFmt, dstFmt));
+						}
+					}
+
+					delete[] src;
+					delete[] dst;
+				}
+			}
+		}
+	}
+
+	void test_in_place() {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const Graphics::PixelFormat dstFmt(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		const Graphics::PixelFormat smallFmt(2, 5, 5, 5, 0, 10, 5, 0, 0);
+		const int w = 19;
+		const int h = 4;
+		_seed = 2;
+
+		for (int i = 0; i < ARRAYSIZE(formats); ++i) {
+			// Expanding to the larger destination, in a buffer large enough
+			// for it
+			const Graphics::PixelFormat &srcFmt = formats[i];
+			const int srcPitch = w * srcFmt.bytesPerPixel;
+			const int dstPitch = w * dstFmt.bytesPerPixel;
+			byte *buffer = new byte[dstPitch * h];
+			byte *src = new byte[srcPitch * h];
+			for (int n = 0; n < srcPitch * h; ++n)
+				src[n] = nextRandom();
+			memcpy(buffer, src, srcPitch * h);
+
+			TS_ASSERT(Graphics::crossBlit(buffer, buffer, dstPitch, srcPitch, w, h, dstFmt, srcFmt));
+			for (int y = 0; y < h; ++y) {
+				for (int x = 0; x < w; ++x)
+					TS_ASSERT_EQUALS(READ_UINT32(buffer + y * dstPitch + x * 4), expectedColor(src + y * srcPitch + x * srcFmt.bytesPerPixel, srcFmt, dstFmt));
+			}
+
+			// And shrinking it again
+			byte *copy = new byte[dstPitch * h];
+			memcpy(copy, buffer, dstPitch * h);
+			TS_ASSERT(Graphics::crossBlit(buffer, buffer, w * 2, dstPitch, w, h, smallFmt, dstFmt));
+			for (int y = 0; y < h; ++y) {
+				for (int x = 0; x < w; ++x)
+					TS_ASSERT_EQUALS(READ_UINT16(buffer + y * w * 2 + x * 2), expectedColor(copy + y * dstPitch + x * 4, dstFmt, smallFmt));
+			}
+
+			delete[] buffer;
+			delete[] src;
+			delete[] copy;
+		}
+	}
+};
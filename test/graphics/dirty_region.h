@@ -0,0 +1,79 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirty_region.h"
+
+class DirtyRegionTestSuite : public CxxTest::TestSuite {
+public:
+	void test_coalescing() {
+		Graphics::DirtyRegion region(8, 10);
+		Common::Array<Common::Rect> rects;
+
+		TS_ASSERT(region.isEmpty());
+		region.getRects(rects, 10);
+		TS_ASSERT(rects.empty());
+
+		// Two overlapping rects, covering the same tile columns
+		region.addRect(Common::Rect(3, 2, 20, 15));
+		region.addRect(Common::Rect(1, 12, 22, 35));
+		// One to the right, not touching them
+		region.addRect(Common::Rect(50, 0, 52, 3));
+		TS_ASSERT(!region.isEmpty());
+		TS_ASSERT_EQUALS(region.getArea(), 17u * 13 + 21u * 23 + 2u * 3);
+
+		region.getRects(rects, 10);
+		TS_ASSERT_EQUALS(rects.size(), 2u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(0, 0, 24, 35));
+		TS_ASSERT_EQUALS(rects[1], Common::Rect(48, 0, 52, 10));
+
+		// With too many rects, the tiles grow
+		region.getRects(rects, 1);
+		TS_ASSERT_EQUALS(rects.size(), 1u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(0, 0, 52, 35));
+
+		region.clear();
+		TS_ASSERT(region.isEmpty());
+		region.getRects(rects, 10);
+		TS_ASSERT(rects.empty());
+	}
+
+	void test_coverage() {
+		enum {
+			kWidth = 320,
+			kHeight = 200
+		};
+
+		Graphics::DirtyRegion region(16, 10);
+		byte dirty[kWidth * kHeight];
+		memset(dirty, 0, sizeof(dirty));
+
+		uint32 seed = 1;
+		for (int i = 0; i < 2000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const int x = (seed >> 8) % kWidth;
+			const int y = (seed >> 16) % kHeight;
+			const int w = MIN<int>(1 + (seed >> 4) % 24, kWidth - x);
+			const int h = MIN<int>(1 + (seed >> 24) % 24, kHeight - y);
+
+			region.addRect(Common::Rect(x, y, x + w, y + h));
+			for (int j = y; j < y + h; ++j)
+				memset(dirty + j * kWidth + x, 1, w);
+		}
+
+		Common::Array<Common::Rect> rects;
+		region.getRects(rects, 50);
+		TS_ASSERT_LESS_THAN_EQUALS(rects.size(), 50u);
+
+		for (uint i = 0; i < rects.size(); ++i) {
+			TS_ASSERT(rects[i].left >= 0 && rects[i].right <= kWidth);
+			TS_ASSERT(rects[i].top >= 0 && rects[i].bottom <= kHeight);
+			TS_ASSERT_EQUALS(rects[i].top % 10, 0);
+			for (int y = rects[i].top; y < rects[i].bottom; ++y)
+				memset(dirty + y * kWidth + rects[i].left, 0, rects[i].width());
+		}
+
+		bool covered = true;
+		for (int i = 0; i < kWidth * kHeight; ++i)
+			covered &= !dirty[i];
+		TS_ASSERT(covered);
+	}
+};
@@ -0,0 +1,94 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/fonts/glyph_atlas.h"
+
+class GlyphAtlasTestSuite : public CxxTest::TestSuite {
+private:
+	typedef Graphics::GlyphAtlas::Location Location;
+
+	static bool overlap(const Location &a, const Location &b) {
+		return a.page == b.page && a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+	}
+
+	static void fill(Graphics::GlyphAtlas &atlas, const Location &loc, byte value) {
+		byte *pixels = atlas.getPixels(loc);
+		for (int y = 0; y < loc.h; ++y)
+			memset(pixels + y * atlas.getPitch(loc), value, loc.w);
+	}
+
+	static bool check(Graphics::GlyphAtlas &atlas, const Location &loc, byte value) {
+		const byte *pixels = atlas.getPixels(loc);
+		for (int y = 0; y < loc.h; ++y) {
+			for (int x = 0; x < loc.w; ++x) {
+				if (pixels[y * atlas.getPitch(loc) + x] != value)
+					return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	void test_packing() {
+		Graphics::GlyphAtlas atlas(64, 64 * 64);
+		Location locs[40];
+
+		for (int i = 0; i < ARRAYSIZE(locs); ++i) {
+			locs[i] = atlas.allocate(3 + i % 7, 4 + i % 5);
+			TS_ASSERT(atlas.isValid(locs[i]));
+			TS_ASSERT_EQUALS(locs[i].page, 0);
+			TS_ASSERT(check(atlas, locs[i], 0));
+			fill(atlas, locs[i], i + 1);
+		}
+		TS_ASSERT_EQUALS(atlas.getMemoryUsage(), 64u * 64u);
+
+		for (int i = 0; i < ARRAYSIZE(locs); ++i) {
+			TS_ASSERT(locs[i].x + locs[i].w <= 64 && locs[i].y + locs[i].h <= 64);
+			TS_ASSERT(check(atlas, locs[i], i + 1));
+			for (int j = 0; j < i; ++j)
+				TS_ASSERT(!overlap(locs[i], locs[j]));
+		}
+	}
+
+	void test_eviction() {
+		// Room for two pages of 16x16 bitmaps
+		Graphics::GlyphAtlas atlas(16, 2 * 16 * 16);
+
+		const Location first = atlas.allocate(16, 16);
+		const Location second = atlas.allocate(16, 16);
+		TS_ASSERT_DIFFERS(first.page, second.page);
+		fill(atlas, first, 1);
+		fill(atlas, second, 2);
+
+		// The second page was used last, until now
+		atlas.getPixels(first);
+
+		const Location third = atlas.allocate(10, 10);
+		TS_ASSERT_EQUALS(atlas.getStats().evictions, 1u);
+		TS_ASSERT_EQUALS(atlas.getMemoryUsage(), 2u * 16u * 16u);
+		TS_ASSERT(atlas.isValid(first));
+		TS_ASSERT(!atlas.isValid(second));
+		TS_ASSERT(atlas.isValid(third));
+		TS_ASSERT(check(atlas, first, 1));
+		TS_ASSERT(check(atlas, third, 0));
+	}
+
+	void test_large_bitmap() {
+		Graphics::GlyphAtlas atlas(16, 2 * 16 * 16);
+
+		const Location small = atlas.allocate(8, 8);
+		const Location large = atlas.allocate(40, 10);
+		TS_ASSERT(atlas.isValid(large));
+		TS_ASSERT_EQUALS(large.w, 40);
+		TS_ASSERT_EQUALS(atlas.getPitch(large), 40);
+		TS_ASSERT(check(atlas, large, 0));
+
+		// The budget only allows the page of its own
+		TS_ASSERT(!atlas.isValid(small));
+		TS_ASSERT_EQUALS(atlas.getMemoryUsage(), 40u * 16u);
+
+		atlas.clear();
+		TS_ASSERT(!atlas.isValid(large));
+		TS_ASSERT_EQUALS(atlas.getMemoryUsage(), 0u);
+		TS_ASSERT(atlas.isValid(atlas.allocate(4, 4)));
+	}
+};
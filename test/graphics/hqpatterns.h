@@ -0,0 +1,78 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/intern.h"
+
+#ifdef USE_HQ_SCALERS
+
+extern "C" uint32 *RGBtoYUV;
+
+class HQPatternsTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kWidth = 203,
+		kHeight = 20,
+		kPitch = kWidth + 2
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	// The pattern computation the hq scalers used to do for each pixel
+	static int referencePattern(const uint16 *p, int pitch) {
+		static const int offsets[8][2] = {
+			{ -1, -1 }, { 0, -1 }, { 1, -1 },
+			{ -1,  0 },            { 1,  0 },
+			{ -1,  1 }, { 0,  1 }, { 1,  1 }
+		};
+
+		int pattern = 0;
+		for (int i = 0; i < 8; ++i) {
+			const uint16 w = p[offsets[i][0] + offsets[i][1] * pitch];
+			if (*p != w && diffYUV(RGBtoYUV[*p], RGBtoYUV[w]))
+				pattern |= 1 << i;
+		}
+		return pattern;
+	}
+
+	void checkFormat(uint32 bitFormat) {
+		InitScalers(bitFormat);
+
+		uint16 image[(kHeight + 2) * kPitch];
+		_seed = bitFormat;
+		for (int i = 0; i < ARRAYSIZE(image); ++i) {
+			// Mix random colors with slight variations of a few colors,
+			// to get close to every threshold of diffYUV()
+			const uint32 r = nextRandom();
+			if (r & 1)
+				image[i] = nextRandom();
+			else
+				image[i] = ((r >> 1) & 3) * 0x2104 + ((r >> 3) & 0x0C63);
+		}
+
+		const uint16 *src = image + kPitch + 1;
+		HQPatterns patterns(src, kPitch, kWidth);
+		for (int y = 0; y < kHeight; ++y) {
+			const uint8 *row = patterns.nextRow();
+			for (int x = 0; x < kWidth; ++x)
+				TS_ASSERT_EQUALS(row[x], referencePattern(src + y * kPitch + x, kPitch));
+		}
+
+		DestroyScalers();
+	}
+
+public:
+	void test_patterns_565() {
+		checkFormat(565);
+	}
+
+	void test_patterns_555() {
+		checkFormat(555);
+	}
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transform_cache.h"
+
+class TransformCacheTestSuite : public CxxTest::TestSuite {
+private:
+	static void fill(Graphics::Surface &surface, int w, int h, uint32 seed) {
+		surface.create(w, h, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				seed = seed * 1103515245 + 12345;
+				*(uint32 *)surface.getBasePtr(x, y) = seed;
+			}
+		}
+	}
+
+	static bool equals(const Graphics::Surface *a, Graphics::Surface *b) {
+		bool result = a->w == b->w && a->h == b->h;
+		for (int y = 0; result && y < a->h; ++y)
+			result = !memcmp(a->getBasePtr(0, y), b->getBasePtr(0, y), a->w * 4);
+
+		b->free();
+		delete b;
+		return result;
+	}
+
+public:
+	void test_hits() {
+		Graphics::TransformCache &cache = TransformCacheMan;
+		cache.clear();
+		cache.resetStats();
+
+		Graphics::TransparentSurface src;
+		fill(src, 16, 12, 1);
+
+		const Graphics::TransparentSurface *scaled = cache.scale(src, 0, 40, 30, Graphics::FILTER_BILINEAR);
+		TS_ASSERT(equals(scaled, src.scaleT<Graphics::FILTER_BILINEAR>(40, 30)));
+		TS_ASSERT_EQUALS(cache.scale(src, 0, 40, 30, Graphics::FILTER_BILINEAR), scaled);
+		// A wrapper around the same pixels finds the same entry
+		Graphics::TransparentSurface wrapper(src, false);
+		TS_ASSERT_EQUALS(cache.scale(wrapper, 0, 40, 30, Graphics::FILTER_BILINEAR), scaled);
+		TS_ASSERT_EQUALS(cache.getStats().hits, 2u);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 1u);
+
+		// Other filters, sizes and generations are different entries
+		cache.scale(src, 0, 40, 30, Graphics::FILTER_NEAREST);
+		cache.scale(src, 0, 40, 31, Graphics::FILTER_BILINEAR);
+		cache.scale(src, 1, 40, 30, Graphics::FILTER_BILINEAR);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 4u);
+		TS_ASSERT_EQUALS(cache.getSize(), 4u);
+
+		Graphics::TransformStruct transform(150, 80, 30, 3, 4);
+		const Graphics::TransparentSurface *rotated = cache.rotoscale(src, 0, transform);
+		TS_ASSERT(equals(rotated, src.rotoscaleT<Graphics::FILTER_BILINEAR>(transform)));
+		TS_ASSERT_EQUALS(cache.rotoscale(src, 0, transform), rotated);
+		// Only the angle, zoom and hotspot matter
+		transform._rgbaMod = 0x80FFFFFF;
+		TS_ASSERT_EQUALS(cache.rotoscale(src, 0, transform), rotated);
+		transform._hotspot.x++;
+		TS_ASSERT_DIFFERS(cache.rotoscale(src, 0, transform), rotated);
+		TS_ASSERT_EQUALS(cache.getStats().hits, 4u);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 6u);
+
+		cache.invalidate(src);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+		TS_ASSERT_EQUALS(cache.getStats().evictions, 0u);
+		src.free();
+	}
+
+	void test_sub_area() {
+		Graphics::TransformCache &cache = TransformCacheMan;
+		cache.clear();
+
+		Graphics::TransparentSurface src;
+		fill(src, 20, 20, 2);
+		const Common::Rect area(3, 5, 13, 12);
+		Graphics::TransparentSurface part(src.getSubArea(area), false);
+		Graphics::TransparentSurface copy(part, true);
+
+		TS_ASSERT(equals(cache.scale(part, 0, 25, 9, Graphics::FILTER_BILINEAR), copy.scaleT<Graphics::FILTER_BILINEAR>(25, 9)));
+		TS_ASSERT(equals(cache.scale(part, 0, 25, 9, Graphics::FILTER_NEAREST), copy.scaleT<Graphics::FILTER_NEAREST>(25, 9)));
+
+		// Invalidating the whole surface drops its parts
+		cache.scale(copy, 0, 25, 9);
+		TS_ASSERT_EQUALS(cache.getSize(), 3u);
+		cache.invalidate(src);
+		TS_ASSERT_EQUALS(cache.getSize(), 1u);
+
+		cache.clear();
+		copy.free();
+		src.free();
+	}
+
+	void test_budget() {
+		Graphics::TransformCache &cache = TransformCacheMan;
+		cache.clear();
+		cache.resetStats();
+
+		Graphics::TransparentSurface src;
+		fill(src, 8, 8, 3);
+
+		// Room for two 16x16 surfaces
+		cache.setBudget(2 * 16 * 16 * 4 + 100);
+		cache.scale(src, 0, 16, 16);
+		cache.scale(src, 1, 16, 16);
+		// Use the first one, so the second one gets dropped for a third one
+		cache.scale(src, 0, 16, 16);
+		cache.scale(src, 2, 16, 16);
+		TS_ASSERT_EQUALS(cache.getSize(), 2u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 2u * 16 * 16 * 4);
+		TS_ASSERT_EQUALS(cache.getStats().evictions, 1u);
+
+		cache.scale(src, 0, 16, 16);
+		cache.scale(src, 2, 16, 16);
+		TS_ASSERT_EQUALS(cache.getStats().hits, 3u);
+		cache.scale(src, 1, 16, 16);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 4u);
+
+		// A surface bigger than the whole budget is still kept, on its own
+		const Graphics::TransparentSurface *big = cache.scale(src, 0, 64, 64);
+		TS_ASSERT_EQUALS(cache.getSize(), 1u);
+		TS_ASSERT_EQUALS(cache.scale(src, 0, 64, 64), big);
+
+		cache.setBudget(0);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+
+		cache.setBudget(Graphics::TransformCache::kDefaultBudget);
+		cache.resetStats();
+		src.free();
+	}
+};
@@ -0,0 +1,133 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transparent_surface.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite {
+private:
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	// Mostly fully transparent or opaque pixels, like real sprites
+	uint32 randomPixel() {
+		uint32 pixel = (nextRandom() << 16) ^ nextRandom();
+		switch (nextRandom() % 4) {
+		case 0:
+			return pixel & 0xFFFFFF00;
+		case 1:
+			return pixel | 0xFF;
+		default:
+			return pixel;
+		}
+	}
+
+	// Pixels are 0xRRGGBBAA in native endianness
+	static uint32 channel(uint32 pixel, int shift) {
+		return (pixel >> shift) & 0xFF;
+	}
+
+	static uint32 expectedPixel(uint32 src, uint32 dst, Graphics::AlphaType alphaMode, uint32 color) {
+		const uint32 a = channel(src, 0);
+
+		if (color == 0xFFFFFFFF && alphaMode == Graphics::ALPHA_OPAQUE)
+			return src | 0xFF;
+		if (color == 0xFFFFFFFF && alphaMode == Graphics::ALPHA_BINARY)
+			return a ? (src | 0xFF) : dst;
+
+		uint32 result = 0xFF;
+		if (color == 0xFFFFFFFF) {
+			if (!a)
+				return dst;
+			for (int shift = 8; shift < 32; shift += 8)
+				result |= ((channel(src, shift) * a + channel(dst, shift) * (255 - a)) >> 8) << shift;
+		} else {
+			const uint32 ina = a * (color >> 24) >> 8;
+			for (int shift = 8; shift < 32; shift += 8) {
+				// The color mod is 0xAARRGGBB
+				const uint32 mod = channel(color, shift - 8);
+				const uint32 value = (channel(dst, shift) * (255 - ina) >> 8) + (channel(src, shift) * ina * mod >> 16);
+				result |= (value & 0xFF) << shift;
+			}
+		}
+		return result;
+	}
+
+	void checkBlit(Graphics::AlphaType alphaMode, uint32 color, int flipping) {
+		static const int widths[] = { 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33, 64 };
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+		for (int i = 0; i < ARRAYSIZE(widths); ++i) {
+			const int w = widths[i];
+			const int h = 3;
+
+			Graphics::TransparentSurface sprite;
+			sprite.create(w, h, format);
+			sprite.setAlphaMode(alphaMode);
+			Graphics::Surface target;
+			target.create(w + 3, h + 2, format);
+			Graphics::Surface expected;
+			expected.create(w + 3, h + 2, format);
+
+			for (int y = 0; y < h; ++y)
+				for (int x = 0; x < w; ++x)
+					*(uint32 *)sprite.getBasePtr(x, y) = randomPixel();
+			for (int y = 0; y < target.h; ++y) {
+				for (int x = 0; x < target.w; ++x) {
+					const uint32 pixel = randomPixel();
+					*(uint32 *)target.getBasePtr(x, y) = pixel;
+					*(uint32 *)expected.getBasePtr(x, y) = pixel;
+				}
+			}
+
+			for (int y = 0; y < h; ++y) {
+				for (int x = 0; x < w; ++x) {
+					const int srcX = (flipping & Graphics::FLIP_H) ? w - 1 - x : x;
+					const int srcY = (flipping & Graphics::FLIP_V) ? h - 1 - y : y;
+					uint32 *dst = (uint32 *)expected.getBasePtr(x + 1, y + 1);
+					*dst = expectedPixel(*(const uint32 *)sprite.getBasePtr(srcX, srcY), *dst, alphaMode, color);
+				}
+			}
+
+			sprite.blit(target, 1, 1, flipping, nullptr, color);
+			for (int y = 0; y < target.h; ++y)
+				TS_ASSERT_EQUALS(memcmp(target.getBasePtr(0, y), expected.getBasePtr(0, y), target.w * 4), 0);
+
+			sprite.free();
+			target.free();
+			expected.free();
+		}
+	}
+
+public:
+	void test_opaque() {
+		_seed = 1;
+		// Opaque blits do not support horizontal flipping
+		checkBlit(Graphics::ALPHA_OPAQUE, 0xFFFFFFFF, Graphics::FLIP_NONE);
+		checkBlit(Graphics::ALPHA_OPAQUE, 0xFFFFFFFF, Graphics::FLIP_V);
+	}
+
+	void test_binary() {
+		_seed = 2;
+		checkBlit(Graphics::ALPHA_BINARY, 0xFFFFFFFF, Graphics::FLIP_NONE);
+		checkBlit(Graphics::ALPHA_BINARY, 0xFFFFFFFF, Graphics::FLIP_HV);
+	}
+
+	void test_alpha_blend() {
+		_seed = 3;
+		checkBlit(Graphics::ALPHA_FULL, 0xFFFFFFFF, Graphics::FLIP_NONE);
+		checkBlit(Graphics::ALPHA_FULL, 0xFFFFFFFF, Graphics::FLIP_H);
+		checkBlit(Graphics::ALPHA_FULL, 0xFFFFFFFF, Graphics::FLIP_V);
+	}
+
+	void test_color_mod() {
+		_seed = 4;
+		checkBlit(Graphics::ALPHA_FULL, 0x80FF4020, Graphics::FLIP_NONE);
+		checkBlit(Graphics::ALPHA_FULL, 0xFF00FFFF, Graphics::FLIP_NONE);
+		checkBlit(Graphics::ALPHA_FULL, 0xC0102030, Graphics::FLIP_H);
+		// Color modulation also applies to binary sprites
+		checkBlit(Graphics::ALPHA_BINARY, 0xFFC0C0C0, Graphics::FLIP_NONE);
+	}
+};
@@ -0,0 +1,130 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/VectorRendererSpec.h"
+#include "graphics/transparent_surface.h"
+
+template<typename PixelType>
+class TestRenderer : public Graphics::VectorRendererSpec<PixelType> {
+public:
+	TestRenderer(const Graphics::PixelFormat &format) : Graphics::VectorRendererSpec<PixelType>(format) {}
+
+	void blend(PixelType *first, PixelType *last, PixelType color, uint8 alpha) {
+		this->blendFill(first, last, color, alpha);
+	}
+};
+
+class VectorRendererTestSuite : public CxxTest::TestSuite {
+private:
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	// What blendPixelPtr() does to every channel. The alpha channel is
+	// blended towards opaque, or towards 255 in 32 bit formats.
+	static uint32 expectedBlend(uint32 dst, uint32 src, uint8 alpha, const Graphics::PixelFormat &format) {
+		const uint32 alphaMask = (0xFF >> format.aLoss) << format.aShift;
+		if (alpha == 0xFF)
+			return src | alphaMask;
+
+		const int shifts[4] = { format.rShift, format.gShift, format.bShift, format.aShift };
+		const int losses[4] = { format.rLoss, format.gLoss, format.bLoss, format.aLoss };
+		uint32 result = 0;
+		for (int i = 0; i < 4; ++i) {
+			if (losses[i] == 8)
+				continue;
+
+			const int mask = 0xFF >> losses[i];
+			const int d = (dst >> shifts[i]) & mask;
+			const int s = (i == 3) ? (format.bytesPerPixel == 4 ? 0xFF : mask) : (src >> shifts[i]) & mask;
+			result |= (uint32)((d + (((s - d) * alpha) >> 8)) & mask) << shifts[i];
+		}
+		return result;
+	}
+
+	template<typename PixelType>
+	void checkBlend(const Graphics::PixelFormat &format) {
+		static const uint8 alphas[] = { 0, 1, 4, 100, 128, 254, 255 };
+		TestRenderer<PixelType> renderer(format);
+		PixelType row[64], original[64];
+
+		for (int i = 0; i < ARRAYSIZE(alphas); ++i) {
+			for (int start = 0; start < 3; ++start) {
+				for (int width = 0; width < 40; ++width) {
+					const PixelType color = nextRandom();
+					for (int x = 0; x < ARRAYSIZE(row); ++x)
+						row[x] = original[x] = nextRandom();
+
+					renderer.blend(row + start, row + start + width, color, alphas[i]);
+
+					for (int x = 0; x < ARRAYSIZE(row); ++x) {
+						const bool inside = x >= start && x < start + width;
+						const PixelType expected = inside ? (PixelType)expectedBlend(original[x], color, alphas[i], format) : original[x];
+						TS_ASSERT_EQUALS(row[x], expected);
+					}
+				}
+			}
+		}
+	}
+
+public:
+	void test_blend_fill() {
+		_seed = 1;
+		checkBlend<uint16>(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		checkBlend<uint16>(Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
+		checkBlend<uint16>(Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12));
+		checkBlend<uint32>(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+		checkBlend<uint32>(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		checkBlend<uint32>(Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0));
+		checkBlend<uint32>(Graphics::PixelFormat(4, 7, 7, 7, 1, 17, 10, 3, 31));
+	}
+
+	void test_fill_bounds() {
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		TestRenderer<uint16> renderer(format);
+		Graphics::TransparentSurface surface;
+		surface.create(48, 8, format);
+		renderer.setSurface(&surface);
+
+		for (int x = 0; x < 4; ++x) {
+			for (int w = 1; w < 40; ++w) {
+				memset(surface.getPixels(), 0, surface.pitch * surface.h);
+				renderer.setFgColor(255, 255, 255);
+				renderer.setFillMode(Graphics::VectorRenderer::kFillForeground);
+				renderer.drawSquare(x, 2, w, 3);
+
+				for (int py = 0; py < surface.h; ++py) {
+					for (int px = 0; px < surface.w; ++px) {
+						const bool inside = px >= x && px < x + w && py >= 2 && py < 5;
+						TS_ASSERT_EQUALS(*(const uint16 *)surface.getBasePtr(px, py), inside ? 0xFFFF : 0);
+					}
+				}
+			}
+		}
+
+		surface.free();
+	}
+
+	void test_gradient_dithering() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		TestRenderer<uint32> renderer(format);
+		Graphics::TransparentSurface surface;
+		surface.create(37, 64, format);
+		renderer.setSurface(&surface);
+		renderer.setGradientColors(0, 0, 0, 40, 80, 120);
+		renderer.setGradientFactor(1);
+		renderer.setFillMode(Graphics::VectorRenderer::kFillGradient);
+		renderer.fillSurface();
+
+		// Dithered rows alternate between two colors, one pixel at a time
+		for (int y = 0; y < surface.h; ++y) {
+			const uint32 *row = (const uint32 *)surface.getBasePtr(0, y);
+			for (int x = 2; x < surface.w; ++x)
+				TS_ASSERT_EQUALS(row[x], row[x - 2]);
+		}
+
+		surface.free();
+	}
+};
@@ -0,0 +1,130 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+private:
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	void fill(byte *buffer, int size) {
+		for (int i = 0; i < size; ++i)
+			buffer[i] = nextRandom();
+	}
+
+	static int clip(int value, Graphics::YUVToRGBManager::LuminanceScale scale) {
+		if (scale == Graphics::YUVToRGBManager::kScaleFull)
+			return CLIP(value, 0, 255);
+		return (CLIP(value, 16, 235) - 16) * 255 / 219;
+	}
+
+	// The conversion the lookup tables are built from
+	static uint32 expectedPixel(const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, byte y, byte u, byte v) {
+		const int cr = v - 128;
+		const int cb = u - 128;
+		const int r = y + (int16)((0.419 / 0.299) * cr);
+		const int g = y + (int16)(-(0.299 / 0.419) * cr) + (int16)(-(0.114 / 0.331) * cb);
+		const int b = y + (int16)((0.587 / 0.331) * cb);
+		return format.RGBToColor(clip(r, scale), clip(g, scale), clip(b, scale));
+	}
+
+	static uint32 getPixel(const Graphics::Surface &surface, int x, int y) {
+		if (surface.format.bytesPerPixel == 2)
+			return *(const uint16 *)surface.getBasePtr(x, y);
+		return *(const uint32 *)surface.getBasePtr(x, y);
+	}
+
+	// shift is the log2 of the chroma subsampling, 0 for 444, 1 for 420 and
+	// 2 for 410
+	void checkConversion(int shift) {
+		static const int sizes[] = { 4, 12, 20, 68, 132, 276 };
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+		static const Graphics::YUVToRGBManager::LuminanceScale scales[] = {
+			Graphics::YUVToRGBManager::kScaleFull,
+			Graphics::YUVToRGBManager::kScaleITU
+		};
+
+		for (int i = 0; i < ARRAYSIZE(sizes); ++i) {
+			const int w = sizes[i];
+			const int h = 8;
+			const int yPitch = w + 5;
+			// 410 reads one more row and column of chroma
+			const int uvPitch = (w >> shift) + 3;
+			const int uvHeight = (h >> shift) + 1;
+
+			byte *ySrc = new byte[yPitch * h];
+			byte *uSrc = new byte[uvPitch * uvHeight];
+			byte *vSrc = new byte[uvPitch * uvHeight];
+			fill(ySrc, yPitch * h);
+			fill(uSrc, uvPitch * uvHeight);
+			fill(vSrc, uvPitch * uvHeight);
+
+			for (int j = 0; j < ARRAYSIZE(formats); ++j) {
+				for (int k = 0; k < ARRAYSIZE(scales); ++k) {
+					Graphics::Surface dst;
+					dst.create(w + 2, h, formats[j]);
+
+					if (shift == 0)
+						YUVToRGBMan.convert444(&dst, scales[k], ySrc, uSrc, vSrc, w, h, yPitch, uvPitch);
+					else if (shift == 1)
+						YUVToRGBMan.convert420(&dst, scales[k], ySrc, uSrc, vSrc, w, h, yPitch, uvPitch);
+					else
+						YUVToRGBMan.convert410(&dst, scales[k], ySrc, uSrc, vSrc, w, h, yPitch, uvPitch);
+
+					int errors = 0;
+					for (int y = 0; y < h; ++y) {
+						for (int x = 0; x < w; ++x) {
+							byte u, v;
+							const int index = (y >> shift) * uvPitch + (x >> shift);
+							if (shift == 2) {
+								// Bilinear interpolation between the chroma samples
+								const int xDiff = x & 3, yDiff = y & 3;
+								u = (uSrc[index] * (4 - xDiff) * (4 - yDiff) + uSrc[index + 1] * xDiff * (4 - yDiff) +
+								     uSrc[index + uvPitch] * yDiff * (4 - xDiff) + uSrc[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+								v = (vSrc[index] * (4 - xDiff) * (4 - yDiff) + vSrc[index + 1] * xDiff * (4 - yDiff) +
+								     vSrc[index + uvPitch] * yDiff * (4 - xDiff) + vSrc[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+							} else {
+								u = uSrc[index];
+								v = vSrc[index];
+							}
+
+							if (getPixel(dst, x, y) != expectedPixel(formats[j], scales[k], ySrc[y * yPitch + x], u, v))
+								errors++;
+						}
+					}
+					TS_ASSERT_EQUALS(errors, 0);
+					dst.free();
+				}
+			}
+
+			delete[] ySrc;
+			delete[] uSrc;
+			delete[] vSrc;
+		}
+	}
+
+public:
+	void test_convert444() {
+		_seed = 1;
+		checkConversion(0);
+	}
+
+	void test_convert420() {
+		_seed = 2;
+		checkConversion(1);
+	}
+
+	void test_convert410() {
+		_seed = 3;
+		checkConversion(2);
+	}
+};
@@ -5,14 +5,19 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h
+TEST_LIBS    := audio/libaudio.a graphics/libgraphics.a common/libcommon.a
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
 	TEST_LIBS += engines/wintermute/libwintermute.a
 endif
 
+ifdef POSIX
+	TESTS += $(srcdir)/test/backends/fs/posix/*.h
+	TEST_LIBS += backends/fs/posix/posix-mmapstream.o backends/fs/stdiostream.o
+endif
+
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
 TEST_CFLAGS  := $(CFLAGS) -I$(srcdir)/test/cxxtest
@@ -42,8 +47,32 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+# Benchmarks, not run as part of the tests. The '<name>-bench' target builds
+# and runs test/benchmarks/<name>.cpp.
+BENCHMARKS      := scaler blit yuv conversion theme ttf vectorrenderer lookup hashmap hash opl zip detection
+BENCHMARK_LIBS  := gui/libgui.a audio/libaudio.a image/libimage.a graphics/libgraphics.a common/libcommon.a
+BENCHMARK_BINS  := $(BENCHMARKS:%=test/benchmarks/%$(EXEEXT))
+
+theme-bench: BENCHMARK_ARGS := $(srcdir)/gui/themes
+ttf-bench: BENCHMARK_ARGS := $(srcdir)/gui/themes/fonts/FreeSans.ttf
+opl-bench: BENCHMARK_ARGS := $(srcdir)/test/benchmarks/music.dro
+
+test/benchmarks/detection$(EXEEXT): engines/advancedDetector.o engines/obsolete.o engines/game.o engines/savestate.o
+ifdef POSIX
+test/benchmarks/detection$(EXEEXT): backends/fs/abstract-fs.o backends/fs/stdiostream.o \
+	backends/fs/posix/posix-fs.o backends/fs/posix/posix-fs-factory.o backends/fs/posix/posix-mmapstream.o
+test/benchmarks/theme$(EXEEXT): backends/fs/abstract-fs.o backends/fs/stdiostream.o \
+	backends/fs/posix/posix-fs.o backends/fs/posix/posix-fs-factory.o backends/fs/posix/posix-mmapstream.o
+endif
+
+$(BENCHMARKS:%=%-bench): %-bench: test/benchmarks/%$(EXEEXT)
+	./$< $(BENCHMARK_ARGS)
+$(BENCHMARK_BINS): test/benchmarks/%$(EXEEXT): $(srcdir)/test/benchmarks/%.cpp $(BENCHMARK_LIBS)
+	@mkdir -p test/benchmarks
+	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(CFLAGS) -o $@ $(filter-out %.a,$+) $(filter %.a,$+) $(TEST_LDFLAGS)
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner $(BENCHMARK_BINS)
 
-.PHONY: test clean-test
+.PHONY: test $(BENCHMARKS:%=%-bench) clean-test
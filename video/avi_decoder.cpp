@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/bufferedstream.h"
 #include "common/stream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -395,7 +396,10 @@ bool AVIDecoder::loadStream(Common::SeekableReadStream *stream) {
 		return false;
 	}
 
-	_fileStream = stream;
+	// The chunk headers are small, and without an index the tracks search
+	// the file for their chunks independently, seeking back and forth. Keep
+	// some blocks of the file around, so these reads rarely reach it.
+	_fileStream = Common::wrapCachedSeekableReadStream(stream, 4096, 8, DisposeAfterUse::YES);
 
 	// Go through all chunks in the file
 	while (_fileStream->pos() < fileSize && parseNextChunk())
@@ -26,6 +26,7 @@
 
 #include "video/smk_decoder.h"
 
+#include "common/bufferedstream.h"
 #include "common/endian.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -290,7 +291,10 @@ SmackerDecoder::~SmackerDecoder() {
 bool SmackerDecoder::loadStream(Common::SeekableReadStream *stream) {
 	close();
 
-	_fileStream = stream;
+	// Every frame starts with small reads of its palette and chunk sizes,
+	// so keep some blocks of the file around instead of going to it for
+	// each of them.
+	_fileStream = Common::wrapCachedSeekableReadStream(stream, 4096, 8, DisposeAfterUse::YES);
 
 	// Read in the Smacker header
 	_header.signature = _fileStream->readUint32BE();